@@ -3,6 +3,7 @@
 
 #include <openenclave/advanced/allocator.h>
 #include <openenclave/advanced/mallinfo.h>
+#include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
 
 #define HAVE_MMAP 0
@@ -76,26 +77,199 @@ void oe_allocator_cleanup(void)
 {
 }
 
+/*
+**==============================================================================
+**
+** Thread cache
+**
+** dlmalloc serializes all allocations on a single global lock. To keep the
+** threads of an enclave from contending on it, each thread keeps the small
+** blocks it frees on lists indexed by size class and serves small allocations
+** from them. An empty list is refilled with several blocks carved out under a
+** single acquisition of the lock, and a full list returns half of its blocks
+** at once with dlbulk_free(). Cached blocks remain allocated as far as
+** dlmalloc is concerned; they are returned when the thread exits.
+**
+**==============================================================================
+*/
+
+// Size classes are multiples of OE_THREAD_CACHE_CLASS_SIZE bytes, up to
+// OE_THREAD_CACHE_MAX_SIZE bytes.
+#define OE_THREAD_CACHE_CLASS_SIZE 16
+#define OE_THREAD_CACHE_NUM_CLASSES 16
+#define OE_THREAD_CACHE_MAX_SIZE \
+    (OE_THREAD_CACHE_CLASS_SIZE * OE_THREAD_CACHE_NUM_CLASSES)
+
+// Maximum number of blocks cached per size class.
+#define OE_THREAD_CACHE_MAX_BLOCKS 32
+
+// Number of blocks allocated at once when a list is empty.
+#define OE_THREAD_CACHE_REFILL_BLOCKS 8
+
+typedef struct _cached_block
+{
+    struct _cached_block* next;
+} cached_block_t;
+
+typedef struct _thread_cache
+{
+    // Set between oe_allocator_thread_init() and
+    // oe_allocator_thread_cleanup(). Blocks freed outside of this window go
+    // straight to dlmalloc.
+    bool enabled;
+    cached_block_t* blocks[OE_THREAD_CACHE_NUM_CLASSES];
+    size_t num_blocks[OE_THREAD_CACHE_NUM_CLASSES];
+} thread_cache_t;
+
+static __thread thread_cache_t _thread_cache;
+
+static size_t _class_size(size_t index)
+{
+    return (index + 1) * OE_THREAD_CACHE_CLASS_SIZE;
+}
+
+/* Return up to count blocks of the given class to dlmalloc */
+static void _release_blocks(
+    thread_cache_t* cache,
+    size_t index,
+    size_t count)
+{
+    void* blocks[OE_THREAD_CACHE_MAX_BLOCKS];
+    size_t n = 0;
+
+    while (n < count && n < OE_THREAD_CACHE_MAX_BLOCKS && cache->blocks[index])
+    {
+        cached_block_t* block = cache->blocks[index];
+        cache->blocks[index] = block->next;
+        cache->num_blocks[index]--;
+        blocks[n++] = block;
+    }
+
+    if (n)
+        dlbulk_free(blocks, n);
+}
+
+static void _flush_thread_cache(thread_cache_t* cache)
+{
+    for (size_t i = 0; i < OE_THREAD_CACHE_NUM_CLASSES; i++)
+        _release_blocks(cache, i, cache->num_blocks[i]);
+}
+
+/* Allocate a block of the given class, refilling the list if needed */
+static void* _cache_malloc(thread_cache_t* cache, size_t index)
+{
+    cached_block_t* block = cache->blocks[index];
+    void* blocks[OE_THREAD_CACHE_REFILL_BLOCKS];
+    size_t sizes[OE_THREAD_CACHE_REFILL_BLOCKS];
+
+    if (block)
+    {
+        cache->blocks[index] = block->next;
+        cache->num_blocks[index]--;
+        return block;
+    }
+
+    for (size_t i = 0; i < OE_THREAD_CACHE_REFILL_BLOCKS; i++)
+        sizes[i] = _class_size(index);
+
+    // The blocks are carved out of a single chunk, but each of them can be
+    // freed on its own. Fall back to a single block if the heap cannot
+    // provide a chunk that large.
+    if (!dlindependent_comalloc(OE_THREAD_CACHE_REFILL_BLOCKS, sizes, blocks))
+        return dlmalloc(_class_size(index));
+
+    for (size_t i = OE_THREAD_CACHE_REFILL_BLOCKS - 1; i > 0; i--)
+    {
+        block = (cached_block_t*)blocks[i];
+        block->next = cache->blocks[index];
+        cache->blocks[index] = block;
+        cache->num_blocks[index]++;
+    }
+
+    return blocks[0];
+}
+
+/* Cache a block if it is small enough. Returns false otherwise */
+static bool _cache_free(thread_cache_t* cache, void* ptr)
+{
+    size_t usable_size = dlmalloc_usable_size(ptr);
+    size_t index;
+    cached_block_t* block = (cached_block_t*)ptr;
+
+    // The block can serve any allocation of the largest class that fits in
+    // its usable size.
+    if (usable_size < OE_THREAD_CACHE_CLASS_SIZE ||
+        usable_size >= OE_THREAD_CACHE_MAX_SIZE + OE_THREAD_CACHE_CLASS_SIZE)
+        return false;
+
+    index = usable_size / OE_THREAD_CACHE_CLASS_SIZE - 1;
+
+    if (cache->num_blocks[index] == OE_THREAD_CACHE_MAX_BLOCKS)
+        _release_blocks(cache, index, OE_THREAD_CACHE_MAX_BLOCKS / 2);
+
+    block->next = cache->blocks[index];
+    cache->blocks[index] = block;
+    cache->num_blocks[index]++;
+
+    return true;
+}
+
 void oe_allocator_thread_init(void)
 {
+    _thread_cache.enabled = true;
 }
 
 void oe_allocator_thread_cleanup(void)
 {
+    thread_cache_t* cache = &_thread_cache;
+
+    cache->enabled = false;
+    _flush_thread_cache(cache);
 }
 
 void* oe_allocator_malloc(size_t size)
 {
+    thread_cache_t* cache = &_thread_cache;
+
+    if (cache->enabled && size <= OE_THREAD_CACHE_MAX_SIZE)
+    {
+        size_t index = size ? (size - 1) / OE_THREAD_CACHE_CLASS_SIZE : 0;
+        return _cache_malloc(cache, index);
+    }
+
     return dlmalloc(size);
 }
 
 void oe_allocator_free(void* ptr)
 {
+    thread_cache_t* cache = &_thread_cache;
+
+    if (!ptr)
+        return;
+
+    if (cache->enabled && _cache_free(cache, ptr))
+        return;
+
     dlfree(ptr);
 }
 
 void* oe_allocator_calloc(size_t nmemb, size_t size)
 {
+    thread_cache_t* cache = &_thread_cache;
+    size_t total_size;
+    void* ptr;
+
+    if (cache->enabled && nmemb && size && size <= OE_THREAD_CACHE_MAX_SIZE &&
+        nmemb <= OE_THREAD_CACHE_MAX_SIZE / size)
+    {
+        total_size = nmemb * size;
+
+        if ((ptr = oe_allocator_malloc(total_size)))
+            memset(ptr, 0, total_size);
+
+        return ptr;
+    }
+
     return dlcalloc(nmemb, size);
 }
 
@@ -123,6 +297,10 @@ oe_result_t oe_allocator_mallinfo(oe_mallinfo_t* info)
 {
     info->max_total_heap_size = _max_heap_size;
 
+    // Do not report the blocks cached by the calling thread as allocated.
+    if (_thread_cache.enabled)
+        _flush_thread_cache(&_thread_cache);
+
     struct mallinfo minfo = dlmallinfo();
     // uordblks:  current total allocated space (normal or mmapped)
     info->current_allocated_heap_size = minfo.uordblks;
@@ -0,0 +1,460 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+/*
+**==============================================================================
+**
+** quote verification collateral cache:
+**
+**     The TCB info, QE identity and CRLs for an FMSPC and PCK CA type only
+**     change when Intel publishes new ones, and each of them states when the
+**     next update is due. Collateral is therefore kept per FMSPC and CA type
+**     and reused until the earliest nextUpdate among its items. Collateral
+**     whose issue dates are in the future is not reused either.
+**
+**     Every use of the collateral still verifies it, including its dates, so
+**     the cache only saves the round trip to the quote provider.
+**
+**     A call that misses marks the entry as pending while it fetches. Calls
+**     for the same key in the meantime wait for that fetch and share its
+**     result instead of fetching again.
+**
+**     The least recently used entry is replaced when the cache is full.
+**     Entries with a fetch in progress or with waiters are never replaced;
+**     when all of them are busy, the collateral is fetched without caching.
+**
+**==============================================================================
+*/
+
+#include "collateralcache.h"
+#include <openenclave/internal/crypto/crl.h>
+#include <openenclave/internal/datetime.h>
+#include <openenclave/internal/pem.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/safecrt.h>
+#include <openenclave/internal/trace.h>
+#include "../common.h"
+#include "collateral.h"
+#include "tcbinfo.h"
+
+#ifdef OE_BUILD_ENCLAVE
+#include <openenclave/internal/thread.h>
+#else
+#include "../../host/hostthread.h"
+typedef oe_mutex oe_mutex_t;
+typedef oe_cond oe_cond_t;
+#define OE_MUTEX_INITIALIZER OE_H_MUTEX_INITIALIZER
+#endif
+
+/* Number of items in the collateral */
+#define NUM_ITEMS 7
+
+typedef oe_get_sgx_quote_verification_collateral_args_t args_t;
+
+typedef struct _entry
+{
+    /* The key */
+    uint8_t fmspc[6];
+    uint8_t collateral_provider;
+    bool used;
+
+    /* A fetch for this key is in progress */
+    bool pending;
+
+    /* Number of calls waiting for the pending fetch */
+    size_t waiters;
+
+    /* Incremented when a fetch completes, with the result of that fetch */
+    uint64_t fetches;
+    oe_result_t fetch_result;
+
+    /* The items of the last fetched collateral, one after the other */
+    uint8_t* data;
+    size_t sizes[NUM_ITEMS];
+
+    /* The collateral may be reused until expires */
+    bool reusable;
+    oe_datetime_t expires;
+
+    uint64_t last_used;
+} entry_t;
+
+static oe_mutex_t _lock = OE_MUTEX_INITIALIZER;
+
+/* Broadcast when a pending fetch completes */
+#ifdef OE_BUILD_ENCLAVE
+static oe_cond_t _done = OE_COND_INITIALIZER;
+#else
+static oe_cond_t _done;
+static oe_once_type _done_once = OE_H_ONCE_INITIALIZER;
+
+static void _init_done(void)
+{
+    oe_cond_init(&_done);
+}
+#endif
+
+static entry_t _entries[OE_COLLATERAL_CACHE_MAX_ENTRIES];
+static uint64_t _clock;
+static uint64_t _hits;
+static uint64_t _misses;
+
+static void _get_items(
+    args_t* args,
+    uint8_t** items[NUM_ITEMS],
+    size_t* sizes[NUM_ITEMS])
+{
+    items[0] = &args->tcb_info;
+    sizes[0] = &args->tcb_info_size;
+    items[1] = &args->tcb_info_issuer_chain;
+    sizes[1] = &args->tcb_info_issuer_chain_size;
+    items[2] = &args->pck_crl;
+    sizes[2] = &args->pck_crl_size;
+    items[3] = &args->pck_crl_issuer_chain;
+    sizes[3] = &args->pck_crl_issuer_chain_size;
+    items[4] = &args->root_ca_crl;
+    sizes[4] = &args->root_ca_crl_size;
+    items[5] = &args->qe_identity;
+    sizes[5] = &args->qe_identity_size;
+    items[6] = &args->qe_identity_issuer_chain;
+    sizes[6] = &args->qe_identity_issuer_chain_size;
+}
+
+/* Copy the items of the collateral into one new buffer */
+static uint8_t* _pack(
+    args_t* args,
+    size_t sizes[NUM_ITEMS])
+{
+    uint8_t** items[NUM_ITEMS];
+    size_t* item_sizes[NUM_ITEMS];
+    size_t total = 0;
+    size_t offset = 0;
+    uint8_t* data;
+
+    _get_items(args, items, item_sizes);
+
+    for (size_t i = 0; i < NUM_ITEMS; i++)
+    {
+        sizes[i] = *item_sizes[i];
+        total += sizes[i];
+    }
+
+    if (!(data = (uint8_t*)oe_malloc(total ? total : 1)))
+        return NULL;
+
+    for (size_t i = 0; i < NUM_ITEMS; i++)
+    {
+        if (sizes[i])
+            memcpy(data + offset, *items[i], sizes[i]);
+
+        offset += sizes[i];
+    }
+
+    return data;
+}
+
+/* Return a copy of the cached collateral in args->host_out_buffer */
+static oe_result_t _unpack(
+    const entry_t* entry,
+    args_t* args)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t** items[NUM_ITEMS];
+    size_t* sizes[NUM_ITEMS];
+    size_t total = 0;
+    size_t offset = 0;
+    uint8_t* data;
+
+    if (!entry->data)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < NUM_ITEMS; i++)
+        total += entry->sizes[i];
+
+    if (!(data = (uint8_t*)oe_malloc(total ? total : 1)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    memcpy(data, entry->data, total);
+    args->host_out_buffer = data;
+
+    _get_items(args, items, sizes);
+
+    for (size_t i = 0; i < NUM_ITEMS; i++)
+    {
+        *sizes[i] = entry->sizes[i];
+        *items[i] = entry->sizes[i] ? data + offset : NULL;
+        offset += entry->sizes[i];
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _get_crl_update_dates(
+    const uint8_t* data,
+    size_t size,
+    oe_datetime_t* this_update,
+    oe_datetime_t* next_update)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_crl_t crl = {0};
+    bool crl_read = false;
+
+    if (!data)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // v1/v2 CRLs are PEM encoded, v3 CRLs are DER encoded.
+    if (size >= OE_PEM_BEGIN_CRL_LEN &&
+        memcmp(data, OE_PEM_BEGIN_CRL, OE_PEM_BEGIN_CRL_LEN) == 0)
+        OE_CHECK(oe_crl_read_pem(&crl, data, size));
+    else
+        OE_CHECK(oe_crl_read_der(&crl, data, size));
+
+    crl_read = true;
+    OE_CHECK(oe_crl_get_update_dates(&crl, this_update, next_update));
+
+    result = OE_OK;
+
+done:
+    if (crl_read)
+        oe_crl_free(&crl);
+
+    return result;
+}
+
+/* Get the latest issue date and the earliest next update of the TCB info, the
+ * QE identity and the CRLs. */
+static oe_result_t _get_validity(
+    const args_t* args,
+    oe_datetime_t* from,
+    oe_datetime_t* until)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_datetime_t issued[4];
+    oe_datetime_t next[4];
+
+    OE_CHECK(oe_read_json_update_dates(
+        args->tcb_info, args->tcb_info_size, &issued[0], &next[0]));
+    OE_CHECK(oe_read_json_update_dates(
+        args->qe_identity, args->qe_identity_size, &issued[1], &next[1]));
+    OE_CHECK(_get_crl_update_dates(
+        args->pck_crl, args->pck_crl_size, &issued[2], &next[2]));
+    OE_CHECK(_get_crl_update_dates(
+        args->root_ca_crl, args->root_ca_crl_size, &issued[3], &next[3]));
+
+    *from = issued[0];
+    *until = next[0];
+
+    for (size_t i = 1; i < OE_COUNTOF(issued); i++)
+    {
+        if (oe_datetime_compare(&issued[i], from) > 0)
+            *from = issued[i];
+
+        if (oe_datetime_compare(&next[i], until) < 0)
+            *until = next[i];
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Called with the lock held */
+static entry_t* _find(const args_t* args)
+{
+    for (size_t i = 0; i < OE_COUNTOF(_entries); i++)
+    {
+        entry_t* entry = &_entries[i];
+
+        if (entry->used &&
+            entry->collateral_provider == args->collateral_provider &&
+            memcmp(entry->fmspc, args->fmspc, sizeof(entry->fmspc)) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+/* Called with the lock held. Returns NULL when all the entries are busy. */
+static entry_t* _add(const args_t* args)
+{
+    entry_t* entry = NULL;
+
+    for (size_t i = 0; i < OE_COUNTOF(_entries); i++)
+    {
+        entry_t* e = &_entries[i];
+
+        if (!e->used)
+        {
+            entry = e;
+            break;
+        }
+
+        if (!e->pending && !e->waiters &&
+            (!entry || e->last_used < entry->last_used))
+            entry = e;
+    }
+
+    if (entry)
+    {
+        oe_free(entry->data);
+        memset(entry, 0, sizeof(*entry));
+        memcpy(entry->fmspc, args->fmspc, sizeof(entry->fmspc));
+        entry->collateral_provider = args->collateral_provider;
+        entry->used = true;
+    }
+
+    return entry;
+}
+
+oe_result_t oe_get_cached_sgx_quote_verification_collateral(
+    oe_get_sgx_quote_verification_collateral_args_t* args,
+    oe_collateral_fetch_t fetch)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_datetime_t now = {0};
+    entry_t* entry;
+    uint8_t* data = NULL;
+    size_t sizes[NUM_ITEMS];
+    bool reusable = false;
+    oe_datetime_t from = {0};
+    oe_datetime_t until = {0};
+
+    if (!args || !fetch)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_datetime_now(&now));
+
+#ifndef OE_BUILD_ENCLAVE
+    oe_once(&_done_once, _init_done);
+#endif
+
+    oe_mutex_lock(&_lock);
+
+    entry = _find(args);
+
+    if (entry)
+        entry->last_used = ++_clock;
+
+    if (entry && entry->reusable &&
+        oe_datetime_compare(&now, &entry->expires) < 0)
+    {
+        _hits++;
+        result = _unpack(entry, args);
+        oe_mutex_unlock(&_lock);
+        OE_CHECK(result);
+        goto done;
+    }
+
+    if (entry && entry->pending)
+    {
+        uint64_t fetches = entry->fetches;
+
+        _hits++;
+        entry->waiters++;
+
+        while (entry->fetches == fetches)
+            oe_cond_wait(&_done, &_lock);
+
+        entry->waiters--;
+        result = entry->fetch_result;
+
+        if (result == OE_OK)
+            result = _unpack(entry, args);
+
+        oe_mutex_unlock(&_lock);
+        OE_CHECK(result);
+        goto done;
+    }
+
+    _misses++;
+
+    if (!entry)
+        entry = _add(args);
+
+    if (entry)
+        entry->pending = true;
+
+    oe_mutex_unlock(&_lock);
+
+    result = fetch(args);
+
+    if (!entry)
+        goto done;
+
+    if (result == OE_OK)
+    {
+        data = _pack(args, sizes);
+
+        reusable = data && _get_validity(args, &from, &until) == OE_OK &&
+                   oe_datetime_compare(&from, &now) <= 0 &&
+                   oe_datetime_compare(&now, &until) < 0;
+
+        if (!reusable)
+            OE_TRACE_INFO("quote verification collateral is not cached");
+    }
+
+    oe_mutex_lock(&_lock);
+
+    oe_free(entry->data);
+    entry->data = data;
+
+    if (data)
+        memcpy(entry->sizes, sizes, sizeof(sizes));
+    else
+        memset(entry->sizes, 0, sizeof(entry->sizes));
+
+    data = NULL;
+    entry->reusable = reusable;
+    entry->expires = until;
+
+    /* Waiters report a failure to keep a copy as running out of memory */
+    entry->fetch_result =
+        result != OE_OK ? result : entry->data ? OE_OK : OE_OUT_OF_MEMORY;
+    entry->pending = false;
+    entry->fetches++;
+    oe_cond_broadcast(&_done);
+
+    oe_mutex_unlock(&_lock);
+
+done:
+    return result;
+}
+
+void oe_get_collateral_cache_stats(uint64_t* hits, uint64_t* misses)
+{
+    oe_mutex_lock(&_lock);
+
+    if (hits)
+        *hits = _hits;
+
+    if (misses)
+        *misses = _misses;
+
+    oe_mutex_unlock(&_lock);
+}
+
+void oe_clear_collateral_cache(void)
+{
+    oe_mutex_lock(&_lock);
+
+    for (size_t i = 0; i < OE_COUNTOF(_entries); i++)
+    {
+        entry_t* entry = &_entries[i];
+
+        /* Busy entries keep their data for the waiters, but are not reused */
+        if (entry->pending || entry->waiters)
+        {
+            entry->reusable = false;
+            continue;
+        }
+
+        oe_free(entry->data);
+        memset(entry, 0, sizeof(*entry));
+    }
+
+    oe_mutex_unlock(&_lock);
+}
@@ -0,0 +1,65 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_COMMON_SGX_COLLATERALCACHE_H
+#define _OE_COMMON_SGX_COLLATERALCACHE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/report.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Maximum number of FMSPC and CA type pairs that the quote verification
+ * collateral cache holds.
+ */
+#define OE_COLLATERAL_CACHE_MAX_ENTRIES 64
+
+/**
+ * Fetch the quote verification collateral for args->fmspc and
+ * args->collateral_provider.
+ */
+typedef oe_result_t (*oe_collateral_fetch_t)(
+    oe_get_sgx_quote_verification_collateral_args_t* args);
+
+/**
+ * Get the quote verification collateral for args->fmspc and
+ * args->collateral_provider from the cache, or with **fetch** on a miss.
+ *
+ * Collateral is reused until the earliest nextUpdate of its TCB info, QE
+ * identity and CRLs. Collateral that is not valid yet, has expired, or whose
+ * dates cannot be read is returned but not reused. Concurrent calls that miss
+ * on the same key share a single fetch.
+ *
+ * Collateral from the cache is returned in a single buffer at
+ * args->host_out_buffer, which oe_free_sgx_quote_verification_collateral_args()
+ * releases.
+ *
+ * @param[in,out] args The quote verification collateral.
+ * @param[in] fetch The function that fetches the collateral on a miss.
+ */
+oe_result_t oe_get_cached_sgx_quote_verification_collateral(
+    oe_get_sgx_quote_verification_collateral_args_t* args,
+    oe_collateral_fetch_t fetch);
+
+/**
+ * Get the number of calls to oe_get_cached_sgx_quote_verification_collateral()
+ * that were answered from the cache, including the ones that waited for the
+ * fetch of another call, and the number of fetches.
+ *
+ * @param[out] hits The number of hits, or NULL.
+ * @param[out] misses The number of misses, or NULL.
+ */
+void oe_get_collateral_cache_stats(uint64_t* hits, uint64_t* misses);
+
+/**
+ * Drop the cached collateral. Fetches in progress complete normally. Called
+ * by oe_verifier_shutdown().
+ */
+void oe_clear_collateral_cache(void);
+
+OE_EXTERNC_END
+
+#endif // _OE_COMMON_SGX_COLLATERALCACHE_H
@@ -1426,4 +1426,71 @@ oe_result_t oe_parse_advisoryids_json(
 done:
 
     return result;
-}
\ No newline at end of file
+}
+
+oe_result_t oe_read_json_update_dates(
+    const uint8_t* json,
+    size_t json_size,
+    oe_datetime_t* issue_date,
+    oe_datetime_t* next_update)
+{
+    oe_result_t result = OE_JSON_INFO_PARSE_ERROR;
+    const uint8_t* itr = json;
+    const uint8_t* end = json + json_size;
+    const uint8_t* name = NULL;
+    size_t name_length = 0;
+    bool has_issue_date = false;
+    bool has_next_update = false;
+
+    if (!json || !issue_date || !next_update)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    // Enter the object under the top level property, such as "tcbInfo".
+    itr = _skip_ws(itr, end);
+    OE_CHECK(_read('{', &itr, end));
+    OE_CHECK(_read_string(&itr, end, &name, &name_length));
+    OE_CHECK(_read(':', &itr, end));
+    OE_CHECK(_read('{', &itr, end));
+
+    // The dates follow a few string and integer properties in every version.
+    while (!has_issue_date || !has_next_update)
+    {
+        const uint8_t* str = NULL;
+        size_t size = 0;
+        uint64_t value = 0;
+
+        OE_CHECK(_read_string(&itr, end, &name, &name_length));
+        OE_CHECK(_read(':', &itr, end));
+
+        if (itr < end && *itr == '"')
+        {
+            OE_CHECK(_read_string(&itr, end, &str, &size));
+
+            if (_json_str_equal(name, name_length, "issueDate"))
+            {
+                if (oe_datetime_from_string(
+                        (const char*)str, size, issue_date) != OE_OK)
+                    OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
+                has_issue_date = true;
+            }
+            else if (_json_str_equal(name, name_length, "nextUpdate"))
+            {
+                if (oe_datetime_from_string(
+                        (const char*)str, size, next_update) != OE_OK)
+                    OE_RAISE(OE_JSON_INFO_PARSE_ERROR);
+                has_next_update = true;
+            }
+        }
+        else
+        {
+            OE_CHECK(_read_integer(&itr, end, &value));
+        }
+
+        if (!has_issue_date || !has_next_update)
+            OE_CHECK(_read(',', &itr, end));
+    }
+
+    result = OE_OK;
+done:
+    return result;
+}
@@ -216,6 +216,21 @@ oe_result_t oe_parse_advisoryids_json(
     size_t id_sizes_size,
     size_t* num_ids);
 
+/*!
+ * Read the issueDate and nextUpdate fields of a TCB info or QE identity json
+ * string, without parsing or verifying the rest of it.
+ *
+ * @param[in] json The json string.
+ * @param[in] json_size The string length of json.
+ * @param[out] issue_date The issueDate field.
+ * @param[out] next_update The nextUpdate field.
+ */
+oe_result_t oe_read_json_update_dates(
+    const uint8_t* json,
+    size_t json_size,
+    oe_datetime_t* issue_date,
+    oe_datetime_t* next_update);
+
 OE_EXTERNC_END
 
 #endif // _OE_COMMON_TCBINFO_H
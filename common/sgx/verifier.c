@@ -13,6 +13,7 @@
 
 #include "../attest_plugin.h"
 #include "../common.h"
+#include "collateralcache.h"
 #include "endorsements.h"
 #include "quote.h"
 #include "report.h"
@@ -934,6 +935,9 @@ oe_result_t oe_verifier_shutdown(void)
 {
     oe_result_t result = OE_UNEXPECTED;
 
+    // The enclave calls this on termination, before checking for leaks.
+    oe_clear_collateral_cache();
+
     if (oe_mutex_lock(&init_mutex))
         OE_RAISE(OE_UNEXPECTED);
 
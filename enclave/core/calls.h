@@ -12,10 +12,22 @@
 extern const oe_ecall_func_t __oe_ecalls_table[];
 extern const size_t __oe_ecalls_table_size;
 
+/**
+ * The __oe_ecalls_zero_copy_table marks the ecalls declared zero_copy. It is
+ * generated by oeedger8r only when the enclave declares such ecalls.
+ */
+extern const uint8_t* __oe_ecalls_zero_copy_table;
+
 typedef struct _ecall_table
 {
     const oe_ecall_func_t* ecalls;
     size_t num_ecalls;
 } ecall_table_t;
 
+/**
+ * Release the ocall batches kept for reuse. Called when the enclave
+ * terminates.
+ */
+void oe_free_ocall_batches(void);
+
 #endif /* OE_CALLS_H */
@@ -4,6 +4,7 @@
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/calls.h>
 
 // Function used by oeedger8r for allocating ocall buffers. This function can be
 // optimized by allocating a buffer for making ocalls and pass it in to the
@@ -23,6 +24,19 @@ void oe_free_ocall_buffer(void* buffer)
     oe_free(buffer);
 }
 
+// OCALL arguments are copied by libutee, so the host cannot fill enclave
+// provided buffers in place. Callers marshal the data instead.
+void* oe_allocate_ocall_staging_buffer(size_t size)
+{
+    OE_UNUSED(size);
+    return NULL;
+}
+
+void oe_free_ocall_staging_buffer(void* buffer)
+{
+    OE_UNUSED(buffer);
+}
+
 // TODO
 void* oe_allocate_arena(size_t capacity)
 {
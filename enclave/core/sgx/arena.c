@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "arena.h"
+#include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/edger8r/common.h>
 #include <openenclave/internal/print.h>
@@ -11,11 +12,41 @@
 #include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 
+/*
+**==============================================================================
+**
+** Shared memory arena
+**
+** Each thread allocates the buffers of its switchless ocalls from a list of
+** host memory chunks. Allocations are bumped from the current chunk; when it
+** is full, the arena moves to the next chunk, allocating one from the host if
+** needed. A chunk is at least as large as the allocation, so that calls of
+** any size stay switchless. Resetting the arena rewinds it to the first chunk.
+** The extra chunks are returned to the host once the thread has not needed
+** them for OE_ARENA_IDLE_RESETS consecutive resets, and all chunks are
+** returned when the outermost ecall of the thread exits.
+**
+** The chunk descriptors are kept in enclave memory so that the host cannot
+** tamper with the list.
+**
+**==============================================================================
+*/
+
 // Default shared memory arena capacity is 1 mb
 static size_t _capacity = 1024 * 1024;
 
 static const size_t _max_capacity = 1 << 30;
 
+typedef struct _oe_arena_chunk
+{
+    struct _oe_arena_chunk* next;
+    uint8_t* buffer;
+    size_t capacity;
+    size_t used;
+} oe_arena_chunk_t;
+
+static oe_arena_statistics_t _statistics;
+
 void* oe_allocate_arena(size_t capacity);
 void oe_deallocate_arena(void* buffer);
 
@@ -25,6 +56,21 @@ static oe_shared_memory_arena_t* _get_arena()
     return &oe_sgx_get_td()->arena;
 }
 
+static void _update_maximum(size_t* maximum, size_t value)
+{
+    size_t current = __atomic_load_n(maximum, __ATOMIC_RELAXED);
+
+    while (value > current &&
+           !__atomic_compare_exchange_n(
+               maximum,
+               &current,
+               value,
+               false,
+               __ATOMIC_RELAXED,
+               __ATOMIC_RELAXED))
+        ;
+}
+
 bool oe_configure_arena_capacity(size_t cap)
 {
     if (cap > _max_capacity)
@@ -35,48 +81,123 @@ bool oe_configure_arena_capacity(size_t cap)
     return true;
 }
 
+bool oe_configure_thread_arena_capacity(size_t cap)
+{
+    if (cap > _max_capacity)
+        return false;
+
+    _get_arena()->chunk_capacity = cap;
+    return true;
+}
+
+static oe_arena_chunk_t* _new_chunk(
+    oe_shared_memory_arena_t* arena,
+    size_t min_capacity)
+{
+    oe_arena_chunk_t* chunk = NULL;
+    size_t capacity = arena->chunk_capacity;
+
+    if (capacity == 0)
+        capacity = __atomic_load_n(&_capacity, __ATOMIC_SEQ_CST);
+
+    if (capacity < min_capacity)
+        capacity = min_capacity;
+
+    if (capacity > _max_capacity)
+        return NULL;
+
+    if (!(chunk = (oe_arena_chunk_t*)oe_calloc(1, sizeof(*chunk))))
+        return NULL;
+
+    if (!(chunk->buffer = (uint8_t*)oe_allocate_arena(capacity)))
+    {
+        oe_free(chunk);
+        return NULL;
+    }
+
+    chunk->capacity = capacity;
+    arena->num_chunks++;
+
+    __atomic_add_fetch(&_statistics.chunk_allocations, 1, __ATOMIC_RELAXED);
+    _update_maximum(&_statistics.max_chunk_count, arena->num_chunks);
+
+    return chunk;
+}
+
+static void _free_chunks(oe_arena_chunk_t* chunk)
+{
+    while (chunk)
+    {
+        oe_arena_chunk_t* next = chunk->next;
+        oe_deallocate_arena(chunk->buffer);
+        oe_free(chunk);
+        chunk = next;
+    }
+}
+
+bool oe_arena_is_active(void)
+{
+    return _get_arena()->chunks != NULL;
+}
+
 void* oe_arena_malloc(size_t size)
 {
     oe_result_t result = OE_UNEXPECTED;
     size_t total_size = 0;
     const size_t align = OE_EDGER8R_BUFFER_ALIGNMENT;
     oe_shared_memory_arena_t* arena = _get_arena();
-
-    // Create the arena if it hasn't been created.
-    if (arena->buffer == NULL)
-    {
-        arena->capacity = __atomic_load_n(&_capacity, __ATOMIC_SEQ_CST);
-        void* buffer = oe_allocate_arena(arena->capacity);
-        if (buffer == NULL)
-        {
-            arena->capacity = 0;
-            return NULL;
-        }
-        arena->buffer = (uint8_t*)buffer;
-        arena->used = 0;
-    }
+    oe_arena_chunk_t* chunk = arena->current;
+    uint8_t* addr = NULL;
 
     // Round up to the nearest alignment size.
     total_size = oe_round_up_to_multiple(size, align);
 
     // check for overflow
     if (total_size < size)
-        return NULL;
+        goto done;
 
-    // check for capacity
-    size_t used_after;
-    OE_CHECK(oe_safe_add_sizet(arena->used, total_size, &used_after));
+    // Find the first chunk with enough room. The chunks after the current
+    // one are empty.
+    while (chunk && total_size > chunk->capacity - chunk->used)
+        chunk = chunk->next;
 
-    // Ok if the incoming malloc puts us below the capacity.
-    if (used_after <= arena->capacity)
+    // Append a new chunk if none has enough room.
+    if (!chunk)
     {
-        uint8_t* addr = arena->buffer + arena->used;
-        arena->used = used_after;
-        return addr;
+        if (!(chunk = _new_chunk(arena, total_size)))
+            goto done;
+
+        if (arena->current)
+        {
+            oe_arena_chunk_t* last = arena->current;
+            while (last->next)
+                last = last->next;
+            last->next = chunk;
+        }
+        else
+        {
+            arena->chunks = chunk;
+        }
     }
 
+    addr = chunk->buffer + chunk->used;
+    chunk->used += total_size;
+    arena->current = chunk;
+
+    OE_CHECK(oe_safe_add_u64(arena->used, total_size, &arena->used));
+    _update_maximum(&_statistics.high_water_mark, arena->used);
+
+    result = OE_OK;
+
 done:
-    return NULL;
+    if (result != OE_OK)
+    {
+        __atomic_add_fetch(
+            &_statistics.failed_allocations, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    return addr;
 }
 
 void* oe_arena_calloc(size_t num, size_t size)
@@ -96,15 +217,57 @@ void* oe_arena_calloc(size_t num, size_t size)
 void oe_arena_free_all()
 {
     oe_shared_memory_arena_t* arena = _get_arena();
+    oe_arena_chunk_t* first = arena->chunks;
+
+    if (!first)
+        return;
+
+    // Track how long the extra chunks have gone unused.
+    if (arena->current == first)
+        arena->idle_resets++;
+    else
+        arena->idle_resets = 0;
+
+    for (oe_arena_chunk_t* chunk = first; chunk; chunk = chunk->next)
+        chunk->used = 0;
+
+    arena->current = first;
     arena->used = 0;
+
+    // Shrink back to a single chunk when the thread is idle.
+    if (first->next && arena->idle_resets >= OE_ARENA_IDLE_RESETS)
+    {
+        _free_chunks(first->next);
+        first->next = NULL;
+        arena->num_chunks = 1;
+        arena->idle_resets = 0;
+    }
 }
 
 // Free the arena in the current thread.
 void oe_teardown_arena()
 {
     oe_shared_memory_arena_t* arena = _get_arena();
+    size_t chunk_capacity = arena->chunk_capacity;
 
-    if (arena->buffer != NULL)
-        oe_deallocate_arena(arena->buffer);
+    _free_chunks(arena->chunks);
     memset(arena, 0, sizeof(oe_shared_memory_arena_t));
+
+    // The capacity configured for this thread outlives the ecall.
+    arena->chunk_capacity = chunk_capacity;
+}
+
+void oe_get_arena_statistics(oe_arena_statistics_t* statistics)
+{
+    if (!statistics)
+        return;
+
+    statistics->high_water_mark =
+        __atomic_load_n(&_statistics.high_water_mark, __ATOMIC_RELAXED);
+    statistics->max_chunk_count =
+        __atomic_load_n(&_statistics.max_chunk_count, __ATOMIC_RELAXED);
+    statistics->chunk_allocations =
+        __atomic_load_n(&_statistics.chunk_allocations, __ATOMIC_RELAXED);
+    statistics->failed_allocations =
+        __atomic_load_n(&_statistics.failed_allocations, __ATOMIC_RELAXED);
 }
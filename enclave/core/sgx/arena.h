@@ -6,8 +6,35 @@
 
 #include <openenclave/bits/types.h>
 
+/* Number of consecutive resets after which unused chunks are released */
+#define OE_ARENA_IDLE_RESETS 256
+
+typedef struct _oe_arena_statistics
+{
+    /* Most bytes in use at once by the arena of a thread */
+    size_t high_water_mark;
+
+    /* Most chunks held at once by the arena of a thread */
+    size_t max_chunk_count;
+
+    /* Chunks allocated from the host */
+    size_t chunk_allocations;
+
+    /* Allocations that could not be satisfied */
+    size_t failed_allocations;
+} oe_arena_statistics_t;
+
+/* Set the default capacity of arena chunks */
 bool oe_configure_arena_capacity(size_t cap);
 
+/* Set the capacity of arena chunks for the current thread, or zero to use the
+ * default. */
+bool oe_configure_thread_arena_capacity(size_t cap);
+
+/* Whether the current thread holds arena chunks, so that small allocations
+ * do not need to allocate host memory */
+bool oe_arena_is_active(void);
+
 void* oe_arena_malloc(size_t size);
 
 void* oe_arena_calloc(size_t num, size_t size);
@@ -16,4 +43,6 @@ void oe_arena_free_all();
 
 void oe_teardown_arena();
 
+void oe_get_arena_statistics(oe_arena_statistics_t* statistics);
+
 #endif /* _OE_ARENA_H */
@@ -0,0 +1,354 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/edger8r/enclave.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/safemath.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+#include "switchlesscalls.h"
+
+/*
+**==============================================================================
+**
+** Asynchronous switchless ocalls.
+**
+** An asynchronous ocall owns a block of host memory that holds the call
+** arguments followed by the marshalling buffer, so that the caller can return
+** while the host workers still read from it. The handle describing the block
+** is kept in enclave memory, so the host cannot redirect later accesses.
+**
+** Blocks are not freed when a call completes but kept on a free list, since
+** allocating host memory requires an ocall. Calls released before they
+** complete are kept on a detached list and moved to the free list once the
+** host has completed them. Both lists are released when the enclave
+** terminates, after the host workers have stopped.
+**
+**==============================================================================
+*/
+
+// Smallest marshalling buffer allocated. Buffers are rounded up to a power of
+// two so that they can be reused by calls with different sizes.
+#define OE_ASYNC_OCALL_MIN_BUFFER_SIZE 256
+
+// Maximum number of completed calls kept for reuse.
+#define OE_ASYNC_OCALL_MAX_FREE_CALLS 64
+
+// Maximum number of pauses between two polls of oe_wait_async_ocall().
+#define OE_ASYNC_OCALL_MAX_BACKOFF 1024
+
+struct _oe_async_ocall
+{
+    struct _oe_async_ocall* next;
+
+    // Host memory.
+    oe_call_host_function_args_t* args;
+    uint8_t* buffer;
+    size_t buffer_size;
+
+    // The output buffer passed to oe_post_async_ocall().
+    const void* output_buffer;
+    size_t output_buffer_size;
+};
+
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+static oe_async_ocall_t* _free_calls;
+static size_t _num_free_calls;
+static oe_async_ocall_t* _detached_calls;
+
+static bool _is_complete(oe_async_ocall_t* call)
+{
+    return __atomic_load_n(&call->args->result, __ATOMIC_ACQUIRE) !=
+           __OE_RESULT_MAX;
+}
+
+static void _free_call(oe_async_ocall_t* call)
+{
+    oe_host_free(call->args);
+    oe_free(call);
+}
+
+/* Move the completed detached calls to the free list. Called with _lock held.
+ * Returns the calls that did not fit in the free list. */
+static oe_async_ocall_t* _reclaim_detached_calls(void)
+{
+    oe_async_ocall_t** p = &_detached_calls;
+    oe_async_ocall_t* excess = NULL;
+
+    while (*p)
+    {
+        oe_async_ocall_t* call = *p;
+
+        if (!_is_complete(call))
+        {
+            p = &call->next;
+            continue;
+        }
+
+        *p = call->next;
+
+        if (_num_free_calls < OE_ASYNC_OCALL_MAX_FREE_CALLS)
+        {
+            call->next = _free_calls;
+            _free_calls = call;
+            _num_free_calls++;
+        }
+        else
+        {
+            call->next = excess;
+            excess = call;
+        }
+    }
+
+    return excess;
+}
+
+oe_async_ocall_t* oe_allocate_async_ocall(size_t buffer_size)
+{
+    oe_async_ocall_t* call = NULL;
+    oe_async_ocall_t* excess = NULL;
+    size_t capacity = OE_ASYNC_OCALL_MIN_BUFFER_SIZE;
+    size_t args_size = oe_round_up_to_multiple(
+        sizeof(oe_call_host_function_args_t), OE_EDGER8R_BUFFER_ALIGNMENT);
+    size_t block_size = 0;
+
+    oe_spin_lock(&_lock);
+    {
+        excess = _reclaim_detached_calls();
+
+        // Take the first free call that is large enough.
+        for (oe_async_ocall_t** p = &_free_calls; *p; p = &(*p)->next)
+        {
+            if ((*p)->buffer_size >= buffer_size)
+            {
+                call = *p;
+                *p = call->next;
+                _num_free_calls--;
+                break;
+            }
+        }
+    }
+    oe_spin_unlock(&_lock);
+
+    // Freeing host memory makes ocalls, so do it outside the lock.
+    while (excess)
+    {
+        oe_async_ocall_t* next = excess->next;
+        _free_call(excess);
+        excess = next;
+    }
+
+    if (call)
+    {
+        call->next = NULL;
+        return call;
+    }
+
+    while (capacity < buffer_size)
+    {
+        if (oe_safe_mul_sizet(capacity, 2, &capacity) != OE_OK)
+            return NULL;
+    }
+
+    if (oe_safe_add_sizet(args_size, capacity, &block_size) != OE_OK)
+        return NULL;
+
+    if (!(call = (oe_async_ocall_t*)oe_calloc(1, sizeof(*call))))
+        return NULL;
+
+    if (!(call->args = (oe_call_host_function_args_t*)oe_host_malloc(
+              block_size)))
+    {
+        oe_free(call);
+        return NULL;
+    }
+
+    call->buffer = (uint8_t*)call->args + args_size;
+    call->buffer_size = capacity;
+
+    // A call that has not been posted counts as complete.
+    call->args->result = OE_UNEXPECTED;
+
+    return call;
+}
+
+void* oe_get_async_ocall_buffer(oe_async_ocall_t* call)
+{
+    return call ? call->buffer : NULL;
+}
+
+/* Whether [ptr, ptr + size) lies within the marshalling buffer of the call */
+static bool _is_within_buffer(
+    oe_async_ocall_t* call,
+    const void* ptr,
+    size_t size)
+{
+    const uint8_t* start = (const uint8_t*)ptr;
+
+    return start >= call->buffer && start <= call->buffer + call->buffer_size &&
+           size <= (size_t)(call->buffer + call->buffer_size - start);
+}
+
+oe_result_t oe_post_async_ocall(
+    oe_async_ocall_t* call,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_host_function_args_t* args = NULL;
+
+    if (!call || !input_buffer || input_buffer_size == 0 ||
+        output_buffer_size < sizeof(oe_result_t))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!_is_within_buffer(call, input_buffer, input_buffer_size) ||
+        !_is_within_buffer(call, output_buffer, output_buffer_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    call->output_buffer = output_buffer;
+    call->output_buffer_size = output_buffer_size;
+
+    args = call->args;
+    args->function_id = function_id;
+    args->input_buffer = input_buffer;
+    args->input_buffer_size = input_buffer_size;
+    args->output_buffer = output_buffer;
+    args->output_buffer_size = output_buffer_size;
+    args->output_bytes_written = 0;
+    args->result = OE_UNEXPECTED;
+
+    if (oe_is_switchless_initialized())
+    {
+        result = oe_post_switchless_ocall(args);
+
+        if (result == OE_OK)
+            goto done;
+
+        if (result != OE_CONTEXT_SWITCHLESS_OCALL_MISSED)
+            OE_RAISE(result);
+    }
+
+    // Fall back to a regular ocall, which completes the call.
+    result = oe_ocall(
+        oe_is_switchless_initialized() ? OE_OCALL_CALL_HOST_FUNCTION_FALLBACK
+                                       : OE_OCALL_CALL_HOST_FUNCTION,
+        (uint64_t)args,
+        NULL);
+    if (result != OE_OK)
+        args->result = result;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_poll_async_ocall(oe_async_ocall_t* call)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t function_result = OE_UNEXPECTED;
+
+    if (!call)
+        return OE_INVALID_PARAMETER;
+
+    if (!_is_complete(call))
+        return OE_BUSY;
+
+    if ((result = call->args->result) != OE_OK)
+        return result;
+
+    // Currently exactly output_buffer_size bytes must be written.
+    if (call->args->output_bytes_written != call->output_buffer_size)
+        return OE_FAILURE;
+
+    // The output buffer starts with the result of the host function stub.
+    memcpy(&function_result, call->output_buffer, sizeof(function_result));
+    return function_result;
+}
+
+oe_result_t oe_wait_async_ocall(oe_async_ocall_t* call)
+{
+    oe_result_t result;
+    size_t backoff = 1;
+
+    if (!call)
+        return OE_INVALID_PARAMETER;
+
+    // Back off exponentially so that a long call does not keep the core
+    // spinning on the shared cache line.
+    while ((result = oe_poll_async_ocall(call)) == OE_BUSY)
+    {
+        for (size_t i = 0; i < backoff; i++)
+        {
+            /* Yield to CPU */
+            asm volatile("pause");
+        }
+
+        if (backoff < OE_ASYNC_OCALL_MAX_BACKOFF)
+            backoff *= 2;
+    }
+
+    oe_release_async_ocall(call);
+
+    return result;
+}
+
+void oe_release_async_ocall(oe_async_ocall_t* call)
+{
+    bool cached = false;
+
+    if (!call)
+        return;
+
+    oe_spin_lock(&_lock);
+    {
+        if (!_is_complete(call))
+        {
+            call->next = _detached_calls;
+            _detached_calls = call;
+            cached = true;
+        }
+        else if (_num_free_calls < OE_ASYNC_OCALL_MAX_FREE_CALLS)
+        {
+            call->next = _free_calls;
+            _free_calls = call;
+            _num_free_calls++;
+            cached = true;
+        }
+    }
+    oe_spin_unlock(&_lock);
+
+    if (!cached)
+        _free_call(call);
+}
+
+void oe_free_async_ocalls(void)
+{
+    oe_async_ocall_t* lists[2];
+
+    oe_spin_lock(&_lock);
+    {
+        lists[0] = _free_calls;
+        lists[1] = _detached_calls;
+        _free_calls = NULL;
+        _detached_calls = NULL;
+        _num_free_calls = 0;
+    }
+    oe_spin_unlock(&_lock);
+
+    // Freeing host memory makes ocalls, so do it outside the lock.
+    for (size_t i = 0; i < OE_COUNTOF(lists); i++)
+    {
+        while (lists[i])
+        {
+            oe_async_ocall_t* next = lists[i]->next;
+            _free_call(lists[i]);
+            lists[i] = next;
+        }
+    }
+}
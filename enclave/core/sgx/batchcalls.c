@@ -0,0 +1,350 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/edger8r/enclave.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/safemath.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+#include "../calls.h"
+
+/*
+**==============================================================================
+**
+** Batched ocalls.
+**
+** A batch owns a block of host memory that holds the argument of the batch
+** ocall, the arguments of up to OE_OCALL_BATCH_MAX_CALLS calls, and the
+** marshalling buffers of the calls. Submitting the batch makes a single
+** OE_OCALL_CALL_HOST_FUNCTION_BATCH ocall, for which the host performs the
+** calls in order.
+**
+** The output buffers of the calls are in the host block, but the enclave
+** keeps its own copy of their addresses and of the completions and result
+** locations, so that the host cannot redirect them. Batches are kept on a free
+** list when released, since allocating host memory requires an ocall. The
+** free list is released when the enclave terminates.
+**
+**==============================================================================
+*/
+
+// Maximum number of calls submitted with one ocall.
+#define OE_OCALL_BATCH_MAX_CALLS 64
+
+// Smallest marshalling area allocated. Larger areas are rounded up to a power
+// of two.
+#define OE_OCALL_BATCH_MIN_BUFFER_SIZE (64 * 1024)
+
+// Maximum number of released batches kept for reuse.
+#define OE_OCALL_BATCH_MAX_FREE_BATCHES 4
+
+typedef struct _oe_ocall_batch_call
+{
+    void* output_buffer;
+    size_t output_buffer_size;
+    oe_ocall_batch_completion_t completion;
+    void* completion_arg;
+    oe_result_t* call_result;
+} oe_ocall_batch_call_t;
+
+struct _oe_ocall_batch
+{
+    struct _oe_ocall_batch* next;
+
+    // Host memory.
+    oe_call_host_function_batch_args_t* args;
+    oe_call_host_function_args_t* calls;
+    uint8_t* buffer;
+    size_t buffer_size;
+    size_t buffer_used;
+
+    // The buffer returned by the last oe_ocall_batch_allocate_buffer().
+    uint8_t* current;
+    size_t current_size;
+
+    size_t num_calls;
+    oe_ocall_batch_call_t entries[OE_OCALL_BATCH_MAX_CALLS];
+};
+
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+static oe_ocall_batch_t* _free_batches;
+static size_t _num_free_batches;
+
+static size_t _header_size(void)
+{
+    return oe_round_up_to_multiple(
+        sizeof(oe_call_host_function_batch_args_t) +
+            OE_OCALL_BATCH_MAX_CALLS * sizeof(oe_call_host_function_args_t),
+        OE_EDGER8R_BUFFER_ALIGNMENT);
+}
+
+static void _free_batch(oe_ocall_batch_t* batch)
+{
+    oe_host_free(batch->args);
+    oe_free(batch);
+}
+
+/* Replace the host block of an empty batch by one whose marshalling area can
+ * hold at least size bytes */
+static oe_result_t _grow_batch(oe_ocall_batch_t* batch, size_t size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t capacity = OE_OCALL_BATCH_MIN_BUFFER_SIZE;
+    size_t block_size = 0;
+    uint8_t* block = NULL;
+
+    while (capacity < size)
+        OE_CHECK(oe_safe_mul_sizet(capacity, 2, &capacity));
+
+    OE_CHECK(oe_safe_add_sizet(_header_size(), capacity, &block_size));
+
+    if (!(block = (uint8_t*)oe_host_malloc(block_size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    oe_host_free(batch->args);
+
+    batch->args = (oe_call_host_function_batch_args_t*)block;
+    batch->calls = (oe_call_host_function_args_t*)(batch->args + 1);
+    batch->buffer = block + _header_size();
+    batch->buffer_size = capacity;
+    batch->buffer_used = 0;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Whether [ptr, ptr + size) lies within the current marshalling buffer */
+static bool _is_within_current(
+    oe_ocall_batch_t* batch,
+    const void* ptr,
+    size_t size)
+{
+    const uint8_t* start = (const uint8_t*)ptr;
+    const uint8_t* end = batch->current + batch->current_size;
+
+    return batch->current && start >= batch->current && start <= end &&
+           size <= (size_t)(end - start);
+}
+
+oe_result_t oe_ocall_batch_begin(oe_ocall_batch_t** batch)
+{
+    oe_ocall_batch_t* b = NULL;
+
+    if (!batch)
+        return OE_INVALID_PARAMETER;
+
+    *batch = NULL;
+
+    oe_spin_lock(&_lock);
+    {
+        if ((b = _free_batches))
+        {
+            _free_batches = b->next;
+            _num_free_batches--;
+        }
+    }
+    oe_spin_unlock(&_lock);
+
+    if (!b && !(b = (oe_ocall_batch_t*)oe_calloc(1, sizeof(*b))))
+        return OE_OUT_OF_MEMORY;
+
+    b->next = NULL;
+    *batch = b;
+    return OE_OK;
+}
+
+void* oe_ocall_batch_allocate_buffer(oe_ocall_batch_t* batch, size_t size)
+{
+    size_t total_size = 0;
+
+    if (!batch || size == 0)
+        return NULL;
+
+    total_size = oe_round_up_to_multiple(size, OE_EDGER8R_BUFFER_ALIGNMENT);
+    if (total_size < size)
+        return NULL;
+
+    // Submit the pending calls if the call does not fit. Their results are
+    // reported through their result locations.
+    if (batch->num_calls == OE_OCALL_BATCH_MAX_CALLS ||
+        total_size > batch->buffer_size - batch->buffer_used)
+        oe_ocall_batch_submit(batch);
+
+    if (total_size > batch->buffer_size)
+    {
+        if (_grow_batch(batch, total_size) != OE_OK)
+            return NULL;
+    }
+
+    batch->current = batch->buffer + batch->buffer_used;
+    batch->current_size = total_size;
+    batch->buffer_used += total_size;
+
+    return batch->current;
+}
+
+oe_result_t oe_ocall_batch_add(
+    oe_ocall_batch_t* batch,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    oe_ocall_batch_completion_t completion,
+    void* completion_arg,
+    oe_result_t* call_result)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_host_function_args_t* args = NULL;
+    oe_ocall_batch_call_t* entry = NULL;
+
+    if (!batch || !input_buffer || input_buffer_size == 0 ||
+        output_buffer_size < sizeof(oe_result_t))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (batch->num_calls == OE_OCALL_BATCH_MAX_CALLS)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!_is_within_current(batch, input_buffer, input_buffer_size) ||
+        !_is_within_current(batch, output_buffer, output_buffer_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    entry = &batch->entries[batch->num_calls];
+    entry->output_buffer = output_buffer;
+    entry->output_buffer_size = output_buffer_size;
+    entry->completion = completion;
+    entry->completion_arg = completion_arg;
+    entry->call_result = call_result;
+
+    args = &batch->calls[batch->num_calls];
+    args->function_id = function_id;
+    args->input_buffer = input_buffer;
+    args->input_buffer_size = input_buffer_size;
+    args->output_buffer = output_buffer;
+    args->output_buffer_size = output_buffer_size;
+    args->output_bytes_written = 0;
+    args->result = OE_UNEXPECTED;
+
+    // The buffer belongs to this call now.
+    batch->current = NULL;
+    batch->current_size = 0;
+    batch->num_calls++;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Get the result of a call of a submitted batch */
+static oe_result_t _get_call_result(oe_ocall_batch_t* batch, size_t index)
+{
+    oe_ocall_batch_call_t* entry = &batch->entries[index];
+    oe_result_t result = OE_UNEXPECTED;
+
+    // Copy the host-controlled fields before checking them.
+    oe_call_host_function_args_t args = batch->calls[index];
+
+    if (args.result != OE_OK)
+        return args.result;
+
+    // Currently exactly output_buffer_size bytes must be written.
+    if (args.output_bytes_written != entry->output_buffer_size)
+        return OE_FAILURE;
+
+    // The output buffer starts with the result of the host function stub.
+    memcpy(&result, entry->output_buffer, sizeof(result));
+    return result;
+}
+
+oe_result_t oe_ocall_batch_submit(oe_ocall_batch_t* batch)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!batch)
+        return OE_INVALID_PARAMETER;
+
+    if (batch->num_calls == 0)
+        return OE_OK;
+
+    batch->args->num_calls = batch->num_calls;
+    batch->args->calls = batch->calls;
+
+    result = oe_ocall(
+        OE_OCALL_CALL_HOST_FUNCTION_BATCH, (uint64_t)batch->args, NULL);
+
+    for (size_t i = 0; i < batch->num_calls; i++)
+    {
+        oe_ocall_batch_call_t* entry = &batch->entries[i];
+        oe_result_t call_result = result;
+
+        if (call_result == OE_OK)
+            call_result = _get_call_result(batch, i);
+
+        if (entry->call_result)
+            *entry->call_result = call_result;
+
+        if (call_result == OE_OK && entry->completion)
+            entry->completion(entry->output_buffer, entry->completion_arg);
+    }
+
+    batch->num_calls = 0;
+    batch->buffer_used = 0;
+    batch->current = NULL;
+    batch->current_size = 0;
+
+    return result;
+}
+
+oe_result_t oe_ocall_batch_end(oe_ocall_batch_t* batch)
+{
+    oe_result_t result;
+    bool cached = false;
+
+    if (!batch)
+        return OE_INVALID_PARAMETER;
+
+    result = oe_ocall_batch_submit(batch);
+
+    oe_spin_lock(&_lock);
+    {
+        if (_num_free_batches < OE_OCALL_BATCH_MAX_FREE_BATCHES)
+        {
+            batch->next = _free_batches;
+            _free_batches = batch;
+            _num_free_batches++;
+            cached = true;
+        }
+    }
+    oe_spin_unlock(&_lock);
+
+    if (!cached)
+        _free_batch(batch);
+
+    return result;
+}
+
+void oe_free_ocall_batches(void)
+{
+    oe_ocall_batch_t* batches;
+
+    oe_spin_lock(&_lock);
+    {
+        batches = _free_batches;
+        _free_batches = NULL;
+        _num_free_batches = 0;
+    }
+    oe_spin_unlock(&_lock);
+
+    // Freeing host memory makes ocalls, so do it outside the lock.
+    while (batches)
+    {
+        oe_ocall_batch_t* next = batches->next;
+        _free_batch(batches);
+        batches = next;
+    }
+}
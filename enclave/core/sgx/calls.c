@@ -194,6 +194,116 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** Ecall marshalling buffers
+**
+**     Each thread keeps the enclave buffer that the inputs and outputs of its
+**     ecalls are marshalled into, so that ecalls do not allocate from the heap
+**     in the common case. Calls made while the buffer is in use, such as the
+**     switchless ecalls run by an enclave worker, allocate their own buffer.
+**     The buffers are tracked in a list so that they can be released before
+**     the enclave checks for memory leaks at termination.
+**
+**==============================================================================
+*/
+
+// Buffers are grown to a power of two, starting at this size.
+#define OE_ECALL_BUFFER_MIN_SIZE (4 * 1024)
+
+// Larger buffers are allocated for the duration of the ecall only.
+#define OE_ECALL_BUFFER_MAX_CACHED_SIZE (16 * 1024 * 1024)
+
+typedef struct _oe_ecall_buffer
+{
+    struct _oe_ecall_buffer* next;
+    oe_sgx_td_t* td;
+    uint8_t* data;
+    size_t capacity;
+    bool in_use;
+} oe_ecall_buffer_t;
+
+static oe_ecall_buffer_t* _ecall_buffers;
+static oe_spinlock_t _ecall_buffers_lock = OE_SPINLOCK_INITIALIZER;
+
+/* The oeedger8r-generated code overrides this for enclaves that declare
+ * zero_copy ecalls. */
+OE_WEAK const uint8_t* __oe_ecalls_zero_copy_table;
+
+static uint8_t* _get_ecall_buffer(oe_sgx_td_t* td, size_t size)
+{
+    oe_ecall_buffer_t* buffer = td->ecall_buffer;
+    size_t capacity = OE_ECALL_BUFFER_MIN_SIZE;
+
+    if (size > OE_ECALL_BUFFER_MAX_CACHED_SIZE || (buffer && buffer->in_use))
+        return oe_malloc(size);
+
+    if (buffer && buffer->capacity >= size)
+    {
+        buffer->in_use = true;
+        return buffer->data;
+    }
+
+    while (capacity < size)
+        capacity *= 2;
+
+    if (!buffer)
+    {
+        if (!(buffer = oe_calloc(1, sizeof(*buffer))))
+            return NULL;
+
+        buffer->td = td;
+        td->ecall_buffer = buffer;
+
+        oe_spin_lock(&_ecall_buffers_lock);
+        buffer->next = _ecall_buffers;
+        _ecall_buffers = buffer;
+        oe_spin_unlock(&_ecall_buffers_lock);
+    }
+
+    // The contents need not be preserved, so avoid oe_realloc.
+    oe_free(buffer->data);
+    buffer->capacity = 0;
+
+    if (!(buffer->data = oe_malloc(capacity)))
+        return NULL;
+
+    buffer->capacity = capacity;
+    buffer->in_use = true;
+    return buffer->data;
+}
+
+static void _put_ecall_buffer(oe_sgx_td_t* td, uint8_t* data)
+{
+    oe_ecall_buffer_t* buffer = td->ecall_buffer;
+
+    if (buffer && data == buffer->data)
+        buffer->in_use = false;
+    else
+        oe_free(data);
+}
+
+static void _free_ecall_buffers(void)
+{
+    oe_spin_lock(&_ecall_buffers_lock);
+    {
+        oe_ecall_buffer_t* p = _ecall_buffers;
+
+        while (p)
+        {
+            oe_ecall_buffer_t* next = p->next;
+            p->td->ecall_buffer = NULL;
+            oe_free(p->data);
+            oe_free(p);
+            p = next;
+        }
+
+        _ecall_buffers = NULL;
+    }
+    oe_spin_unlock(&_ecall_buffers_lock);
+}
+
 /**
  * This is the preferred way to call enclave functions.
  */
@@ -202,12 +312,14 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
     oe_call_enclave_function_args_t args, *args_ptr;
     oe_result_t result = OE_OK;
     oe_ecall_func_t func = NULL;
+    oe_sgx_td_t* td = oe_sgx_get_td();
     uint8_t* buffer = NULL;
     uint8_t* input_buffer = NULL;
     uint8_t* output_buffer = NULL;
     size_t buffer_size = 0;
     size_t output_bytes_written = 0;
     ecall_table_t ecall_table;
+    bool zero_copy = false;
 
     // Ensure that args lies outside the enclave.
     if (!oe_is_outside_enclave(
@@ -257,18 +369,36 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
     if (func == NULL)
         OE_RAISE(OE_NOT_FOUND);
 
-    // Allocate buffers in enclave memory
-    buffer = input_buffer = oe_malloc(buffer_size);
+    // The input buffer of a zero_copy ecall is left in host memory. Its stub
+    // copies the marshalling struct and each in parameter to enclave memory,
+    // which avoids staging the whole input buffer.
+    zero_copy = __oe_ecalls_zero_copy_table &&
+                __oe_ecalls_zero_copy_table[args.function_id];
+
+    if (zero_copy)
+        buffer_size = args.output_buffer_size;
+
+    // Get buffers in enclave memory
+    buffer = _get_ecall_buffer(td, buffer_size);
     if (buffer == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
-    // Copy input buffer to enclave buffer.
-    memcpy(input_buffer, args.input_buffer, args.input_buffer_size);
+    if (zero_copy)
+    {
+        input_buffer = (uint8_t*)args.input_buffer;
+        output_buffer = buffer;
+    }
+    else
+    {
+        // Copy input buffer to enclave buffer.
+        input_buffer = buffer;
+        memcpy(input_buffer, args.input_buffer, args.input_buffer_size);
+        output_buffer = buffer + args.input_buffer_size;
+    }
 
     // Clear out output buffer.
     // This ensures reproducible behavior if say the function is reading from
     // output buffer.
-    output_buffer = buffer + args.input_buffer_size;
     memset(output_buffer, 0, args.output_buffer_size);
 
     // Call the function.
@@ -296,7 +426,7 @@ oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
 
 done:
     if (buffer)
-        oe_free(buffer);
+        _put_ecall_buffer(td, buffer);
 
     return result;
 }
@@ -417,6 +547,15 @@ static void _handle_ecall(
             /* Cleanup verifiers */
             oe_verifier_shutdown();
 
+            /* Release the ecall marshalling buffers of all threads */
+            _free_ecall_buffers();
+
+            /* Release the ocall batches kept for reuse */
+            oe_free_ocall_batches();
+
+            /* Release the asynchronous ocalls kept for reuse */
+            oe_free_async_ocalls();
+
             /* If memory still allocated, print a trace and return an error */
             OE_CHECK(oe_check_memory_leaks());
 
@@ -727,8 +866,8 @@ oe_result_t oe_call_host_function_internal(
 
         // Fall back to regular OCALL if host worker threads are unavailable
         if (post_result == OE_CONTEXT_SWITCHLESS_OCALL_MISSED)
-            OE_CHECK(
-                oe_ocall(OE_OCALL_CALL_HOST_FUNCTION, (uint64_t)args, NULL));
+            OE_CHECK(oe_ocall(
+                OE_OCALL_CALL_HOST_FUNCTION_FALLBACK, (uint64_t)args, NULL));
         else
         {
             OE_CHECK(post_result);
@@ -3,8 +3,10 @@
 
 #include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/calls.h>
 #include <openenclave/internal/sgx/ecall_context.h>
 #include <openenclave/internal/sgx/td.h>
+#include "arena.h"
 #include "td.h"
 
 /**
@@ -47,6 +49,41 @@ void* oe_ecall_context_get_ocall_buffer(uint64_t size)
     return NULL;
 }
 
+static uint64_t _grow_count;
+static uint64_t _fallback_count;
+
+/**
+ * Ask the host to grow the ocall buffer of this thread binding to at least the
+ * given size. The host keeps the larger buffer for the later ecalls on the
+ * binding, so that subsequent large ocalls need no extra transition.
+ */
+static void* _grow_ocall_buffer(uint64_t size)
+{
+    oe_sgx_td_t* td = oe_sgx_get_td();
+    oe_ecall_context_t* ecall_context = _get_ecall_context();
+    uint64_t arg_out = 0;
+    uint8_t* buffer = NULL;
+
+    // The host frees the old buffer, so only grow it while no ocall of an
+    // outer ecall on this thread can be using it.
+    if (!ecall_context || td->depth != 1 || size > OE_MAX_OCALL_BUFFER_SIZE)
+        return NULL;
+
+    if (oe_ocall(OE_OCALL_GROW_OCALL_BUFFER, size, &arg_out) != OE_OK)
+        return NULL;
+
+    buffer = (uint8_t*)arg_out;
+    if (!buffer || !oe_is_outside_enclave(buffer, size))
+        return NULL;
+
+    ecall_context->ocall_buffer = buffer;
+    ecall_context->ocall_buffer_size = size;
+
+    __atomic_add_fetch(&_grow_count, 1, __ATOMIC_RELAXED);
+
+    return buffer;
+}
+
 // Function used by oeedger8r for allocating ocall buffers.
 void* oe_allocate_ocall_buffer(size_t size)
 {
@@ -58,10 +95,28 @@ void* oe_allocate_ocall_buffer(size_t size)
         return buffer;
     }
 
+    // Otherwise have the host grow the buffer of this thread binding.
+    if ((buffer = _grow_ocall_buffer(size)))
+    {
+        return buffer;
+    }
+
     // Perform host allocation by making an ocall.
+    __atomic_add_fetch(&_fallback_count, 1, __ATOMIC_RELAXED);
     return oe_host_malloc(size);
 }
 
+void oe_get_ocall_buffer_statistics(
+    uint64_t* grow_count,
+    uint64_t* fallback_count)
+{
+    if (grow_count)
+        *grow_count = __atomic_load_n(&_grow_count, __ATOMIC_RELAXED);
+
+    if (fallback_count)
+        *fallback_count = __atomic_load_n(&_fallback_count, __ATOMIC_RELAXED);
+}
+
 // Function used by oeedger8r for freeing ocall buffers.
 void oe_free_ocall_buffer(void* buffer)
 {
@@ -83,6 +138,25 @@ void oe_free_ocall_buffer(void* buffer)
     oe_host_free(buffer);
 }
 
+// Staging buffers share the arena with the switchless ocall buffers. Both are
+// released by rewinding the arena, so a staging buffer must be freed before
+// the next switchless ocall of the thread. A thread without an arena would
+// allocate its first chunk with an extra ocall, and free it when the ecall
+// returns, so it marshals the data instead.
+void* oe_allocate_ocall_staging_buffer(size_t size)
+{
+    if (!oe_arena_is_active())
+        return NULL;
+
+    return oe_arena_malloc(size);
+}
+
+void oe_free_ocall_staging_buffer(void* buffer)
+{
+    if (buffer)
+        oe_arena_free_all();
+}
+
 void* oe_allocate_arena(size_t capacity)
 {
     return oe_host_malloc(capacity);
@@ -19,6 +19,13 @@ static size_t _host_worker_count = 0;
 // The array of host worker contexts. Initialized by host through ECALL
 static oe_host_worker_context_t* _host_worker_contexts = NULL;
 
+// The queue of switchless ocalls waiting for a host worker. Initialized by
+// host through ECALL. The cells pointer and capacity are copied into enclave
+// memory so that the host cannot redirect enqueues.
+static oe_switchless_call_queue_t* _call_queue = NULL;
+static oe_switchless_call_queue_cell_t* _call_queue_cells = NULL;
+static uint64_t _call_queue_mask = 0;
+
 // Flag to denote if switchless calls have already been initialized.
 static bool _is_switchless_initialized = false;
 
@@ -99,10 +106,14 @@ bool oe_is_switchless_initialized()
 */
 oe_result_t oe_sgx_init_context_switchless_ecall(
     oe_host_worker_context_t* host_worker_contexts,
-    uint64_t num_host_workers)
+    uint64_t num_host_workers,
+    oe_switchless_call_queue_t* call_queue)
 {
     oe_result_t result = OE_UNEXPECTED;
     uint64_t contexts_size = 0;
+    oe_switchless_call_queue_cell_t* cells = NULL;
+    uint64_t capacity = 0;
+    uint64_t cells_size = 0;
 
     if (!oe_atomic_compare_and_swap(
             &_switchless_init_in_progress, (int64_t) false, (int64_t) true))
@@ -125,6 +136,25 @@ oe_result_t oe_sgx_init_context_switchless_ecall(
         OE_RAISE(OE_INVALID_PARAMETER);
     }
 
+    // The call queue is optional. Its capacity must be a power of two.
+    if (call_queue)
+    {
+        if (!oe_is_outside_enclave(call_queue, sizeof(*call_queue)))
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        cells = call_queue->cells;
+        capacity = call_queue->capacity;
+
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        OE_CHECK(oe_safe_mul_u64(
+            sizeof(oe_switchless_call_queue_cell_t), capacity, &cells_size));
+
+        if (!oe_is_outside_enclave(cells, cells_size))
+            OE_RAISE(OE_INVALID_PARAMETER);
+    }
+
     /* lfence after checks. */
     oe_lfence();
 
@@ -132,6 +162,13 @@ oe_result_t oe_sgx_init_context_switchless_ecall(
     _host_worker_count = num_host_workers;
     _host_worker_contexts = host_worker_contexts;
 
+    if (call_queue)
+    {
+        _call_queue = call_queue;
+        _call_queue_cells = cells;
+        _call_queue_mask = capacity - 1;
+    }
+
     __atomic_store_n(&_is_switchless_initialized, true, __ATOMIC_SEQ_CST);
 
     result = OE_OK;
@@ -142,13 +179,130 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _wake_host_worker()
+**
+**  Wake the given host worker if it is sleeping.
+**
+**==============================================================================
+*/
+static bool _wake_host_worker(oe_host_worker_context_t* context)
+{
+    // If event is 0, it means that it has gone to sleep. Wake it by
+    // making an ocall (oe_sgx_wake_switchless_worker_ocall).
+    // Note: it is important to use an atomic cas operation to set
+    // the value to 1 before making the ocall. Setting the value to
+    // 1 prevents the host worker from simulataneously going to
+    // sleep. If instead, just a compare operation is used to
+    // determine if the host thread is sleeping or not, the host
+    // thread could go to sleep after the enclave has determined
+    // that the host is not sleeping, causing a deadlock.
+    //
+    // If event is 1, that indicates a pending wake notification.
+    int32_t oldval = 0;
+    int32_t newval = 1;
+    // Weak operation could sporadically fail.
+    // We need a strong operation.
+    bool weak = false;
+    if (__atomic_compare_exchange_n(
+            &context->event,
+            &oldval,
+            newval,
+            weak,
+            __ATOMIC_ACQ_REL,
+            __ATOMIC_ACQUIRE))
+    {
+        // The pevious value of the event was 0 which means that the
+        // worker was previously sleeping.
+        // Wake it via an ocall.
+        oe_sgx_wake_switchless_worker_ocall(context);
+        return true;
+    }
+
+    return false;
+}
+
+/*
+**==============================================================================
+**
+** _enqueue_switchless_ocall()
+**
+**  Append the function call to the shared call queue. This is a bounded
+**  multi-producer/multi-consumer ring: each cell carries a sequence number
+**  that tells producers and consumers whose turn it is to use the cell.
+**  Only indices masked with the enclave copy of the capacity are written, so
+**  a corrupted queue can at worst make posting fail.
+**
+**==============================================================================
+*/
+static bool _enqueue_switchless_ocall(oe_call_host_function_args_t* args)
+{
+    uint64_t pos = __atomic_load_n(&_call_queue->enqueue_pos, __ATOMIC_RELAXED);
+    oe_switchless_call_queue_cell_t* cell = NULL;
+
+    while (true)
+    {
+        cell = &_call_queue_cells[pos & _call_queue_mask];
+        uint64_t seq = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            // The cell is free. Try to claim the position.
+            if (__atomic_compare_exchange_n(
+                    &_call_queue->enqueue_pos,
+                    &pos,
+                    pos + 1,
+                    true,
+                    __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The queue is full.
+            return false;
+        }
+        else
+        {
+            // Another producer claimed this position.
+            pos = __atomic_load_n(&_call_queue->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->call_arg = args;
+    __atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+
+    // Update statistics.
+    uint64_t depth =
+        pos + 1 - __atomic_load_n(&_call_queue->dequeue_pos, __ATOMIC_RELAXED);
+    uint64_t max_depth =
+        __atomic_load_n(&_call_queue->max_depth, __ATOMIC_RELAXED);
+    while (depth > max_depth && depth <= _call_queue_mask + 1 &&
+           !__atomic_compare_exchange_n(
+               &_call_queue->max_depth,
+               &max_depth,
+               depth,
+               true,
+               __ATOMIC_RELAXED,
+               __ATOMIC_RELAXED))
+        ;
+    __atomic_add_fetch(&_call_queue->total_queued_count, 1, __ATOMIC_RELAXED);
+
+    return true;
+}
+
 /*
 **==============================================================================
 **
 ** oe_post_switchless_ocall()
 **
 **  Post the function call (wrapped in args) to a free host worker thread
-**  by writing to its context.
+**  by writing to its context. If all the workers are busy, append it to the
+**  call queue, from which workers pick up calls once they are done with
+**  their current one.
 **
 **==============================================================================
 */
@@ -178,44 +332,35 @@ oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args)
                     args))
             {
                 // The worker thread has been marked to execute this switchless
-                // call. Determine if it needs to be woken up or not.
-                //
-                // If event is 0, it means that it has gone to sleep. Wake it by
-                // making an ocall (oe_sgx_wake_switchless_worker_ocall).
-                // Note: it is important to use an atomic cas operation to set
-                // the value to 1 before making the ocall. Setting the value to
-                // 1 prevents the host worker from simulataneously going to
-                // sleep. If instead, just a compare operation is used to
-                // determine if the host thread is sleeping or not, the host
-                // thread could go to sleep after the enclave has determined
-                // that the host is not sleeping, causing a deadlock.
-                //
-                // If event is 1, that indicates a pending wake notification.
-                int32_t oldval = 0;
-                int32_t newval = 1;
-                // Weak operation could sporadically fail.
-                // We need a strong operation.
-                bool weak = false;
-                if (__atomic_compare_exchange_n(
-                        &_host_worker_contexts[tries].event,
-                        &oldval,
-                        newval,
-                        weak,
-                        __ATOMIC_ACQ_REL,
-                        __ATOMIC_ACQUIRE))
-                {
-                    // The pevious value of the event was 0 which means that the
-                    // worker was previously sleeping.
-                    // Wake it via an ocall.
-                    oe_sgx_wake_switchless_worker_ocall(
-                        &_host_worker_contexts[tries]);
-                }
-
+                // call. Wake it up if needed.
+                _wake_host_worker(&_host_worker_contexts[tries]);
                 return OE_OK;
             }
         }
     }
 
+    // All workers are busy. Queue the call instead of falling back to a
+    // regular ocall.
+    if (_call_queue && _enqueue_switchless_ocall(args))
+    {
+        // A worker may have gone to sleep since the scan above. Make sure at
+        // least one worker is awake to drain the queue.
+        for (size_t i = 0; i < _host_worker_count; i++)
+        {
+            if (_host_worker_contexts[i].event == 0)
+            {
+                _wake_host_worker(&_host_worker_contexts[i]);
+                break;
+            }
+        }
+
+        return OE_OK;
+    }
+
+    if (_call_queue)
+        __atomic_add_fetch(
+            &_call_queue->total_missed_count, 1, __ATOMIC_RELAXED);
+
     result = OE_CONTEXT_SWITCHLESS_OCALL_MISSED;
 
     return result;
@@ -257,7 +402,15 @@ void oe_sgx_switchless_enclave_worker_thread_ecall(
     // Prevent speculative execution.
     oe_lfence();
 
-    const uint64_t spin_count_threshold = context->spin_count_threshold;
+    // Keep the spin policy in enclave memory. The values in the context are
+    // only written back for the host to report.
+    const uint64_t min_threshold = context->min_spin_count_threshold;
+    const uint64_t max_threshold = context->max_spin_count_threshold;
+    uint64_t spin_count_threshold = context->spin_count_threshold;
+    uint64_t average_spin_count = context->average_spin_count;
+    bool slept = false;
+    uint64_t sleep_spin_count = 0;
+
     while (!context->is_stopping)
     {
         volatile oe_call_enclave_function_args_t* local_call_arg = NULL;
@@ -274,6 +427,20 @@ void oe_sgx_switchless_enclave_worker_thread_ecall(
             OE_ATOMIC_MEMORY_BARRIER_RELEASE();
             context->call_arg = NULL;
 
+            // Adapt the spin budget to the time it took for this message to
+            // arrive.
+            oe_switchless_update_spin_policy(
+                context->spin_count,
+                slept,
+                sleep_spin_count,
+                min_threshold,
+                max_threshold,
+                &average_spin_count,
+                &spin_count_threshold);
+            context->spin_count_threshold = spin_count_threshold;
+            context->average_spin_count = average_spin_count;
+            slept = false;
+
             // Reset spin count for next message.
             context->total_spin_count += context->spin_count;
             context->spin_count = 0;
@@ -290,6 +457,12 @@ void oe_sgx_switchless_enclave_worker_thread_ecall(
 
                 // Make an ocall to sleep until messages arrive.
                 oe_sgx_sleep_switchless_worker_ocall(context);
+                context->total_wake_count++;
+
+                // The length of the sleep is only a hint from the host. A
+                // wrong value changes the budget within its bounds.
+                sleep_spin_count = context->last_sleep_spin_count;
+                slept = true;
             }
 
             // In Release builds, the following pause has been observed to be
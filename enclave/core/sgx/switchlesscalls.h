@@ -10,4 +10,11 @@ bool oe_is_switchless_initialized();
 
 oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args);
 
+/**
+ * Release the asynchronous ocalls kept for reuse and the ones released before
+ * they completed. Called when the enclave terminates, after the host workers
+ * have stopped.
+ */
+void oe_free_async_ocalls(void);
+
 #endif // _OE_SWITCHLESSCALLS_H
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "../common/sgx/collateral.h"
+#include "../common/sgx/collateralcache.h"
 #include "platform_t.h"
 
 /**
@@ -147,7 +148,7 @@ void oe_update_default_collateral_arg_sizes(
 /**
  * Call into host to fetch collateral information.
  */
-oe_result_t oe_get_sgx_quote_verification_collateral(
+static oe_result_t _fetch_sgx_quote_verification_collateral(
     oe_get_sgx_quote_verification_collateral_args_t* args)
 {
     oe_result_t result = OE_FAILURE;
@@ -332,6 +333,13 @@ done:
     return result;
 }
 
+oe_result_t oe_get_sgx_quote_verification_collateral(
+    oe_get_sgx_quote_verification_collateral_args_t* args)
+{
+    return oe_get_cached_sgx_quote_verification_collateral(
+        args, _fetch_sgx_quote_verification_collateral);
+}
+
 void oe_prealloc_quote_verification_collateral_args(
     oe_get_sgx_quote_verification_collateral_args_t* buf,
     oe_get_sgx_quote_verification_collateral_args_t* default_sizes)
@@ -459,7 +467,12 @@ void oe_update_default_collateral_arg_sizes(
 void oe_free_sgx_quote_verification_collateral_args(
     oe_get_sgx_quote_verification_collateral_args_t* args)
 {
-    if (args)
+    if (args && args->host_out_buffer)
+    {
+        /* Collateral from the cache lives in host_out_buffer */
+        oe_free(args->host_out_buffer);
+    }
+    else if (args)
     {
         oe_free(args->tcb_info);
         oe_free(args->tcb_info_issuer_chain);
@@ -468,6 +481,5 @@ void oe_free_sgx_quote_verification_collateral_args(
         oe_free(args->pck_crl_issuer_chain);
         oe_free(args->qe_identity);
         oe_free(args->qe_identity_issuer_chain);
-        oe_free(args->host_out_buffer);
     }
 }
\ No newline at end of file
@@ -35,6 +35,8 @@ typedef pthread_mutex_t oe_mutex;
 
 typedef pthread_key_t oe_thread_key;
 
+typedef pthread_cond_t oe_cond;
+
 #elif _MSC_VER
 
 typedef INIT_ONCE oe_once_type;
@@ -45,6 +47,12 @@ typedef HANDLE oe_mutex;
 
 typedef DWORD oe_thread_key;
 
+typedef struct _oe_cond
+{
+    HANDLE semaphore;
+    LONG waiters;
+} oe_cond;
+
 #endif
 
 /**
@@ -181,6 +189,49 @@ int oe_mutex_unlock(oe_mutex* mutex);
  */
 int oe_mutex_destroy(oe_mutex* mutex);
 
+/**
+ * Initialize a condition variable.
+ *
+ * @param cond Initialize this condition variable.
+ *
+ * @return Returns zero on success.
+ */
+int oe_cond_init(oe_cond* cond);
+
+/**
+ * Wait on a condition variable.
+ *
+ * This function releases the mutex, which the caller holds, waits until the
+ * condition variable is signaled, and acquires the mutex again. It may return
+ * without a signal, so callers check their condition in a loop.
+ *
+ * @param cond Wait on this condition variable.
+ * @param mutex Release this mutex while waiting.
+ *
+ * @return Returns zero on success.
+ */
+int oe_cond_wait(oe_cond* cond, oe_mutex* mutex);
+
+/**
+ * Wake all the threads that wait on a condition variable.
+ *
+ * The caller must hold the mutex that the waiters pass to oe_cond_wait().
+ *
+ * @param cond Signal this condition variable.
+ *
+ * @return Returns zero on success.
+ */
+int oe_cond_broadcast(oe_cond* cond);
+
+/**
+ * Destroy a condition variable that no thread waits on.
+ *
+ * @param cond Destroy this condition variable.
+ *
+ * @return Returns zero on success.
+ */
+int oe_cond_destroy(oe_cond* cond);
+
 /**
  * Create a key for accessing thread-specific data.
  *
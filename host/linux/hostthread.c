@@ -83,6 +83,34 @@ int oe_mutex_destroy(oe_mutex* Lock)
     return pthread_mutex_destroy(Lock);
 }
 
+/*
+**==============================================================================
+**
+** oe_cond
+**
+**==============================================================================
+*/
+
+int oe_cond_init(oe_cond* cond)
+{
+    return pthread_cond_init(cond, NULL);
+}
+
+int oe_cond_wait(oe_cond* cond, oe_mutex* mutex)
+{
+    return pthread_cond_wait(cond, mutex);
+}
+
+int oe_cond_broadcast(oe_cond* cond)
+{
+    return pthread_cond_broadcast(cond);
+}
+
+int oe_cond_destroy(oe_cond* cond)
+{
+    return pthread_cond_destroy(cond);
+}
+
 /*
 **==============================================================================
 **
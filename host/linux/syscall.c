@@ -7,15 +7,19 @@
 #include <limits.h>
 #include <netdb.h>
 #include <openenclave/corelibc/limits.h>
+#include <openenclave/internal/syscall/ioring.h>
+#include <openenclave/internal/syscall/sys/ioring.h>
 #include <openenclave/internal/syscall/sys/uio.h>
 #include <openenclave/internal/syscall/types.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/epoll.h>
 #include <sys/file.h>
 #include <sys/ioctl.h>
 #include <sys/poll.h>
+#include <sys/sendfile.h>
 #include <sys/signal.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -176,6 +180,104 @@ ssize_t oe_syscall_pwrite_ocall(
     return pwrite((int)fd, buf, count, offset);
 }
 
+/* Copy through a host buffer, stopping at the first short read. */
+static ssize_t _splice_copy(
+    int in_fd,
+    oe_off_t in_offset,
+    int out_fd,
+    oe_off_t out_offset,
+    size_t count)
+{
+    char buf[64 * 1024];
+    size_t total = 0;
+
+    while (total < count)
+    {
+        size_t chunk = count - total;
+        ssize_t n;
+        ssize_t written = 0;
+
+        if (chunk > sizeof(buf))
+            chunk = sizeof(buf);
+
+        do
+        {
+            if (in_offset == -1)
+                n = read(in_fd, buf, chunk);
+            else
+                n = pread(in_fd, buf, chunk, in_offset + (oe_off_t)total);
+        } while (n < 0 && errno == EINTR);
+
+        if (n <= 0)
+            return (n == 0 || total) ? (ssize_t)total : -1;
+
+        /* Data that was read but could not be written is lost, as with a
+         * short write of sendfile(). */
+        while (written < n)
+        {
+            ssize_t w;
+
+            if (out_offset == -1)
+                w = write(out_fd, buf + written, (size_t)(n - written));
+            else
+                w = pwrite(
+                    out_fd,
+                    buf + written,
+                    (size_t)(n - written),
+                    out_offset + (oe_off_t)total + written);
+
+            if (w < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+
+                total += (size_t)written;
+                return total ? (ssize_t)total : -1;
+            }
+
+            written += w;
+        }
+
+        total += (size_t)n;
+
+        if ((size_t)n < chunk)
+            break;
+    }
+
+    return (ssize_t)total;
+}
+
+ssize_t oe_syscall_splice_ocall(
+    oe_host_fd_t in_fd,
+    oe_off_t in_offset,
+    oe_host_fd_t out_fd,
+    oe_off_t out_offset,
+    size_t count)
+{
+    ssize_t ret;
+
+    errno = 0;
+
+    /* sendfile() writes at the file position of out_fd. It fails with EINVAL
+     * or ENOSYS before moving any data if the kernel does not support the
+     * descriptors, in which case copy through a host buffer instead. */
+    if (out_offset == -1)
+    {
+        off_t offset = (off_t)in_offset;
+
+        ret = sendfile(
+            (int)out_fd, (int)in_fd, in_offset == -1 ? NULL : &offset, count);
+
+        if (ret != -1 || (errno != EINVAL && errno != ENOSYS))
+            return ret;
+
+        errno = 0;
+    }
+
+    return _splice_copy(
+        (int)in_fd, in_offset, (int)out_fd, out_offset, count);
+}
+
 int oe_syscall_close_ocall(oe_host_fd_t fd)
 {
     errno = 0;
@@ -280,6 +382,51 @@ done:
     return ret;
 }
 
+ssize_t oe_syscall_readdir_batch_ocall(
+    uint64_t dirp,
+    struct oe_dirent* entries,
+    size_t count)
+{
+    ssize_t ret = -1;
+    size_t n = 0;
+
+    errno = 0;
+
+    if (!entries && count)
+    {
+        errno = EINVAL;
+        goto done;
+    }
+
+    for (; n < count; n++)
+    {
+        long pos = dirp ? telldir((DIR*)dirp) : 0;
+        int r = oe_syscall_readdir_ocall(dirp, &entries[n]);
+
+        if (r == 1)
+            break;
+
+        if (r != 0)
+        {
+            /* Return the entries read and report the error with the next
+             * call, which reads the failing entry again. */
+            if (n)
+            {
+                seekdir((DIR*)dirp, pos);
+                errno = 0;
+                break;
+            }
+
+            goto done;
+        }
+    }
+
+    ret = (ssize_t)n;
+
+done:
+    return ret;
+}
+
 void oe_syscall_rewinddir_ocall(uint64_t dirp)
 {
     if (dirp)
@@ -573,6 +720,17 @@ ssize_t oe_syscall_recv_ocall(
     return recv((int)sockfd, buf, len, flags);
 }
 
+ssize_t oe_syscall_recv_host_buffer_ocall(
+    oe_host_fd_t sockfd,
+    void* host_buf,
+    size_t len,
+    int flags)
+{
+    errno = 0;
+
+    return recv((int)sockfd, host_buf, len, flags);
+}
+
 ssize_t oe_syscall_recvfrom_ocall(
     oe_host_fd_t sockfd,
     void* buf,
@@ -1299,6 +1457,570 @@ done:
     return ret;
 }
 
+/*
+**==============================================================================
+**
+** Persistent poll:
+**
+** The enclave keeps an epoll instance per thread and sends only the changes
+** to its interest set. A reset replaces the instance under the same fd, which
+** also drops registrations that outlived the closing of their fd.
+**
+**==============================================================================
+*/
+
+oe_host_fd_t oe_syscall_poll_create_ocall(void)
+{
+    errno = 0;
+
+    return epoll_create1(EPOLL_CLOEXEC);
+}
+
+static int _apply_poll_change(int epfd, const struct oe_host_poll_change* c)
+{
+    struct epoll_event event = {0};
+    int fd = (int)c->fd;
+
+    /* The poll and epoll event bits are the same on Linux. */
+    event.events = (uint16_t)c->events;
+    event.data.fd = fd;
+
+    switch (c->op)
+    {
+        case EPOLL_CTL_ADD:
+        {
+            if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event) == 0)
+                return 0;
+
+            if (errno != EEXIST)
+                return -1;
+
+            return epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &event);
+        }
+        case EPOLL_CTL_MOD:
+        {
+            if (epoll_ctl(epfd, EPOLL_CTL_MOD, fd, &event) == 0)
+                return 0;
+
+            if (errno != ENOENT)
+                return -1;
+
+            return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &event);
+        }
+        case EPOLL_CTL_DEL:
+        {
+            /* The fd may have been closed, which already removed it. */
+            if (epoll_ctl(epfd, EPOLL_CTL_DEL, fd, NULL) == 0 ||
+                errno == ENOENT || errno == EBADF)
+                return 0;
+
+            return -1;
+        }
+        default:
+        {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+}
+
+int oe_syscall_poll_wait_ocall(
+    oe_host_fd_t epfd,
+    bool reset,
+    struct oe_host_poll_change* changes,
+    size_t nchanges,
+    struct oe_host_pollfd* events,
+    size_t maxevents,
+    int timeout)
+{
+    int ret = -1;
+    struct epoll_event* ready = NULL;
+    int n;
+
+    errno = 0;
+
+    if (epfd < 0 || (nchanges && !changes) || !events || maxevents == 0 ||
+        maxevents > INT_MAX)
+    {
+        errno = EINVAL;
+        goto done;
+    }
+
+    if (reset)
+    {
+        int tmp;
+
+        if ((tmp = epoll_create1(EPOLL_CLOEXEC)) == -1)
+            goto done;
+
+        if (dup2(tmp, (int)epfd) == -1)
+        {
+            close(tmp);
+            goto done;
+        }
+
+        close(tmp);
+        fcntl((int)epfd, F_SETFD, FD_CLOEXEC);
+    }
+
+    for (size_t i = 0; i < nchanges; i++)
+    {
+        if (_apply_poll_change((int)epfd, &changes[i]) != 0)
+        {
+            /* Only the wait may report an interruption. */
+            if (errno == EINTR)
+                errno = EIO;
+
+            goto done;
+        }
+    }
+
+    if (!(ready = calloc(maxevents, sizeof(struct epoll_event))))
+    {
+        errno = ENOMEM;
+        goto done;
+    }
+
+    if ((n = epoll_wait((int)epfd, ready, (int)maxevents, timeout)) < 0)
+        goto done;
+
+    for (int i = 0; i < n; i++)
+    {
+        events[i].fd = ready[i].data.fd;
+        events[i].events = 0;
+        events[i].revents = (short int)ready[i].events;
+    }
+
+    ret = n;
+
+done:
+
+    if (ready)
+        free(ready);
+
+    return ret;
+}
+
+int oe_syscall_poll_close_ocall(oe_host_fd_t epfd)
+{
+    errno = 0;
+
+    return close((int)epfd);
+}
+
+/*
+**==============================================================================
+**
+** I/O rings:
+**
+** The workers of a ring claim submissions, perform them with blocking calls,
+** and post their completions. A worker that finds no submissions spins for a
+** while and then sleeps on sq_cond until the enclave wakes it. The enclave
+** and each worker hold a reference to the ring, which is freed by the last one
+** to drop it. A teardown waits until the claimed submissions have completed
+** and the workers have exited, so that no worker uses a descriptor after the
+** enclave releases it.
+**
+**==============================================================================
+*/
+
+/* Number of times an idle worker polls the submission ring before it sleeps. */
+#define IO_RING_SPIN_COUNT 1024
+
+typedef struct _io_ring
+{
+    oe_io_ring_header_t* header;
+    oe_io_ring_host_sqe_t* sq;
+    oe_io_ring_host_cqe_t* cq;
+    uint8_t* data;
+    uint32_t num_entries;
+    uint32_t buffer_size;
+
+    pthread_mutex_t lock;
+    pthread_cond_t sq_cond;
+    pthread_cond_t cq_cond;
+    pthread_cond_t idle_cond;
+    bool stopping;
+
+    /* Number of workers that have not exited, and number of submissions
+     * that workers are claiming or performing. */
+    uint32_t workers;
+    uint64_t active;
+
+    /* Number of threads in oe_syscall_io_ring_wait_ocall(). */
+    uint64_t waiters;
+
+    uint32_t refs;
+} io_ring_t;
+
+static void _io_ring_put(io_ring_t* ring)
+{
+    if (__atomic_sub_fetch(&ring->refs, 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+
+    pthread_cond_destroy(&ring->idle_cond);
+    pthread_cond_destroy(&ring->cq_cond);
+    pthread_cond_destroy(&ring->sq_cond);
+    pthread_mutex_destroy(&ring->lock);
+    free(ring->header);
+    free(ring);
+}
+
+static bool _io_ring_is_stopping(io_ring_t* ring)
+{
+    return __atomic_load_n(&ring->stopping, __ATOMIC_ACQUIRE);
+}
+
+static void _io_ring_stop(io_ring_t* ring)
+{
+    pthread_mutex_lock(&ring->lock);
+    __atomic_store_n(&ring->stopping, true, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&ring->sq_cond);
+    pthread_cond_broadcast(&ring->cq_cond);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/* Called by a worker when it is done with a submission it counted in
+ * ring->active. Once the ring is stopping, the last one wakes the teardown. */
+static void _io_ring_complete(io_ring_t* ring)
+{
+    if (__atomic_sub_fetch(&ring->active, 1, __ATOMIC_SEQ_CST) == 0 &&
+        _io_ring_is_stopping(ring))
+    {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_broadcast(&ring->idle_cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+/* Get the number of submissions that have not been claimed, given the head
+ * of the submission ring. */
+static uint64_t _io_ring_pending(io_ring_t* ring, uint64_t head)
+{
+    uint64_t tail = __atomic_load_n(&ring->header->sq_tail, __ATOMIC_SEQ_CST);
+
+    /* Ignore a tail that the enclave could not have produced. */
+    if (tail - head > ring->num_entries)
+        return 0;
+
+    return tail - head;
+}
+
+static uint64_t _io_ring_head(io_ring_t* ring)
+{
+    return __atomic_load_n(&ring->header->sq_head, __ATOMIC_SEQ_CST);
+}
+
+static void _io_ring_sleep(io_ring_t* ring)
+{
+    pthread_mutex_lock(&ring->lock);
+
+    /* Count ourselves before checking sq_tail, as the enclave checks
+     * sleeping_workers after publishing sq_tail. */
+    __atomic_add_fetch(&ring->header->sleeping_workers, 1, __ATOMIC_SEQ_CST);
+
+    if (_io_ring_pending(ring, _io_ring_head(ring)) == 0 && !ring->stopping)
+        pthread_cond_wait(&ring->sq_cond, &ring->lock);
+
+    __atomic_sub_fetch(&ring->header->sleeping_workers, 1, __ATOMIC_SEQ_CST);
+
+    pthread_mutex_unlock(&ring->lock);
+}
+
+static void _io_ring_perform(
+    io_ring_t* ring,
+    const oe_io_ring_host_sqe_t* sqe,
+    oe_io_ring_host_cqe_t* cqe)
+{
+    uint8_t* buf = NULL;
+    size_t len = 0;
+    int fd = (int)sqe->fd;
+    ssize_t res = -1;
+
+    errno = 0;
+
+    if (sqe->slot >= ring->num_entries || sqe->len > ring->buffer_size)
+    {
+        errno = EINVAL;
+        goto done;
+    }
+
+    buf = ring->data + (size_t)sqe->slot * ring->buffer_size;
+    len = sqe->len;
+
+    switch (sqe->opcode)
+    {
+        case OE_IO_RING_OP_NOP:
+            res = 0;
+            break;
+
+        case OE_IO_RING_OP_READ:
+            if (sqe->offset < 0)
+                res = read(fd, buf, len);
+            else
+                res = pread(fd, buf, len, (off_t)sqe->offset);
+            break;
+
+        case OE_IO_RING_OP_WRITE:
+            if (sqe->offset < 0)
+                res = write(fd, buf, len);
+            else
+                res = pwrite(fd, buf, len, (off_t)sqe->offset);
+            break;
+
+        case OE_IO_RING_OP_RECV:
+            res = recv(fd, buf, len, sqe->flags);
+            break;
+
+        case OE_IO_RING_OP_SEND:
+            res = send(fd, buf, len, sqe->flags);
+            break;
+
+        case OE_IO_RING_OP_FSYNC:
+            res = fsync(fd);
+            break;
+
+        default:
+            errno = EINVAL;
+            break;
+    }
+
+done:
+    cqe->slot = sqe->slot;
+    cqe->res = res;
+    cqe->err = res < 0 ? errno : 0;
+}
+
+static void _io_ring_post(io_ring_t* ring, const oe_io_ring_host_sqe_t* sqe)
+{
+    oe_io_ring_host_cqe_t result;
+    oe_io_ring_host_cqe_t* cqe;
+    uint64_t position;
+
+    _io_ring_perform(ring, sqe, &result);
+
+    position =
+        __atomic_fetch_add(&ring->header->cq_reserve, 1, __ATOMIC_SEQ_CST);
+    cqe = &ring->cq[position % ring->num_entries];
+    cqe->slot = result.slot;
+    cqe->res = result.res;
+    cqe->err = result.err;
+    __atomic_store_n(&cqe->seq, position + 1, __ATOMIC_SEQ_CST);
+
+    /* The waiters count themselves before checking seq. */
+    if (__atomic_load_n(&ring->waiters, __ATOMIC_SEQ_CST))
+    {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_broadcast(&ring->cq_cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+static void* _io_ring_worker(void* arg)
+{
+    io_ring_t* ring = (io_ring_t*)arg;
+    unsigned int idle = 0;
+
+    while (!_io_ring_is_stopping(ring))
+    {
+        oe_io_ring_host_sqe_t sqe;
+        uint64_t head = _io_ring_head(ring);
+
+        if (_io_ring_pending(ring, head) == 0)
+        {
+            if (++idle < IO_RING_SPIN_COUNT)
+                sched_yield();
+            else
+            {
+                _io_ring_sleep(ring);
+                idle = 0;
+            }
+
+            continue;
+        }
+
+        /* Copy the entry before claiming it. If another worker claims it
+         * first, the entry may be reused, but the claim then fails. */
+        sqe = ring->sq[head % ring->num_entries];
+
+        /* Count the claim before checking for a stop: a teardown that finds
+         * no active submissions after stopping the ring knows that no worker
+         * claims another one. */
+        __atomic_add_fetch(&ring->active, 1, __ATOMIC_SEQ_CST);
+
+        if (_io_ring_is_stopping(ring) ||
+            !__atomic_compare_exchange_n(
+                &ring->header->sq_head,
+                &head,
+                head + 1,
+                false,
+                __ATOMIC_SEQ_CST,
+                __ATOMIC_SEQ_CST))
+        {
+            _io_ring_complete(ring);
+            continue;
+        }
+
+        idle = 0;
+        _io_ring_post(ring, &sqe);
+        _io_ring_complete(ring);
+    }
+
+    pthread_mutex_lock(&ring->lock);
+    __atomic_sub_fetch(&ring->workers, 1, __ATOMIC_SEQ_CST);
+    pthread_cond_broadcast(&ring->idle_cond);
+    pthread_mutex_unlock(&ring->lock);
+
+    _io_ring_put(ring);
+    return NULL;
+}
+
+uint64_t oe_syscall_io_ring_setup_ocall(
+    uint32_t num_entries,
+    uint32_t buffer_size,
+    uint32_t num_workers,
+    uint64_t* ring_out)
+{
+    uint64_t ret = 0;
+    io_ring_t* ring = NULL;
+    pthread_attr_t attr;
+    bool have_attr = false;
+    uint32_t i;
+
+    errno = 0;
+
+    if (!ring_out || num_entries == 0 || num_workers == 0)
+    {
+        errno = EINVAL;
+        goto done;
+    }
+
+    if (!(ring = calloc(1, sizeof(io_ring_t))))
+        goto done;
+
+    if (!(ring->header = calloc(1, oe_io_ring_size(num_entries, buffer_size))))
+    {
+        free(ring);
+        ring = NULL;
+        goto done;
+    }
+
+    ring->sq = (oe_io_ring_host_sqe_t*)((uint8_t*)ring->header +
+                                        oe_io_ring_sq_offset());
+    ring->cq = (oe_io_ring_host_cqe_t*)((uint8_t*)ring->header +
+                                        oe_io_ring_cq_offset(num_entries));
+    ring->data = (uint8_t*)ring->header + oe_io_ring_data_offset(num_entries);
+    ring->num_entries = num_entries;
+    ring->buffer_size = buffer_size;
+    ring->header->num_entries = num_entries;
+    ring->header->buffer_size = buffer_size;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->sq_cond, NULL);
+    pthread_cond_init(&ring->cq_cond, NULL);
+    pthread_cond_init(&ring->idle_cond, NULL);
+
+    /* The reference of the enclave. */
+    ring->refs = 1;
+
+    if ((errno = pthread_attr_init(&attr)) != 0)
+        goto done;
+
+    have_attr = true;
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    for (i = 0; i < num_workers; i++)
+    {
+        pthread_t thread;
+        int err;
+
+        __atomic_add_fetch(&ring->refs, 1, __ATOMIC_ACQ_REL);
+        __atomic_add_fetch(&ring->workers, 1, __ATOMIC_SEQ_CST);
+
+        if ((err = pthread_create(&thread, &attr, _io_ring_worker, ring)))
+        {
+            __atomic_sub_fetch(&ring->workers, 1, __ATOMIC_SEQ_CST);
+            __atomic_sub_fetch(&ring->refs, 1, __ATOMIC_ACQ_REL);
+            errno = err;
+            goto done;
+        }
+    }
+
+    *ring_out = (uint64_t)ring->header;
+    ret = (uint64_t)ring;
+    ring = NULL;
+
+done:
+
+    if (have_attr)
+        pthread_attr_destroy(&attr);
+
+    if (ring)
+    {
+        int err = errno;
+        _io_ring_stop(ring);
+        _io_ring_put(ring);
+        errno = err;
+    }
+
+    return ret;
+}
+
+int oe_syscall_io_ring_wake_ocall(uint64_t handle)
+{
+    io_ring_t* ring = (io_ring_t*)handle;
+
+    errno = 0;
+
+    pthread_mutex_lock(&ring->lock);
+    pthread_cond_broadcast(&ring->sq_cond);
+    pthread_mutex_unlock(&ring->lock);
+
+    return 0;
+}
+
+int oe_syscall_io_ring_wait_ocall(uint64_t handle, uint64_t position)
+{
+    io_ring_t* ring = (io_ring_t*)handle;
+    oe_io_ring_host_cqe_t* cqe = &ring->cq[position % ring->num_entries];
+
+    errno = 0;
+
+    pthread_mutex_lock(&ring->lock);
+    __atomic_add_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+
+    while (__atomic_load_n(&cqe->seq, __ATOMIC_SEQ_CST) != position + 1 &&
+           !ring->stopping)
+        pthread_cond_wait(&ring->cq_cond, &ring->lock);
+
+    __atomic_sub_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&ring->lock);
+
+    return 0;
+}
+
+int oe_syscall_io_ring_teardown_ocall(uint64_t handle)
+{
+    io_ring_t* ring = (io_ring_t*)handle;
+
+    errno = 0;
+
+    _io_ring_stop(ring);
+
+    /* The enclave releases the descriptors of the operations in flight once
+     * this returns, so wait until no worker can touch them. */
+    pthread_mutex_lock(&ring->lock);
+
+    while (__atomic_load_n(&ring->workers, __ATOMIC_SEQ_CST) ||
+           __atomic_load_n(&ring->active, __ATOMIC_SEQ_CST))
+        pthread_cond_wait(&ring->idle_cond, &ring->lock);
+
+    pthread_mutex_unlock(&ring->lock);
+
+    _io_ring_put(ring);
+
+    return 0;
+}
+
 /*
 **==============================================================================
 **
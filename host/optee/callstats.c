@@ -0,0 +1,19 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+
+oe_result_t oe_get_enclave_call_stats(
+    oe_enclave_t* enclave,
+    oe_call_stats_t* ecall_stats,
+    size_t* num_ecall_stats,
+    oe_call_stats_t* ocall_stats,
+    size_t* num_ocall_stats)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(ecall_stats);
+    OE_UNUSED(num_ecall_stats);
+    OE_UNUSED(ocall_stats);
+    OE_UNUSED(num_ocall_stats);
+    return OE_UNSUPPORTED;
+}
@@ -0,0 +1,37 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+
+oe_result_t oe_create_enclave_pool(
+    const oe_enclave_pool_settings_t* settings,
+    oe_enclave_pool_t** pool)
+{
+    OE_UNUSED(settings);
+    OE_UNUSED(pool);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_enclave_pool_acquire(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t** enclave)
+{
+    OE_UNUSED(pool);
+    OE_UNUSED(enclave);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_enclave_pool_release(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t* enclave)
+{
+    OE_UNUSED(pool);
+    OE_UNUSED(enclave);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_terminate_enclave_pool(oe_enclave_pool_t* pool)
+{
+    OE_UNUSED(pool);
+    return OE_UNSUPPORTED;
+}
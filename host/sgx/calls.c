@@ -3,6 +3,7 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #if defined(__linux__)
@@ -20,12 +21,14 @@
 
 #include <openenclave/bits/sgx/sgxtypes.h>
 #include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/debugrt/host.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/registers.h>
 #include <openenclave/internal/safecrt.h>
 #include <openenclave/internal/safemath.h>
+#include <openenclave/internal/sgx/ecall_context.h>
 #include <openenclave/internal/sgx/td.h>
 #include <openenclave/internal/switchless.h>
 #include <openenclave/internal/utils.h>
@@ -222,6 +225,8 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
     oe_ocall_func_t func = NULL;
     size_t buffer_size = 0;
     ocall_table_t ocall_table;
+    uint64_t function_id = 0;
+    uint64_t start = 0;
 
     args_ptr = (oe_call_host_function_args_t*)arg;
     if (args_ptr == NULL)
@@ -235,10 +240,11 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
     ocall_table.num_ocalls = enclave->num_ocalls;
 
     // Fetch matching function.
-    if (args_ptr->function_id >= ocall_table.num_ocalls)
+    function_id = args_ptr->function_id;
+    if (function_id >= ocall_table.num_ocalls)
         OE_RAISE(OE_NOT_FOUND);
 
-    func = ocall_table.ocalls[args_ptr->function_id];
+    func = ocall_table.ocalls[function_id];
     if (func == NULL)
     {
         result = OE_NOT_FOUND;
@@ -258,12 +264,14 @@ oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     // Call the function.
+    start = oe_call_stats_timestamp();
     func(
         args_ptr->input_buffer,
         args_ptr->input_buffer_size,
         args_ptr->output_buffer,
         args_ptr->output_buffer_size,
         &args_ptr->output_bytes_written);
+    oe_record_ocall(enclave, function_id, oe_call_stats_timestamp() - start);
 
     // The ocall succeeded.
     OE_ATOMIC_MEMORY_BARRIER_RELEASE();
@@ -274,6 +282,51 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _handle_call_host_function_batch()
+**
+**     Perform a batch of calls from the enclave in order. A failed call does
+**     not stop the following ones; its result is reported to the enclave.
+**
+**==============================================================================
+*/
+
+static oe_result_t _handle_call_host_function_batch(
+    uint64_t arg,
+    oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_host_function_batch_args_t* args =
+        (oe_call_host_function_batch_args_t*)arg;
+    uint64_t num_calls = 0;
+    oe_call_host_function_args_t* calls = NULL;
+
+    if (!args)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    num_calls = args->num_calls;
+    calls = args->calls;
+
+    if (num_calls && !calls)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (uint64_t i = 0; i < num_calls; i++)
+    {
+        oe_result_t call_result =
+            oe_handle_call_host_function((uint64_t)&calls[i], enclave);
+
+        if (call_result != OE_OK)
+            calls[i].result = call_result;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 static const char* oe_ocall_str(oe_func_t ocall)
 {
     // clang-format off
@@ -284,7 +337,10 @@ static const char* oe_ocall_str(oe_func_t ocall)
         "THREAD_WAIT",
         "MALLOC",
         "FREE",
-        "GET_TIME"
+        "GET_TIME",
+        "GROW_OCALL_BUFFER",
+        "CALL_HOST_FUNCTION_BATCH",
+        "CALL_HOST_FUNCTION_FALLBACK"
     };
     // clang-format on
 
@@ -316,6 +372,70 @@ static const char* oe_ecall_str(oe_func_t ecall)
         return "UNKNOWN";
 };
 
+/*
+**==============================================================================
+**
+** _handle_grow_ocall_buffer()
+**
+**     Grow the ocall buffer of the thread binding so that it can hold at
+**     least arg_in bytes. The buffer grows geometrically and is passed to the
+**     enclave in the ecall context of every later ecall on this binding.
+**
+**==============================================================================
+*/
+
+static oe_result_t _handle_grow_ocall_buffer(
+    void* tcs,
+    uint64_t arg_in,
+    uint64_t* arg_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_thread_binding_t* binding = oe_get_thread_binding();
+    uint64_t size = binding ? binding->ocall_buffer_size : 0;
+    void* buffer = NULL;
+
+    if (!binding || binding->tcs != (uint64_t)tcs || !arg_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (arg_in > OE_MAX_OCALL_BUFFER_SIZE)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (size >= arg_in)
+    {
+        *arg_out = (uint64_t)binding->ocall_buffer;
+        result = OE_OK;
+        goto done;
+    }
+
+    if (size == 0)
+        size = arg_in;
+
+    while (size < arg_in)
+        size *= 2;
+
+    if (size > OE_MAX_OCALL_BUFFER_SIZE)
+        size = OE_MAX_OCALL_BUFFER_SIZE;
+
+    if (!(buffer = malloc(size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    // The enclave only grows the buffer while no ocall is using it.
+    free(binding->ocall_buffer);
+    binding->ocall_buffer = buffer;
+    binding->ocall_buffer_size = size;
+
+    OE_TRACE_VERBOSE(
+        "grew ocall buffer of tcs %p to %llu bytes",
+        tcs,
+        OE_LLU(size));
+
+    *arg_out = (uint64_t)buffer;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 /*
 **==============================================================================
 **
@@ -346,7 +466,10 @@ static oe_result_t _handle_ocall(
         "%s 0x%x %s: %s\n",
         enclave->path,
         enclave->addr,
-        func == OE_OCALL_CALL_HOST_FUNCTION ? "EDL_OCALL" : "OE_OCALL",
+        func == OE_OCALL_CALL_HOST_FUNCTION ||
+                func == OE_OCALL_CALL_HOST_FUNCTION_FALLBACK
+            ? "EDL_OCALL"
+            : "OE_OCALL",
         oe_ocall_str(func));
 
     switch ((oe_func_t)func)
@@ -375,6 +498,23 @@ static oe_result_t _handle_ocall(
             oe_handle_get_time(arg_in, arg_out);
             break;
 
+        case OE_OCALL_CALL_HOST_FUNCTION_FALLBACK:
+            if (arg_in)
+                oe_record_switchless_ocall(
+                    enclave,
+                    ((oe_call_host_function_args_t*)arg_in)->function_id,
+                    false);
+            OE_CHECK(oe_handle_call_host_function(arg_in, enclave));
+            break;
+
+        case OE_OCALL_CALL_HOST_FUNCTION_BATCH:
+            OE_CHECK(_handle_call_host_function_batch(arg_in, enclave));
+            break;
+
+        case OE_OCALL_GROW_OCALL_BUFFER:
+            OE_CHECK(_handle_grow_ocall_buffer(tcs, arg_in, arg_out));
+            break;
+
         default:
         {
             /* No function found with the number */
@@ -446,6 +586,156 @@ int __oe_dispatch_ocall(
     return 1;
 }
 
+/*
+**==============================================================================
+**
+** _set_preferred_binding()/_get_preferred_binding()
+**
+**     Each host thread remembers the last thread binding it released. The
+**     next ECALL from that thread tries to reclaim the same binding first,
+**     which keeps a host thread on the same TCS (and its warm enclave-side
+**     thread data) whenever it is still free, and avoids contending with
+**     other threads on the low bits of the busy bitmap.
+**
+**==============================================================================
+*/
+
+static oe_once_type _preferred_binding_once;
+static oe_thread_key _preferred_binding_key;
+
+static void _create_preferred_binding_key(void)
+{
+    oe_thread_key_create(&_preferred_binding_key);
+}
+
+static void _set_preferred_binding(oe_thread_binding_t* binding)
+{
+    oe_once(&_preferred_binding_once, _create_preferred_binding_key);
+    oe_thread_setspecific(_preferred_binding_key, binding);
+}
+
+static oe_thread_binding_t* _get_preferred_binding(void)
+{
+    oe_once(&_preferred_binding_once, _create_preferred_binding_key);
+    return (oe_thread_binding_t*)oe_thread_getspecific(_preferred_binding_key);
+}
+
+/* Index of the lowest set bit of a non-zero mask */
+static size_t _lowest_bit(uint64_t mask)
+{
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzll(mask);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return index;
+#endif
+}
+
+/* Atomically set the given bit of enclave->busy_bindings. Fails if the bit
+ * was already set by another thread. */
+static bool _try_claim_binding(oe_enclave_t* enclave, size_t index)
+{
+    const uint64_t bit = 1ULL << index;
+
+    for (;;)
+    {
+        uint64_t busy = oe_atomic_load(&enclave->busy_bindings);
+
+        if (busy & bit)
+            return false;
+
+        if (oe_atomic_compare_and_swap(
+                (volatile int64_t*)&enclave->busy_bindings,
+                (int64_t)busy,
+                (int64_t)(busy | bit)))
+            return true;
+    }
+}
+
+static void _unclaim_binding(oe_enclave_t* enclave, size_t index)
+{
+    const uint64_t bit = 1ULL << index;
+
+    for (;;)
+    {
+        uint64_t busy = oe_atomic_load(&enclave->busy_bindings);
+
+        if (oe_atomic_compare_and_swap(
+                (volatile int64_t*)&enclave->busy_bindings,
+                (int64_t)busy,
+                (int64_t)(busy & ~bit)))
+            return;
+    }
+}
+
+/* Returns the binding of this enclave that is already owned by the calling
+ * thread (nested ECALL), or NULL. Only the owning thread ever stores its own
+ * id into binding->thread, so these unlocked reads cannot produce a false
+ * positive. */
+static oe_thread_binding_t* _find_owned_binding(
+    oe_enclave_t* enclave,
+    oe_thread_t thread)
+{
+    oe_thread_binding_t* binding = oe_get_thread_binding();
+    uint64_t busy;
+
+    /* Common case: the TSD binding belongs to this enclave */
+    if (binding && binding->enclave == enclave &&
+        (binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
+        return binding;
+
+    /* The TSD may refer to another enclave when ECALLs to several enclaves
+     * are nested within OCALLs. Fall back to the busy bindings. */
+    busy = oe_atomic_load(&enclave->busy_bindings);
+
+    while (busy)
+    {
+        size_t i = _lowest_bit(busy);
+        binding = &enclave->bindings[i];
+
+        if ((binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
+            return binding;
+
+        busy &= busy - 1;
+    }
+
+    return NULL;
+}
+
+/* Claim a free binding, preferring the one last used by this thread */
+static oe_thread_binding_t* _claim_free_binding(oe_enclave_t* enclave)
+{
+    const size_t num_bindings = enclave->num_bindings;
+    const uint64_t all = (num_bindings == 64) ? ~0ULL
+                                               : ((1ULL << num_bindings) - 1);
+    oe_thread_binding_t* preferred = _get_preferred_binding();
+
+    /* Compare addresses only: the preferred binding may belong to an enclave
+     * that has since been terminated and must not be dereferenced. */
+    if (preferred >= &enclave->bindings[0] &&
+        preferred < &enclave->bindings[num_bindings])
+    {
+        size_t i = (size_t)(preferred - &enclave->bindings[0]);
+
+        if (_try_claim_binding(enclave, i))
+            return preferred;
+    }
+
+    for (;;)
+    {
+        uint64_t free_mask = ~oe_atomic_load(&enclave->busy_bindings) & all;
+
+        if (!free_mask)
+            return NULL;
+
+        size_t i = _lowest_bit(free_mask);
+
+        if (_try_claim_binding(enclave, i))
+            return &enclave->bindings[i];
+    }
+}
+
 /*
 **==============================================================================
 **
@@ -457,71 +747,48 @@ int __oe_dispatch_ocall(
 **
 **     If such a binding already exists, the binding's count in incremented.
 **     Else, the calling host thread is bound to the first available enclave
-**     thread context.
+**     thread context, trying the one it used last first.
 **
-**     Returns the address of the thread control structure (TCS) corresponding
-**     to the enclave thread context.
+**     Bindings are claimed through the enclave->busy_bindings bitmap. Once a
+**     bit is claimed, the binding's fields are only modified by the owning
+**     thread, so no lock is taken.
+**
+**     Returns the binding corresponding to the enclave thread context.
 **
 **==============================================================================
 */
 
-static void* _assign_tcs(oe_enclave_t* enclave)
+static oe_thread_binding_t* _assign_tcs(oe_enclave_t* enclave)
 {
-    void* tcs = NULL;
-    size_t i;
     oe_thread_t thread = oe_thread_self();
+    oe_thread_binding_t* binding;
 
-    oe_mutex_lock(&enclave->lock);
+    /* First attempt to find a busy binding owned by this thread */
+    if ((binding = _find_owned_binding(enclave, thread)))
     {
-        /* First attempt to find a busy oe_sgx_td_t owned by this thread */
-        for (i = 0; i < enclave->num_bindings; i++)
-        {
-            oe_thread_binding_t* binding = &enclave->bindings[i];
-
-            if ((binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
-            {
-                binding->count++;
-                tcs = (void*)binding->tcs;
-
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_push_thread_binding(
-                        enclave->debug_enclave, (sgx_tcs_t*)tcs);
-                break;
-            }
-        }
+        binding->count++;
+    }
+    else if ((binding = _claim_free_binding(enclave)))
+    {
+        binding->thread = thread;
+        binding->count = 1;
+        binding->flags |= _OE_THREAD_BUSY;
 
-        /* If binding not found above, look for an available ThreadBinding */
-        if (!tcs)
-        {
-            for (i = 0; i < enclave->num_bindings; i++)
-            {
-                oe_thread_binding_t* binding = &enclave->bindings[i];
-
-                if (!(binding->flags & _OE_THREAD_BUSY))
-                {
-                    binding->flags |= _OE_THREAD_BUSY;
-                    binding->thread = thread;
-                    binding->count = 1;
-
-                    tcs = (void*)binding->tcs;
-
-                    /* Set into TSD so asynchronous exceptions can get it */
-                    _set_thread_binding(binding);
-                    assert(oe_get_thread_binding() == binding);
-
-                    /* Notify the debugger runtime */
-                    if (enclave->debug && enclave->debug_enclave != NULL)
-                        oe_debug_push_thread_binding(
-                            enclave->debug_enclave, (sgx_tcs_t*)tcs);
-                    break;
-                }
-            }
-        }
+        /* Set into TSD so asynchronous exceptions can get it */
+        _set_thread_binding(binding);
+        assert(oe_get_thread_binding() == binding);
+    }
+    else
+    {
+        return NULL;
     }
-    oe_mutex_unlock(&enclave->lock);
 
-    return tcs;
+    /* Notify the debugger runtime */
+    if (enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_push_thread_binding(
+            enclave->debug_enclave, (sgx_tcs_t*)binding->tcs);
+
+    return binding;
 }
 
 /*
@@ -529,44 +796,35 @@ static void* _assign_tcs(oe_enclave_t* enclave)
 **
 ** _release_tcs()
 **
-**     Decrement the ThreadBinding.count field of the binding associated with
-**     the given TCS. If the field becomes zero, the binding is dissolved.
+**     Decrement the ThreadBinding.count field of the given binding. If the
+**     field becomes zero, the binding is dissolved and returned to the free
+**     set.
 **
 **==============================================================================
 */
 
-static void _release_tcs(oe_enclave_t* enclave, void* tcs)
+static void _release_tcs(oe_enclave_t* enclave, oe_thread_binding_t* binding)
 {
-    size_t i;
+    binding->count--;
+
+    /* Notify the debugger runtime */
+    if (enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_pop_thread_binding();
 
-    oe_mutex_lock(&enclave->lock);
+    if (binding->count == 0)
     {
-        for (i = 0; i < enclave->num_bindings; i++)
-        {
-            oe_thread_binding_t* binding = &enclave->bindings[i];
-
-            if ((binding->flags & _OE_THREAD_BUSY) &&
-                (void*)binding->tcs == tcs)
-            {
-                binding->count--;
-
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_pop_thread_binding();
-
-                if (binding->count == 0)
-                {
-                    binding->flags &= (~_OE_THREAD_BUSY);
-                    binding->thread = 0;
-                    memset(&binding->event, 0, sizeof(binding->event));
-                    _set_thread_binding(NULL);
-                    assert(oe_get_thread_binding() == NULL);
-                }
-                break;
-            }
-        }
+        binding->flags &= (~_OE_THREAD_BUSY);
+        binding->thread = 0;
+        memset(&binding->event, 0, sizeof(binding->event));
+        _set_thread_binding(NULL);
+        assert(oe_get_thread_binding() == NULL);
+
+        _set_preferred_binding(binding);
+
+        /* Publish the release last: the binding may be claimed by another
+         * thread as soon as its bit is cleared */
+        _unclaim_binding(enclave, (size_t)(binding - &enclave->bindings[0]));
     }
-    oe_mutex_unlock(&enclave->lock);
 }
 
 /*
@@ -586,20 +844,24 @@ oe_result_t oe_ecall(
     uint64_t* arg_out_ptr)
 {
     oe_result_t result = OE_UNEXPECTED;
+    oe_thread_binding_t* binding = NULL;
     void* tcs = NULL;
     oe_code_t code = OE_CODE_ECALL;
     oe_code_t code_out = 0;
     uint16_t func_out = 0;
     uint16_t result_out = 0;
     uint64_t arg_out = 0;
+    uint64_t start = 0;
 
     if (!enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     /* Assign a oe_sgx_td_t for this operation */
-    if (!(tcs = _assign_tcs(enclave)))
+    if (!(binding = _assign_tcs(enclave)))
         OE_RAISE(OE_OUT_OF_THREADS);
 
+    tcs = (void*)binding->tcs;
+
     oe_log(
         OE_LOG_LEVEL_VERBOSE,
         "%s 0x%x %s: %s\n",
@@ -608,6 +870,8 @@ oe_result_t oe_ecall(
         func == OE_ECALL_CALL_ENCLAVE_FUNCTION ? "EDL_ECALL" : "OE_ECALL",
         oe_ecall_str(func));
 
+    start = oe_call_stats_timestamp();
+
     /* Perform ECALL or ORET */
     OE_CHECK(_do_eenter(
         enclave,
@@ -625,6 +889,12 @@ oe_result_t oe_ecall(
     if (code_out != OE_CODE_ERET)
         OE_RAISE(OE_UNEXPECTED);
 
+    if (func == OE_ECALL_CALL_ENCLAVE_FUNCTION)
+        oe_record_ecall(
+            enclave,
+            ((oe_call_enclave_function_args_t*)arg)->function_id,
+            oe_call_stats_timestamp() - start);
+
     if (arg_out_ptr)
         *arg_out_ptr = arg_out;
 
@@ -632,8 +902,8 @@ oe_result_t oe_ecall(
 
 done:
 
-    if (enclave && tcs)
-        _release_tcs(enclave, tcs);
+    if (enclave && binding)
+        _release_tcs(enclave, binding);
 
     /* ATTN: this causes an assertion with call nesting. */
     /* ATTN: make enclave argument a cookie. */
@@ -0,0 +1,210 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "callstats.h"
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/raise.h>
+#include <stdlib.h>
+#include <string.h>
+#include "enclave.h"
+
+/*
+**==============================================================================
+**
+** Call statistics
+**
+** Each enclave keeps a table of statistics per ecall and per ocall, indexed by
+** the function id of the call. Counters are updated with atomic operations so
+** that no lock is taken on the call paths. Latencies are measured in TSC
+** cycles on the host: an ecall is timed from EENTER to its return, including
+** the ocalls it makes, and an ocall is timed while its host function runs.
+**
+**==============================================================================
+*/
+
+static void _add(volatile uint64_t* counter, uint64_t value)
+{
+#if defined(__GNUC__)
+    __atomic_add_fetch(counter, value, __ATOMIC_RELAXED);
+#else
+    uint64_t old;
+    do
+    {
+        old = oe_atomic_load(counter);
+    } while (!oe_atomic_compare_and_swap(
+        (int64_t volatile*)counter, (int64_t)old, (int64_t)(old + value)));
+#endif
+}
+
+/* Index of the log2 latency bucket of the given number of cycles */
+static size_t _histogram_index(uint64_t cycles)
+{
+    size_t index = 0;
+
+    while (cycles >>= 1)
+        index++;
+
+    if (index >= OE_CALL_STATS_HISTOGRAM_SIZE)
+        index = OE_CALL_STATS_HISTOGRAM_SIZE - 1;
+
+    return index;
+}
+
+static void _record_call(
+    oe_call_stats_t* stats,
+    size_t num_stats,
+    uint64_t function_id,
+    uint64_t cycles)
+{
+    oe_call_stats_t* s;
+
+    if (!stats || function_id >= num_stats)
+        return;
+
+    s = &stats[function_id];
+    oe_atomic_increment(&s->count);
+    _add(&s->cycles, cycles);
+    oe_atomic_increment(&s->histogram[_histogram_index(cycles)]);
+}
+
+static void _record_switchless(
+    oe_call_stats_t* stats,
+    size_t num_stats,
+    uint64_t function_id,
+    bool hit)
+{
+    if (!stats || function_id >= num_stats)
+        return;
+
+    if (hit)
+        oe_atomic_increment(&stats[function_id].switchless_hits);
+    else
+        oe_atomic_increment(&stats[function_id].switchless_misses);
+}
+
+oe_result_t oe_initialize_call_stats(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_stats_table_t* table = &enclave->call_stats;
+
+    if (enclave->num_ecalls &&
+        !(table->ecalls = (oe_call_stats_t*)calloc(
+              enclave->num_ecalls, sizeof(oe_call_stats_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (enclave->num_ocalls &&
+        !(table->ocalls = (oe_call_stats_t*)calloc(
+              enclave->num_ocalls, sizeof(oe_call_stats_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    table->num_ecalls = enclave->num_ecalls;
+    table->num_ocalls = enclave->num_ocalls;
+
+    result = OE_OK;
+
+done:
+    if (result != OE_OK)
+        oe_free_call_stats(enclave);
+
+    return result;
+}
+
+void oe_free_call_stats(oe_enclave_t* enclave)
+{
+    oe_call_stats_table_t* table = &enclave->call_stats;
+
+    free(table->ecalls);
+    free(table->ocalls);
+    memset(table, 0, sizeof(*table));
+}
+
+void oe_record_ecall(
+    oe_enclave_t* enclave,
+    uint64_t function_id,
+    uint64_t cycles)
+{
+    oe_call_stats_table_t* table = &enclave->call_stats;
+    _record_call(table->ecalls, table->num_ecalls, function_id, cycles);
+}
+
+void oe_record_ocall(
+    oe_enclave_t* enclave,
+    uint64_t function_id,
+    uint64_t cycles)
+{
+    oe_call_stats_table_t* table = &enclave->call_stats;
+    _record_call(table->ocalls, table->num_ocalls, function_id, cycles);
+}
+
+void oe_record_switchless_ecall(
+    oe_enclave_t* enclave,
+    uint64_t function_id,
+    bool hit)
+{
+    oe_call_stats_table_t* table = &enclave->call_stats;
+    _record_switchless(table->ecalls, table->num_ecalls, function_id, hit);
+}
+
+void oe_record_switchless_ocall(
+    oe_enclave_t* enclave,
+    uint64_t function_id,
+    bool hit)
+{
+    oe_call_stats_table_t* table = &enclave->call_stats;
+    _record_switchless(table->ocalls, table->num_ocalls, function_id, hit);
+}
+
+static void _copy_stats(
+    oe_call_stats_t* dest,
+    oe_call_stats_t* src,
+    size_t num_stats)
+{
+    for (size_t i = 0; i < num_stats; i++)
+    {
+        dest[i].count = oe_atomic_load(&src[i].count);
+        dest[i].cycles = oe_atomic_load(&src[i].cycles);
+        dest[i].switchless_hits = oe_atomic_load(&src[i].switchless_hits);
+        dest[i].switchless_misses = oe_atomic_load(&src[i].switchless_misses);
+
+        for (size_t j = 0; j < OE_CALL_STATS_HISTOGRAM_SIZE; j++)
+            dest[i].histogram[j] = oe_atomic_load(&src[i].histogram[j]);
+    }
+}
+
+oe_result_t oe_get_enclave_call_stats(
+    oe_enclave_t* enclave,
+    oe_call_stats_t* ecall_stats,
+    size_t* num_ecall_stats,
+    oe_call_stats_t* ocall_stats,
+    size_t* num_ocall_stats)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_stats_table_t* table = NULL;
+    bool too_small = false;
+
+    if (!enclave || !num_ecall_stats || !num_ocall_stats)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((*num_ecall_stats && !ecall_stats) ||
+        (*num_ocall_stats && !ocall_stats))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    table = &enclave->call_stats;
+
+    too_small = *num_ecall_stats < table->num_ecalls ||
+                *num_ocall_stats < table->num_ocalls;
+
+    *num_ecall_stats = table->num_ecalls;
+    *num_ocall_stats = table->num_ocalls;
+
+    if (too_small)
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+
+    _copy_stats(ecall_stats, table->ecalls, table->num_ecalls);
+    _copy_stats(ocall_stats, table->ocalls, table->num_ocalls);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -0,0 +1,62 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_CALLSTATS_H
+#define _OE_HOST_SGX_CALLSTATS_H
+
+#include <openenclave/host.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+OE_EXTERNC_BEGIN
+
+/* Per-function call statistics of an enclave, indexed by function id */
+typedef struct _oe_call_stats_table
+{
+    oe_call_stats_t* ecalls;
+    size_t num_ecalls;
+    oe_call_stats_t* ocalls;
+    size_t num_ocalls;
+} oe_call_stats_table_t;
+
+/* Read the time-stamp counter */
+OE_INLINE uint64_t oe_call_stats_timestamp(void)
+{
+#if defined(__GNUC__)
+    return __builtin_ia32_rdtsc();
+#elif defined(_MSC_VER)
+    return __rdtsc();
+#else
+#error "unsupported"
+#endif
+}
+
+oe_result_t oe_initialize_call_stats(oe_enclave_t* enclave);
+
+void oe_free_call_stats(oe_enclave_t* enclave);
+
+/* Record a completed ecall or ocall that took the given TSC cycles */
+void oe_record_ecall(
+    oe_enclave_t* enclave,
+    uint64_t function_id,
+    uint64_t cycles);
+void oe_record_ocall(
+    oe_enclave_t* enclave,
+    uint64_t function_id,
+    uint64_t cycles);
+
+/* Record whether a switchless call was handed to a worker thread */
+void oe_record_switchless_ecall(
+    oe_enclave_t* enclave,
+    uint64_t function_id,
+    bool hit);
+void oe_record_switchless_ocall(
+    oe_enclave_t* enclave,
+    uint64_t function_id,
+    bool hit);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_SGX_CALLSTATS_H */
@@ -59,6 +59,7 @@ static char* get_fullpath(const char* path)
 #include "cpuid.h"
 #include "enclave.h"
 #include "exception.h"
+#include "measurecache.h"
 #include "platform_u.h"
 #include "sgxload.h"
 
@@ -108,46 +109,64 @@ static oe_result_t _add_filled_pages(
     bool extend)
 {
     oe_result_t result = OE_UNEXPECTED;
-    oe_page_t* page = NULL;
-    size_t i;
-
-    page = oe_memalign(OE_PAGE_SIZE, sizeof(oe_page_t));
-    if (!page)
-        OE_RAISE(OE_OUT_OF_MEMORY);
+    const uint64_t flags = SGX_SECINFO_REG | SGX_SECINFO_R | SGX_SECINFO_W;
+    uint32_t* chunk = NULL;
+    size_t size;
+    size_t chunk_size;
 
     /* Reject invalid parameters */
     if (!context || !enclave_addr || !vaddr)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    /* Fill or clear the page */
-    if (filler)
+    if (npages == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    OE_CHECK(oe_safe_mul_sizet(npages, OE_PAGE_SIZE, &size));
+
+    /* Zero pages need no source buffer when simulated */
+    if (!filler)
     {
-        size_t n = OE_PAGE_SIZE / sizeof(uint32_t);
-        uint32_t* p = (uint32_t*)page;
+        OE_CHECK(oe_sgx_load_enclave_zero_pages(
+            context, enclave_addr, enclave_addr + *vaddr, size, flags, extend));
+        (*vaddr) += size;
 
-        while (n--)
-            *p++ = filler;
+        result = OE_OK;
+        goto done;
     }
-    else
-        memset(page, 0, sizeof(*page));
 
-    /* Add the pages */
-    for (i = 0; i < npages; i++)
+    /* Fill a chunk of pages and add the pages a chunk at a time */
+    chunk_size = size < OE_SGX_LOAD_CHUNK_SIZE ? size : OE_SGX_LOAD_CHUNK_SIZE;
+
+    if (!(chunk = oe_memalign(OE_PAGE_SIZE, chunk_size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    for (size_t i = 0; i < chunk_size / sizeof(uint32_t); i++)
+        chunk[i] = filler;
+
+    while (size)
     {
-        uint64_t addr = enclave_addr + *vaddr;
-        uint64_t src = (uint64_t)page;
-        uint64_t flags = SGX_SECINFO_REG | SGX_SECINFO_R | SGX_SECINFO_W;
+        size_t n = size < chunk_size ? size : chunk_size;
 
-        OE_CHECK(oe_sgx_load_enclave_data(
-            context, enclave_addr, addr, src, flags, extend));
-        (*vaddr) += OE_PAGE_SIZE;
+        OE_CHECK(oe_sgx_load_enclave_data_range(
+            context,
+            enclave_addr,
+            enclave_addr + *vaddr,
+            (uint64_t)chunk,
+            n,
+            flags,
+            extend));
+        (*vaddr) += n;
+        size -= n;
     }
 
     result = OE_OK;
 
 done:
-    if (page)
-        oe_memalign_free(page);
+    if (chunk)
+        oe_memalign_free(chunk);
 
     return result;
 }
@@ -491,14 +510,15 @@ static oe_result_t _configure_enclave(
             // Configure the switchless ocalls, such as the number of workers.
             case OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS:
             {
-                size_t max_host_workers =
-                    settings[i].u.context_switchless_setting->max_host_workers;
-                size_t max_enclave_workers =
-                    settings[i]
-                        .u.context_switchless_setting->max_enclave_workers;
+                const oe_enclave_setting_context_switchless_t* setting =
+                    settings[i].u.context_switchless_setting;
 
                 OE_CHECK(oe_start_switchless_manager(
-                    enclave, max_host_workers, max_enclave_workers));
+                    enclave,
+                    setting->max_host_workers,
+                    setting->max_enclave_workers,
+                    setting->min_spin_count,
+                    setting->max_spin_count));
                 break;
             }
 #ifdef OE_WITH_EXPERIMENTAL_EEID
@@ -761,11 +781,14 @@ done:
 }
 #endif
 
-oe_result_t oe_sgx_build_enclave(
+/* Builds the enclave. Sets *initialize_failed if the enclave was built but
+ * the platform failed to initialize it. */
+static oe_result_t _build_enclave(
     oe_sgx_load_context_t* context,
     const char* path,
     const oe_sgx_enclave_properties_t* properties,
-    oe_enclave_t* enclave)
+    oe_enclave_t* enclave,
+    bool* initialize_failed)
 {
     oe_result_t result = OE_UNEXPECTED;
     size_t loaded_enclave_pages_size = 0;
@@ -777,6 +800,9 @@ oe_result_t oe_sgx_build_enclave(
     size_t tls_page_count;
     uint64_t vaddr = 0;
     oe_sgx_enclave_properties_t props;
+    oe_sgx_image_id_t image_id;
+    OE_SHA256 cache_key;
+    bool cacheable = false;
 
     if (!enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
@@ -800,6 +826,15 @@ oe_result_t oe_sgx_build_enclave(
     if (!context || !path || !enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+#if !defined(OE_WITH_EXPERIMENTAL_EEID)
+    /* Identify the image before reading it, for the measurement cache.
+     * Simulated enclaves skip EINIT, which would catch a stale MRENCLAVE, so
+     * they are always measured. */
+    cacheable = context->type == OE_SGX_LOAD_TYPE_CREATE &&
+                !oe_sgx_is_simulation_load_context(context) &&
+                oe_sgx_get_image_id(path, &image_id) == OE_OK;
+#endif
+
     /* Load the elf object */
     if (oe_load_enclave_image(path, &oeimage) != OE_OK)
         OE_RAISE(OE_FAILURE);
@@ -882,6 +917,24 @@ oe_result_t oe_sgx_build_enclave(
         context->attributes.flags |= OE_ENCLAVE_FLAG_SGX_KSS;
     }
 
+    /* Reuse the MRENCLAVE of a previous load of the same image with the
+     * same properties, unless the file changed while it was read */
+    if (cacheable)
+    {
+        oe_sgx_image_id_t id;
+
+        cacheable =
+            oe_sgx_get_image_id(path, &id) == OE_OK &&
+            memcmp(&id, &image_id, sizeof(id)) == 0 &&
+            oe_sgx_get_measure_cache_key(
+                path, &image_id, &props, &context->attributes, &cache_key) ==
+                OE_OK;
+
+        if (cacheable)
+            context->use_cached_mrenclave = oe_sgx_measure_cache_lookup(
+                &cache_key, &props, &context->cached_mrenclave);
+    }
+
     /* Perform the ECREATE operation */
     OE_CHECK(oe_sgx_create_enclave(
         context, enclave_size, loaded_enclave_pages_size, &enclave_addr));
@@ -925,8 +978,16 @@ oe_result_t oe_sgx_build_enclave(
 #endif
 
     /* Ask the platform to initialize the enclave and finalize the hash */
-    OE_CHECK(oe_sgx_initialize_enclave(
-        context, enclave_addr, &props, &enclave->hash));
+    result = oe_sgx_initialize_enclave(
+        context, enclave_addr, &props, &enclave->hash);
+    if (result != OE_OK)
+    {
+        *initialize_failed = true;
+        OE_RAISE(result);
+    }
+
+    if (cacheable && !context->use_cached_mrenclave)
+        oe_sgx_measure_cache_store(&cache_key, &enclave->hash);
 
     /* Save full path of this enclave. When a debugger attaches to the host
      * process, it needs the fullpath so that it can load the image binary and
@@ -942,6 +1003,11 @@ oe_result_t oe_sgx_build_enclave(
 
 done:
 
+    /* Measure the image again next time if the cached MRENCLAVE may be the
+     * reason of the failure */
+    if (result != OE_OK && context && context->use_cached_mrenclave)
+        oe_sgx_measure_cache_remove(&cache_key);
+
     if (ecall_data)
         free(ecall_data);
 
@@ -950,6 +1016,46 @@ done:
     return result;
 }
 
+oe_result_t oe_sgx_build_enclave(
+    oe_sgx_load_context_t* context,
+    const char* path,
+    const oe_sgx_enclave_properties_t* properties,
+    oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sgx_load_context_t initial_context;
+    bool initialize_failed = false;
+
+    if (!context || !enclave)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    initial_context = *context;
+    result = _build_enclave(
+        context, path, properties, enclave, &initialize_failed);
+
+#if !defined(OEHOSTMR)
+    /* EINIT fails if the cached MRENCLAVE is stale, e.g. if the image was
+     * replaced by one with the same identity. The entry has been removed, so
+     * release the enclave that was built and build a new one from a fresh
+     * measurement of the image. */
+    if (result != OE_OK && initialize_failed && context->use_cached_mrenclave)
+    {
+        if (enclave->addr)
+            oe_sgx_delete_enclave(enclave);
+
+        oe_mutex_destroy(&enclave->lock);
+
+        *context = initial_context;
+        initialize_failed = false;
+        result = _build_enclave(
+            context, path, properties, enclave, &initialize_failed);
+    }
+#endif
+
+done:
+    return result;
+}
+
 oe_result_t oe_get_ecall_id_table(
     oe_enclave_t* enclave,
     oe_ecall_id_t** ecall_id_table,
@@ -1129,6 +1235,9 @@ oe_result_t oe_create_enclave(
     enclave->num_ecalls = ecall_count;
     oe_register_ecalls(enclave, ecall_name_table, ecall_count);
 
+    /* Allocate the call statistics */
+    OE_CHECK(oe_initialize_call_stats(enclave));
+
     /* Invoke enclave initialization. */
     OE_CHECK(_initialize_enclave(enclave));
 
@@ -1192,6 +1301,9 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
     if (enclave->ecall_id_table)
         free(enclave->ecall_id_table);
 
+    /* Free the call statistics */
+    oe_free_call_stats(enclave);
+
     /* Once the enclave destructor has been invoked, the enclave memory
      * and data structures are freed on a best effort basis from here on */
 
@@ -1214,11 +1326,14 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
         {
             oe_thread_binding_t* binding = &enclave->bindings[i];
             CloseHandle(binding->event.handle);
-            free(binding->ocall_buffer);
         }
 
 #endif
 
+        /* Release the ocall buffers of the thread bindings */
+        for (size_t i = 0; i < enclave->num_bindings; i++)
+            free(enclave->bindings[i].ocall_buffer);
+
         /* Free the path name of the enclave image file */
         free(enclave->path);
     }
@@ -13,6 +13,12 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#if defined(_WIN32)
+#include <Windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#endif
 #include "../fopen.h"
 #include "../memalign.h"
 #include "../strings.h"
@@ -257,10 +263,10 @@ static int _reset_buffer(
     return 0;
 }
 
-int elf64_load(const char* path, elf64_t* elf)
+/* Opens a regular file for reading and gets its size */
+static int _open_file(const char* path, FILE** is, size_t* size)
 {
     int rc = -1;
-    FILE* is = NULL;
     int fd = -1;
 #if defined(_MSC_VER)
     struct __stat64 statbuf;
@@ -268,25 +274,21 @@ int elf64_load(const char* path, elf64_t* elf)
     struct stat statbuf;
 #endif
 
-    if (elf)
-        memset(elf, 0, sizeof(elf64_t));
-
-    if (!path || !elf)
-        goto done;
+    *is = NULL;
 
     /* Open input file */
-    if (oe_fopen(&is, path, "rb") != 0)
+    if (oe_fopen(is, path, "rb") != 0)
         goto done;
 
 #if defined(_MSC_VER)
-    fd = _fileno(is);
+    fd = _fileno(*is);
     if (fd == -1 || _fstat64(fd, &statbuf) != 0)
         goto done;
 
     if ((statbuf.st_mode & _S_IFREG) == 0)
         goto done;
 #else
-    fd = fileno(is);
+    fd = fileno(*is);
     if (fd == -1 || fstat(fd, &statbuf) != 0)
         goto done;
 
@@ -296,7 +298,34 @@ int elf64_load(const char* path, elf64_t* elf)
 #endif
 
     /* Store the size of this file */
-    elf->size = (size_t)statbuf.st_size;
+    *size = (size_t)statbuf.st_size;
+
+    rc = 0;
+
+done:
+
+    if (rc != 0 && *is)
+    {
+        fclose(*is);
+        *is = NULL;
+    }
+
+    return rc;
+}
+
+int elf64_load(const char* path, elf64_t* elf)
+{
+    int rc = -1;
+    FILE* is = NULL;
+
+    if (elf)
+        memset(elf, 0, sizeof(elf64_t));
+
+    if (!path || !elf)
+        goto done;
+
+    if (_open_file(path, &is, &elf->size) != 0)
+        goto done;
 
     /* Allocate the data to hold this image */
     if (!(elf->data = malloc(elf->size)))
@@ -348,6 +377,116 @@ done:
     return rc;
 }
 
+static void _unmap_file(void* data, size_t size)
+{
+#if defined(_WIN32)
+    OE_UNUSED(size);
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+int elf64_map(const char* path, elf64_t* elf)
+{
+    int rc = -1;
+    FILE* is = NULL;
+
+    if (elf)
+        memset(elf, 0, sizeof(elf64_t));
+
+    if (!path || !elf)
+        goto done;
+
+    if (_open_file(path, &is, &elf->size) != 0)
+        goto done;
+
+    /* Empty files cannot be mapped */
+    if (elf->size < sizeof(elf64_ehdr_t))
+        goto done;
+
+    /* Map a private copy-on-write view of the file, so that the pages are
+     * read on first access and changes are not written back to the file */
+#if defined(_WIN32)
+    {
+        HANDLE file = (HANDLE)_get_osfhandle(_fileno(is));
+        HANDLE mapping;
+
+        if (file == INVALID_HANDLE_VALUE)
+            goto done;
+
+        mapping = CreateFileMappingW(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+        if (!mapping)
+            goto done;
+
+        /* The view keeps the mapping open */
+        elf->data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+
+        if (!elf->data)
+            goto done;
+    }
+#else
+    {
+        void* data = mmap(
+            NULL,
+            elf->size,
+            PROT_READ | PROT_WRITE,
+            MAP_PRIVATE,
+            fileno(is),
+            0);
+
+        if (data == MAP_FAILED)
+            goto done;
+
+        elf->data = data;
+    }
+#endif
+
+    /* Validate the ELF file. */
+    if (!_is_valid_elf64(elf))
+        goto done;
+
+    /* Set the magic number */
+    elf->magic = ELF_MAGIC;
+
+    rc = 0;
+
+done:
+
+    if (is)
+        fclose(is);
+
+    if (rc != 0 && elf)
+    {
+        if (elf->data)
+            _unmap_file(elf->data, elf->size);
+
+        memset(elf, 0, sizeof(elf64_t));
+    }
+
+    if (rc)
+        OE_TRACE_ERROR("path=%s\n", path);
+
+    return rc;
+}
+
+int elf64_unmap(elf64_t* elf)
+{
+    int rc = -1;
+
+    if (!_is_valid_elf64(elf))
+        goto done;
+
+    _unmap_file(elf->data, elf->size);
+
+    rc = 0;
+
+done:
+
+    return rc;
+}
+
 static size_t _find_shdr(const elf64_t* elf, const char* name)
 {
     size_t result = (size_t)-1;
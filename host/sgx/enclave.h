@@ -15,6 +15,7 @@
 #include "../ecall_ids.h"
 #include "../hostthread.h"
 #include "asmdefs.h"
+#include "callstats.h"
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -84,6 +85,8 @@ typedef struct _thread_binding
 /* Whether the thread is handling an exception */
 #define _OE_THREAD_HANDLING_EXCEPTION 0X2UL
 
+OE_STATIC_ASSERT(OE_SGX_MAX_TCS <= 64);
+
 /* Get thread data from thread-specific data (TSD) */
 oe_thread_binding_t* oe_get_thread_binding(void);
 
@@ -110,6 +113,11 @@ typedef struct _oe_enclave
     size_t num_bindings;
     oe_mutex lock;
 
+    /* Bitmap of bindings currently owned by a host thread (bit i refers to
+     * bindings[i]). Claimed and released with compare-and-swap so that
+     * oe_ecall() does not serialize on the enclave lock */
+    volatile uint64_t busy_bindings;
+
     /* Hash of enclave (MRENCLAVE) */
     OE_SHA256 hash;
 
@@ -133,6 +141,9 @@ typedef struct _oe_enclave
     oe_ecall_id_t* ecall_id_table;
     size_t ecall_id_table_size;
     size_t num_ecalls;
+
+    /* Statistics of the ecalls and ocalls */
+    oe_call_stats_table_t call_stats;
 } oe_enclave_t;
 
 /* Get the event for the given TCS */
@@ -4,7 +4,9 @@
 #include <assert.h>
 #include <openenclave/host.h>
 #include <openenclave/internal/queue.h>
+#include <openenclave/internal/raise.h>
 #include <openenclave/internal/trace.h>
+#include "../strings.h"
 #include "enclave.h"
 
 static OE_LIST_HEAD(EnclaveListHead, _enclave_entry) oe_enclave_list_head;
@@ -205,3 +207,358 @@ cleanup:
 
     return ret;
 }
+
+/*
+**==============================================================================
+**
+** Enclave pools:
+**
+**     Background threads keep size enclaves ready, counting the ones they
+**     are creating, and terminate released enclaves that are not reused.
+**     Ready enclaves are handed out from a ring in FIFO order.
+**
+**==============================================================================
+*/
+
+struct _oe_enclave_pool
+{
+    oe_enclave_pool_settings_t settings;
+    char* path;
+
+    oe_mutex lock;
+
+    /* Signaled when an enclave becomes ready, a creation fails, or the pool
+     * is terminated */
+    oe_cond ready_cond;
+
+    /* Signaled when the background threads have work */
+    oe_cond work_cond;
+
+    /* Ring of ready enclaves with room for settings.size of them */
+    oe_enclave_t** ready;
+    size_t ready_head;
+    size_t num_ready;
+    size_t num_creating;
+
+    /* Released enclaves to terminate */
+    oe_enclave_t** retired;
+    size_t num_retired;
+
+    /* Result of the last failed creation, which stops creations until an
+     * acquire reports it */
+    oe_result_t error;
+
+    oe_thread_t* threads;
+    size_t num_threads;
+    bool stopping;
+};
+
+static bool _is_enclave_instance(oe_enclave_t* enclave)
+{
+    bool found = false;
+    EnclaveEntry* tmp;
+
+    if (oe_mutex_lock(&oe_enclave_list_lock) != 0)
+        return false;
+
+    OE_LIST_FOREACH(tmp, &oe_enclave_list_head, next_entry)
+    {
+        if (tmp->enclave == enclave)
+        {
+            found = true;
+            break;
+        }
+    }
+
+    oe_mutex_unlock(&oe_enclave_list_lock);
+
+    return found;
+}
+
+static void _push_ready(oe_enclave_pool_t* pool, oe_enclave_t* enclave)
+{
+    size_t tail = (pool->ready_head + pool->num_ready) % pool->settings.size;
+
+    pool->ready[tail] = enclave;
+    pool->num_ready++;
+    oe_cond_broadcast(&pool->ready_cond);
+}
+
+static void* _pool_thread(void* arg)
+{
+    oe_enclave_pool_t* pool = (oe_enclave_pool_t*)arg;
+    const oe_enclave_pool_settings_t* s = &pool->settings;
+
+    oe_mutex_lock(&pool->lock);
+
+    while (!pool->stopping)
+    {
+        if (pool->num_retired)
+        {
+            oe_enclave_t* enclave = pool->retired[--pool->num_retired];
+
+            oe_mutex_unlock(&pool->lock);
+            oe_terminate_enclave(enclave);
+            oe_mutex_lock(&pool->lock);
+        }
+        else if (
+            pool->error == OE_OK &&
+            pool->num_ready + pool->num_creating < s->size)
+        {
+            oe_enclave_t* enclave = NULL;
+            oe_result_t result;
+
+            pool->num_creating++;
+            oe_mutex_unlock(&pool->lock);
+
+            result = s->create(
+                pool->path,
+                s->type,
+                s->flags,
+                s->settings,
+                s->setting_count,
+                &enclave);
+
+            oe_mutex_lock(&pool->lock);
+            pool->num_creating--;
+
+            if (result == OE_OK)
+                _push_ready(pool, enclave);
+            else
+            {
+                OE_TRACE_ERROR(
+                    "enclave pool failed to create an enclave: %s\n",
+                    oe_result_str(result));
+                pool->error = result;
+                oe_cond_broadcast(&pool->ready_cond);
+            }
+        }
+        else
+        {
+            oe_cond_wait(&pool->work_cond, &pool->lock);
+        }
+    }
+
+    oe_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+static void _free_pool(oe_enclave_pool_t* pool)
+{
+    for (size_t i = 0; i < pool->num_ready; i++)
+        oe_terminate_enclave(
+            pool->ready[(pool->ready_head + i) % pool->settings.size]);
+
+    for (size_t i = 0; i < pool->num_retired; i++)
+        oe_terminate_enclave(pool->retired[i]);
+
+    oe_cond_destroy(&pool->work_cond);
+    oe_cond_destroy(&pool->ready_cond);
+    oe_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool->retired);
+    free(pool->ready);
+    free(pool->path);
+    free(pool);
+}
+
+oe_result_t oe_create_enclave_pool(
+    const oe_enclave_pool_settings_t* settings,
+    oe_enclave_pool_t** pool_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_enclave_pool_t* pool = NULL;
+    size_t num_threads;
+    bool initialized = false;
+
+    if (pool_out)
+        *pool_out = NULL;
+
+    if (!settings || !pool_out || !settings->path || !settings->create ||
+        settings->size == 0 || settings->size > OE_ENCLAVE_POOL_MAX_SIZE ||
+        (settings->setting_count && !settings->settings))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    num_threads = settings->num_threads ? settings->num_threads : 1;
+    if (num_threads > settings->size)
+        num_threads = settings->size;
+
+    if (!(pool = (oe_enclave_pool_t*)calloc(1, sizeof(*pool))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    pool->settings = *settings;
+    pool->error = OE_OK;
+
+    if (!(pool->path = oe_strdup(settings->path)) ||
+        !(pool->ready = (oe_enclave_t**)calloc(
+              settings->size, sizeof(oe_enclave_t*))) ||
+        !(pool->retired = (oe_enclave_t**)calloc(
+              settings->size, sizeof(oe_enclave_t*))) ||
+        !(pool->threads =
+              (oe_thread_t*)calloc(num_threads, sizeof(oe_thread_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (oe_mutex_init(&pool->lock) != 0)
+        OE_RAISE(OE_FAILURE);
+
+    if (oe_cond_init(&pool->ready_cond) != 0)
+    {
+        oe_mutex_destroy(&pool->lock);
+        OE_RAISE(OE_FAILURE);
+    }
+
+    if (oe_cond_init(&pool->work_cond) != 0)
+    {
+        oe_cond_destroy(&pool->ready_cond);
+        oe_mutex_destroy(&pool->lock);
+        OE_RAISE(OE_FAILURE);
+    }
+
+    initialized = true;
+
+    for (; pool->num_threads < num_threads; pool->num_threads++)
+    {
+        if (oe_thread_create(
+                &pool->threads[pool->num_threads], _pool_thread, pool) != 0)
+            OE_RAISE(OE_FAILURE);
+    }
+
+    *pool_out = pool;
+    pool = NULL;
+    result = OE_OK;
+
+done:
+
+    if (pool)
+    {
+        if (initialized)
+            oe_terminate_enclave_pool(pool);
+        else
+        {
+            free(pool->threads);
+            free(pool->retired);
+            free(pool->ready);
+            free(pool->path);
+            free(pool);
+        }
+    }
+
+    return result;
+}
+
+oe_result_t oe_enclave_pool_acquire(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t** enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (enclave)
+        *enclave = NULL;
+
+    if (!pool || !enclave)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (oe_mutex_lock(&pool->lock) != 0)
+        OE_RAISE(OE_FAILURE);
+
+    while (!pool->num_ready && pool->error == OE_OK && !pool->stopping)
+        oe_cond_wait(&pool->ready_cond, &pool->lock);
+
+    if (pool->num_ready)
+    {
+        *enclave = pool->ready[pool->ready_head];
+        pool->ready_head = (pool->ready_head + 1) % pool->settings.size;
+        pool->num_ready--;
+        result = OE_OK;
+    }
+    else if (pool->stopping)
+    {
+        result = OE_INVALID_PARAMETER;
+    }
+    else
+    {
+        /* Report the failure once and let the threads try again */
+        result = pool->error;
+        pool->error = OE_OK;
+    }
+
+    /* Create a replacement */
+    oe_cond_broadcast(&pool->work_cond);
+    oe_mutex_unlock(&pool->lock);
+
+    if (result != OE_OK)
+        OE_RAISE(result);
+
+done:
+    return result;
+}
+
+oe_result_t oe_enclave_pool_release(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    bool reuse = false;
+
+    if (!pool || !enclave || !_is_enclave_instance(enclave))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (pool->settings.reset)
+        reuse = pool->settings.reset(enclave, pool->settings.reset_arg) ==
+                OE_OK;
+
+    if (oe_mutex_lock(&pool->lock) != 0)
+        OE_RAISE(OE_FAILURE);
+
+    if (pool->stopping)
+    {
+        /* Terminated below */
+    }
+    else if (
+        reuse && pool->num_ready + pool->num_creating < pool->settings.size)
+    {
+        _push_ready(pool, enclave);
+        enclave = NULL;
+    }
+    else if (pool->num_retired < pool->settings.size)
+    {
+        pool->retired[pool->num_retired++] = enclave;
+        oe_cond_broadcast(&pool->work_cond);
+        enclave = NULL;
+    }
+
+    oe_mutex_unlock(&pool->lock);
+
+    if (enclave)
+        oe_terminate_enclave(enclave);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_terminate_enclave_pool(oe_enclave_pool_t* pool)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!pool)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    oe_cond_broadcast(&pool->work_cond);
+    oe_cond_broadcast(&pool->ready_cond);
+    oe_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->num_threads; i++)
+        oe_thread_join(pool->threads[i]);
+
+    _free_pool(pool);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -20,17 +20,44 @@
 #include <openenclave/internal/utils.h>
 #include <stdlib.h>
 #include <string.h>
+#include "../hostthread.h"
 #include "../memalign.h"
 #include "../strings.h"
 #include "enclave.h"
 #include "sgxload.h"
 
+/* The loadable segments are staged into the image buffer in chunks of this
+ * size, which are spread over at most OE_ELF_STAGE_MAX_THREADS threads. */
+#define OE_ELF_STAGE_CHUNK_SIZE (4 * 1024 * 1024)
+#define OE_ELF_STAGE_MAX_THREADS 8
+
+/* File contents of a loadable segment */
+typedef struct _elf_stage_copy
+{
+    uint64_t vaddr;
+    const uint8_t* data;
+    uint64_t size;
+} elf_stage_copy_t;
+
+/* Chunks of the image buffer staged by one thread: first_chunk, then every
+ * chunk_stride-th chunk after it */
+typedef struct _elf_stage_job
+{
+    char* image_base;
+    size_t image_size;
+    const elf_stage_copy_t* copies;
+    size_t num_copies;
+    size_t num_chunks;
+    size_t first_chunk;
+    size_t chunk_stride;
+} elf_stage_job_t;
+
 static void _unload_elf_image(oe_enclave_elf_image_t* image)
 {
     if (image)
     {
         if (image->elf.data)
-            free(image->elf.data);
+            elf64_unmap(&image->elf);
 
         if (image->image_base)
             oe_memalign_free(image->image_base);
@@ -53,10 +80,10 @@ static oe_result_t _unload_image(oe_enclave_image_t* image)
     return OE_OK;
 }
 
-/* Loads an ELF64 binary from disk into memory as image->elf.data
+/* Maps an ELF64 binary from disk into memory as image->elf.data
  * and provides a pointer to it as an ELF64 header structure.
  *
- * The caller is responsible for calling free on image->elf.data.
+ * The caller is responsible for calling elf64_unmap on image->elf.
  */
 static oe_result_t _read_elf_header(
     const char* path,
@@ -66,8 +93,8 @@ static oe_result_t _read_elf_header(
     oe_result_t result = OE_UNEXPECTED;
     elf64_ehdr_t* eh = NULL;
 
-    /* Load the ELF64 into memory */
-    if (elf64_load(path, &image->elf) != 0)
+    /* Map the ELF64 into memory */
+    if (elf64_map(path, &image->elf) != 0)
     {
         OE_RAISE(OE_INVALID_IMAGE);
     }
@@ -176,8 +203,8 @@ done:
     return result;
 }
 
-/* Reads the number of loadable segments and allocates a zeroed, page-aligned
- * image buffer for reading the segment contents into.
+/* Reads the number of loadable segments and allocates a page-aligned image
+ * buffer for staging the segment contents into.
  *
  * The caller is responsible for calling memalign_free on image->image_base.
  */
@@ -235,15 +262,115 @@ static oe_result_t _initialize_image_segments(
     /* Calculate the full size of the image (rounded up to the page size) */
     image->image_size = oe_round_up_to_page_size(hi - lo);
 
-    /* Allocate the in-memory image for program segments on a page boundary */
+    /* Allocate the in-memory image for program segments on a page boundary.
+     * Staging fills all of it, including the zeros between segments. */
     image->image_base = (char*)oe_memalign(OE_PAGE_SIZE, image->image_size);
     if (!image->image_base)
     {
         OE_RAISE(OE_OUT_OF_MEMORY);
     }
 
-    /* Zero initialize the in-memory image */
-    memset(image->image_base, 0, image->image_size);
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Fills a chunk of the image buffer with the file contents of the segments
+ * and zeros between them. */
+static void _stage_chunk(const elf_stage_job_t* job, uint64_t offset)
+{
+    uint64_t end = offset + OE_ELF_STAGE_CHUNK_SIZE;
+    uint64_t pos = offset;
+
+    if (end > job->image_size)
+        end = job->image_size;
+
+    /* The copies are sorted by address and do not overlap */
+    for (size_t i = 0; i < job->num_copies && pos < end; i++)
+    {
+        const elf_stage_copy_t* copy = &job->copies[i];
+        uint64_t copy_end = copy->vaddr + copy->size;
+        uint64_t lo = copy->vaddr > pos ? copy->vaddr : pos;
+        uint64_t hi = copy_end < end ? copy_end : end;
+
+        if (lo >= hi)
+            continue;
+
+        memset(job->image_base + pos, 0, lo - pos);
+        memcpy(job->image_base + lo, copy->data + (lo - copy->vaddr), hi - lo);
+        pos = hi;
+    }
+
+    memset(job->image_base + pos, 0, end - pos);
+}
+
+static void* _stage_thread(void* arg)
+{
+    const elf_stage_job_t* job = (const elf_stage_job_t*)arg;
+
+    for (size_t i = job->first_chunk; i < job->num_chunks;
+         i += job->chunk_stride)
+        _stage_chunk(job, (uint64_t)i * OE_ELF_STAGE_CHUNK_SIZE);
+
+    return NULL;
+}
+
+/* Stages the segment contents into the image buffer and loads the
+ * relocations into image->reloc_data. The chunks of the image buffer are
+ * independent, so they are staged by several threads while the calling
+ * thread loads the relocations. Both only read the mapped ELF file.
+ *
+ * The caller is responsible for calling memalign_free on image->reloc_data.
+ */
+static oe_result_t _stage_image(
+    oe_enclave_elf_image_t* image,
+    const elf_stage_copy_t* copies,
+    size_t num_copies)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    elf_stage_job_t jobs[OE_ELF_STAGE_MAX_THREADS];
+    oe_thread_t threads[OE_ELF_STAGE_MAX_THREADS];
+    bool started[OE_ELF_STAGE_MAX_THREADS] = {0};
+    size_t num_chunks = (image->image_size + OE_ELF_STAGE_CHUNK_SIZE - 1) /
+                        OE_ELF_STAGE_CHUNK_SIZE;
+    size_t num_jobs = num_chunks < OE_ELF_STAGE_MAX_THREADS
+                          ? num_chunks
+                          : OE_ELF_STAGE_MAX_THREADS;
+    bool relocations_loaded;
+
+    for (size_t i = 0; i < num_jobs; i++)
+    {
+        jobs[i].image_base = image->image_base;
+        jobs[i].image_size = image->image_size;
+        jobs[i].copies = copies;
+        jobs[i].num_copies = num_copies;
+        jobs[i].num_chunks = num_chunks;
+        jobs[i].first_chunk = i;
+        jobs[i].chunk_stride = num_jobs;
+
+        /* Images of a single chunk are staged on the calling thread */
+        if (num_jobs > 1)
+            started[i] =
+                oe_thread_create(&threads[i], _stage_thread, &jobs[i]) == 0;
+    }
+
+    /* Load the relocations into memory (zero-padded to next page size) */
+    relocations_loaded =
+        elf64_load_relocations(
+            &image->elf, &image->reloc_data, &image->reloc_size) == 0;
+
+    /* Stage the chunks of the threads that could not be started */
+    for (size_t i = 0; i < num_jobs; i++)
+    {
+        if (started[i])
+            oe_thread_join(threads[i]);
+        else
+            _stage_thread(&jobs[i]);
+    }
+
+    if (!relocations_loaded)
+        OE_RAISE(OE_INVALID_IMAGE);
 
     result = OE_OK;
 
@@ -251,32 +378,41 @@ done:
     return result;
 }
 
-/* Populates the image buffer with the contents of all loadable segments.
- * For each loaded segment, this function caches the segment properties
- * needed during enclave load in image->segments.
+/* Populates the image buffer with the contents of all loadable segments and
+ * loads the relocations. For each loaded segment, this function caches the
+ * segment properties needed during enclave load in image->segments.
  *
  * Also validates that the PT_TLS segment conforms to the enclave loader
  * expectations for handling TLS.
  *
- * The caller is responsible for calling memalign_free on image->segments.
+ * The caller is responsible for calling memalign_free on image->segments and
+ * image->reloc_data.
  */
 static oe_result_t _stage_image_segments(
     const elf64_ehdr_t* ehdr,
     oe_enclave_elf_image_t* image)
 {
     oe_result_t result = OE_UNEXPECTED;
+    elf_stage_copy_t* copies = NULL;
 
     /* Allocate array of cached segment structures for enclave load */
     size_t segments_size = image->num_segments * sizeof(oe_elf_segment_t);
     image->segments =
         (oe_elf_segment_t*)oe_memalign(OE_PAGE_SIZE, segments_size);
-    memset(image->segments, 0, segments_size);
     if (!image->segments)
     {
         OE_RAISE(OE_OUT_OF_MEMORY);
     }
+    memset(image->segments, 0, segments_size);
 
-    /* Read all loadable program segments into in-memory image and cache their
+    copies = (elf_stage_copy_t*)calloc(
+        image->num_segments, sizeof(elf_stage_copy_t));
+    if (!copies)
+    {
+        OE_RAISE(OE_OUT_OF_MEMORY);
+    }
+
+    /* Locate all loadable program segments in the ELF file and cache their
      * properties in the segments array. */
     for (size_t i = 0, pt_read_segments_index = 0; i < ehdr->e_phnum; i++)
     {
@@ -290,6 +426,8 @@ static oe_result_t _stage_image_segments(
         {
             case PT_LOAD:
             {
+                uint64_t file_end;
+
                 /* Cache the segment properties for enclave page add */
                 segment->memsz = ph->p_memsz;
                 segment->vaddr = ph->p_vaddr;
@@ -304,11 +442,21 @@ static oe_result_t _stage_image_segments(
                         i);
                 }
 
-                /* Copy the segment data to the image buffer */
-                memcpy(
-                    image->image_base + segment->vaddr,
-                    segment_data,
-                    ph->p_filesz);
+                /* The segment data is read from the mapped file later */
+                if (oe_safe_add_u64(ph->p_offset, ph->p_filesz, &file_end) !=
+                        OE_OK ||
+                    file_end > image->elf.size)
+                {
+                    OE_RAISE_MSG(
+                        OE_INVALID_IMAGE,
+                        "Segment at index %lu is past the end of the file",
+                        i);
+                }
+
+                copies[pt_read_segments_index].vaddr = ph->p_vaddr;
+                copies[pt_read_segments_index].data =
+                    (const uint8_t*)segment_data;
+                copies[pt_read_segments_index].size = ph->p_filesz;
                 pt_read_segments_index++;
                 break;
             }
@@ -382,9 +530,13 @@ static oe_result_t _stage_image_segments(
         }
     }
 
+    /* Copy the segments and load the relocations */
+    OE_CHECK(_stage_image(image, copies, image->num_segments));
+
     result = OE_OK;
 
 done:
+    free(copies);
     return result;
 }
 
@@ -428,11 +580,6 @@ static oe_result_t _load_elf_image(
 
     OE_CHECK(_stage_image_segments(ehdr, image));
 
-    /* Load the relocations into memory (zero-padded to next page size) */
-    if (elf64_load_relocations(
-            &image->elf, &image->reloc_data, &image->reloc_size) != 0)
-        OE_RAISE(OE_INVALID_IMAGE);
-
     if (oe_get_current_logging_level() >= OE_LOG_LEVEL_VERBOSE)
         _dump_relocations(image->reloc_data, image->reloc_size);
 
@@ -547,20 +694,18 @@ static oe_result_t _add_relocation_pages(
 
     if (reloc_data && reloc_size)
     {
-        const oe_page_t* pages = (const oe_page_t*)reloc_data;
-        size_t npages = reloc_size / sizeof(oe_page_t);
+        uint64_t flags = SGX_SECINFO_REG | SGX_SECINFO_R;
+        bool extend = true;
 
-        for (size_t i = 0; i < npages; i++)
-        {
-            uint64_t addr = enclave_addr + *vaddr;
-            uint64_t src = (uint64_t)&pages[i];
-            uint64_t flags = SGX_SECINFO_REG | SGX_SECINFO_R;
-            bool extend = true;
-
-            OE_CHECK(oe_sgx_load_enclave_data(
-                context, enclave_addr, addr, src, flags, extend));
-            (*vaddr) += sizeof(oe_page_t);
-        }
+        OE_CHECK(oe_sgx_load_enclave_data_range(
+            context,
+            enclave_addr,
+            enclave_addr + *vaddr,
+            (uint64_t)reloc_data,
+            reloc_size,
+            flags,
+            extend));
+        (*vaddr) += reloc_size;
     }
 
     result = OE_OK;
@@ -586,7 +731,7 @@ static oe_result_t _add_segment_pages(
 
     /* Take into account that segment base address may not be page aligned */
     page_rva = oe_round_down_to_page_size(segment->vaddr);
-    segment_end = segment->vaddr + segment->memsz;
+    segment_end = oe_round_up_to_page_size(segment->vaddr + segment->memsz);
     flags = _make_secinfo_flags(segment->flags);
 
     if (flags == 0)
@@ -597,16 +742,15 @@ static oe_result_t _add_segment_pages(
 
     flags |= SGX_SECINFO_REG;
 
-    for (; page_rva < segment_end; page_rva += OE_PAGE_SIZE)
-    {
-        OE_CHECK(oe_sgx_load_enclave_data(
-            context,
-            enclave_addr,
-            enclave_addr + page_rva,
-            (uint64_t)image + page_rva,
-            flags,
-            true));
-    }
+    /* The pages are added and measured in order */
+    OE_CHECK(oe_sgx_load_enclave_data_range(
+        context,
+        enclave_addr,
+        enclave_addr + page_rva,
+        (uint64_t)image + page_rva,
+        segment_end - page_rva,
+        flags,
+        true));
 
     result = OE_OK;
 
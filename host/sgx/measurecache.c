@@ -0,0 +1,259 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include "measurecache.h"
+#include <openenclave/internal/raise.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "../hostthread.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+/*
+**==============================================================================
+**
+** Measurement cache:
+**
+** Computing MRENCLAVE hashes every measured page of the enclave, which costs
+** as much as reading the whole image again. The cache maps an image file and
+** the properties that it is loaded with to the MRENCLAVE of a previous load,
+** so that creating the same enclave again only copies the pages. The file is
+** identified by its device, inode, size and times rather than by a digest of
+** its contents, which would cost as much as the measurement itself. A stale
+** value cannot produce a wrong enclave: EINIT checks the MRENCLAVE of the
+** SIGSTRUCT against the one that the CPU measured, in which case the image is
+** measured and loaded again. Simulated enclaves skip EINIT, so they do not
+** use the cache.
+**
+**==============================================================================
+*/
+
+typedef struct _measure_cache_entry
+{
+    OE_SHA256 key;
+    OE_SHA256 mrenclave;
+    uint64_t last_used;
+    bool valid;
+} measure_cache_entry_t;
+
+static measure_cache_entry_t _entries[OE_SGX_MEASURE_CACHE_SIZE];
+static uint64_t _clock;
+static uint64_t _hits;
+static uint64_t _misses;
+static oe_mutex _lock = OE_H_MUTEX_INITIALIZER;
+
+#if defined(_WIN32)
+/* Split a FILETIME, in units of 100 ns, into seconds and nanoseconds */
+static void _set_time(const FILETIME* time, int64_t* sec, int64_t* nsec)
+{
+    const uint64_t ticks =
+        ((uint64_t)time->dwHighDateTime << 32) | time->dwLowDateTime;
+
+    *sec = (int64_t)(ticks / 10000000);
+    *nsec = (int64_t)(ticks % 10000000) * 100;
+}
+#endif
+
+oe_result_t oe_sgx_get_image_id(const char* path, oe_sgx_image_id_t* id)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    struct stat st;
+
+    if (!path || !id)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (stat(path, &st) != 0)
+        OE_RAISE_NO_TRACE(OE_NOT_FOUND);
+
+    memset(id, 0, sizeof(*id));
+    id->dev = (uint64_t)st.st_dev;
+    id->ino = (uint64_t)st.st_ino;
+    id->size = (uint64_t)st.st_size;
+
+    /* A file rewritten within the same second must get another identity */
+#if defined(_WIN32)
+    {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+
+        if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+            OE_RAISE_NO_TRACE(OE_NOT_FOUND);
+
+        _set_time(&data.ftLastWriteTime, &id->mtime, &id->mtime_nsec);
+        _set_time(&data.ftCreationTime, &id->ctime, &id->ctime_nsec);
+    }
+#else
+    id->mtime = (int64_t)st.st_mtim.tv_sec;
+    id->mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+    id->ctime = (int64_t)st.st_ctim.tv_sec;
+    id->ctime_nsec = (int64_t)st.st_ctim.tv_nsec;
+#endif
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sgx_get_measure_cache_key(
+    const char* path,
+    const oe_sgx_image_id_t* id,
+    const oe_sgx_enclave_properties_t* properties,
+    const sgx_attributes_t* attributes,
+    OE_SHA256* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    if (!path || !id || !properties || !attributes || !key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(&context, path, strlen(path) + 1));
+    OE_CHECK(oe_sha256_update(&context, id, sizeof(*id)));
+    OE_CHECK(oe_sha256_update(&context, properties, sizeof(*properties)));
+    OE_CHECK(oe_sha256_update(&context, attributes, sizeof(*attributes)));
+    OE_CHECK(oe_sha256_final(&context, key));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static measure_cache_entry_t* _find(const OE_SHA256* key)
+{
+    for (size_t i = 0; i < OE_SGX_MEASURE_CACHE_SIZE; i++)
+    {
+        measure_cache_entry_t* entry = &_entries[i];
+
+        if (entry->valid && memcmp(&entry->key, key, sizeof(*key)) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+static bool _is_signed(const oe_sgx_enclave_properties_t* properties)
+{
+    const sgx_sigstruct_t* sigstruct =
+        (const sgx_sigstruct_t*)properties->sigstruct;
+
+    return memcmp(
+               sigstruct->header,
+               SGX_SIGSTRUCT_HEADER,
+               sizeof(SGX_SIGSTRUCT_HEADER)) == 0;
+}
+
+bool oe_sgx_measure_cache_lookup(
+    const OE_SHA256* key,
+    const oe_sgx_enclave_properties_t* properties,
+    OE_SHA256* mrenclave)
+{
+    bool found = false;
+    measure_cache_entry_t* entry;
+
+    if (!key || !properties || !mrenclave)
+        return false;
+
+    if (oe_mutex_lock(&_lock) != 0)
+        return false;
+
+    if ((entry = _find(key)))
+    {
+        const sgx_sigstruct_t* sigstruct =
+            (const sgx_sigstruct_t*)properties->sigstruct;
+
+        /* The SIGSTRUCT of a signed image states the expected MRENCLAVE */
+        if (!_is_signed(properties) ||
+            memcmp(
+                sigstruct->enclavehash,
+                &entry->mrenclave,
+                sizeof(sigstruct->enclavehash)) == 0)
+        {
+            entry->last_used = ++_clock;
+            *mrenclave = entry->mrenclave;
+            found = true;
+        }
+    }
+
+    if (found)
+        _hits++;
+    else
+        _misses++;
+
+    oe_mutex_unlock(&_lock);
+
+    return found;
+}
+
+void oe_sgx_measure_cache_store(
+    const OE_SHA256* key,
+    const OE_SHA256* mrenclave)
+{
+    measure_cache_entry_t* entry;
+
+    if (!key || !mrenclave)
+        return;
+
+    if (oe_mutex_lock(&_lock) != 0)
+        return;
+
+    /* Replace the entry of the key, or else a free or the least recently
+     * used entry */
+    if (!(entry = _find(key)))
+    {
+        entry = &_entries[0];
+
+        for (size_t i = 0; i < OE_SGX_MEASURE_CACHE_SIZE; i++)
+        {
+            if (!_entries[i].valid)
+            {
+                entry = &_entries[i];
+                break;
+            }
+
+            if (_entries[i].last_used < entry->last_used)
+                entry = &_entries[i];
+        }
+    }
+
+    entry->key = *key;
+    entry->mrenclave = *mrenclave;
+    entry->last_used = ++_clock;
+    entry->valid = true;
+
+    oe_mutex_unlock(&_lock);
+}
+
+void oe_sgx_measure_cache_remove(const OE_SHA256* key)
+{
+    measure_cache_entry_t* entry;
+
+    if (!key)
+        return;
+
+    if (oe_mutex_lock(&_lock) != 0)
+        return;
+
+    if ((entry = _find(key)))
+        memset(entry, 0, sizeof(*entry));
+
+    oe_mutex_unlock(&_lock);
+}
+
+void oe_sgx_get_measure_cache_stats(uint64_t* hits, uint64_t* misses)
+{
+    if (oe_mutex_lock(&_lock) != 0)
+        return;
+
+    if (hits)
+        *hits = _hits;
+
+    if (misses)
+        *misses = _misses;
+
+    oe_mutex_unlock(&_lock);
+}
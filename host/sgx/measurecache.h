@@ -0,0 +1,58 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_MEASURECACHE_H
+#define _OE_HOST_SGX_MEASURECACHE_H
+
+#include <openenclave/bits/properties.h>
+#include <openenclave/bits/sgx/sgxtypes.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/crypto/sha.h>
+
+OE_EXTERNC_BEGIN
+
+/* Maximum number of measurements that the cache holds */
+#define OE_SGX_MEASURE_CACHE_SIZE 32
+
+/* Identity of an enclave image file, which changes when the file does */
+typedef struct _oe_sgx_image_id
+{
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime;
+    int64_t mtime_nsec;
+    int64_t ctime;
+    int64_t ctime_nsec;
+} oe_sgx_image_id_t;
+
+oe_result_t oe_sgx_get_image_id(const char* path, oe_sgx_image_id_t* id);
+
+/* Compute the key of the measurement of an image that is loaded with the
+ * given properties and attributes. */
+oe_result_t oe_sgx_get_measure_cache_key(
+    const char* path,
+    const oe_sgx_image_id_t* id,
+    const oe_sgx_enclave_properties_t* properties,
+    const sgx_attributes_t* attributes,
+    OE_SHA256* key);
+
+/* Find the MRENCLAVE of a key. If the properties hold a signed SIGSTRUCT,
+ * a cached value that differs from its ENCLAVEHASH is not returned. */
+bool oe_sgx_measure_cache_lookup(
+    const OE_SHA256* key,
+    const oe_sgx_enclave_properties_t* properties,
+    OE_SHA256* mrenclave);
+
+void oe_sgx_measure_cache_store(
+    const OE_SHA256* key,
+    const OE_SHA256* mrenclave);
+
+void oe_sgx_measure_cache_remove(const OE_SHA256* key);
+
+/* Get the number of lookups that found a measurement and that did not. */
+void oe_sgx_get_measure_cache_stats(uint64_t* hits, uint64_t* misses);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_SGX_MEASURECACHE_H */
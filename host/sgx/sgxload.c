@@ -354,7 +354,8 @@ oe_result_t oe_sgx_create_enclave(
         OE_RAISE(OE_OUT_OF_MEMORY);
 
     /* Measure this operation */
-    OE_CHECK(oe_sgx_measure_create_enclave(&context->hash_context, secs));
+    if (!context->use_cached_mrenclave)
+        OE_CHECK(oe_sgx_measure_create_enclave(&context->hash_context, secs));
 
     if (context->type == OE_SGX_LOAD_TYPE_MEASURE)
     {
@@ -514,35 +515,189 @@ static void _dump_load_enclave_data(
 
 #endif /* defined(OE_TRACE_MEASURE) */
 
-oe_result_t oe_sgx_load_enclave_data(
+/* Check the parameters of a load of size bytes at addr and measure its pages.
+ * The pages are loaded from consecutive source pages, or all from the single
+ * page at src if same_src is set. */
+static oe_result_t _measure_load(
     oe_sgx_load_context_t* context,
     uint64_t base,
     uint64_t addr,
     uint64_t src,
+    uint64_t size,
+    bool same_src,
     uint64_t flags,
     bool extend)
 {
     oe_result_t result = OE_UNEXPECTED;
+    uint64_t end;
 
-    if (!context || !base || !addr || !src || !flags)
+    if (!context || !base || !addr || !src || !size || !flags)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     if (context->state != OE_SGX_LOAD_STATE_ENCLAVE_CREATED)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    /* addr and src must both be page aligned */
-    if (addr % OE_PAGE_SIZE || src % OE_PAGE_SIZE)
+    /* addr, src and size must all be page aligned */
+    if (addr % OE_PAGE_SIZE || src % OE_PAGE_SIZE || size % OE_PAGE_SIZE)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    OE_CHECK(oe_safe_add_u64(addr, size, &end));
+
+    /* The MRENCLAVE of the enclave is already known */
+    if (context->use_cached_mrenclave)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    for (uint64_t offset = 0; offset < size; offset += OE_PAGE_SIZE)
+    {
+        uint64_t page_src = same_src ? src : src + offset;
+
 #if defined(OE_TRACE_MEASURE)
 
-    _dump_load_enclave_data(addr - base, flags, src, extend);
+        _dump_load_enclave_data(addr + offset - base, flags, page_src, extend);
 
 #endif /* defined(OE_TRACE_MEASURE) */
 
-    /* Measure this operation */
-    OE_CHECK(oe_sgx_measure_load_enclave_data(
-        &context->hash_context, base, addr, src, flags, extend));
+        /* Measure this operation */
+        OE_CHECK(oe_sgx_measure_load_enclave_data(
+            &context->hash_context,
+            base,
+            addr + offset,
+            page_src,
+            flags,
+            extend));
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+#if !defined(OEHOSTMR)
+
+/* Verify that the pages are within the simulated enclave boundaries */
+static oe_result_t _check_sim_range(
+    const oe_sgx_load_context_t* context,
+    uint64_t addr,
+    uint64_t size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t start = (uint64_t)context->sim.addr;
+    uint64_t end = start + context->sim.size;
+
+    if (addr < start || addr > end || size > end - addr)
+        OE_RAISE_MSG(OE_FAILURE, "Page is NOT within enclave boundaries", NULL);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Set the access permissions of simulated enclave pages */
+static oe_result_t _protect_sim_range(
+    uint64_t addr,
+    uint64_t size,
+    uint64_t flags)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    int prot = _make_memory_protect_param(flags, true /*simulate*/);
+
+    if ((uint32_t)prot > OE_INT_MAX)
+        OE_RAISE_MSG(OE_FAILURE, "Unexpected page protections: %#x", prot);
+
+#if defined(__linux__)
+    if (mprotect((void*)addr, size, prot) != 0)
+        OE_RAISE_MSG(
+            OE_FAILURE,
+            "mprotect failed (addr=%#x, size=%#x, prot=%#x)",
+            addr,
+            size,
+            prot);
+#elif defined(_WIN32)
+    DWORD old;
+    if (!VirtualProtect((LPVOID)addr, size, prot, &old))
+        OE_RAISE_MSG(
+            OE_FAILURE,
+            "VirtualProtect failed (addr=%#x, size=%#x, prot=%#x)",
+            addr,
+            size,
+            prot);
+#endif
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Add enclave pages with a single call, which the SGX driver performs with
+ * its multi-page add ioctl */
+static oe_result_t _add_enclave_pages(
+    uint64_t addr,
+    uint64_t size,
+    uint64_t src,
+    uint64_t flags,
+    bool extend)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    int protect = _make_memory_protect_param(flags, false /*not simulate*/);
+    uint32_t enclave_error;
+
+    if (!extend)
+        protect |= ENCLAVE_PAGE_UNVALIDATED;
+
+    if (oe_sgx_enclave_load_data(
+            (void*)addr,
+            size,
+            (const void*)src,
+            (uint32_t)protect,
+            &enclave_error) != size)
+        OE_RAISE_MSG(
+            OE_PLATFORM_ERROR,
+            "enclave_load_data failed (addr=%#x, size=%#x, prot=%#x, "
+            "err=%#x)",
+            addr,
+            size,
+            protect,
+            enclave_error);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+#endif // OEHOSTMR
+
+oe_result_t oe_sgx_load_enclave_data(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    uint64_t flags,
+    bool extend)
+{
+    return oe_sgx_load_enclave_data_range(
+        context, base, addr, src, OE_PAGE_SIZE, flags, extend);
+}
+
+oe_result_t oe_sgx_load_enclave_data_range(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    uint64_t size,
+    uint64_t flags,
+    bool extend)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    OE_CHECK(
+        _measure_load(context, base, addr, src, size, false, flags, extend));
 
     if (context->type == OE_SGX_LOAD_TYPE_MEASURE)
     {
@@ -554,68 +709,104 @@ oe_result_t oe_sgx_load_enclave_data(
     else if (oe_sgx_is_simulation_load_context(context))
     {
         /* Simulate enclave add page */
-        /* Verify that page is within enclave boundaries */
-        if ((void*)addr < context->sim.addr ||
-            (uint8_t*)addr >
-                (uint8_t*)context->sim.addr + context->sim.size - OE_PAGE_SIZE)
-            OE_RAISE_MSG(
-                OE_FAILURE, "Page is NOT within enclave boundaries", NULL);
+        OE_CHECK(_check_sim_range(context, addr, size));
 
         /* Copy page contents onto memory-mapped region */
-        OE_CHECK(oe_memcpy_s(
-            (uint8_t*)addr, OE_PAGE_SIZE, (uint8_t*)src, OE_PAGE_SIZE));
+        OE_CHECK(oe_memcpy_s((uint8_t*)addr, size, (uint8_t*)src, size));
 
-        /* Set page access permissions */
-        {
-            int prot = _make_memory_protect_param(flags, true /*simulate*/);
+        OE_CHECK(_protect_sim_range(addr, size, flags));
+    }
+    else
+    {
+        OE_CHECK(_add_enclave_pages(addr, size, src, flags, extend));
+    }
+#endif // OEHOSTMR
 
-            if ((uint32_t)prot > OE_INT_MAX)
-                OE_RAISE_MSG(
-                    OE_FAILURE, "Unexpected page protections: %#x", prot);
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sgx_load_enclave_zero_pages(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t size,
+    uint64_t flags,
+    bool extend)
+{
+    static const oe_page_t zero_page;
+    oe_result_t result = OE_UNEXPECTED;
+#if !defined(OEHOSTMR)
+    void* chunk = NULL;
+#endif // OEHOSTMR
+
+    OE_CHECK(_measure_load(
+        context, base, addr, (uint64_t)&zero_page, size, true, flags, extend));
+
+    if (context->type == OE_SGX_LOAD_TYPE_MEASURE)
+    {
+        /* EADD has no further action in measurement mode */
+        result = OE_OK;
+        goto done;
+    }
+#if !defined(OEHOSTMR)
+    else if (oe_sgx_is_simulation_load_context(context))
+    {
+        OE_CHECK(_check_sim_range(context, addr, size));
 
 #if defined(__linux__)
-            if (mprotect((void*)addr, OE_PAGE_SIZE, prot) != 0)
+        /* Map fresh zero pages over the range, which sets their permissions
+         * too and does not touch them until the enclave uses them */
+        {
+            int prot = _make_memory_protect_param(flags, true /*simulate*/);
+            int mflags = MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED;
+
+            if (mmap((void*)addr, size, prot, mflags, -1, 0) == MAP_FAILED)
                 OE_RAISE_MSG(
                     OE_FAILURE,
-                    "mprotect failed (addr=%#x, prot=%#x)",
+                    "mmap failed (addr=%#x, size=%#x, prot=%#x)",
                     addr,
+                    size,
                     prot);
+        }
 #elif defined(_WIN32)
-            DWORD old;
-            if (!VirtualProtect((LPVOID)addr, OE_PAGE_SIZE, prot, &old))
-                OE_RAISE_MSG(
-                    OE_FAILURE,
-                    "VirtualProtect failed (addr=%#x, prot=%#x)",
-                    addr,
-                    prot);
+        memset((void*)addr, 0, size);
+        OE_CHECK(_protect_sim_range(addr, size, flags));
 #endif
-        }
     }
     else
     {
-        int protect = _make_memory_protect_param(flags, false /*not simulate*/);
-        if (!extend)
-            protect |= ENCLAVE_PAGE_UNVALIDATED;
+        uint64_t chunk_size =
+            size < OE_SGX_LOAD_CHUNK_SIZE ? size : OE_SGX_LOAD_CHUNK_SIZE;
 
-        uint32_t enclave_error;
-        if (oe_sgx_enclave_load_data(
-                (void*)addr,
-                OE_PAGE_SIZE,
-                (const void*)src,
-                (uint32_t)protect,
-                &enclave_error) != OE_PAGE_SIZE)
-            OE_RAISE_MSG(
-                OE_PLATFORM_ERROR,
-                "enclave_load_data failed (addr=%#x, prot=%#x, err=%#x)",
-                addr,
-                protect,
-                enclave_error);
+        if (!(chunk = oe_memalign(OE_PAGE_SIZE, chunk_size)))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        memset(chunk, 0, chunk_size);
+
+        for (uint64_t offset = 0; offset < size; offset += chunk_size)
+        {
+            uint64_t n = size - offset;
+
+            if (n > chunk_size)
+                n = chunk_size;
+
+            OE_CHECK(_add_enclave_pages(
+                addr + offset, n, (uint64_t)chunk, flags, extend));
+        }
     }
 #endif // OEHOSTMR
 
     result = OE_OK;
 
 done:
+#if !defined(OEHOSTMR)
+    if (chunk)
+        oe_memalign_free(chunk);
+#endif // OEHOSTMR
+
     return result;
 }
 
@@ -637,8 +828,11 @@ oe_result_t oe_sgx_initialize_enclave(
         OE_RAISE(OE_INVALID_PARAMETER);
 
     /* Measure this operation */
-    OE_CHECK(
-        oe_sgx_measure_initialize_enclave(&context->hash_context, mrenclave));
+    if (context->use_cached_mrenclave)
+        *mrenclave = context->cached_mrenclave;
+    else
+        OE_CHECK(oe_sgx_measure_initialize_enclave(
+            &context->hash_context, mrenclave));
 #if !defined(OEHOSTMR)
     /* EINIT has no further action in measurement/simulation mode */
     if (context->type == OE_SGX_LOAD_TYPE_CREATE &&
@@ -10,6 +10,9 @@
 
 OE_EXTERNC_BEGIN
 
+/* Largest source buffer that loaders allocate for a range of pages. */
+#define OE_SGX_LOAD_CHUNK_SIZE (4 * 1024 * 1024)
+
 OE_INLINE bool oe_sgx_is_simulation_load_context(
     const oe_sgx_load_context_t* context)
 {
@@ -41,6 +44,25 @@ oe_result_t oe_sgx_load_enclave_data(
     uint64_t flags,
     bool extend);
 
+/* Add size bytes of pages at addr from the same number of bytes at src. */
+oe_result_t oe_sgx_load_enclave_data_range(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    uint64_t size,
+    uint64_t flags,
+    bool extend);
+
+/* Add size bytes of zero pages at addr. */
+oe_result_t oe_sgx_load_enclave_zero_pages(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t size,
+    uint64_t flags,
+    bool extend);
+
 oe_result_t oe_sgx_initialize_enclave(
     oe_sgx_load_context_t* context,
     uint64_t addr,
@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "../../common/sgx/collateralcache.h"
 #include "../hostthread.h"
 #include "sgxquoteprovider.h"
 
@@ -50,7 +51,7 @@ done:
     return result;
 }
 
-oe_result_t oe_get_sgx_quote_verification_collateral(
+static oe_result_t _fetch_sgx_quote_verification_collateral(
     oe_get_sgx_quote_verification_collateral_args_t* args)
 {
     oe_result_t result = OE_FAILURE;
@@ -284,6 +285,13 @@ done:
     return result;
 }
 
+oe_result_t oe_get_sgx_quote_verification_collateral(
+    oe_get_sgx_quote_verification_collateral_args_t* args)
+{
+    return oe_get_cached_sgx_quote_verification_collateral(
+        args, _fetch_sgx_quote_verification_collateral);
+}
+
 void oe_free_sgx_quote_verification_collateral_args(
     oe_get_sgx_quote_verification_collateral_args_t* args)
 {
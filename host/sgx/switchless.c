@@ -8,21 +8,56 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/switchless.h>
 #include <openenclave/internal/utils.h>
+#include <string.h>
 #include "../calls.h"
 #include "../hostthread.h"
 #include "enclave.h"
 #include "platform_u.h"
 
 /**
- * Number of iterations an ocall worker thread would spin before going to sleep
+ * Number of iterations an ocall worker thread initially spins before going to
+ * sleep. Adapted at runtime by oe_switchless_update_spin_policy().
  */
 #define OE_HOST_WORKER_SPIN_COUNT_THRESHOLD (4096U)
 
 /**
- * Number of iterations an ecall worker thread would spin before going to sleep
+ * Number of iterations an ecall worker thread initially spins before going to
+ * sleep. Adapted at runtime by oe_switchless_update_spin_policy().
  */
 #define OE_ENCLAVE_WORKER_SPIN_COUNT_THRESHOLD (4096U)
 
+/**
+ * Number of iterations timed to measure the cost of one spin iteration.
+ */
+#define OE_SPIN_CALIBRATION_COUNT (1024U)
+
+/**
+ * TSC cycles of one iteration of the spin loops of the workers, which is
+ * dominated by the pause instruction. Used to express how long a worker slept
+ * in spin iterations.
+ */
+static uint64_t _cycles_per_spin = 1;
+static oe_once_type _calibrate_once = OE_H_ONCE_INITIALIZER;
+
+static void _calibrate_spin(void)
+{
+    uint64_t start = oe_call_stats_timestamp();
+    uint64_t cycles;
+
+    for (size_t i = 0; i < OE_SPIN_CALIBRATION_COUNT; i++)
+        oe_yield_cpu();
+
+    cycles = (oe_call_stats_timestamp() - start) / OE_SPIN_CALIBRATION_COUNT;
+    _cycles_per_spin = cycles ? cycles : 1;
+}
+
+/* Number of spin iterations that would have taken as long as the time since
+ * the given timestamp */
+static uint64_t _spins_since(uint64_t start)
+{
+    return (oe_call_stats_timestamp() - start) / _cycles_per_spin;
+}
+
 /**
  * Declare the prototypes of the following functions to avoid missing-prototypes
  * warning.
@@ -31,7 +66,8 @@ OE_UNUSED_FUNC oe_result_t _oe_sgx_init_context_switchless_ecall(
     oe_enclave_t* enclave,
     oe_result_t* _retval,
     oe_host_worker_context_t* host_worker_contexts,
-    uint64_t num_host_workers);
+    uint64_t num_host_workers,
+    oe_switchless_call_queue_t* call_queue);
 OE_UNUSED_FUNC oe_result_t _oe_sgx_switchless_enclave_worker_thread_ecall(
     oe_enclave_t* enclave,
     oe_enclave_worker_context_t* context);
@@ -48,11 +84,13 @@ oe_result_t _oe_sgx_init_context_switchless_ecall(
     oe_enclave_t* enclave,
     oe_result_t* _retval,
     oe_host_worker_context_t* host_worker_contexts,
-    uint64_t num_host_workers)
+    uint64_t num_host_workers,
+    oe_switchless_call_queue_t* call_queue)
 {
     OE_UNUSED(enclave);
     OE_UNUSED(host_worker_contexts);
     OE_UNUSED(num_host_workers);
+    OE_UNUSED(call_queue);
 
     if (_retval)
         *_retval = OE_UNSUPPORTED;
@@ -75,6 +113,91 @@ OE_WEAK_ALIAS(
     _oe_sgx_switchless_enclave_worker_thread_ecall,
     oe_sgx_switchless_enclave_worker_thread_ecall);
 
+/*
+** Remove the oldest call from the switchless ocall queue. Returns NULL if the
+** queue is empty.
+*/
+static oe_call_host_function_args_t* _dequeue_switchless_ocall(
+    oe_switchless_call_queue_t* queue)
+{
+    const uint64_t mask = queue->capacity - 1;
+    uint64_t pos = oe_atomic_load(&queue->dequeue_pos);
+    oe_switchless_call_queue_cell_t* cell = NULL;
+
+    while (true)
+    {
+        cell = &queue->cells[pos & mask];
+        uint64_t seq = oe_atomic_load(&cell->sequence);
+        int64_t diff = (int64_t)(seq - (pos + 1));
+
+        if (diff == 0)
+        {
+            // The cell has been filled. Try to claim the position.
+            if (oe_atomic_compare_and_swap(
+                    (volatile int64_t*)&queue->dequeue_pos,
+                    (int64_t)pos,
+                    (int64_t)(pos + 1)))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // The queue is empty.
+            return NULL;
+        }
+
+        pos = oe_atomic_load(&queue->dequeue_pos);
+    }
+
+    oe_call_host_function_args_t* args = cell->call_arg;
+
+    // Hand the cell back to the producers for the next lap of the ring.
+    OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+    cell->sequence = pos + mask + 1;
+
+    return args;
+}
+
+/*
+** Handle a switchless ocall picked up by a worker thread.
+*/
+static void _handle_switchless_ocall(
+    oe_call_host_function_args_t* args,
+    oe_enclave_t* enclave)
+{
+    // Read the function id first: the enclave may reuse the arguments as
+    // soon as the call completes.
+    oe_record_switchless_ocall(enclave, args->function_id, true);
+    oe_handle_call_host_function((uint64_t)args, enclave);
+}
+
+/*
+** Handle up to OE_SWITCHLESS_CALL_QUEUE_BATCH_SIZE queued switchless ocalls.
+** Returns the number of calls handled.
+*/
+static size_t _drain_switchless_ocall_queue(oe_host_worker_context_t* context)
+{
+    oe_switchless_call_queue_t* queue =
+        context->enc->switchless_manager
+            ? context->enc->switchless_manager->host_call_queue
+            : NULL;
+    size_t count = 0;
+
+    if (!queue)
+        return 0;
+
+    while (count < OE_SWITCHLESS_CALL_QUEUE_BATCH_SIZE)
+    {
+        oe_call_host_function_args_t* args = _dequeue_switchless_ocall(queue);
+        if (!args)
+            break;
+
+        _handle_switchless_ocall(args, context->enc);
+        count++;
+    }
+
+    return count;
+}
+
 /*
 ** The thread function that handles switchless ocalls
 **
@@ -82,22 +205,45 @@ OE_WEAK_ALIAS(
 static void* _switchless_ocall_worker(void* arg)
 {
     oe_host_worker_context_t* context = (oe_host_worker_context_t*)arg;
+    bool slept = false;
+    uint64_t sleep_spin_count = 0;
 
     while (!context->is_stopping)
     {
         volatile oe_call_host_function_args_t* local_call_arg = NULL;
+        size_t handled = 0;
         if ((local_call_arg = context->call_arg) != NULL)
         {
             // Handle the switchless call, but do not clear the slot yet. Since
             // the slot is not empty, any new incoming switchless call request
             // will be scheduled in another available work thread and get
             // handled immediately.
-            oe_handle_call_host_function(
-                (uint64_t)local_call_arg, context->enc);
+            _handle_switchless_ocall(
+                (oe_call_host_function_args_t*)local_call_arg, context->enc);
 
             // After handling the switchless call, mark this worker thread
             // as free by clearing the slot.
             context->call_arg = NULL;
+            handled = 1;
+        }
+        else
+        {
+            handled = _drain_switchless_ocall_queue(context);
+        }
+
+        if (handled)
+        {
+            // Adapt the spin budget to the time it took for this message to
+            // arrive.
+            oe_switchless_update_spin_policy(
+                context->spin_count,
+                slept,
+                sleep_spin_count,
+                context->min_spin_count_threshold,
+                context->max_spin_count_threshold,
+                &context->average_spin_count,
+                &context->spin_count_threshold);
+            slept = false;
 
             // Reset spin count for next message.
             context->total_spin_count += context->spin_count;
@@ -107,25 +253,79 @@ static void* _switchless_ocall_worker(void* arg)
         {
             // If there is no message, increment spin count until threshold is
             // reached.
-            if (++context->spin_count >= OE_HOST_WORKER_SPIN_COUNT_THRESHOLD)
+            if (++context->spin_count >= context->spin_count_threshold)
             {
                 // Reset spin count and go to sleep until event is fired.
                 context->total_spin_count += context->spin_count;
                 context->spin_count = 0;
+
+                uint64_t sleep_start = oe_call_stats_timestamp();
                 oe_host_worker_wait(context);
+                sleep_spin_count = _spins_since(sleep_start);
+                context->total_wake_count++;
+                slept = true;
             }
 
             /* Yield CPU */
             oe_yield_cpu();
         }
     }
+
+    // Handle the calls that were posted before the stop, so that the enclave
+    // threads waiting for them can return.
+    if (context->call_arg)
+    {
+        _handle_switchless_ocall(
+            (oe_call_host_function_args_t*)context->call_arg, context->enc);
+        context->call_arg = NULL;
+    }
+
+    while (_drain_switchless_ocall_queue(context))
+        ;
+
     return NULL;
 }
 
+/*
+** Fail the switchless ocalls that were posted after the host workers exited,
+** so that the enclave threads waiting for them do not spin forever. The
+** slots of the workers are left taken so that no call is posted to them.
+*/
+static void _fail_pending_switchless_ocalls(
+    oe_switchless_call_manager_t* manager)
+{
+    oe_call_host_function_args_t* args = NULL;
+
+    for (size_t i = 0; i < manager->num_host_workers; i++)
+    {
+        args = (oe_call_host_function_args_t*)manager->host_worker_contexts[i]
+                   .call_arg;
+        if (args)
+        {
+            OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+            args->result = OE_ENCLAVE_ABORTING;
+        }
+    }
+
+    if (!manager->host_call_queue)
+        return;
+
+    while ((args = _dequeue_switchless_ocall(manager->host_call_queue)))
+    {
+        OE_ATOMIC_MEMORY_BARRIER_RELEASE();
+        args->result = OE_ENCLAVE_ABORTING;
+    }
+}
+
 void oe_sgx_sleep_switchless_worker_ocall(oe_enclave_worker_context_t* context)
 {
+    uint64_t start = oe_call_stats_timestamp();
+
     // Wait for messages.
     oe_enclave_worker_wait(context);
+
+    // Let the worker adapt its spin budget to the length of the sleep.
+    context->last_sleep_spin_count = _spins_since(start);
 }
 
 /*
@@ -149,20 +349,34 @@ static void* _switchless_ecall_worker(void* arg)
 static oe_result_t oe_stop_worker_threads(oe_switchless_call_manager_t* manager)
 {
     oe_result_t result = OE_UNEXPECTED;
-    for (size_t i = 0; i < manager->num_host_workers; i++)
+
+    // Stop the enclave workers first, as the ecalls that they handle may make
+    // switchless ocalls.
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
     {
-        manager->host_worker_contexts[i].is_stopping = true;
-        oe_host_worker_wake(&manager->host_worker_contexts[i]);
+        manager->enclave_worker_contexts[i].is_stopping = true;
+        oe_enclave_worker_wake(&manager->enclave_worker_contexts[i]);
 
         OE_TRACE_INFO(
-            "Switchless host worker thread %d spun for %lu times",
+            "Switchless enclave worker thread %d spun for %lu times, "
+            "woke up %lu times",
             (int)i,
-            manager->host_worker_contexts[i].total_spin_count);
+            manager->enclave_worker_contexts[i].total_spin_count,
+            manager->enclave_worker_contexts[i].total_wake_count);
     }
+
     for (size_t i = 0; i < manager->num_enclave_workers; i++)
     {
-        manager->enclave_worker_contexts[i].is_stopping = true;
-        oe_enclave_worker_wake(&manager->enclave_worker_contexts[i]);
+        if (manager->enclave_worker_threads[i] != (oe_thread_t)NULL)
+            if (oe_thread_join(manager->enclave_worker_threads[i]))
+                OE_RAISE(OE_THREAD_JOIN_ERROR);
+    }
+
+    // The host workers handle the calls still queued before they exit.
+    for (size_t i = 0; i < manager->num_host_workers; i++)
+    {
+        manager->host_worker_contexts[i].is_stopping = true;
+        oe_host_worker_wake(&manager->host_worker_contexts[i]);
     }
 
     for (size_t i = 0; i < manager->num_host_workers; i++)
@@ -170,13 +384,25 @@ static oe_result_t oe_stop_worker_threads(oe_switchless_call_manager_t* manager)
         if (manager->host_worker_threads[i] != (oe_thread_t)NULL)
             if (oe_thread_join(manager->host_worker_threads[i]))
                 OE_RAISE(OE_THREAD_JOIN_ERROR);
+
+        OE_TRACE_INFO(
+            "Switchless host worker thread %d spun for %lu times, "
+            "woke up %lu times",
+            (int)i,
+            manager->host_worker_contexts[i].total_spin_count,
+            manager->host_worker_contexts[i].total_wake_count);
     }
 
-    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+    _fail_pending_switchless_ocalls(manager);
+
+    if (manager->host_call_queue)
     {
-        if (manager->enclave_worker_threads[i] != (oe_thread_t)NULL)
-            if (oe_thread_join(manager->enclave_worker_threads[i]))
-                OE_RAISE(OE_THREAD_JOIN_ERROR);
+        OE_TRACE_INFO(
+            "Switchless ocall queue: %lu calls queued, %lu calls missed, "
+            "max depth %lu",
+            manager->host_call_queue->total_queued_count,
+            manager->host_call_queue->total_missed_count,
+            manager->host_call_queue->max_depth);
     }
 
     result = OE_OK;
@@ -184,10 +410,35 @@ done:
     return result;
 }
 
+/*
+** Set the bounds and initial spin budget of a worker.
+*/
+static void _init_spin_policy(
+    uint64_t initial_threshold,
+    uint64_t min_threshold,
+    uint64_t max_threshold,
+    uint64_t* min_spin_count_threshold,
+    uint64_t* max_spin_count_threshold,
+    uint64_t* average_spin_count,
+    uint64_t* spin_count_threshold)
+{
+    if (initial_threshold < min_threshold)
+        initial_threshold = min_threshold;
+    if (initial_threshold > max_threshold)
+        initial_threshold = max_threshold;
+
+    *min_spin_count_threshold = min_threshold;
+    *max_spin_count_threshold = max_threshold;
+    *average_spin_count = initial_threshold / 4;
+    *spin_count_threshold = initial_threshold;
+}
+
 oe_result_t oe_start_switchless_manager(
     oe_enclave_t* enclave,
     size_t num_host_workers,
-    size_t num_enclave_workers)
+    size_t num_enclave_workers,
+    size_t min_spin_count_threshold,
+    size_t max_spin_count_threshold)
 {
     oe_result_t result = OE_UNEXPECTED;
     oe_result_t result_out = 0;
@@ -196,16 +447,30 @@ oe_result_t oe_start_switchless_manager(
     oe_thread_t* host_threads = NULL;
     oe_enclave_worker_context_t* enclave_contexts = NULL;
     oe_thread_t* enclave_threads = NULL;
+    oe_switchless_call_queue_t* call_queue = NULL;
 
     if (enclave == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    oe_once(&_calibrate_once, _calibrate_spin);
+
     if (enclave->switchless_manager != NULL)
         OE_RAISE(OE_UNEXPECTED);
 
     if (num_host_workers == 0 && num_enclave_workers == 0)
         OE_RAISE(OE_UNEXPECTED);
 
+    if (min_spin_count_threshold == 0)
+        min_spin_count_threshold =
+            OE_SWITCHLESS_DEFAULT_MIN_SPIN_COUNT_THRESHOLD;
+
+    if (max_spin_count_threshold == 0)
+        max_spin_count_threshold =
+            OE_SWITCHLESS_DEFAULT_MAX_SPIN_COUNT_THRESHOLD;
+
+    if (min_spin_count_threshold > max_spin_count_threshold)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
     // Limit the number of workers to the number of thread bindings
     // because the maximum parallelism is dictated by the latter for
     // synchronous ocalls. We may need to revisit this for asynchronous
@@ -238,18 +503,48 @@ oe_result_t oe_start_switchless_manager(
     if (enclave_threads == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
+    if (num_host_workers > 0)
+    {
+        call_queue = calloc(1, sizeof(oe_switchless_call_queue_t));
+        if (call_queue == NULL)
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        call_queue->capacity = OE_SWITCHLESS_CALL_QUEUE_CAPACITY;
+        call_queue->cells = calloc(
+            OE_SWITCHLESS_CALL_QUEUE_CAPACITY,
+            sizeof(oe_switchless_call_queue_cell_t));
+        if (call_queue->cells == NULL)
+        {
+            free(call_queue);
+            OE_RAISE(OE_OUT_OF_MEMORY);
+        }
+
+        // Cell i is initially ready for the producer at position i.
+        for (uint64_t i = 0; i < call_queue->capacity; i++)
+            call_queue->cells[i].sequence = i;
+    }
+
     manager->num_host_workers = num_host_workers;
     manager->host_worker_contexts = host_contexts;
     manager->host_worker_threads = host_threads;
     manager->num_enclave_workers = num_enclave_workers;
     manager->enclave_worker_contexts = enclave_contexts;
     manager->enclave_worker_threads = enclave_threads;
+    manager->host_call_queue = call_queue;
 
     // Start the host worker threads, and assign each one a private context.
     for (size_t i = 0; i < num_host_workers; i++)
     {
         OE_TRACE_INFO("Creating switchless host worker thread %d\n", (int)i);
         manager->host_worker_contexts[i].enc = enclave;
+        _init_spin_policy(
+            OE_HOST_WORKER_SPIN_COUNT_THRESHOLD,
+            min_spin_count_threshold,
+            max_spin_count_threshold,
+            &manager->host_worker_contexts[i].min_spin_count_threshold,
+            &manager->host_worker_contexts[i].max_spin_count_threshold,
+            &manager->host_worker_contexts[i].average_spin_count,
+            &manager->host_worker_contexts[i].spin_count_threshold);
         if (oe_thread_create(
                 &manager->host_worker_threads[i],
                 _switchless_ocall_worker,
@@ -266,7 +561,8 @@ oe_result_t oe_start_switchless_manager(
             enclave,
             &result_out,
             manager->host_worker_contexts,
-            manager->num_host_workers));
+            manager->num_host_workers,
+            manager->host_call_queue));
         OE_CHECK(result_out);
     }
 
@@ -277,8 +573,14 @@ oe_result_t oe_start_switchless_manager(
     {
         OE_TRACE_INFO("Creating switchless enclave worker thread %d\n", (int)i);
         manager->enclave_worker_contexts[i].enc = enclave;
-        manager->enclave_worker_contexts[i].spin_count_threshold =
-            OE_ENCLAVE_WORKER_SPIN_COUNT_THRESHOLD;
+        _init_spin_policy(
+            OE_ENCLAVE_WORKER_SPIN_COUNT_THRESHOLD,
+            min_spin_count_threshold,
+            max_spin_count_threshold,
+            &manager->enclave_worker_contexts[i].min_spin_count_threshold,
+            &manager->enclave_worker_contexts[i].max_spin_count_threshold,
+            &manager->enclave_worker_contexts[i].average_spin_count,
+            &manager->enclave_worker_contexts[i].spin_count_threshold);
         if (oe_thread_create(
                 &manager->enclave_worker_threads[i],
                 _switchless_ecall_worker,
@@ -338,6 +640,11 @@ oe_result_t oe_stop_switchless_manager(oe_enclave_t* enclave)
             free(manager->enclave_worker_contexts);
         if (manager->enclave_worker_threads != NULL)
             free(manager->enclave_worker_threads);
+        if (manager->host_call_queue != NULL)
+        {
+            free(manager->host_call_queue->cells);
+            free(manager->host_call_queue);
+        }
         free(manager);
     }
     result = OE_OK;
@@ -345,6 +652,55 @@ done:
     return result;
 }
 
+oe_result_t oe_get_switchless_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_statistics_t* statistics)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_switchless_call_manager_t* manager = NULL;
+
+    if (enclave == NULL || statistics == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((manager = enclave->switchless_manager) == NULL)
+        OE_RAISE(OE_NOT_FOUND);
+
+    memset(statistics, 0, sizeof(*statistics));
+
+    // The counters are updated by the workers without synchronization, so
+    // the values are only approximate while calls are in flight.
+    for (size_t i = 0; i < manager->num_host_workers; i++)
+    {
+        oe_host_worker_context_t* context = &manager->host_worker_contexts[i];
+        statistics->host_worker_spin_count +=
+            context->total_spin_count + context->spin_count;
+        statistics->host_worker_wake_count += context->total_wake_count;
+    }
+
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+    {
+        oe_enclave_worker_context_t* context =
+            &manager->enclave_worker_contexts[i];
+        statistics->enclave_worker_spin_count +=
+            context->total_spin_count + context->spin_count;
+        statistics->enclave_worker_wake_count += context->total_wake_count;
+    }
+
+    if (manager->host_call_queue)
+    {
+        statistics->queued_ocall_count =
+            manager->host_call_queue->total_queued_count;
+        statistics->missed_ocall_count =
+            manager->host_call_queue->total_missed_count;
+        statistics->max_ocall_queue_depth = manager->host_call_queue->max_depth;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 void oe_sgx_wake_switchless_worker_ocall(oe_host_worker_context_t* context)
 {
     oe_host_worker_wake(context);
@@ -374,6 +730,7 @@ static oe_result_t _switchless_call_enclave_function_impl(
     oe_switchless_call_manager_t* manager = enclave->switchless_manager;
     oe_enclave_worker_context_t* contexts = manager->enclave_worker_contexts;
     size_t tries = 0;
+    uint64_t start = oe_call_stats_timestamp();
 
     /* Reject invalid parameters */
     if (!enclave)
@@ -453,9 +810,16 @@ static oe_result_t _switchless_call_enclave_function_impl(
         }
     }
 
-    if (!switchless_call_posted)
+    oe_record_switchless_ecall(enclave, function_id, switchless_call_posted);
+
+    if (switchless_call_posted)
+    {
+        oe_record_ecall(
+            enclave, function_id, oe_call_stats_timestamp() - start);
+    }
+    else
     {
-        // Dispatch as normal ecall.
+        // Dispatch as normal ecall, which records the call.
         OE_CHECK(oe_ecall(
             enclave, OE_ECALL_CALL_ENCLAVE_FUNCTION, (uint64_t)&args, NULL));
     }
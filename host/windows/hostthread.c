@@ -119,6 +119,56 @@ int oe_mutex_destroy(oe_mutex* Lock)
     return !CloseHandle(*Lock);
 }
 
+/*
+**==============================================================================
+**
+** oe_cond
+**
+** Waiters count themselves under the mutex and sleep on a semaphore, which a
+** broadcast releases once per counted waiter.
+**
+**==============================================================================
+*/
+
+int oe_cond_init(oe_cond* cond)
+{
+    cond->waiters = 0;
+    cond->semaphore = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+    return cond->semaphore == NULL;
+}
+
+int oe_cond_wait(oe_cond* cond, oe_mutex* mutex)
+{
+    DWORD r;
+
+    cond->waiters++;
+
+    /* Release the mutex and start waiting atomically */
+    r = SignalObjectAndWait(*mutex, cond->semaphore, INFINITE, FALSE);
+
+    if (oe_mutex_lock(mutex))
+        return 1;
+
+    return r != WAIT_OBJECT_0;
+}
+
+int oe_cond_broadcast(oe_cond* cond)
+{
+    LONG waiters = cond->waiters;
+
+    cond->waiters = 0;
+
+    if (waiters && !ReleaseSemaphore(cond->semaphore, waiters, NULL))
+        return 1;
+
+    return 0;
+}
+
+int oe_cond_destroy(oe_cond* cond)
+{
+    return !CloseHandle(cond->semaphore);
+}
+
 /*
 **==============================================================================
 **
@@ -1385,6 +1385,24 @@ ssize_t oe_syscall_pwrite_ocall(
     PANIC;
 }
 
+ssize_t oe_syscall_splice_ocall(
+    oe_host_fd_t in_fd,
+    oe_off_t in_offset,
+    oe_host_fd_t out_fd,
+    oe_off_t out_offset,
+    size_t count)
+{
+    OE_UNUSED(in_fd);
+    OE_UNUSED(in_offset);
+    OE_UNUSED(out_fd);
+    OE_UNUSED(out_offset);
+    OE_UNUSED(count);
+
+    /* Not implemented yet. The enclave copies the data itself instead. */
+    _set_errno(OE_ENOSYS);
+    return -1;
+}
+
 int oe_syscall_close_ocall(oe_host_fd_t fd)
 {
     int ret = -1;
@@ -1644,6 +1662,48 @@ done:
     return ret;
 }
 
+ssize_t oe_syscall_readdir_batch_ocall(
+    uint64_t dirp,
+    struct oe_dirent* entries,
+    size_t count)
+{
+    ssize_t ret = -1;
+    size_t n = 0;
+
+    _set_errno(0);
+
+    if (!entries && count)
+    {
+        _set_errno(OE_EINVAL);
+        goto done;
+    }
+
+    for (; n < count; n++)
+    {
+        int r = oe_syscall_readdir_ocall(dirp, &entries[n]);
+
+        if (r == 1)
+            break;
+
+        if (r != 0)
+        {
+            /* Return the entries read before the error, if any. */
+            if (n)
+            {
+                _set_errno(0);
+                break;
+            }
+
+            goto done;
+        }
+    }
+
+    ret = (ssize_t)n;
+
+done:
+    return ret;
+}
+
 void oe_syscall_rewinddir_ocall(uint64_t dirp)
 {
     DWORD err = 0;
@@ -2343,6 +2403,15 @@ ssize_t oe_syscall_recv_ocall(
     return ret;
 }
 
+ssize_t oe_syscall_recv_host_buffer_ocall(
+    oe_host_fd_t sockfd,
+    void* host_buf,
+    size_t len,
+    int flags)
+{
+    return oe_syscall_recv_ocall(sockfd, host_buf, len, flags);
+}
+
 ssize_t oe_syscall_recvfrom_ocall(
     oe_host_fd_t sockfd,
     void* buf,
@@ -2940,6 +3009,88 @@ int oe_syscall_poll_ocall(
     PANIC;
 }
 
+oe_host_fd_t oe_syscall_poll_create_ocall(void)
+{
+    /* Not implemented yet. poll() falls back to oe_syscall_poll_ocall(). */
+    _set_errno(OE_ENOSYS);
+    return -1;
+}
+
+int oe_syscall_poll_wait_ocall(
+    oe_host_fd_t epfd,
+    bool reset,
+    struct oe_host_poll_change* changes,
+    size_t nchanges,
+    struct oe_host_pollfd* events,
+    size_t maxevents,
+    int timeout)
+{
+    OE_UNUSED(epfd);
+    OE_UNUSED(reset);
+    OE_UNUSED(changes);
+    OE_UNUSED(nchanges);
+    OE_UNUSED(events);
+    OE_UNUSED(maxevents);
+    OE_UNUSED(timeout);
+
+    _set_errno(OE_ENOSYS);
+    return -1;
+}
+
+int oe_syscall_poll_close_ocall(oe_host_fd_t epfd)
+{
+    OE_UNUSED(epfd);
+
+    _set_errno(OE_ENOSYS);
+    return -1;
+}
+
+/*
+**==============================================================================
+**
+** I/O rings:
+**
+**==============================================================================
+*/
+
+uint64_t oe_syscall_io_ring_setup_ocall(
+    uint32_t num_entries,
+    uint32_t buffer_size,
+    uint32_t num_workers,
+    uint64_t* ring)
+{
+    OE_UNUSED(num_entries);
+    OE_UNUSED(buffer_size);
+    OE_UNUSED(num_workers);
+    OE_UNUSED(ring);
+
+    /* Not implemented yet. Fail the setup so that no other call is made. */
+    _set_errno(OE_ENOSYS);
+    return 0;
+}
+
+int oe_syscall_io_ring_wake_ocall(uint64_t handle)
+{
+    OE_UNUSED(handle);
+
+    PANIC;
+}
+
+int oe_syscall_io_ring_wait_ocall(uint64_t handle, uint64_t position)
+{
+    OE_UNUSED(handle);
+    OE_UNUSED(position);
+
+    PANIC;
+}
+
+int oe_syscall_io_ring_teardown_ocall(uint64_t handle)
+{
+    OE_UNUSED(handle);
+
+    PANIC;
+}
+
 /*
 **==============================================================================
 **
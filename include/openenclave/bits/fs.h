@@ -25,6 +25,27 @@ OE_EXTERNC_BEGIN
  */
 #define OE_HOST_FILE_SYSTEM "oe_host_file_system"
 
+/**
+ * Flag of **mount()** that caches the data of host files in the enclave.
+ *
+ * Reads are served from, and writes are buffered in, a page cache that is
+ * written back to the host on **fsync()**, on **close()** and when pages are
+ * evicted. The **data** parameter of **mount()** may point to an
+ * **oe_hostfs_cache_options_t** structure. The cache assumes that the files
+ * are not modified on the host while the enclave has them open. Files opened
+ * with O_APPEND are not cached.
+ */
+#define OE_MS_HOSTFS_CACHE 0x40000000
+
+/**
+ * Options of a host file system mounted with **OE_MS_HOSTFS_CACHE**.
+ */
+typedef struct _oe_hostfs_cache_options
+{
+    /** Maximum number of bytes of file data cached, or 0 for 1 MB. */
+    size_t max_bytes;
+} oe_hostfs_cache_options_t;
+
 OE_EXTERNC_END
 
 #endif /* _OE_BITS_FS_H */
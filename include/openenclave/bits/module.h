@@ -63,6 +63,48 @@ oe_result_t oe_load_module_host_socket_interface(void);
  */
 oe_result_t oe_load_module_host_resolver(void);
 
+/**
+ * Maximum number of lookups that the host resolver cache can hold.
+ */
+#define OE_HOST_RESOLVER_CACHE_MAX_ENTRIES 65536
+
+/**
+ * Options of the lookup cache of the host resolver module.
+ */
+typedef struct _oe_host_resolver_cache_options
+{
+    /** Maximum number of cached lookups, or 0 to disable the cache. */
+    size_t max_entries;
+
+    /** Number of seconds for which a successful lookup is reused. */
+    uint32_t ttl;
+
+    /** Number of seconds for which a lookup of a name or service that does
+     * not exist (EAI_NONAME, EAI_NODATA) is reused. */
+    uint32_t negative_ttl;
+} oe_host_resolver_cache_options_t;
+
+/**
+ * Configure the lookup cache of the host resolver module.
+ *
+ * By default, every getaddrinfo call is forwarded to the host. With the cache
+ * enabled, results are kept in the enclave and reused until their time to
+ * live expires, and concurrent lookups with the same node, service and hints
+ * share a single host lookup, even when the time to live is 0. The least
+ * recently used lookups are evicted when the cache is full. Expiry is measured
+ * with the host clock, which the host controls like the answers themselves.
+ *
+ * Configuring the cache again drops the cached results.
+ *
+ * @param options The cache options, or NULL to disable the cache.
+ *
+ * @retval OE_OK The cache was configured.
+ * @retval OE_INVALID_PARAMETER **max_entries** is greater than
+ * OE_HOST_RESOLVER_CACHE_MAX_ENTRIES.
+ */
+oe_result_t oe_configure_host_resolver_cache(
+    const oe_host_resolver_cache_options_t* options);
+
 /**
  * Load the event polling (epoll) module.
  *
@@ -74,6 +116,19 @@ oe_result_t oe_load_module_host_resolver(void);
  * @retval OE_FAILURE Module failed to load.
  */
 oe_result_t oe_load_module_host_epoll(void);
+
+/**
+ * Load the host I/O ring module.
+ *
+ * This function loads the host I/O ring module which is needed
+ * for an enclave application to be able to call oe_io_ring_setup,
+ * oe_io_ring_submit, and oe_io_ring_reap, which queue file and socket
+ * I/O for host worker threads.
+ *
+ * @retval OE_OK The module was successfully loaded.
+ * @retval OE_FAILURE Module failed to load.
+ */
+oe_result_t oe_load_module_host_io_ring(void);
 OE_EXTERNC_END
 
 #endif /* _OE_BITS_MODULE_H */
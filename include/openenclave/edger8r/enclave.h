@@ -155,6 +155,217 @@ void* oe_allocate_switchless_ocall_buffer(size_t size);
  */
 void oe_free_switchless_ocall_buffer(void* buffer);
 
+/**
+ * Handle of an asynchronous switchless ocall. See oe_post_async_ocall().
+ */
+typedef struct _oe_async_ocall oe_async_ocall_t;
+
+/**
+ * Allocate an asynchronous ocall with a marshalling buffer of the given size.
+ *
+ * The marshalling buffer is allocated in host memory and should be treated
+ * as untrusted. It can be retrieved with oe_get_async_ocall_buffer().
+ *
+ * @param buffer_size The size in bytes of the marshalling buffer.
+ * @returns the new call, or NULL if the allocation failed.
+ */
+oe_async_ocall_t* oe_allocate_async_ocall(size_t buffer_size);
+
+/**
+ * Get the marshalling buffer of an asynchronous ocall.
+ *
+ * @param call The call returned by oe_allocate_async_ocall().
+ * @returns the marshalling buffer.
+ */
+void* oe_get_async_ocall_buffer(oe_async_ocall_t* call);
+
+/**
+ * Post an asynchronous ocall to the host switchless workers.
+ *
+ * Unlike oe_switchless_call_host_function(), this function does not wait
+ * for the host function to complete. The input and output buffers must lie
+ * within the marshalling buffer of the call. The output buffer must start
+ * with the oe_result_t of the host function stub, as oeedger8r marshalling
+ * structures do.
+ *
+ * If the call cannot be handed to a switchless worker, it is performed as a
+ * regular ocall and is complete when this function returns.
+ *
+ * @param call The call returned by oe_allocate_async_ocall().
+ * @param function_id The id of the host function that will be called.
+ * @param input_buffer Buffer containing inputs data.
+ * @param input_buffer_size Size of the input data buffer.
+ * @param output_buffer Buffer where the outputs of the host function are
+ * written to.
+ * @param output_buffer_size Size of the output buffer.
+ *
+ * @return OE_OK the call was posted.
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ */
+oe_result_t oe_post_async_ocall(
+    oe_async_ocall_t* call,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size);
+
+/**
+ * Check whether a posted asynchronous ocall has completed.
+ *
+ * @param call The posted call.
+ *
+ * @return OE_BUSY the host has not completed the call yet.
+ * @return the result of the call otherwise.
+ */
+oe_result_t oe_poll_async_ocall(oe_async_ocall_t* call);
+
+/**
+ * Wait for a posted asynchronous ocall to complete and release it.
+ *
+ * @param call The posted call. The handle is invalid after this function
+ * returns.
+ *
+ * @return the result of the call.
+ */
+oe_result_t oe_wait_async_ocall(oe_async_ocall_t* call);
+
+/**
+ * Release an asynchronous ocall without waiting for it.
+ *
+ * If the call is still in flight, it is reclaimed once the host completes it.
+ *
+ * @param call The call. The handle is invalid after this function returns.
+ */
+void oe_release_async_ocall(oe_async_ocall_t* call);
+
+/**
+ * Handle of a batch of ocalls. See oe_ocall_batch_begin().
+ */
+typedef struct _oe_ocall_batch oe_ocall_batch_t;
+
+/**
+ * Function called for each successful call of a batch when it is submitted.
+ *
+ * @param output_buffer The output buffer of the call, in host memory.
+ * @param arg The completion_arg passed to oe_ocall_batch_add().
+ */
+typedef void (*oe_ocall_batch_completion_t)(
+    const void* output_buffer,
+    void* arg);
+
+/**
+ * Begin a batch of ocalls.
+ *
+ * Calls added to the batch are performed by the host in the order they were
+ * added, all within a single enclave transition, when the batch is submitted.
+ *
+ * @param batch Receives the new batch.
+ *
+ * @return OE_OK the batch was created.
+ * @return OE_INVALID_PARAMETER batch is NULL.
+ * @return OE_OUT_OF_MEMORY the batch could not be allocated.
+ */
+oe_result_t oe_ocall_batch_begin(oe_ocall_batch_t** batch);
+
+/**
+ * Allocate the marshalling buffer of the next call of a batch.
+ *
+ * The buffer is allocated in host memory and should be treated as untrusted.
+ * If the batch is full, the calls already added are submitted first.
+ *
+ * @param batch The batch returned by oe_ocall_batch_begin().
+ * @param size The size in bytes of the marshalling buffer.
+ * @returns the buffer, or NULL if the allocation failed.
+ */
+void* oe_ocall_batch_allocate_buffer(oe_ocall_batch_t* batch, size_t size);
+
+/**
+ * Add a call to a batch.
+ *
+ * The input and output buffers must lie within the buffer returned by the
+ * last call to oe_ocall_batch_allocate_buffer(). The output buffer must start
+ * with the oe_result_t of the host function stub, as oeedger8r marshalling
+ * structures do.
+ *
+ * @param batch The batch returned by oe_ocall_batch_begin().
+ * @param function_id The id of the host function that will be called.
+ * @param input_buffer Buffer containing inputs data.
+ * @param input_buffer_size Size of the input data buffer.
+ * @param output_buffer Buffer where the outputs of the host function are
+ * written to.
+ * @param output_buffer_size Size of the output buffer.
+ * @param completion Optional function called once the call has succeeded.
+ * @param completion_arg Argument passed to completion.
+ * @param call_result Optional location that receives the result of the call
+ * when the batch is submitted. It must remain valid until then.
+ *
+ * @return OE_OK the call was added.
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ */
+oe_result_t oe_ocall_batch_add(
+    oe_ocall_batch_t* batch,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    oe_ocall_batch_completion_t completion,
+    void* completion_arg,
+    oe_result_t* call_result);
+
+/**
+ * Submit the calls added to a batch to the host with a single ocall.
+ *
+ * The host performs the calls in order. A failed call does not stop the
+ * following ones. Once this function returns, the result of each call has
+ * been stored and the completions of the successful calls have been run, in
+ * call order. The batch can then be reused.
+ *
+ * @param batch The batch returned by oe_ocall_batch_begin().
+ *
+ * @return OE_OK the batch was performed by the host.
+ * @return OE_INVALID_PARAMETER batch is NULL.
+ * @return the result of the ocall if it failed, in which case every call of
+ * the batch failed with this result.
+ */
+oe_result_t oe_ocall_batch_submit(oe_ocall_batch_t* batch);
+
+/**
+ * Submit the pending calls of a batch and release it.
+ *
+ * @param batch The batch. The handle is invalid after this function returns.
+ *
+ * @return the result of oe_ocall_batch_submit().
+ */
+oe_result_t oe_ocall_batch_end(oe_ocall_batch_t* batch);
+
+/**
+ * Copy the given in parameter of a zero_copy ecall from the input buffer, which
+ * may lie in host memory, to its own enclave buffer and set the pointer value
+ * to it. The enclave buffer is kept in _in_<argname> and must be freed with
+ * oe_free().
+ */
+#define OE_COPY_IN_POINTER(argname, argsize, argtype)             \
+    do                                                            \
+    {                                                             \
+        size_t _size = (size_t)(argsize);                         \
+        const uint8_t* _src = input_buffer + input_buffer_offset; \
+        OE_ADD_SIZE(input_buffer_offset, _size);                  \
+        if (input_buffer_offset > input_buffer_size)              \
+        {                                                         \
+            _result = OE_BUFFER_TOO_SMALL;                        \
+            goto done;                                            \
+        }                                                         \
+        if (!(_in_##argname = oe_malloc(_size ? _size : 1)))      \
+        {                                                         \
+            _result = OE_OUT_OF_MEMORY;                           \
+            goto done;                                            \
+        }                                                         \
+        memcpy(_in_##argname, _src, _size);                       \
+        pargs_in->argname = (argtype)_in_##argname;               \
+    } while (0)
+
 /**
  * For hand-written enclaves, that use the older calling mechanism, define empty
  * ecall tables.
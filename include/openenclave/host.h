@@ -119,6 +119,15 @@ typedef struct _oe_enclave_setting_context_switchless
      * workers should be 0.
      */
     size_t max_enclave_workers;
+    /**
+     * Idle workers spin for a number of iterations before going to sleep.
+     * The number adapts to the observed interval between calls and stays
+     * within [min_spin_count, max_spin_count]. A value of 0 selects the
+     * default for that bound. Set both to the same value for a fixed spin
+     * count.
+     */
+    size_t min_spin_count;
+    size_t max_spin_count;
 } oe_enclave_setting_context_switchless_t;
 
 /**
@@ -412,6 +421,194 @@ void oe_free_key(
     uint8_t* key_info,
     size_t key_info_size);
 
+/**
+ * Number of buckets in the latency histogram of oe_call_stats_t.
+ */
+#define OE_CALL_STATS_HISTOGRAM_SIZE 32
+
+/**
+ * Statistics of the calls to one ecall or ocall of an enclave.
+ *
+ * Latencies are measured on the host in time-stamp counter (TSC) cycles. An
+ * ecall is timed from the host until it returns, including the ocalls it
+ * makes. An ocall is timed while its host function runs.
+ */
+typedef struct _oe_call_stats
+{
+    /** Number of completed calls. */
+    uint64_t count;
+
+    /** Total latency of the calls in TSC cycles. */
+    uint64_t cycles;
+
+    /** Number of switchless calls handled by a worker thread. */
+    uint64_t switchless_hits;
+
+    /** Number of switchless calls that fell back to a regular call. */
+    uint64_t switchless_misses;
+
+    /** histogram[i] is the number of calls that took between 2^i and
+     * 2^(i+1) - 1 cycles. The last bucket also counts longer calls. */
+    uint64_t histogram[OE_CALL_STATS_HISTOGRAM_SIZE];
+} oe_call_stats_t;
+
+/**
+ * Get the call statistics of an enclave.
+ *
+ * The statistics are indexed by the function id of the ecalls and ocalls,
+ * which is their position in the tables generated by oeedger8r.
+ *
+ * @param[in] enclave The enclave.
+ * @param[out] ecall_stats The buffer that receives the ecall statistics.
+ * @param[in,out] num_ecall_stats On input, the number of elements of
+ * **ecall_stats**. On output, the number of ecalls of the enclave.
+ * @param[out] ocall_stats The buffer that receives the ocall statistics.
+ * @param[in,out] num_ocall_stats On input, the number of elements of
+ * **ocall_stats**. On output, the number of ocalls of the enclave.
+ *
+ * @retval OE_OK The statistics were copied.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_BUFFER_TOO_SMALL A buffer is too small. **num_ecall_stats** and
+ * **num_ocall_stats** are set to the required sizes.
+ * @retval OE_UNSUPPORTED Call statistics are not supported on this platform.
+ */
+oe_result_t oe_get_enclave_call_stats(
+    oe_enclave_t* enclave,
+    oe_call_stats_t* ecall_stats,
+    size_t* num_ecall_stats,
+    oe_call_stats_t* ocall_stats,
+    size_t* num_ocall_stats);
+
+/**
+ * Maximum number of enclaves that a pool keeps ready.
+ */
+#define OE_ENCLAVE_POOL_MAX_SIZE 1024
+
+/**
+ * A pool of enclaves that are created ahead of time.
+ */
+typedef struct _oe_enclave_pool oe_enclave_pool_t;
+
+/**
+ * Function that creates an enclave, such as the oe_create_<name>_enclave()
+ * function that oeedger8r generates for the enclave.
+ */
+typedef oe_result_t (*oe_enclave_pool_create_func_t)(
+    const char* path,
+    oe_enclave_type_t type,
+    uint32_t flags,
+    const oe_enclave_setting_t* settings,
+    uint32_t setting_count,
+    oe_enclave_t** enclave);
+
+/**
+ * Function that returns a used enclave to its initial state, typically with
+ * an ecall. An enclave that it fails to reset is terminated.
+ */
+typedef oe_result_t (*oe_enclave_pool_reset_func_t)(
+    oe_enclave_t* enclave,
+    void* arg);
+
+/**
+ * Settings of an enclave pool.
+ */
+typedef struct _oe_enclave_pool_settings
+{
+    /** Path, type, flags and settings of the enclaves, as passed to
+     * **create**. The path is copied, the settings must remain valid until
+     * the pool is terminated. */
+    const char* path;
+    oe_enclave_type_t type;
+    uint32_t flags;
+    const oe_enclave_setting_t* settings;
+    uint32_t setting_count;
+
+    /** Function that creates the enclaves. */
+    oe_enclave_pool_create_func_t create;
+
+    /** Number of enclaves to keep ready, from 1 to
+     * OE_ENCLAVE_POOL_MAX_SIZE. */
+    size_t size;
+
+    /** Number of threads that create enclaves in the background, or 0 for
+     * one. At most **size** threads are used. */
+    size_t num_threads;
+
+    /** Optional function that resets released enclaves so that they can be
+     * handed out again. Without it, released enclaves are terminated. */
+    oe_enclave_pool_reset_func_t reset;
+
+    /** Argument passed to **reset**. */
+    void* reset_arg;
+} oe_enclave_pool_settings_t;
+
+/**
+ * Create a pool of enclaves.
+ *
+ * The pool creates **size** enclaves in background threads and creates a
+ * replacement whenever an enclave is acquired, so that acquiring an enclave
+ * does not wait for its creation.
+ *
+ * @param[in] settings The settings of the pool.
+ * @param[out] pool The new pool.
+ *
+ * @retval OE_OK The pool was created and starts creating enclaves.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_OUT_OF_MEMORY There is not enough memory for the pool.
+ * @retval OE_FAILURE A background thread could not be started.
+ */
+oe_result_t oe_create_enclave_pool(
+    const oe_enclave_pool_settings_t* settings,
+    oe_enclave_pool_t** pool);
+
+/**
+ * Take an enclave from a pool.
+ *
+ * This function waits until an enclave is ready if the pool is empty. The
+ * caller owns the enclave until it passes it to oe_enclave_pool_release().
+ *
+ * @param[in] pool The pool.
+ * @param[out] enclave The enclave.
+ *
+ * @retval OE_OK An enclave was taken from the pool.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval Other The result of the last failed creation of an enclave, if the
+ * pool is empty. The pool tries again on the next call.
+ */
+oe_result_t oe_enclave_pool_acquire(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t** enclave);
+
+/**
+ * Return an enclave to its pool.
+ *
+ * The enclave is reset and handed out again if the pool has a reset function
+ * that succeeds and is not full. Otherwise, it is terminated in the
+ * background.
+ *
+ * @param[in] pool The pool that the enclave was acquired from.
+ * @param[in] enclave The enclave.
+ *
+ * @retval OE_OK The enclave was returned.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ */
+oe_result_t oe_enclave_pool_release(
+    oe_enclave_pool_t* pool,
+    oe_enclave_t* enclave);
+
+/**
+ * Terminate a pool and the enclaves that it holds.
+ *
+ * Enclaves that are acquired from the pool and not released are not
+ * terminated. The caller terminates them with oe_terminate_enclave().
+ *
+ * @param[in] pool The pool.
+ *
+ * @retval OE_OK The pool was terminated.
+ * @retval OE_INVALID_PARAMETER **pool** is null.
+ */
+oe_result_t oe_terminate_enclave_pool(oe_enclave_pool_t* pool);
+
 OE_EXTERNC_END
 
 #endif /* _OE_HOST_H */
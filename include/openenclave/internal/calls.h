@@ -84,6 +84,10 @@ typedef enum _oe_func
     OE_OCALL_MALLOC,
     OE_OCALL_FREE,
     OE_OCALL_GET_TIME,
+    OE_OCALL_GROW_OCALL_BUFFER,
+    OE_OCALL_CALL_HOST_FUNCTION_BATCH,
+    /* A switchless OE_OCALL_CALL_HOST_FUNCTION that found no free worker */
+    OE_OCALL_CALL_HOST_FUNCTION_FALLBACK,
     /* Caution: always add new OCALL function numbers here */
     OE_OCALL_MAX, /* This value is never used */
 
@@ -209,6 +213,23 @@ typedef struct _oe_call_host_function_args
     oe_result_t result;
 } oe_call_host_function_args_t;
 
+/*
+**==============================================================================
+**
+** oe_call_host_function_batch_args_t
+**
+**     Argument of OE_OCALL_CALL_HOST_FUNCTION_BATCH: the host performs the
+**     calls in order.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_call_host_function_batch_args
+{
+    uint64_t num_calls;
+    oe_call_host_function_args_t* calls;
+} oe_call_host_function_batch_args_t;
+
 /*
 **==============================================================================
 **
@@ -313,6 +334,32 @@ oe_result_t oe_ecall(
  */
 oe_result_t oe_ocall(uint16_t func, uint64_t arg_in, uint64_t* arg_out);
 
+/**
+ * Allocate a host buffer for an OCALL to fill in place.
+ *
+ * The buffer is passed to the host by address ([user_check]), so that the
+ * caller copies back only the bytes the host produced, instead of the whole
+ * buffer being marshalled as an [out] parameter. It is taken from the shared
+ * memory arena of the calling thread and must be released with
+ * oe_free_ocall_staging_buffer() before the next switchless OCALL.
+ *
+ * The buffer is in host memory and should be treated as untrusted.
+ *
+ * @param size The size in bytes of the buffer.
+ * @returns pointer to the allocated buffer.
+ * @return NULL if the platform does not support staging buffers, if the
+ * calling thread has no shared memory arena yet, or if the allocation failed,
+ * in which case the caller should marshal the data instead.
+ */
+void* oe_allocate_ocall_staging_buffer(size_t size);
+
+/**
+ * Free a buffer allocated with oe_allocate_ocall_staging_buffer().
+ *
+ * @param buffer The buffer to free.
+ */
+void oe_free_ocall_staging_buffer(void* buffer);
+
 OE_EXTERNC_END
 
 #endif /* _OE_CALLS_H */
@@ -246,6 +246,15 @@ int elf64_load(const char* path, elf64_t* elf);
 
 int elf64_unload(elf64_t* elf);
 
+/* Maps the file into memory instead of reading it, so that its pages are
+ * only read when they are accessed. Changes to the mapping are private and
+ * are not written back to the file. Release the mapping with elf64_unmap()
+ * and do not pass it to functions that resize the image, such as
+ * elf64_add_section(). */
+int elf64_map(const char* path, elf64_t* elf);
+
+int elf64_unmap(elf64_t* elf);
+
 int elf64_get_dynamic_symbol_table(
     const elf64_t* elf,
     const elf64_sym_t** symtab,
@@ -10,6 +10,12 @@
 
 OE_EXTERNC_BEGIN
 
+/**
+ * Largest ocall buffer the host keeps per thread binding. Larger ocalls
+ * allocate their buffer with oe_host_malloc().
+ */
+#define OE_MAX_OCALL_BUFFER_SIZE (16 * 1024 * 1024)
+
 typedef struct _oe_ecall_context
 {
     // Storage for making ocall
@@ -34,6 +40,14 @@ oe_call_host_function_args_t* oe_ecall_context_get_ocall_args();
  */
 void* oe_ecall_context_get_ocall_buffer(uint64_t size);
 
+/**
+ * Get the number of times the host grew the per-binding ocall buffer and the
+ * number of ocall buffers allocated with oe_host_malloc() instead.
+ */
+void oe_get_ocall_buffer_statistics(
+    uint64_t* grow_count,
+    uint64_t* fallback_count);
+
 OE_EXTERNC_END
 
 #endif /* _OE_INTERNAL_ECALL_CONTEXT_H */
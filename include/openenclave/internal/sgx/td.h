@@ -81,7 +81,7 @@ oe_thread_data_t* oe_get_thread_data(void);
  * Due to the inability to use OE_OFFSETOF on a struct while defining its
  * members, this value is computed and hard-coded.
  */
-#define OE_THREAD_SPECIFIC_DATA_SIZE (3744)
+#define OE_THREAD_SPECIFIC_DATA_SIZE (3712)
 
 typedef struct _oe_callsite oe_callsite_t;
 
@@ -94,16 +94,27 @@ typedef struct _oe_tls_atexit
 
 /* This structure manages a pool of shared memory (memory visible to both
  * the enclave and the host). An instance of this structure is maintained
- * for each thread. This structure is used in enclave/core/arena.c.
+ * for each thread. The pool is a list of host-allocated chunks that grows
+ * on demand. This structure is used in enclave/core/sgx/arena.c.
  */
 typedef struct _oe_shared_memory_arena_t
 {
-    uint8_t* buffer;
-    uint64_t capacity;
+    /* Chunks in allocation order, and the chunk being allocated from */
+    struct _oe_arena_chunk* chunks;
+    struct _oe_arena_chunk* current;
+    uint64_t num_chunks;
+
+    /* Bytes allocated since the arena was last reset */
     uint64_t used;
+
+    /* Capacity of new chunks for this thread (zero for the default) */
+    uint64_t chunk_capacity;
+
+    /* Number of consecutive resets that only used the first chunk */
+    uint64_t idle_resets;
 } oe_shared_memory_arena_t;
 
-OE_CHECK_SIZE(sizeof(oe_shared_memory_arena_t), 24);
+OE_CHECK_SIZE(sizeof(oe_shared_memory_arena_t), 48);
 
 OE_PACK_BEGIN
 typedef struct _td
@@ -156,13 +167,16 @@ typedef struct _td
     int32_t errnum;
     int32_t padding2;
 
-    /* Thread-specific shared memory pool (see enclave/core/arena.c) */
+    /* Thread-specific shared memory pool (see enclave/core/sgx/arena.c) */
     oe_shared_memory_arena_t arena;
 
     /* TLS atexit functions (see enclave/core/sgx/threadlocal.c) */
     oe_tls_atexit_t* tls_atexit_functions;
     uint64_t num_tls_atexit_functions;
 
+    /* Ecall marshalling buffer (see enclave/core/sgx/calls.c) */
+    struct _oe_ecall_buffer* ecall_buffer;
+
     /* Reserved for thread specific data. */
     uint8_t thread_specific_data[OE_THREAD_SPECIFIC_DATA_SIZE];
 } oe_sgx_td_t;
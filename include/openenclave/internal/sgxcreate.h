@@ -61,6 +61,11 @@ struct _oe_sgx_load_context
     /* Hash context used to measure enclave as it is loaded */
     oe_sha256_context_t hash_context;
 
+    /* MRENCLAVE from the measurement cache. When use_cached_mrenclave is
+     * set, the enclave is loaded without being measured. */
+    bool use_cached_mrenclave;
+    OE_SHA256 cached_mrenclave;
+
 #ifdef OE_WITH_EXPERIMENTAL_EEID
     /* EEID data needed during enclave creation */
     oe_eeid_t* eeid;
@@ -14,19 +14,28 @@
  * oe_host_worker_context_t is used both by the host (windows/linux) and the
  * enclave (ELF). Lock down the layout.
  */
-OE_STATIC_ASSERT(sizeof(oe_host_worker_context_t) == 40);
+OE_STATIC_ASSERT(sizeof(oe_host_worker_context_t) == 80);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, call_arg) == 0);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, enc) == 8);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, is_stopping) == 16);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, event) == 20);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, spin_count) == 24);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, total_spin_count) == 32);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_host_worker_context_t, spin_count_threshold) == 40);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_host_worker_context_t, min_spin_count_threshold) == 48);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_host_worker_context_t, max_spin_count_threshold) == 56);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_host_worker_context_t, average_spin_count) == 64);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_host_worker_context_t, total_wake_count) == 72);
 
 /**
  * oe_enclave_worker_context_t is used both by the host (windows/linux) and the
  * enclave (ELF). Lock down the layout.
  */
-OE_STATIC_ASSERT(sizeof(oe_enclave_worker_context_t) == 48);
+OE_STATIC_ASSERT(sizeof(oe_enclave_worker_context_t) == 88);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, call_arg) == 0);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, enc) == 8);
 OE_STATIC_ASSERT(OE_OFFSETOF(oe_enclave_worker_context_t, is_stopping) == 16);
@@ -36,6 +45,118 @@ OE_STATIC_ASSERT(
     OE_OFFSETOF(oe_enclave_worker_context_t, spin_count_threshold) == 32);
 OE_STATIC_ASSERT(
     OE_OFFSETOF(oe_enclave_worker_context_t, total_spin_count) == 40);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_enclave_worker_context_t, min_spin_count_threshold) == 48);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_enclave_worker_context_t, max_spin_count_threshold) == 56);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_enclave_worker_context_t, average_spin_count) == 64);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_enclave_worker_context_t, total_wake_count) == 72);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_enclave_worker_context_t, last_sleep_spin_count) == 80);
+
+/**
+ * oe_switchless_call_queue_t is used both by the host (windows/linux) and the
+ * enclave (ELF). Lock down the layout.
+ */
+OE_STATIC_ASSERT(sizeof(oe_switchless_call_queue_cell_t) == 16);
+OE_STATIC_ASSERT(sizeof(oe_switchless_call_queue_t) == 216);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_call_queue_t, cells) == 0);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_call_queue_t, capacity) == 8);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_call_queue_t, enqueue_pos) == 64);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_call_queue_t, dequeue_pos) == 128);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_switchless_call_queue_t, total_queued_count) == 192);
+OE_STATIC_ASSERT(
+    OE_OFFSETOF(oe_switchless_call_queue_t, total_missed_count) == 200);
+OE_STATIC_ASSERT(OE_OFFSETOF(oe_switchless_call_queue_t, max_depth) == 208);
+
+/**
+ * Number of cells in the switchless ocall queue. Must be a power of two.
+ */
+#define OE_SWITCHLESS_CALL_QUEUE_CAPACITY (256U)
+
+/**
+ * Maximum number of queued switchless ocalls a host worker handles before
+ * checking its own slot again.
+ */
+#define OE_SWITCHLESS_CALL_QUEUE_BATCH_SIZE (16U)
+
+/**
+ * Default bounds of the adaptive spin budget of switchless workers, used when
+ * oe_enclave_setting_context_switchless_t leaves them as 0.
+ */
+#define OE_SWITCHLESS_DEFAULT_MIN_SPIN_COUNT_THRESHOLD (1024U)
+#define OE_SWITCHLESS_DEFAULT_MAX_SPIN_COUNT_THRESHOLD (65536U)
+
+/**
+ * Update the spin budget of a switchless worker after it has picked up a
+ * message.
+ *
+ * If the message arrived while the worker was spinning, spin_count measures
+ * the inter-arrival time. The budget tracks a multiple of its moving average
+ * so that the worker keeps spinning through the typical gap but gives up
+ * quickly when messages stop.
+ *
+ * If the worker had gone to sleep before the message arrived, the gap was
+ * longer than the budget. sleep_spin_count is the length of the sleep in spin
+ * iterations. If the message arrived within one more budget, the budget is
+ * doubled so that a medium load does not pay the wake latency on every
+ * message. Otherwise the worker was idle and spinning longer would not have
+ * helped, so the budget is halved.
+ *
+ * The budget always stays within [min_threshold, max_threshold].
+ */
+OE_INLINE void oe_switchless_update_spin_policy(
+    uint64_t spin_count,
+    bool slept,
+    uint64_t sleep_spin_count,
+    uint64_t min_threshold,
+    uint64_t max_threshold,
+    uint64_t* average_spin_count,
+    uint64_t* spin_count_threshold)
+{
+    uint64_t threshold;
+
+    if (slept)
+    {
+        if (sleep_spin_count <= *spin_count_threshold)
+            threshold = *spin_count_threshold * 2;
+        else
+            threshold = *spin_count_threshold / 2;
+
+        *average_spin_count = threshold / 4;
+    }
+    else
+    {
+        *average_spin_count =
+            *average_spin_count - *average_spin_count / 8 + spin_count / 8;
+        threshold = *average_spin_count * 4;
+    }
+
+    if (threshold < min_threshold)
+        threshold = min_threshold;
+    if (threshold > max_threshold)
+        threshold = max_threshold;
+
+    *spin_count_threshold = threshold;
+}
+
+/**
+ * Aggregated statistics of the switchless workers and ocall queue of an
+ * enclave.
+ */
+typedef struct _oe_switchless_statistics
+{
+    uint64_t host_worker_spin_count;
+    uint64_t host_worker_wake_count;
+    uint64_t enclave_worker_spin_count;
+    uint64_t enclave_worker_wake_count;
+    uint64_t queued_ocall_count;
+    uint64_t missed_ocall_count;
+    uint64_t max_ocall_queue_depth;
+} oe_switchless_statistics_t;
 
 typedef struct _oe_switchless_call_manager
 {
@@ -46,15 +167,23 @@ typedef struct _oe_switchless_call_manager
     oe_enclave_worker_context_t* enclave_worker_contexts;
     oe_thread_t* enclave_worker_threads;
     size_t num_enclave_workers;
+
+    oe_switchless_call_queue_t* host_call_queue;
 } oe_switchless_call_manager_t;
 
 oe_result_t oe_start_switchless_manager(
     oe_enclave_t* enclave,
     size_t num_host_workers,
-    size_t num_enclave_workers);
+    size_t num_enclave_workers,
+    size_t min_spin_count_threshold,
+    size_t max_spin_count_threshold);
 
 oe_result_t oe_stop_switchless_manager(oe_enclave_t* enclave);
 
+oe_result_t oe_get_switchless_statistics(
+    oe_enclave_t* enclave,
+    oe_switchless_statistics_t* statistics);
+
 void oe_host_worker_wait(oe_host_worker_context_t* context);
 
 void oe_host_worker_wake(oe_host_worker_context_t* context);
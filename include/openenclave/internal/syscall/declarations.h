@@ -163,12 +163,14 @@ OE_DECLARE_SYSCALL1(SYS_rmdir);
 #if __x86_64__ || _M_X64
 OE_DECLARE_SYSCALL5(SYS_select);
 #endif
+OE_DECLARE_SYSCALL4(SYS_sendfile);
 OE_DECLARE_SYSCALL6(SYS_sendto);
 OE_DECLARE_SYSCALL3(SYS_sendmsg);
 OE_DECLARE_SYSCALL5(SYS_setsockopt);
 OE_DECLARE_SYSCALL2(SYS_shutdown);
 OE_DECLARE_SYSCALL3(SYS_socket);
 OE_DECLARE_SYSCALL4(SYS_socketpair);
+OE_DECLARE_SYSCALL6(SYS_splice);
 #if __x86_64__ || _M_X64
 OE_DECLARE_SYSCALL2(SYS_stat);
 #endif
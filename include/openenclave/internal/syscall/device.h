@@ -31,6 +31,9 @@ enum
 
     /* The host epoll device. */
     OE_DEVID_HOST_EPOLL,
+
+    /* The host I/O ring device. */
+    OE_DEVID_HOST_IO_RING,
 };
 
 /* Device names. */
@@ -39,6 +42,7 @@ enum
 #define OE_DEVICE_NAME_SGX_FILE_SYSTEM OE_SGX_FILE_SYSTEM
 #define OE_DEVICE_NAME_HOST_SOCKET_INTERFACE "oe_host_socket_interface"
 #define OE_DEVICE_NAME_HOST_EPOLL "oe_host_epoll"
+#define OE_DEVICE_NAME_HOST_IO_RING "oe_host_io_ring"
 
 typedef enum _oe_device_type
 {
@@ -47,6 +51,7 @@ typedef enum _oe_device_type
     OE_DEVICE_TYPE_FILE_SYSTEM,
     OE_DEVICE_TYPE_SOCKET_INTERFACE,
     OE_DEVICE_TYPE_EPOLL,
+    OE_DEVICE_TYPE_IO_RING,
 } oe_device_type_t;
 
 typedef struct _oe_device oe_device_t;
@@ -122,6 +127,16 @@ typedef struct _oe_epoll_device_ops
 
 } oe_epoll_device_ops_t;
 
+typedef struct _oe_io_ring_device_ops
+{
+    oe_device_ops_t base;
+
+    oe_fd_t* (*io_ring_setup)(
+        oe_device_t* device,
+        const struct oe_io_ring_params* params);
+
+} oe_io_ring_device_ops_t;
+
 typedef struct _oe_device oe_device_t;
 
 struct _oe_device
@@ -138,6 +153,7 @@ struct _oe_device
         oe_fs_device_ops_t fs;
         oe_socket_device_ops_t socket;
         oe_epoll_device_ops_t epoll;
+        oe_io_ring_device_ops_t io_ring;
     } ops;
 };
 
@@ -80,12 +80,27 @@ OE_EXTERNC_BEGIN
 #define OE_AT_FDCWD (-100)
 #define OE_AT_REMOVEDIR 0x200
 
+// clang-format off
+#define OE_SPLICE_F_MOVE     1
+#define OE_SPLICE_F_NONBLOCK 2
+#define OE_SPLICE_F_MORE     4
+#define OE_SPLICE_F_GIFT     8
+// clang-format on
+
 int oe_open(const char* pathname, int flags, oe_mode_t mode);
 
 int oe_open_d(uint64_t devid, const char* pathname, int flags, oe_mode_t mode);
 
 int __oe_fcntl(int fd, int cmd, uint64_t arg);
 
+ssize_t oe_splice(
+    int fd_in,
+    oe_off_t* off_in,
+    int fd_out,
+    oe_off_t* off_out,
+    size_t len,
+    unsigned int flags);
+
 #if !defined(WIN32) /* __feature_io__ */
 OE_INLINE int oe_fcntl(int fd, int cmd, ...)
 {
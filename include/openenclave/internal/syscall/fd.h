@@ -7,6 +7,7 @@
 #include <openenclave/bits/defs.h>
 #include <openenclave/bits/types.h>
 #include <openenclave/internal/syscall/sys/epoll.h>
+#include <openenclave/internal/syscall/sys/ioring.h>
 #include <openenclave/internal/syscall/sys/socket.h>
 #include <openenclave/internal/syscall/sys/stat.h>
 #include <openenclave/internal/syscall/sys/uio.h>
@@ -21,6 +22,7 @@ typedef enum _oe_fd_type
     OE_FD_TYPE_FILE,
     OE_FD_TYPE_SOCKET,
     OE_FD_TYPE_EPOLL,
+    OE_FD_TYPE_IO_RING,
 } oe_fd_type_t;
 
 typedef struct _oe_fd oe_fd_t;
@@ -68,6 +70,11 @@ typedef struct _oe_file_ops
 
     int (*fsync)(oe_fd_t* file);
     int (*fdatasync)(oe_fd_t* file);
+
+    /* Whether the data and the offset of the file are kept in the enclave,
+     * so that the host must not read or write its host descriptor. Null if
+     * they never are. */
+    bool (*is_cached)(oe_fd_t* file);
 } oe_file_ops_t;
 
 /* Socket operations .*/
@@ -165,17 +172,48 @@ typedef struct _oe_epoll_ops
     void (*on_close)(oe_fd_t* epoll, int fd);
 } oe_epoll_ops_t;
 
+/* I/O ring operations. */
+typedef struct _oe_io_ring_ops
+{
+    /* Inherited operations. */
+    oe_fd_ops_t fd;
+
+    int (*submit)(
+        oe_fd_t* ring,
+        const struct oe_io_ring_sqe* sqes,
+        unsigned int count);
+
+    int (*reap)(
+        oe_fd_t* ring,
+        struct oe_io_ring_cqe* cqes,
+        unsigned int count,
+        unsigned int min_complete);
+} oe_io_ring_ops_t;
+
 struct _oe_fd
 {
     oe_fd_type_t type;
+
+    /* Managed by the fd table: one reference for the table and one for each
+     * oe_fdtable_get() that has not been matched by oe_fdtable_put(). */
+    uint64_t refcount;
+
     union {
         oe_fd_ops_t fd;
         oe_file_ops_t file;
         oe_socket_ops_t socket;
         oe_epoll_ops_t epoll;
+        oe_io_ring_ops_t io_ring;
     } ops;
 };
 
+/* Whether the host must not move the data of the descriptor itself. */
+OE_INLINE bool oe_fd_is_cached(oe_fd_t* desc)
+{
+    return desc->type == OE_FD_TYPE_FILE && desc->ops.file.is_cached &&
+           desc->ops.file.is_cached(desc);
+}
+
 OE_EXTERNC_END
 
 // clang-format on
@@ -10,14 +10,55 @@
 
 OE_EXTERNC_BEGIN
 
+/**
+ * Looks up the descriptor of **fd** and takes a reference to it.
+ *
+ * The lookup does not take a lock. The reference keeps the descriptor from
+ * being closed while it is in use, and must be dropped with oe_fdtable_put().
+ *
+ * @param fd The file descriptor.
+ * @param type The expected fd type. Can be OE_FD_TYPE_ANY.
+ *
+ * @return The descriptor, or NULL with oe_errno set.
+ */
 oe_fd_t* oe_fdtable_get(int fd, oe_fd_type_t type);
 
+/**
+ * Drops a reference taken by oe_fdtable_get().
+ *
+ * If the fd has been released in the meantime and this was the last
+ * reference, the descriptor is closed. oe_errno is preserved.
+ */
+void oe_fdtable_put(oe_fd_t* desc);
+
 int oe_fdtable_assign(oe_fd_t* desc);
 
+/**
+ * Replaces the descriptor of **fd** by **new_desc**.
+ *
+ * The reference that the table held to the old descriptor, if any, is passed
+ * to the caller through **old_desc**. Drop it with oe_fdtable_put().
+ */
 int oe_fdtable_reassign(int fd, oe_fd_t* new_desc, oe_fd_t** old_desc);
 
+/**
+ * Removes **fd** from the table and drops the reference that the table held.
+ *
+ * @return The result of closing the descriptor if this was the last
+ * reference, 0 if other threads still use it (the last one closes it), or -1
+ * with oe_errno set if **fd** is not assigned.
+ */
 int oe_fdtable_release(int fd);
 
+/**
+ * Returns the number of descriptors closed so far.
+ *
+ * A host fd may be reused by the host once the descriptor using it is closed,
+ * so state kept per host fd, such as the interest set of poll(), may be stale
+ * when this number has changed.
+ */
+uint64_t oe_fdtable_get_close_count(void);
+
 /**
  * Invokes **callback** for each fd of type **type** in the fdtable.
  *
@@ -0,0 +1,92 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_IORING_H
+#define _OE_SYSCALL_IORING_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/edl/syscall_types.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** The layout of an I/O ring in host memory, shared by the host I/O ring device
+** and the host worker threads that drain it.
+**
+** The host allocates one block holding the header, the submission ring, the
+** completion ring, and a data buffer for each entry, in that order. The
+** enclave produces submissions (advancing sq_tail) and the workers claim them
+** by advancing sq_head with a compare-and-swap. A worker posts a completion
+** by reserving a position with cq_reserve, filling the entry, and setting its
+** sequence number to the position plus one last.
+**
+** Each operation in flight owns one slot, which selects its data buffer, so
+** no more than num_entries operations are in flight and neither ring
+** overflows.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_io_ring_host_sqe
+{
+    uint32_t opcode;
+    int32_t flags;
+    uint32_t slot;
+    uint32_t len;
+    oe_host_fd_t fd;
+    int64_t offset;
+} oe_io_ring_host_sqe_t;
+
+typedef struct _oe_io_ring_host_cqe
+{
+    uint64_t seq;
+    uint32_t slot;
+    int32_t err;
+    int64_t res;
+} oe_io_ring_host_cqe_t;
+
+typedef struct _oe_io_ring_header
+{
+    uint32_t num_entries;
+    uint32_t buffer_size;
+
+    /* Written by the enclave. */
+    uint64_t sq_tail;
+
+    /* Written by the workers. */
+    uint64_t sq_head;
+    uint64_t cq_reserve;
+
+    /* Number of workers waiting for submissions. */
+    uint64_t sleeping_workers;
+} oe_io_ring_header_t;
+
+OE_INLINE size_t oe_io_ring_sq_offset(void)
+{
+    return sizeof(oe_io_ring_header_t);
+}
+
+OE_INLINE size_t oe_io_ring_cq_offset(uint32_t num_entries)
+{
+    return oe_io_ring_sq_offset() +
+           (size_t)num_entries * sizeof(oe_io_ring_host_sqe_t);
+}
+
+OE_INLINE size_t oe_io_ring_data_offset(uint32_t num_entries)
+{
+    return oe_io_ring_cq_offset(num_entries) +
+           (size_t)num_entries * sizeof(oe_io_ring_host_cqe_t);
+}
+
+OE_INLINE size_t oe_io_ring_size(uint32_t num_entries, uint32_t buffer_size)
+{
+    return oe_io_ring_data_offset(num_entries) +
+           (size_t)num_entries * buffer_size;
+}
+
+OE_EXTERNC_END
+
+#endif // _OE_SYSCALL_IORING_H
@@ -0,0 +1,153 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYS_IORING_H
+#define _OE_SYS_IORING_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/corelibc/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** I/O rings:
+**
+** An I/O ring lets an enclave thread keep many read/write/send/recv operations
+** on host files and sockets in flight. Operations are queued on a submission
+** ring in host memory and performed by host worker threads, which post their
+** results on a completion ring. Neither submitting nor reaping leaves the
+** enclave unless the workers are asleep or the caller waits for completions.
+**
+** The ring is a file descriptor created by oe_io_ring_setup() and released by
+** close(). It requires the host I/O ring device, which is loaded by
+** oe_load_module_host_io_ring().
+**
+**==============================================================================
+*/
+
+/* Operations of submission queue entries. */
+#define OE_IO_RING_OP_NOP 0
+#define OE_IO_RING_OP_READ 1
+#define OE_IO_RING_OP_WRITE 2
+#define OE_IO_RING_OP_RECV 3
+#define OE_IO_RING_OP_SEND 4
+#define OE_IO_RING_OP_FSYNC 5
+
+/* Default number of entries of a ring. */
+#define OE_IO_RING_DEFAULT_ENTRIES 32
+
+/* Maximum number of entries of a ring. */
+#define OE_IO_RING_MAX_ENTRIES 4096
+
+/* Default size of the host buffer of each entry. */
+#define OE_IO_RING_DEFAULT_BUFFER_SIZE (64 * 1024)
+
+/* Maximum size of the host buffer of each entry. */
+#define OE_IO_RING_MAX_BUFFER_SIZE (1024 * 1024)
+
+/* Default number of host worker threads of a ring. */
+#define OE_IO_RING_DEFAULT_WORKERS 4
+
+/* Maximum number of host worker threads of a ring. */
+#define OE_IO_RING_MAX_WORKERS 64
+
+struct oe_io_ring_params
+{
+    /* Maximum number of operations in flight (0 for the default). */
+    uint32_t entries;
+
+    /* Size of the host buffer of each entry (0 for the default). Larger
+     * transfers are shortened to this size, as a short read or write. */
+    uint32_t buffer_size;
+
+    /* Number of host worker threads (0 for the default). An operation that
+     * blocks on the host, such as a recv() on an idle socket, occupies a
+     * worker until it completes. */
+    uint32_t workers;
+};
+
+/* An operation to submit. */
+struct oe_io_ring_sqe
+{
+    /* One of the OE_IO_RING_OP_* values. */
+    uint32_t opcode;
+
+    /* A file or socket descriptor backed by a host descriptor, such as those
+     * of the host file system and the host socket interface. Files on mounts
+     * with OE_MS_HOSTFS_CACHE cannot be used, since their data is kept in
+     * the enclave. */
+    int fd;
+
+    /* Flags of send() and recv(). */
+    int flags;
+
+    /* The enclave buffer to read from or write to. For reads, the buffer is
+     * filled when the completion is reaped, so it must stay valid until then.
+     */
+    void* addr;
+
+    /* The number of bytes to transfer. */
+    uint32_t len;
+
+    /* The file offset of a read or write, or -1 to use the file position. */
+    oe_off_t off;
+
+    /* Returned in the completion of the operation. */
+    uint64_t user_data;
+};
+
+/* The completion of an operation. */
+struct oe_io_ring_cqe
+{
+    /* The user_data of the operation. */
+    uint64_t user_data;
+
+    /* The result of the operation, or minus its errno. */
+    int64_t res;
+};
+
+/**
+ * Creates an I/O ring.
+ *
+ * @param params The ring parameters, or NULL for the defaults.
+ *
+ * @return The ring file descriptor, or -1 with oe_errno set.
+ */
+int oe_io_ring_setup(const struct oe_io_ring_params* params);
+
+/**
+ * Queues operations on an I/O ring.
+ *
+ * Each entry takes a reference to its descriptor, which is dropped when its
+ * completion is reaped. Data to write or send is copied to host memory here.
+ *
+ * @return The number of entries queued, which is less than **count** if the
+ * ring is full or an entry is invalid, or -1 with oe_errno set if the first
+ * entry could not be queued (OE_EBUSY if the ring is full).
+ */
+int oe_io_ring_submit(
+    int ring,
+    const struct oe_io_ring_sqe* sqes,
+    unsigned int count);
+
+/**
+ * Reaps completions of an I/O ring.
+ *
+ * Waits until at least **min_complete** completions are available, or until
+ * all the operations in flight have completed if there are fewer, and returns
+ * at most **count** of them, in the order in which the operations completed.
+ *
+ * @return The number of completions reaped, or -1 with oe_errno set.
+ */
+int oe_io_ring_reap(
+    int ring,
+    struct oe_io_ring_cqe* cqes,
+    unsigned int count,
+    unsigned int min_complete);
+
+OE_EXTERNC_END
+
+#endif /* _OE_SYS_IORING_H */
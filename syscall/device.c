@@ -116,6 +116,11 @@ static void _assert_device(oe_device_t* device)
             oe_assert(device->ops.epoll.epoll_create1);
             break;
         }
+        case OE_DEVICE_TYPE_IO_RING:
+        {
+            oe_assert(device->ops.io_ring.io_ring_setup);
+            break;
+        }
         default:
         {
             oe_assert(false);
@@ -31,8 +31,8 @@
 /* epoll_ctl() adds/modifies/deletes this mapping. */
 typedef struct _mapping
 {
-    /* The fd parameter from epoll_ctl(). */
-    int fd;
+    /* Whether the fd has been added by epoll_ctl(). */
+    bool in_use;
 
     /* The event parameter from epoll_ctl(). */
     struct oe_epoll_event event;
@@ -57,7 +57,9 @@ typedef struct _epoll
     /* The host file descriptor created by epoll_create(). */
     oe_host_fd_t host_fd;
 
-    /* Mappings added by epoll_ctl(OE_EPOLL_CTL_ADD) */
+    /* Mappings added by epoll_ctl(OE_EPOLL_CTL_ADD), indexed by fd. Enclave
+     * fds are allocated from the bottom of the fd table, so the map stays
+     * dense. map_size is the number of mappings in use. */
     mapping_t* map;
     size_t map_size;
     size_t map_capacity;
@@ -104,10 +106,11 @@ static int _map_reserve(epoll_t* epoll, size_t new_capacity)
         if (!(p = oe_realloc(epoll->map, n * sizeof(mapping_t))))
             goto done;
 
-        /* Zero-fill the unused portion. */
+        /* Zero-fill the new portion. */
         {
-            const size_t num_bytes = (n - epoll->map_size) * sizeof(mapping_t);
-            void* ptr = p + epoll->map_size;
+            const size_t num_bytes =
+                (n - epoll->map_capacity) * sizeof(mapping_t);
+            void* ptr = p + epoll->map_capacity;
 
             if (oe_memset_s(ptr, num_bytes, 0, num_bytes) != OE_OK)
                 goto done;
@@ -126,18 +129,49 @@ done:
 /* Find the mapping for the given file descriptor. */
 static mapping_t* _map_find(epoll_t* epoll, int fd)
 {
-    size_t i;
+    mapping_t* mapping;
 
-    for (i = 0; i < epoll->map_size; i++)
-    {
-        mapping_t* mapping = &epoll->map[i];
+    if (fd < 0 || (size_t)fd >= epoll->map_capacity)
+        return NULL;
+
+    mapping = &epoll->map[fd];
+
+    return mapping->in_use ? mapping : NULL;
+}
+
+/* Add the mapping for the given file descriptor. */
+static int _map_add(epoll_t* epoll, int fd, const struct oe_epoll_event* event)
+{
+    mapping_t* mapping;
+
+    if (fd < 0 || _map_reserve(epoll, (size_t)fd + 1) != 0)
+        return -1;
+
+    mapping = &epoll->map[fd];
 
-        if (mapping->fd == fd)
-            return mapping;
+    if (!mapping->in_use)
+    {
+        mapping->in_use = true;
+        epoll->map_size++;
     }
 
-    /* Not found */
-    return NULL;
+    mapping->event = *event;
+
+    return 0;
+}
+
+/* Remove the mapping for the given file descriptor, if any. */
+static bool _map_remove(epoll_t* epoll, int fd)
+{
+    mapping_t* const mapping = _map_find(epoll, fd);
+
+    if (!mapping)
+        return false;
+
+    mapping->in_use = false;
+    epoll->map_size--;
+
+    return true;
 }
 
 /* Called by oe_epoll_create1(). */
@@ -211,7 +245,10 @@ static int _epoll_ctl_add(epoll_t* epoll, int fd, struct oe_epoll_event* event)
     host_epfd = epoll->host_fd;
 
     /* Get the host fd for the fd. */
-    if ((host_fd = desc->ops.fd.get_host_fd(desc)) == -1)
+    host_fd = desc->ops.fd.get_host_fd(desc);
+    oe_fdtable_put(desc);
+
+    if (host_fd == -1)
         OE_RAISE_ERRNO(oe_errno);
 
     /* Initialize the host event. */
@@ -238,12 +275,8 @@ static int _epoll_ctl_add(epoll_t* epoll, int fd, struct oe_epoll_event* event)
 
     if (retval == 0)
     {
-        if (_map_reserve(epoll, epoll->map_size + 1) != 0)
+        if (_map_add(epoll, fd, event) != 0)
             OE_RAISE_ERRNO(OE_ENOMEM);
-
-        epoll->map[epoll->map_size].fd = fd;
-        epoll->map[epoll->map_size].event = *event;
-        epoll->map_size++;
     }
 
     ret = retval;
@@ -279,7 +312,10 @@ static int _epoll_ctl_mod(epoll_t* epoll, int fd, struct oe_epoll_event* event)
     host_epfd = epoll->host_fd;
 
     /* Get the host fd for the device. */
-    if ((host_fd = desc->ops.fd.get_host_fd(desc)) == -1)
+    host_fd = desc->ops.fd.get_host_fd(desc);
+    oe_fdtable_put(desc);
+
+    if (host_fd == -1)
         OE_RAISE_ERRNO(oe_errno);
 
     /* Initialize the host event. */
@@ -345,7 +381,10 @@ static int _epoll_ctl_del(epoll_t* epoll, int fd)
     host_epfd = epoll->host_fd;
 
     /* Get the host fd for the device. */
-    if ((host_fd = desc->ops.fd.get_host_fd(desc)) == -1)
+    host_fd = desc->ops.fd.get_host_fd(desc);
+    oe_fdtable_put(desc);
+
+    if (host_fd == -1)
         OE_RAISE_ERRNO(oe_errno);
 
     // The host call and the map update must be done in an atomic operation.
@@ -361,20 +400,7 @@ static int _epoll_ctl_del(epoll_t* epoll, int fd)
     /* Delete the mapping. */
     if (retval == 0)
     {
-        bool found = false;
-
-        for (size_t i = 0; i < epoll->map_size; i++)
-        {
-            if (epoll->map[i].fd == fd)
-            {
-                /* Swap with last element of array. */
-                epoll->map[i] = epoll->map[--epoll->map_size];
-                found = true;
-                break;
-            }
-        }
-
-        if (!found)
+        if (!_map_remove(epoll, fd))
             OE_RAISE_ERRNO(OE_ENOENT);
     }
 
@@ -871,12 +897,13 @@ static int _epoll_dup(oe_fd_t* epoll_, oe_fd_t** new_epoll_out)
         {
             mapping_t* map;
 
-            if (!(map = oe_calloc(epoll->map_size, sizeof(mapping_t))))
+            if (!(map = oe_calloc(epoll->map_capacity, sizeof(mapping_t))))
                 OE_RAISE_ERRNO(OE_ENOMEM);
 
-            memcpy(map, epoll->map, epoll->map_size * sizeof(mapping_t));
+            memcpy(map, epoll->map, epoll->map_capacity * sizeof(mapping_t));
             new_epoll->map = map;
             new_epoll->map_size = epoll->map_size;
+            new_epoll->map_capacity = epoll->map_capacity;
         }
 
         *new_epoll_out = &new_epoll->base;
@@ -903,15 +930,7 @@ static void _epoll_on_close(oe_fd_t* epoll_, int fd)
     oe_mutex_lock(&epoll->lock);
 
     /* Delete the mapping if it exists. */
-    for (size_t i = 0; i < epoll->map_size; i++)
-    {
-        if (epoll->map[i].fd == fd)
-        {
-            /* Swap with last element of array. */
-            epoll->map[i] = epoll->map[--epoll->map_size];
-            break;
-        }
-    }
+    _map_remove(epoll, fd);
 
     oe_mutex_unlock(&epoll->lock);
 }
@@ -0,0 +1,1306 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+/*
+**==============================================================================
+**
+** hostfs page cache:
+**
+**     Files opened on a hostfs mount with the OE_MS_HOSTFS_CACHE flag are
+**     read and written through this cache, so that small reads and writes do
+**     not each make an ocall.
+**
+**     The cache holds page-sized blocks of file data, up to a byte budget
+**     given at mount time, and evicts the least recently used page when it is
+**     full. A read that misses loads several pages with one pread() when the
+**     file is being read sequentially; the read-ahead window doubles on each
+**     sequential miss and falls back to a single page on random access.
+**
+**     Writes only update the cached pages. Dirty pages are written back when
+**     they are evicted, and on fsync() and close(). Runs of adjacent dirty
+**     pages are written back with a single pwrite().
+**
+**     Pages are shared by all the descriptors that refer to the same host
+**     file (same st_dev and st_ino), so the descriptors see each other's
+**     writes. Writes of O_APPEND descriptors go to the end of the file as
+**     known to the cache, which includes data not yet written back. The
+**     cache assumes that the host files are not changed by anyone but the
+**     enclave while they are open.
+**
+**==============================================================================
+*/
+
+// clang-format off
+#include <openenclave/enclave.h>
+// clang-format on
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/syscall/fcntl.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include <openenclave/internal/thread.h>
+
+#include "cache.h"
+#include "syscall_t.h"
+
+#define PAGE_SIZE OE_PAGE_SIZE
+
+/* Mask to extract the access mode: O_RDONLY, O_WRONLY, O_RDWR. */
+#define ACCESS_MODE_MASK 000000003
+
+/* Used when the mount does not specify a byte budget. */
+#define DEFAULT_MAX_BYTES (1024 * 1024)
+
+/* Maximum number of pages read or written back with one ocall. */
+#define MAX_IO_PAGES 32
+
+typedef struct _inode inode_t;
+
+typedef struct _page
+{
+    /* Chains of the hash table, of the LRU list and of the inode's pages. */
+    struct _page* hash_next;
+    struct _page* lru_prev;
+    struct _page* lru_next;
+    struct _page* inode_prev;
+    struct _page* inode_next;
+
+    inode_t* inode;
+    uint64_t index;
+
+    /* The range [dirty_start, dirty_end) has not been written back. */
+    size_t dirty_start;
+    size_t dirty_end;
+
+    /* A writable host descriptor of the file for the write-back. */
+    oe_host_fd_t writer_fd;
+
+    /* The bytes past the end of the file are zero. */
+    uint8_t data[PAGE_SIZE];
+} page_t;
+
+/* A writable host descriptor of an inode. */
+typedef struct _writer
+{
+    struct _writer* next;
+    oe_host_fd_t host_fd;
+} writer_t;
+
+struct _inode
+{
+    struct _inode* next;
+
+    /* Identity of the host file, or zero if the host does not provide one. */
+    uint64_t dev;
+    uint64_t ino;
+
+    /* Number of cached files referring to this inode. */
+    uint64_t refcount;
+
+    /* The size of the file, including data not yet written back. */
+    oe_off_t size;
+
+    page_t* pages;
+    size_t num_dirty;
+
+    /* The open writable host descriptors of the file, which are the only
+     * ones that pages may be written back through. */
+    writer_t* writers;
+};
+
+struct _oe_hostfs_cached_file
+{
+    oe_hostfs_cache_t* cache;
+    inode_t* inode;
+
+    /* Number of descriptors sharing this file. */
+    uint64_t refcount;
+
+    /* The open flags. Only OE_O_APPEND may change, through fcntl(). */
+    int flags;
+    oe_off_t offset;
+
+    /* The page that a sequential read would miss next. */
+    uint64_t ra_next;
+
+    /* Number of pages loaded by the next sequential miss. */
+    size_t ra_pages;
+};
+
+struct _oe_hostfs_cache
+{
+    oe_mutex_t lock;
+
+    /* One reference for the mount and one per inode. */
+    uint64_t refcount;
+
+    size_t max_pages;
+    size_t num_pages;
+    size_t max_ra_pages;
+
+    page_t** buckets;
+    size_t num_buckets;
+
+    /* Most recently used page first. */
+    page_t* lru_head;
+    page_t* lru_tail;
+
+    /* Evicted and truncated pages available for reuse. */
+    page_t* free_pages;
+
+    inode_t* inodes;
+
+    /* Staging buffer for ocalls covering several pages. */
+    uint8_t* buffer;
+};
+
+OE_INLINE size_t _min(size_t x, size_t y)
+{
+    return x < y ? x : y;
+}
+
+/*
+**==============================================================================
+**
+** Page management. These functions are called with the cache lock held.
+**
+**==============================================================================
+*/
+
+static size_t _hash(
+    const oe_hostfs_cache_t* cache,
+    const inode_t* inode,
+    uint64_t index)
+{
+    uint64_t h = ((uint64_t)(uintptr_t)inode >> 4) ^
+                 (index * 0x9e3779b97f4a7c15);
+    return (size_t)(h ^ (h >> 32)) & (cache->num_buckets - 1);
+}
+
+static void _lru_remove(oe_hostfs_cache_t* cache, page_t* page)
+{
+    if (page->lru_prev)
+        page->lru_prev->lru_next = page->lru_next;
+    else
+        cache->lru_head = page->lru_next;
+
+    if (page->lru_next)
+        page->lru_next->lru_prev = page->lru_prev;
+    else
+        cache->lru_tail = page->lru_prev;
+
+    page->lru_prev = NULL;
+    page->lru_next = NULL;
+}
+
+static void _lru_push(oe_hostfs_cache_t* cache, page_t* page)
+{
+    page->lru_prev = NULL;
+    page->lru_next = cache->lru_head;
+
+    if (cache->lru_head)
+        cache->lru_head->lru_prev = page;
+    else
+        cache->lru_tail = page;
+
+    cache->lru_head = page;
+}
+
+static page_t* _find_page(
+    oe_hostfs_cache_t* cache,
+    inode_t* inode,
+    uint64_t index)
+{
+    page_t* page = cache->buckets[_hash(cache, inode, index)];
+
+    while (page && (page->inode != inode || page->index != index))
+        page = page->hash_next;
+
+    return page;
+}
+
+static page_t* _get_page(
+    oe_hostfs_cache_t* cache,
+    inode_t* inode,
+    uint64_t index)
+{
+    page_t* page = _find_page(cache, inode, index);
+
+    if (page && page != cache->lru_head)
+    {
+        _lru_remove(cache, page);
+        _lru_push(cache, page);
+    }
+
+    return page;
+}
+
+OE_INLINE bool _is_dirty(const page_t* page)
+{
+    return page->dirty_end > page->dirty_start;
+}
+
+/* Whether the dirty data of the page continues on the next page. */
+OE_INLINE bool _continues(const page_t* page, const page_t* next)
+{
+    return next && _is_dirty(page) && _is_dirty(next) &&
+           page->dirty_end == PAGE_SIZE && next->dirty_start == 0;
+}
+
+static void _clean_page(page_t* page)
+{
+    if (_is_dirty(page))
+        page->inode->num_dirty--;
+
+    page->dirty_start = 0;
+    page->dirty_end = 0;
+}
+
+/* Insert a page obtained from _alloc_page() for the given file position. */
+static void _insert_page(
+    oe_hostfs_cache_t* cache,
+    page_t* page,
+    inode_t* inode,
+    uint64_t index)
+{
+    size_t bucket = _hash(cache, inode, index);
+
+    page->inode = inode;
+    page->index = index;
+    page->dirty_start = 0;
+    page->dirty_end = 0;
+
+    page->hash_next = cache->buckets[bucket];
+    cache->buckets[bucket] = page;
+
+    page->inode_prev = NULL;
+    page->inode_next = inode->pages;
+    if (inode->pages)
+        inode->pages->inode_prev = page;
+    inode->pages = page;
+
+    _lru_push(cache, page);
+}
+
+/* Remove a page from the cache, discarding any data not written back, and
+ * put it on the free list. */
+static void _remove_page(oe_hostfs_cache_t* cache, page_t* page)
+{
+    inode_t* inode = page->inode;
+    page_t** p = &cache->buckets[_hash(cache, inode, page->index)];
+
+    while (*p != page)
+        p = &(*p)->hash_next;
+    *p = page->hash_next;
+
+    if (page->inode_prev)
+        page->inode_prev->inode_next = page->inode_next;
+    else
+        inode->pages = page->inode_next;
+
+    if (page->inode_next)
+        page->inode_next->inode_prev = page->inode_prev;
+
+    _lru_remove(cache, page);
+    _clean_page(page);
+
+    page->inode = NULL;
+    page->hash_next = cache->free_pages;
+    cache->free_pages = page;
+}
+
+/* Write [offset, offset + count) back to the host. */
+static int _write_back(
+    oe_host_fd_t host_fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    int ret = -1;
+    ssize_t retval = -1;
+
+    if (oe_syscall_pwrite_ocall(&retval, host_fd, buf, count, offset) !=
+        OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (retval == -1)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (retval != (ssize_t)count)
+        OE_RAISE_ERRNO(OE_EIO);
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Write back the run of adjacent dirty pages starting with first. Runs longer
+ * than MAX_IO_PAGES are written with several ocalls. */
+static int _flush_run(oe_hostfs_cache_t* cache, page_t* first)
+{
+    int ret = -1;
+    page_t* page = first;
+
+    while (page)
+    {
+        inode_t* inode = page->inode;
+        page_t* run[MAX_IO_PAGES];
+        size_t n = 0;
+        size_t size = 0;
+        const void* buf;
+        oe_off_t offset =
+            (oe_off_t)(page->index * PAGE_SIZE + page->dirty_start);
+
+        run[n++] = page;
+        while (n < MAX_IO_PAGES)
+        {
+            page_t* next = _find_page(cache, inode, run[n - 1]->index + 1);
+
+            if (!_continues(run[n - 1], next))
+                break;
+
+            run[n++] = next;
+        }
+
+        if (n == 1)
+        {
+            buf = page->data + page->dirty_start;
+            size = page->dirty_end - page->dirty_start;
+        }
+        else
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                size_t len = run[i]->dirty_end - run[i]->dirty_start;
+                memcpy(
+                    cache->buffer + size,
+                    run[i]->data + run[i]->dirty_start,
+                    len);
+                size += len;
+            }
+
+            buf = cache->buffer;
+        }
+
+        if (_write_back(page->writer_fd, buf, size, offset) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        /* Continue with the rest of the run, if any. */
+        page = _find_page(cache, inode, run[n - 1]->index + 1);
+        if (!_continues(run[n - 1], page))
+            page = NULL;
+
+        for (size_t i = 0; i < n; i++)
+            _clean_page(run[i]);
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Write back all the dirty pages of the inode. */
+static int _flush_inode(oe_hostfs_cache_t* cache, inode_t* inode)
+{
+    int ret = -1;
+
+    for (page_t* page = inode->pages; page && inode->num_dirty;)
+    {
+        page_t* next = page->inode_next;
+
+        /* Pages in the middle of a run are written with the first one. */
+        if (_is_dirty(page) &&
+            (page->index == 0 ||
+             !_continues(
+                 _find_page(cache, inode, page->index - 1), page)))
+        {
+            if (_flush_run(cache, page) != 0)
+                OE_RAISE_ERRNO(oe_errno);
+        }
+
+        page = next;
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Make the dirty pages that are written back through host_fd use another
+ * writable descriptor of the inode, or discard them if there is none. Called
+ * before host_fd is closed. */
+static void _replace_writer(
+    oe_hostfs_cache_t* cache,
+    inode_t* inode,
+    oe_host_fd_t host_fd)
+{
+    for (page_t* page = inode->pages; page;)
+    {
+        page_t* next = page->inode_next;
+
+        if (_is_dirty(page) && page->writer_fd == host_fd)
+        {
+            if (inode->writers)
+                page->writer_fd = inode->writers->host_fd;
+            else
+                _remove_page(cache, page);
+        }
+
+        page = next;
+    }
+}
+
+/* Get an unused page, evicting the least recently used one if the cache is
+ * full. The page is not in the cache until _insert_page() is called. */
+static page_t* _alloc_page(oe_hostfs_cache_t* cache)
+{
+    page_t* page = NULL;
+
+    if ((page = cache->free_pages))
+    {
+        cache->free_pages = page->hash_next;
+        return page;
+    }
+
+    if (cache->num_pages < cache->max_pages)
+    {
+        if (!(page = oe_malloc(sizeof(page_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        cache->num_pages++;
+        return page;
+    }
+
+    if (!(page = cache->lru_tail))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    /* Write back the whole inode so that the run of the page is coalesced. */
+    if (_is_dirty(page) && _flush_inode(cache, page->inode) != 0)
+    {
+        page = NULL;
+        OE_RAISE_ERRNO(oe_errno);
+    }
+
+    _remove_page(cache, page);
+    cache->free_pages = page->hash_next;
+
+done:
+    return page;
+}
+
+static void _free_page(oe_hostfs_cache_t* cache, page_t* page)
+{
+    page->hash_next = cache->free_pages;
+    cache->free_pages = page;
+}
+
+/* Load up to n missing pages starting at index with a single pread(). The
+ * pages past the end of the file or already cached are not loaded. Returns
+ * the page at index. */
+static page_t* _load_pages(
+    oe_hostfs_cache_t* cache,
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    uint64_t index,
+    size_t n)
+{
+    page_t* ret = NULL;
+    inode_t* inode = file->inode;
+    page_t* pages[MAX_IO_PAGES];
+    size_t num_pages = 0;
+    uint64_t end = ((uint64_t)inode->size + PAGE_SIZE - 1) / PAGE_SIZE;
+    ssize_t retval = -1;
+
+    /* Read-ahead must not evict the pages it is loading. */
+    if (n > cache->max_ra_pages)
+        n = cache->max_ra_pages;
+
+    if (index >= end)
+        n = 1;
+    else if (n > end - index)
+        n = (size_t)(end - index);
+
+    for (size_t i = 1; i < n; i++)
+    {
+        if (_find_page(cache, inode, index + i))
+        {
+            n = i;
+            break;
+        }
+    }
+
+    /* Allocate the pages first, since eviction may use the buffer. */
+    for (; num_pages < n; num_pages++)
+    {
+        if (!(pages[num_pages] = _alloc_page(cache)))
+            OE_RAISE_ERRNO(oe_errno);
+    }
+
+    if (oe_syscall_pread_ocall(
+            &retval,
+            host_fd,
+            cache->buffer,
+            n * PAGE_SIZE,
+            (oe_off_t)(index * PAGE_SIZE)) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (retval == -1)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* The host must not return more than was requested. */
+    if (retval > (ssize_t)(n * PAGE_SIZE))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Data written past the end of the host file and not yet written back
+     * lies in other pages, so the part of the pages not read is zero. */
+    for (size_t i = 0; i < n; i++)
+    {
+        page_t* page = pages[i];
+        size_t offset = i * PAGE_SIZE;
+        size_t length = 0;
+
+        if ((size_t)retval > offset)
+            length = _min((size_t)retval - offset, PAGE_SIZE);
+
+        memcpy(page->data, cache->buffer + offset, length);
+        memset(page->data + length, 0, PAGE_SIZE - length);
+
+        _insert_page(cache, page, inode, index + i);
+        pages[i] = NULL;
+    }
+
+    ret = _find_page(cache, inode, index);
+
+done:
+
+    for (size_t i = 0; i < num_pages; i++)
+    {
+        if (pages[i])
+            _free_page(cache, pages[i]);
+    }
+
+    return ret;
+}
+
+/* Drop the pages at or past length and zero the tail of the last page. */
+static void _truncate_inode(
+    oe_hostfs_cache_t* cache,
+    inode_t* inode,
+    oe_off_t length)
+{
+    for (page_t* page = inode->pages; page;)
+    {
+        page_t* next = page->inode_next;
+        uint64_t start = page->index * PAGE_SIZE;
+
+        if (start >= (uint64_t)length)
+        {
+            _remove_page(cache, page);
+        }
+        else if ((uint64_t)length - start < PAGE_SIZE)
+        {
+            size_t cut = (size_t)((uint64_t)length - start);
+
+            memset(page->data + cut, 0, PAGE_SIZE - cut);
+
+            if (page->dirty_end > cut)
+            {
+                if (page->dirty_start >= cut)
+                    _clean_page(page);
+                else
+                    page->dirty_end = cut;
+            }
+        }
+
+        page = next;
+    }
+
+    inode->size = length;
+}
+
+/*
+**==============================================================================
+**
+** Cache and file management.
+**
+**==============================================================================
+*/
+
+/* Allocate the writer of a descriptor opened with the given flags, or return
+ * NULL with *err set to zero if the descriptor is read-only. */
+static writer_t* _new_writer(oe_host_fd_t host_fd, int flags, int* err)
+{
+    writer_t* writer = NULL;
+
+    *err = 0;
+
+    if ((flags & ACCESS_MODE_MASK) == OE_O_RDONLY)
+        return NULL;
+
+    if (!(writer = oe_calloc(1, sizeof(writer_t))))
+        *err = OE_ENOMEM;
+    else
+        writer->host_fd = host_fd;
+
+    return writer;
+}
+
+/* Called with the cache lock held. */
+static void _remove_writer(inode_t* inode, oe_host_fd_t host_fd)
+{
+    for (writer_t** p = &inode->writers; *p; p = &(*p)->next)
+    {
+        if ((*p)->host_fd == host_fd)
+        {
+            writer_t* writer = *p;
+
+            *p = writer->next;
+            oe_free(writer);
+            break;
+        }
+    }
+}
+
+oe_hostfs_cache_t* oe_hostfs_cache_new(size_t max_bytes)
+{
+    oe_hostfs_cache_t* ret = NULL;
+    oe_hostfs_cache_t* cache = NULL;
+
+    if (max_bytes == 0)
+        max_bytes = DEFAULT_MAX_BYTES;
+
+    if (!(cache = oe_calloc(1, sizeof(oe_hostfs_cache_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    cache->refcount = 1;
+    cache->max_pages = max_bytes / PAGE_SIZE;
+
+    /* Read-ahead must not evict the pages it has just loaded. */
+    if (cache->max_pages < 4)
+        cache->max_pages = 4;
+
+    cache->max_ra_pages = _min(cache->max_pages / 4, MAX_IO_PAGES);
+
+    cache->num_buckets = 64;
+    while (cache->num_buckets < cache->max_pages)
+        cache->num_buckets *= 2;
+
+    if (!(cache->buckets = oe_calloc(cache->num_buckets, sizeof(page_t*))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    if (!(cache->buffer = oe_malloc(MAX_IO_PAGES * PAGE_SIZE)))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    ret = cache;
+    cache = NULL;
+
+done:
+
+    if (cache)
+    {
+        oe_free(cache->buckets);
+        oe_free(cache);
+    }
+
+    return ret;
+}
+
+void oe_hostfs_cache_release(oe_hostfs_cache_t* cache)
+{
+    if (!cache || __atomic_sub_fetch(&cache->refcount, 1, __ATOMIC_ACQ_REL))
+        return;
+
+    /* All the inodes are gone, so only free pages remain. */
+    while (cache->free_pages)
+    {
+        page_t* next = cache->free_pages->hash_next;
+        oe_free(cache->free_pages);
+        cache->free_pages = next;
+    }
+
+    oe_mutex_destroy(&cache->lock);
+    oe_free(cache->buffer);
+    oe_free(cache->buckets);
+    oe_free(cache);
+}
+
+oe_hostfs_cached_file_t* oe_hostfs_cache_open(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t host_fd,
+    int flags)
+{
+    oe_hostfs_cached_file_t* ret = NULL;
+    oe_hostfs_cached_file_t* file = NULL;
+    inode_t* inode = NULL;
+    writer_t* writer = NULL;
+    struct oe_stat_t st;
+    int retval = -1;
+    int err;
+    bool locked = false;
+
+    if (!cache)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (oe_syscall_fstat_ocall(&retval, host_fd, &st) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (retval != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (st.st_size < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(file = oe_calloc(1, sizeof(oe_hostfs_cached_file_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    if (!(writer = _new_writer(host_fd, flags, &err)) && err)
+        OE_RAISE_ERRNO(err);
+
+    oe_mutex_lock(&cache->lock);
+    locked = true;
+
+    /* Hosts that do not provide inode numbers get a private inode. */
+    if (st.st_ino)
+    {
+        for (inode = cache->inodes; inode; inode = inode->next)
+        {
+            if (inode->dev == st.st_dev && inode->ino == st.st_ino)
+                break;
+        }
+    }
+
+    if (inode)
+    {
+        /* The host has already truncated the file. */
+        if ((flags & OE_O_TRUNC))
+            _truncate_inode(cache, inode, 0);
+    }
+    else
+    {
+        if (!(inode = oe_calloc(1, sizeof(inode_t))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        inode->dev = st.st_dev;
+        inode->ino = st.st_ino;
+        inode->size = st.st_size;
+        inode->next = cache->inodes;
+        cache->inodes = inode;
+
+        __atomic_add_fetch(&cache->refcount, 1, __ATOMIC_RELAXED);
+    }
+
+    inode->refcount++;
+
+    if (writer)
+    {
+        writer->next = inode->writers;
+        inode->writers = writer;
+        writer = NULL;
+    }
+
+    file->cache = cache;
+    file->inode = inode;
+    file->refcount = 1;
+    file->flags = flags;
+    file->ra_pages = 1;
+
+    ret = file;
+    file = NULL;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&cache->lock);
+
+    if (file)
+        oe_free(file);
+
+    if (writer)
+        oe_free(writer);
+
+    return ret;
+}
+
+oe_hostfs_cached_file_t* oe_hostfs_cache_dup(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd)
+{
+    writer_t* writer;
+    int err;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(writer = _new_writer(host_fd, file->flags, &err)) && err)
+        OE_RAISE_ERRNO(err);
+
+    oe_mutex_lock(&file->cache->lock);
+    {
+        if (writer)
+        {
+            writer->next = file->inode->writers;
+            file->inode->writers = writer;
+        }
+
+        __atomic_add_fetch(&file->refcount, 1, __ATOMIC_RELAXED);
+    }
+    oe_mutex_unlock(&file->cache->lock);
+
+    return file;
+
+done:
+    return NULL;
+}
+
+int oe_hostfs_cache_close(oe_hostfs_cached_file_t* file, oe_host_fd_t host_fd)
+{
+    int ret = -1;
+    oe_hostfs_cache_t* cache;
+    inode_t* inode;
+    bool release = false;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    cache = file->cache;
+    inode = file->inode;
+
+    oe_mutex_lock(&cache->lock);
+    {
+        /* The descriptor may be the writer of dirty pages. */
+        ret = _flush_inode(cache, inode);
+
+        /* If some pages could not be written back, the others must not be
+         * written back later through the host descriptor being closed. */
+        _remove_writer(inode, host_fd);
+        _replace_writer(cache, inode, host_fd);
+
+        if (__atomic_sub_fetch(&file->refcount, 1, __ATOMIC_ACQ_REL) == 0)
+        {
+            oe_free(file);
+
+            if (--inode->refcount == 0)
+            {
+                /* Discard the pages that could not be written back. */
+                while (inode->pages)
+                    _remove_page(cache, inode->pages);
+
+                for (inode_t** p = &cache->inodes; *p; p = &(*p)->next)
+                {
+                    if (*p == inode)
+                    {
+                        *p = inode->next;
+                        break;
+                    }
+                }
+
+                oe_free(inode);
+                release = true;
+            }
+        }
+    }
+    oe_mutex_unlock(&cache->lock);
+
+    if (release)
+        oe_hostfs_cache_release(cache);
+
+done:
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** File operations.
+**
+**==============================================================================
+*/
+
+/* Called with the cache lock held. */
+static ssize_t _pread(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    oe_hostfs_cache_t* cache = file->cache;
+    inode_t* inode = file->inode;
+    uint8_t* p = (uint8_t*)buf;
+    size_t done = 0;
+
+    if ((file->flags & ACCESS_MODE_MASK) == OE_O_WRONLY)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    if (offset < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (offset >= inode->size || count == 0)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    if ((uint64_t)(inode->size - offset) < count)
+        count = (size_t)(inode->size - offset);
+
+    while (done < count)
+    {
+        uint64_t pos = (uint64_t)offset + done;
+        uint64_t index = pos / PAGE_SIZE;
+        size_t off = pos % PAGE_SIZE;
+        size_t n = _min(PAGE_SIZE - off, count - done);
+        page_t* page;
+
+        if (!(page = _get_page(cache, inode, index)))
+        {
+            /* Load at least the rest of the request. */
+            size_t pages = (off + count - done + PAGE_SIZE - 1) / PAGE_SIZE;
+
+            if (index == file->ra_next)
+                file->ra_pages = _min(file->ra_pages * 2, cache->max_ra_pages);
+            else
+                file->ra_pages = 1;
+
+            if (!(page = _load_pages(
+                      cache,
+                      file,
+                      host_fd,
+                      index,
+                      pages > file->ra_pages ? pages : file->ra_pages)))
+            {
+                if (done)
+                    break;
+
+                OE_RAISE_ERRNO(oe_errno);
+            }
+        }
+
+        memcpy(p + done, page->data + off, n);
+        done += n;
+        file->ra_next = index + 1;
+    }
+
+    ret = (ssize_t)done;
+
+done:
+    return ret;
+}
+
+/* Called with the cache lock held. */
+static ssize_t _pwrite(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    oe_hostfs_cache_t* cache = file->cache;
+    inode_t* inode = file->inode;
+    const uint8_t* p = (const uint8_t*)buf;
+    const bool readable = (file->flags & ACCESS_MODE_MASK) != OE_O_WRONLY;
+    size_t done = 0;
+
+    if ((file->flags & ACCESS_MODE_MASK) == OE_O_RDONLY)
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    /* As on Linux, appends ignore the offset, even that of pwrite(). */
+    if ((file->flags & OE_O_APPEND))
+        offset = inode->size;
+
+    if (offset < 0 || (uint64_t)offset + count > (uint64_t)OE_INT64_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    while (done < count)
+    {
+        uint64_t pos = (uint64_t)offset + done;
+        uint64_t index = pos / PAGE_SIZE;
+        size_t off = pos % PAGE_SIZE;
+        size_t n = _min(PAGE_SIZE - off, count - done);
+        page_t* page;
+
+        if (!(page = _get_page(cache, inode, index)))
+        {
+            uint64_t start = index * PAGE_SIZE;
+
+            if (n == PAGE_SIZE || start >= (uint64_t)inode->size)
+            {
+                /* The page is overwritten or new, so it need not be read. */
+                if (!(page = _alloc_page(cache)))
+                    break;
+
+                memset(page->data, 0, PAGE_SIZE);
+                _insert_page(cache, page, inode, index);
+            }
+            else if (readable)
+            {
+                if (!(page = _load_pages(cache, file, host_fd, index, 1)))
+                    break;
+            }
+            else
+            {
+                /* The rest of the page cannot be read, so write through. */
+                if (_write_back(host_fd, p + done, n, (oe_off_t)pos) != 0)
+                    break;
+
+                done += n;
+
+                if ((oe_off_t)pos + (oe_off_t)n > inode->size)
+                    inode->size = (oe_off_t)pos + (oe_off_t)n;
+
+                continue;
+            }
+        }
+
+        memcpy(page->data + off, p + done, n);
+
+        if (_is_dirty(page))
+        {
+            if (off < page->dirty_start)
+                page->dirty_start = off;
+
+            if (off + n > page->dirty_end)
+                page->dirty_end = off + n;
+        }
+        else
+        {
+            page->dirty_start = off;
+            page->dirty_end = off + n;
+            inode->num_dirty++;
+        }
+
+        page->writer_fd = host_fd;
+        done += n;
+
+        if ((oe_off_t)pos + (oe_off_t)n > inode->size)
+            inode->size = (oe_off_t)pos + (oe_off_t)n;
+    }
+
+    /* On failure, report the bytes written so far like a short write. */
+    if (done == 0 && count)
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = (ssize_t)done;
+
+done:
+    return ret;
+}
+
+ssize_t oe_hostfs_cache_pread(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+
+    if (!file || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&file->cache->lock);
+    ret = _pread(file, host_fd, buf, count, offset);
+    oe_mutex_unlock(&file->cache->lock);
+
+done:
+    return ret;
+}
+
+ssize_t oe_hostfs_cache_pwrite(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+
+    if (!file || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&file->cache->lock);
+    ret = _pwrite(file, host_fd, buf, count, offset);
+    oe_mutex_unlock(&file->cache->lock);
+
+done:
+    return ret;
+}
+
+ssize_t oe_hostfs_cache_read(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    void* buf,
+    size_t count)
+{
+    ssize_t ret = -1;
+
+    if (!file || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&file->cache->lock);
+    {
+        if ((ret = _pread(file, host_fd, buf, count, file->offset)) > 0)
+            file->offset += ret;
+    }
+    oe_mutex_unlock(&file->cache->lock);
+
+done:
+    return ret;
+}
+
+ssize_t oe_hostfs_cache_write(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    const void* buf,
+    size_t count)
+{
+    ssize_t ret = -1;
+
+    if (!file || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&file->cache->lock);
+    {
+        oe_off_t offset = (file->flags & OE_O_APPEND) ? file->inode->size
+                                                      : file->offset;
+
+        if ((ret = _pwrite(file, host_fd, buf, count, offset)) > 0)
+            file->offset = offset + ret;
+    }
+    oe_mutex_unlock(&file->cache->lock);
+
+done:
+    return ret;
+}
+
+oe_off_t oe_hostfs_cache_lseek(
+    oe_hostfs_cached_file_t* file,
+    oe_off_t offset,
+    int whence)
+{
+    oe_off_t ret = -1;
+    oe_off_t base = 0;
+    bool locked = false;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&file->cache->lock);
+    locked = true;
+
+    switch (whence)
+    {
+        case OE_SEEK_SET:
+            base = 0;
+            break;
+        case OE_SEEK_CUR:
+            base = file->offset;
+            break;
+        case OE_SEEK_END:
+            base = file->inode->size;
+            break;
+        default:
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    if ((offset > 0 && base > OE_INT64_MAX - offset) || base + offset < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    file->offset = base + offset;
+    ret = file->offset;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&file->cache->lock);
+
+    return ret;
+}
+
+bool oe_hostfs_cache_get_append(oe_hostfs_cached_file_t* file)
+{
+    bool ret = false;
+
+    if (!file)
+        return false;
+
+    oe_mutex_lock(&file->cache->lock);
+    ret = (file->flags & OE_O_APPEND) != 0;
+    oe_mutex_unlock(&file->cache->lock);
+
+    return ret;
+}
+
+void oe_hostfs_cache_set_append(oe_hostfs_cached_file_t* file, bool append)
+{
+    if (!file)
+        return;
+
+    oe_mutex_lock(&file->cache->lock);
+    {
+        if (append)
+            file->flags |= OE_O_APPEND;
+        else
+            file->flags &= ~OE_O_APPEND;
+    }
+    oe_mutex_unlock(&file->cache->lock);
+}
+
+int oe_hostfs_cache_flush(oe_hostfs_cached_file_t* file)
+{
+    int ret = -1;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&file->cache->lock);
+    ret = _flush_inode(file->cache, file->inode);
+    oe_mutex_unlock(&file->cache->lock);
+
+done:
+    return ret;
+}
+
+oe_off_t oe_hostfs_cache_get_size(oe_hostfs_cached_file_t* file)
+{
+    oe_off_t ret = -1;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&file->cache->lock);
+    ret = file->inode->size;
+    oe_mutex_unlock(&file->cache->lock);
+
+done:
+    return ret;
+}
+
+void oe_hostfs_cache_truncate(
+    oe_hostfs_cache_t* cache,
+    const struct oe_stat_t* st,
+    oe_off_t length)
+{
+    if (!cache || !st || !st->st_ino || length < 0)
+        return;
+
+    oe_mutex_lock(&cache->lock);
+    {
+        for (inode_t* inode = cache->inodes; inode; inode = inode->next)
+        {
+            if (inode->dev == st->st_dev && inode->ino == st->st_ino)
+            {
+                _truncate_inode(cache, inode, length);
+                break;
+            }
+        }
+    }
+    oe_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,98 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_DEVICES_HOSTFS_CACHE_H
+#define _OE_SYSCALL_DEVICES_HOSTFS_CACHE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/edl/syscall_types.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/corelibc/bits/types.h>
+#include <openenclave/internal/syscall/sys/stat.h>
+
+OE_EXTERNC_BEGIN
+
+/* The page cache of a hostfs mount with the OE_MS_HOSTFS_CACHE flag. */
+typedef struct _oe_hostfs_cache oe_hostfs_cache_t;
+
+/* The cache state of an open file, shared by the descriptors that dup()
+ * creates for it. */
+typedef struct _oe_hostfs_cached_file oe_hostfs_cached_file_t;
+
+/* Create a cache holding at most max_bytes of file data. */
+oe_hostfs_cache_t* oe_hostfs_cache_new(size_t max_bytes);
+
+/* Release the reference of the mount. The cache lives on while open files
+ * still use it. */
+void oe_hostfs_cache_release(oe_hostfs_cache_t* cache);
+
+/* Start caching the host file that was just opened with the given flags. */
+oe_hostfs_cached_file_t* oe_hostfs_cache_open(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t host_fd,
+    int flags);
+
+/* Share the cached file with a descriptor created by dup(), whose host
+ * descriptor is host_fd. */
+oe_hostfs_cached_file_t* oe_hostfs_cache_dup(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd);
+
+/* Flush the file and release the reference of the descriptor being closed,
+ * before its host descriptor host_fd is closed. Dirty pages that cannot be
+ * written back through another open descriptor of the file are discarded if
+ * the flush fails. */
+int oe_hostfs_cache_close(oe_hostfs_cached_file_t* file, oe_host_fd_t host_fd);
+
+ssize_t oe_hostfs_cache_read(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    void* buf,
+    size_t count);
+
+ssize_t oe_hostfs_cache_write(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    const void* buf,
+    size_t count);
+
+ssize_t oe_hostfs_cache_pread(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    void* buf,
+    size_t count,
+    oe_off_t offset);
+
+ssize_t oe_hostfs_cache_pwrite(
+    oe_hostfs_cached_file_t* file,
+    oe_host_fd_t host_fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset);
+
+oe_off_t oe_hostfs_cache_lseek(
+    oe_hostfs_cached_file_t* file,
+    oe_off_t offset,
+    int whence);
+
+/* Whether writes of the file go to its end (O_APPEND). */
+bool oe_hostfs_cache_get_append(oe_hostfs_cached_file_t* file);
+
+void oe_hostfs_cache_set_append(oe_hostfs_cached_file_t* file, bool append);
+
+/* Write the dirty pages of the file back to the host. */
+int oe_hostfs_cache_flush(oe_hostfs_cached_file_t* file);
+
+/* Get the size of the file, including data not yet written back. */
+oe_off_t oe_hostfs_cache_get_size(oe_hostfs_cached_file_t* file);
+
+/* Update the cached pages of the host file described by st after it has been
+ * truncated to length bytes. */
+void oe_hostfs_cache_truncate(
+    oe_hostfs_cache_t* cache,
+    const struct oe_stat_t* st,
+    oe_off_t length);
+
+OE_EXTERNC_END
+
+#endif /* _OE_SYSCALL_DEVICES_HOSTFS_CACHE_H */
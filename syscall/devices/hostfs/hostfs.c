@@ -36,6 +36,7 @@
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/internal/safecrt.h>
 
+#include "cache.h"
 #include "syscall_t.h"
 
 #define FS_MAGIC 0x5f35f964
@@ -45,6 +46,9 @@
 /* Mask to extract the access mode: O_RDONLY, O_WRONLY, O_RDWR. */
 #define ACCESS_MODE_MASK 000000003
 
+/* Number of directory entries obtained from the host with one ocall. */
+#define DIR_BATCH_SIZE 64
+
 /* The host file system device. */
 typedef struct _device
 {
@@ -63,6 +67,9 @@ typedef struct _device
         char source[OE_PATH_MAX];
         char target[OE_PATH_MAX];
     } mount;
+
+    /* The page cache if mounted with OE_MS_HOSTFS_CACHE. */
+    oe_hostfs_cache_t* cache;
 } device_t;
 
 /* Create by open(). */
@@ -78,6 +85,9 @@ typedef struct _file
 
     /* The file descriptor for an open directory if non-null. */
     oe_fd_t* dir;
+
+    /* The cache state if the file is accessed through the page cache. */
+    oe_hostfs_cached_file_t* cached;
 } file_t;
 
 /* Created by opendir(), updated by readdir(), closed by closedir(). */
@@ -93,6 +103,17 @@ typedef struct _dir
 
     /* The directory entry obtained from the host by readdir(). */
     struct oe_dirent entry;
+
+    /* Entries obtained from the host but not yet returned by readdir(). */
+    struct oe_dirent* entries;
+    size_t num_entries;
+    size_t next_entry;
+
+    /* True if the host has no more entries. */
+    bool eof;
+
+    /* True if the host does not provide oe_syscall_readdir_batch_ocall(). */
+    bool no_batch;
 } dir_t;
 
 static oe_file_ops_t _get_file_ops(void);
@@ -214,13 +235,12 @@ static int _hostfs_mount(
     if (oe_strcmp(filesystemtype, OE_DEVICE_NAME_HOST_FILE_SYSTEM) != 0)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* The data parameter is not supported for host file systems. */
-    if (data)
+    /* The data parameter is only supported to configure the cache. */
+    if (data && !(flags & OE_MS_HOSTFS_CACHE))
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* Remember whether this is a read-only mount. */
-    if ((flags & OE_MS_RDONLY))
-        fs->mount.flags = flags;
+    /* Remember whether this is a read-only or cached mount. */
+    fs->mount.flags = flags;
 
     /* ---------------------------------------------------------------------
      * Only support absolute paths. Hostfs is treated as an external
@@ -237,6 +257,15 @@ static int _hostfs_mount(
     /* Save the target parameter (checked by the umount2() function). */
     oe_strlcpy(fs->mount.target, target, sizeof(fs->mount.target));
 
+    if ((flags & OE_MS_HOSTFS_CACHE))
+    {
+        const oe_hostfs_cache_options_t* options = data;
+        size_t max_bytes = options ? options->max_bytes : 0;
+
+        if (!(fs->cache = oe_hostfs_cache_new(max_bytes)))
+            OE_RAISE_ERRNO(oe_errno);
+    }
+
     /* Set the flag indicating that this file system is mounted. */
     fs->is_mounted = true;
 
@@ -269,6 +298,10 @@ static int _hostfs_umount2(oe_device_t* device, const char* target, int flags)
     /* Clear the cached mount parameters. */
     oe_memset_s(&fs->mount, sizeof(fs->mount), 0, sizeof(fs->mount));
 
+    /* Files that are still open keep the cache alive. */
+    oe_hostfs_cache_release(fs->cache);
+    fs->cache = NULL;
+
     /* Set the flag indicating that this file system is mounted. */
     fs->is_mounted = false;
 
@@ -292,6 +325,7 @@ static int _hostfs_clone(oe_device_t* device, oe_device_t** new_device)
         OE_RAISE_ERRNO(OE_ENOMEM);
 
     *new_fs = *fs;
+    new_fs->cache = NULL;
     *new_device = &new_fs->base;
 
     ret = 0;
@@ -309,6 +343,7 @@ static int _hostfs_release(oe_device_t* device)
     if (!fs)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    oe_hostfs_cache_release(fs->cache);
     oe_free(fs);
     ret = 0;
 
@@ -348,10 +383,15 @@ static oe_fd_t* _hostfs_open_file(
 
     /* Ask the host to open the file. */
     {
+        /* The cache finds the end of the file for appends, and writes back
+         * its pages at their own offsets. */
+        int host_flags = fs->cache ? (flags & ~OE_O_APPEND) : flags;
+
         if (_make_host_path(fs, pathname, host_path) != 0)
             OE_RAISE_ERRNO_MSG(oe_errno, "pathname=%s", pathname);
 
-        if (oe_syscall_open_ocall(&retval, host_path, flags, mode) != OE_OK)
+        if (oe_syscall_open_ocall(&retval, host_path, host_flags, mode) !=
+            OE_OK)
             OE_RAISE_ERRNO(OE_EINVAL);
 
         if (retval < 0)
@@ -360,6 +400,18 @@ static oe_fd_t* _hostfs_open_file(
         file->host_fd = retval;
     }
 
+    if (fs->cache)
+    {
+        if (!(file->cached = oe_hostfs_cache_open(fs->cache, retval, flags)))
+        {
+            int err = oe_errno;
+            int close_retval;
+
+            oe_syscall_close_ocall(&close_retval, file->host_fd);
+            OE_RAISE_ERRNO(err);
+        }
+    }
+
     ret = &file->base;
     file = NULL;
 
@@ -461,6 +513,9 @@ static int _hostfs_fsync(oe_fd_t* desc)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached && oe_hostfs_cache_flush(file->cached) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
     if (oe_syscall_fsync_ocall(&ret, file->host_fd) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -476,6 +531,9 @@ static int _hostfs_fdatasync(oe_fd_t* desc)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached && oe_hostfs_cache_flush(file->cached) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
     if (oe_syscall_fdatasync_ocall(&ret, file->host_fd) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -521,6 +579,18 @@ static int _hostfs_dup(oe_fd_t* desc, oe_fd_t** new_file_out)
         new_file->host_fd = retval;
     }
 
+    /* Like the host file offset, the cache state is shared. */
+    if (file->cached &&
+        !(new_file->cached =
+              oe_hostfs_cache_dup(file->cached, new_file->host_fd)))
+    {
+        int err = oe_errno;
+        int close_retval;
+
+        oe_syscall_close_ocall(&close_retval, new_file->host_fd);
+        OE_RAISE_ERRNO(err);
+    }
+
     *new_file_out = &new_file->base;
     new_file = NULL;
     ret = 0;
@@ -549,6 +619,12 @@ static ssize_t _hostfs_read(oe_fd_t* desc, void* buf, size_t count)
     if (!file || count > OE_SSIZE_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = oe_hostfs_cache_read(file->cached, file->host_fd, buf, count);
+        goto done;
+    }
+
     /* Call the host to perform the read(). */
     if (oe_syscall_read_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -628,6 +704,12 @@ static ssize_t _hostfs_write(oe_fd_t* desc, const void* buf, size_t count)
     if (!file || (count && !buf) || count > OE_SSIZE_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = oe_hostfs_cache_write(file->cached, file->host_fd, buf, count);
+        goto done;
+    }
+
     /* Call the host. */
     if (oe_syscall_write_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -646,6 +728,84 @@ done:
     return ret;
 }
 
+/* Perform readv() through the page cache, one element at a time. */
+static ssize_t _hostfs_cached_readv(
+    file_t* file,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = -1;
+    size_t total = 0;
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n;
+
+        if (iov[i].iov_len > OE_SSIZE_MAX - total)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        n = oe_hostfs_cache_read(
+            file->cached, file->host_fd, iov[i].iov_base, iov[i].iov_len);
+
+        if (n < 0)
+        {
+            if (total)
+                break;
+
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        total += (size_t)n;
+
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    return ret;
+}
+
+/* Perform writev() through the page cache, one element at a time. */
+static ssize_t _hostfs_cached_writev(
+    file_t* file,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = -1;
+    size_t total = 0;
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n;
+
+        if (iov[i].iov_len > OE_SSIZE_MAX - total)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        n = oe_hostfs_cache_write(
+            file->cached, file->host_fd, iov[i].iov_base, iov[i].iov_len);
+
+        if (n < 0)
+        {
+            if (total)
+                break;
+
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        total += (size_t)n;
+
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    return ret;
+}
+
 static ssize_t _hostfs_readv(
     oe_fd_t* desc,
     const struct oe_iovec* iov,
@@ -660,6 +820,12 @@ static ssize_t _hostfs_readv(
     if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = _hostfs_cached_readv(file, iov, iovcnt);
+        goto done;
+    }
+
     /* Flatten the IO vector into contiguous heap memory. */
     if (oe_iov_pack(iov, iovcnt, &buf, &buf_size, &data_size) != 0)
         OE_RAISE_ERRNO(OE_ENOMEM);
@@ -721,6 +887,12 @@ static ssize_t _hostfs_writev(
     if (!file || !iov || iovcnt < 0 || iovcnt > OE_IOV_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = _hostfs_cached_writev(file, iov, iovcnt);
+        goto done;
+    }
+
     /* Flatten the IO vector into contiguous heap memory. */
     if (oe_iov_pack(iov, iovcnt, &buf, &buf_size, &data_size) != 0)
         OE_RAISE_ERRNO(OE_ENOMEM);
@@ -769,6 +941,13 @@ static oe_off_t _hostfs_lseek_file(oe_fd_t* desc, oe_off_t offset, int whence)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* The host file offset is not used by cached files. */
+    if (file->cached)
+    {
+        ret = oe_hostfs_cache_lseek(file->cached, offset, whence);
+        goto done;
+    }
+
     if (oe_syscall_lseek_ocall(&ret, file->host_fd, offset, whence) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -788,6 +967,11 @@ static int _hostfs_rewinddir(oe_fd_t* desc)
     if (oe_syscall_rewinddir_ocall(dir->host_dir) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Discard the entries obtained before the rewind. */
+    dir->num_entries = 0;
+    dir->next_entry = 0;
+    dir->eof = false;
+
     ret = 0;
 
 done:
@@ -847,6 +1031,13 @@ static ssize_t _hostfs_pread(
     if (!file || count > OE_SSIZE_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = oe_hostfs_cache_pread(
+            file->cached, file->host_fd, buf, count, offset);
+        goto done;
+    }
+
     if (oe_syscall_pread_ocall(&ret, file->host_fd, buf, count, offset) !=
         OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -885,6 +1076,13 @@ static ssize_t _hostfs_pwrite(
     if (!file || count > OE_SSIZE_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached)
+    {
+        ret = oe_hostfs_cache_pwrite(
+            file->cached, file->host_fd, buf, count, offset);
+        goto done;
+    }
+
     if (oe_syscall_pwrite_ocall(&ret, file->host_fd, buf, count, offset) !=
         OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -907,11 +1105,22 @@ static int _hostfs_close_file(oe_fd_t* desc)
 {
     int ret = -1;
     int retval = -1;
+    int flush_errno = 0;
     file_t* file = _cast_file(desc);
 
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Write back the cached data while the host descriptor is open. A failure
+     * is reported after the descriptor is closed, as the host would. */
+    if (file->cached)
+    {
+        if (oe_hostfs_cache_close(file->cached, file->host_fd) != 0)
+            flush_errno = oe_errno;
+
+        file->cached = NULL;
+    }
+
     if (oe_syscall_close_ocall(&retval, file->host_fd) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -920,6 +1129,9 @@ static int _hostfs_close_file(oe_fd_t* desc)
 
     oe_free(file);
 
+    if (flush_errno)
+        OE_RAISE_ERRNO(flush_errno);
+
     ret = retval;
 
 done:
@@ -1005,6 +1217,7 @@ static int _hostfs_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
     file_t* file = _cast_file(desc);
     void* argout = NULL;
     uint64_t argsize = 0;
+    uint64_t host_arg = arg;
 
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -1056,10 +1269,23 @@ static int _hostfs_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
             OE_RAISE_ERRNO(OE_EINVAL);
     }
 
+    /* The host descriptor of a cached file is never in append mode, see
+     * _hostfs_open_file(). The cache keeps the flag instead. */
+    if (file->cached && cmd == OE_F_SETFL)
+        host_arg &= ~(uint64_t)OE_O_APPEND;
+
     if (oe_syscall_fcntl_ocall(
-            &ret, file->host_fd, cmd, arg, argsize, argout) != OE_OK)
+            &ret, file->host_fd, cmd, host_arg, argsize, argout) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cached && ret != -1)
+    {
+        if (cmd == OE_F_SETFL)
+            oe_hostfs_cache_set_append(file->cached, arg & OE_O_APPEND);
+        else if (cmd == OE_F_GETFL && oe_hostfs_cache_get_append(file->cached))
+            ret |= OE_O_APPEND;
+    }
+
 done:
     return ret;
 }
@@ -1104,7 +1330,59 @@ done:
     return ret;
 }
 
-/* Get the next directory entry from the host. */
+/* Refill the entry buffer of the directory from the host. Returns 1 if the
+ * host does not provide the batch ocall. */
+static int _hostfs_refill_dir(dir_t* dir)
+{
+    int ret = -1;
+    ssize_t retval = -1;
+    oe_result_t result;
+
+    if (!dir->entries)
+    {
+        dir->entries = oe_malloc(DIR_BATCH_SIZE * sizeof(struct oe_dirent));
+
+        if (!dir->entries)
+            OE_RAISE_ERRNO(OE_ENOMEM);
+    }
+
+    dir->num_entries = 0;
+    dir->next_entry = 0;
+
+    result = oe_syscall_readdir_batch_ocall(
+        &retval, dir->host_dir, dir->entries, DIR_BATCH_SIZE);
+
+    if (result == OE_UNSUPPORTED)
+    {
+        dir->no_batch = true;
+        ret = 1;
+        goto done;
+    }
+
+    if (result != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (retval == -1)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* The host must not return more entries than requested. */
+    if (retval < 0 || retval > DIR_BATCH_SIZE)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    for (ssize_t i = 0; i < retval; i++)
+        dir->entries[i].d_name[sizeof(dir->entries[i].d_name) - 1] = '\0';
+
+    dir->num_entries = (size_t)retval;
+    dir->eof = (retval == 0);
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Get the next directory entry, refilling the entry buffer from the host with
+ * one ocall when it is empty. */
 static struct oe_dirent* _hostfs_readdir(oe_fd_t* desc)
 {
     struct oe_dirent* ret = NULL;
@@ -1114,7 +1392,22 @@ static struct oe_dirent* _hostfs_readdir(oe_fd_t* desc)
     if (!dir)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* Call the host to get the next directory entry. */
+    if (!dir->no_batch && dir->next_entry == dir->num_entries && !dir->eof)
+    {
+        if (_hostfs_refill_dir(dir) == -1)
+            OE_RAISE_ERRNO(oe_errno);
+    }
+
+    if (!dir->no_batch)
+    {
+        /* If end of file, then return NULL. */
+        if (dir->next_entry < dir->num_entries)
+            ret = &dir->entries[dir->next_entry++];
+
+        goto done;
+    }
+
+    /* The host only provides one entry per call. */
     if (oe_syscall_readdir_ocall(&retval, dir->host_dir, &dir->entry) != OE_OK)
     {
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -1152,6 +1445,7 @@ static int _hostfs_closedir(oe_fd_t* desc)
     if (oe_syscall_closedir_ocall(&retval, dir->host_dir) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    oe_free(dir->entries);
     oe_free(dir);
 
     ret = retval;
@@ -1205,6 +1499,10 @@ static int _hostfs_fstat(oe_fd_t* desc, struct oe_stat_t* buf)
     if (oe_syscall_fstat_ocall(&retval, file->host_fd, buf) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* The file may have grown with data not yet written back. */
+    if (retval == 0 && file->cached)
+        buf->st_size = oe_hostfs_cache_get_size(file->cached);
+
     ret = retval;
 
 done:
@@ -1352,6 +1650,19 @@ static int _hostfs_truncate(
     if (oe_syscall_truncate_ocall(&retval, host_path, length) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Drop the cached data past the new end of the file, if any. */
+    if (retval == 0 && fs->cache)
+    {
+        struct oe_stat_t st;
+        int stat_retval = -1;
+
+        if (oe_syscall_stat_ocall(&stat_retval, host_path, &st) == OE_OK &&
+            stat_retval == 0)
+        {
+            oe_hostfs_cache_truncate(fs->cache, &st, length);
+        }
+    }
+
     ret = retval;
 
 done:
@@ -1420,7 +1731,20 @@ static oe_host_fd_t _hostfs_get_host_fd(oe_fd_t* desc)
 {
     file_t* file = _cast_file(desc);
 
-    return file ? file->host_fd : -1;
+    if (!file)
+        return -1;
+
+    /* Lookups such as poll() must not write the cache back. The data and
+     * the file offset of a cached file live in the enclave, so callers that
+     * let the host move data check _hostfs_is_cached() first. */
+    return file->host_fd;
+}
+
+static bool _hostfs_is_cached(oe_fd_t* desc)
+{
+    file_t* file = _cast_file(desc);
+
+    return file && file->cached;
 }
 
 // clang-format off
@@ -1443,6 +1767,7 @@ static oe_file_ops_t _file_ops =
     .fstat = _hostfs_fstat,
     .fsync = _hostfs_fsync,
     .fdatasync = _hostfs_fdatasync,
+    .is_cached = _hostfs_is_cached,
 };
 // clang-format on
 
@@ -0,0 +1,763 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+
+#include <openenclave/corelibc/limits.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/syscall/fcntl.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/syscall/ioring.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+#include "syscall_t.h"
+
+/*
+**==============================================================================
+**
+** The host I/O ring device.
+**
+** A ring is created by the host, which allocates its memory and starts its
+** workers (see openenclave/internal/syscall/ioring.h). Everything the enclave
+** relies on is kept in enclave memory: the ring geometry, the positions it
+** produces and consumes, and the slot of each operation in flight, which
+** records the enclave buffer, the user data, and the descriptor reference of
+** the operation. The host only returns slot numbers and results, which are
+** checked before any data is copied into the enclave.
+**
+**==============================================================================
+*/
+
+#define DEVICE_MAGIC 0x10a1e5c7
+#define RING_MAGIC 0x5a1a3b2d
+
+/* Number of times a reaper polls the completion ring before it asks the host
+ * to wait. */
+#define REAP_SPIN_COUNT 4096
+
+typedef struct _device
+{
+    struct _oe_device base;
+
+    /* Should be DEVICE_MAGIC */
+    uint32_t magic;
+} device_t;
+
+typedef struct _slot
+{
+    bool in_use;
+    uint32_t opcode;
+    void* addr;
+    uint32_t len;
+    uint64_t user_data;
+
+    /* The reference taken by oe_fdtable_get(), or NULL for no-ops. */
+    oe_fd_t* desc;
+} slot_t;
+
+typedef struct _ring
+{
+    oe_fd_t base;
+
+    /* Should be RING_MAGIC */
+    uint32_t magic;
+
+    /* The handle returned by oe_syscall_io_ring_setup_ocall(). */
+    uint64_t handle;
+
+    /* Host memory. */
+    oe_io_ring_header_t* header;
+    oe_io_ring_host_sqe_t* sq;
+    oe_io_ring_host_cqe_t* cq;
+    uint8_t* data;
+
+    uint32_t num_entries;
+    uint32_t buffer_size;
+
+    /* Serializes submitters. */
+    oe_mutex_t submit_lock;
+    uint64_t sq_tail;
+
+    /* Serializes reapers. */
+    oe_mutex_t reap_lock;
+    uint64_t cq_head;
+
+    /* Slots of the operations, indexed by the slot numbers of the rings. */
+    oe_spinlock_t slots_lock;
+    slot_t* slots;
+    uint32_t* free_slots;
+    uint32_t num_free_slots;
+} ring_t;
+
+static oe_io_ring_ops_t _get_ring_ops(void);
+
+static device_t* _cast_device(const oe_device_t* device_)
+{
+    device_t* device = (device_t*)device_;
+
+    if (device == NULL || device->magic != DEVICE_MAGIC)
+        return NULL;
+
+    return device;
+}
+
+static ring_t* _cast_ring(const oe_fd_t* ring_)
+{
+    ring_t* ring = (ring_t*)ring_;
+
+    if (ring == NULL || ring->magic != RING_MAGIC)
+        return NULL;
+
+    return ring;
+}
+
+static void _free_ring(ring_t* ring)
+{
+    if (ring->handle)
+    {
+        int retval;
+        oe_syscall_io_ring_teardown_ocall(&retval, ring->handle);
+    }
+
+    /* The teardown returns once the host workers have exited, so the host no
+     * longer uses the descriptors of the operations still in flight. Their
+     * completions are abandoned. */
+    for (uint32_t i = 0; ring->slots && i < ring->num_entries; i++)
+    {
+        if (ring->slots[i].in_use && ring->slots[i].desc)
+            oe_fdtable_put(ring->slots[i].desc);
+    }
+
+    oe_free(ring->slots);
+    oe_free(ring->free_slots);
+    oe_free(ring);
+}
+
+static oe_fd_t* _io_ring_setup(
+    oe_device_t* device_,
+    const struct oe_io_ring_params* params)
+{
+    oe_fd_t* ret = NULL;
+    device_t* device = _cast_device(device_);
+    ring_t* ring = NULL;
+    uint32_t num_entries = OE_IO_RING_DEFAULT_ENTRIES;
+    uint32_t buffer_size = OE_IO_RING_DEFAULT_BUFFER_SIZE;
+    uint32_t num_workers = OE_IO_RING_DEFAULT_WORKERS;
+    uint64_t addr = 0;
+
+    oe_errno = 0;
+
+    if (!device)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (params)
+    {
+        if (params->entries)
+            num_entries = params->entries;
+
+        if (params->buffer_size)
+            buffer_size = params->buffer_size;
+
+        if (params->workers)
+            num_workers = params->workers;
+    }
+
+    if (num_entries > OE_IO_RING_MAX_ENTRIES ||
+        buffer_size > OE_IO_RING_MAX_BUFFER_SIZE ||
+        num_workers > OE_IO_RING_MAX_WORKERS)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(ring = oe_calloc(1, sizeof(ring_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    ring->base.type = OE_FD_TYPE_IO_RING;
+    ring->base.ops.io_ring = _get_ring_ops();
+    ring->magic = RING_MAGIC;
+    ring->num_entries = num_entries;
+    ring->buffer_size = buffer_size;
+
+    if (!(ring->slots = oe_calloc(num_entries, sizeof(slot_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    if (!(ring->free_slots = oe_calloc(num_entries, sizeof(uint32_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    /* Hand out the low slots first. */
+    for (uint32_t i = 0; i < num_entries; i++)
+        ring->free_slots[i] = num_entries - 1 - i;
+
+    ring->num_free_slots = num_entries;
+
+    if (oe_syscall_io_ring_setup_ocall(
+            &ring->handle, num_entries, buffer_size, num_workers, &addr) !=
+        OE_OK)
+    {
+        ring->handle = 0;
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    if (!ring->handle)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!oe_is_outside_enclave(
+            (void*)addr, oe_io_ring_size(num_entries, buffer_size)))
+        OE_RAISE_ERRNO(OE_EFAULT);
+
+    ring->header = (oe_io_ring_header_t*)addr;
+    ring->sq = (oe_io_ring_host_sqe_t*)(addr + oe_io_ring_sq_offset());
+    ring->cq =
+        (oe_io_ring_host_cqe_t*)(addr + oe_io_ring_cq_offset(num_entries));
+    ring->data = (uint8_t*)(addr + oe_io_ring_data_offset(num_entries));
+
+    ret = &ring->base;
+    ring = NULL;
+
+done:
+
+    if (ring)
+        _free_ring(ring);
+
+    return ret;
+}
+
+static int _check_sqe(const struct oe_io_ring_sqe* sqe, oe_fd_t* desc)
+{
+    int ret = -1;
+
+    switch (sqe->opcode)
+    {
+        case OE_IO_RING_OP_NOP:
+            break;
+
+        case OE_IO_RING_OP_READ:
+        case OE_IO_RING_OP_WRITE:
+            if (desc->type != OE_FD_TYPE_FILE &&
+                desc->type != OE_FD_TYPE_SOCKET)
+                OE_RAISE_ERRNO(OE_EBADF);
+            break;
+
+        case OE_IO_RING_OP_RECV:
+        case OE_IO_RING_OP_SEND:
+            if (desc->type != OE_FD_TYPE_SOCKET)
+                OE_RAISE_ERRNO(OE_ENOTSOCK);
+            break;
+
+        case OE_IO_RING_OP_FSYNC:
+            if (desc->type != OE_FD_TYPE_FILE)
+                OE_RAISE_ERRNO(OE_EINVAL);
+            break;
+
+        default:
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static bool _transfers_data(uint32_t opcode)
+{
+    return opcode == OE_IO_RING_OP_READ || opcode == OE_IO_RING_OP_WRITE ||
+           opcode == OE_IO_RING_OP_RECV || opcode == OE_IO_RING_OP_SEND;
+}
+
+static bool _reads_data(uint32_t opcode)
+{
+    return opcode == OE_IO_RING_OP_READ || opcode == OE_IO_RING_OP_RECV;
+}
+
+static int _alloc_slot(ring_t* ring, uint32_t* index)
+{
+    int ret = -1;
+
+    oe_spin_lock(&ring->slots_lock);
+
+    if (ring->num_free_slots)
+    {
+        *index = ring->free_slots[--ring->num_free_slots];
+        ret = 0;
+    }
+
+    oe_spin_unlock(&ring->slots_lock);
+
+    return ret;
+}
+
+static void _free_slot(ring_t* ring, uint32_t index)
+{
+    oe_spin_lock(&ring->slots_lock);
+    ring->free_slots[ring->num_free_slots++] = index;
+    oe_spin_unlock(&ring->slots_lock);
+}
+
+static uint32_t _num_in_flight(ring_t* ring)
+{
+    uint32_t n;
+
+    oe_spin_lock(&ring->slots_lock);
+    n = ring->num_entries - ring->num_free_slots;
+    oe_spin_unlock(&ring->slots_lock);
+
+    return n;
+}
+
+/* Write the entry to the submission ring without publishing it. Called with
+ * the submit lock held. */
+static int _queue_sqe(ring_t* ring, const struct oe_io_ring_sqe* sqe)
+{
+    int ret = -1;
+    oe_fd_t* desc = NULL;
+    oe_host_fd_t host_fd = -1;
+    uint32_t len = 0;
+    uint32_t index = 0;
+    slot_t* slot;
+    oe_io_ring_host_sqe_t* host_sqe;
+
+    if (sqe->opcode != OE_IO_RING_OP_NOP)
+    {
+        if (!(desc = oe_fdtable_get(sqe->fd, OE_FD_TYPE_ANY)))
+            OE_RAISE_ERRNO(oe_errno);
+
+        if (_check_sqe(sqe, desc) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        /* The host must not bypass the cache of the file. */
+        if (oe_fd_is_cached(desc))
+            OE_RAISE_ERRNO(OE_EBADF);
+
+        if ((host_fd = desc->ops.fd.get_host_fd(desc)) == -1)
+            OE_RAISE_ERRNO(OE_EBADF);
+    }
+
+    if (_transfers_data(sqe->opcode))
+    {
+        len = sqe->len < ring->buffer_size ? sqe->len : ring->buffer_size;
+
+        if (len && !sqe->addr)
+            OE_RAISE_ERRNO(OE_EFAULT);
+    }
+
+    if (_alloc_slot(ring, &index) != 0)
+        OE_RAISE_ERRNO_MSG(OE_EBUSY, "all ring entries are in flight", NULL);
+
+    slot = &ring->slots[index];
+    slot->in_use = true;
+    slot->opcode = sqe->opcode;
+    slot->addr = sqe->addr;
+    slot->len = len;
+    slot->user_data = sqe->user_data;
+    slot->desc = desc;
+    desc = NULL;
+
+    if (len && !_reads_data(sqe->opcode))
+        memcpy(ring->data + (size_t)index * ring->buffer_size, sqe->addr, len);
+
+    host_sqe = &ring->sq[ring->sq_tail % ring->num_entries];
+    host_sqe->opcode = sqe->opcode;
+    host_sqe->flags = sqe->flags;
+    host_sqe->slot = index;
+    host_sqe->len = len;
+    host_sqe->fd = host_fd;
+    host_sqe->offset = sqe->off;
+
+    ring->sq_tail++;
+    ret = 0;
+
+done:
+
+    if (desc)
+        oe_fdtable_put(desc);
+
+    return ret;
+}
+
+/* Wake the workers if they have gone to sleep */
+static void _wake_workers(ring_t* ring)
+{
+    int retval;
+
+    if (__atomic_load_n(&ring->header->sleeping_workers, __ATOMIC_SEQ_CST))
+        oe_syscall_io_ring_wake_ocall(&retval, ring->handle);
+}
+
+static int _ring_submit(
+    oe_fd_t* ring_,
+    const struct oe_io_ring_sqe* sqes,
+    unsigned int count)
+{
+    int ret = -1;
+    ring_t* ring = _cast_ring(ring_);
+    unsigned int n = 0;
+
+    oe_errno = 0;
+
+    if (!ring || (!sqes && count) || count > OE_INT_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&ring->submit_lock);
+
+    for (; n < count; n++)
+    {
+        if (_queue_sqe(ring, &sqes[n]) != 0)
+            break;
+    }
+
+    if (n)
+    {
+        /* Publish the entries. A worker going to sleep counts itself in
+         * sleeping_workers before it checks sq_tail, so either it sees the
+         * entries or we see it asleep. */
+        __atomic_store_n(
+            &ring->header->sq_tail, ring->sq_tail, __ATOMIC_SEQ_CST);
+        _wake_workers(ring);
+    }
+
+    oe_mutex_unlock(&ring->submit_lock);
+
+    /* Report the error of the first entry only. */
+    if (n == 0 && count)
+        OE_RAISE_ERRNO(oe_errno);
+
+    oe_errno = 0;
+    ret = (int)n;
+
+done:
+    return ret;
+}
+
+/* Check the completion the host posted at the head of the completion ring,
+ * copy its data into the enclave, and release its slot. */
+static int _complete(ring_t* ring, struct oe_io_ring_cqe* cqe)
+{
+    int ret = -1;
+    oe_io_ring_host_cqe_t host_cqe;
+    slot_t* slot;
+    int64_t res;
+
+    /* Copy the host-controlled fields before checking them. */
+    memcpy(
+        &host_cqe,
+        &ring->cq[ring->cq_head % ring->num_entries],
+        sizeof(host_cqe));
+
+    if (host_cqe.slot >= ring->num_entries)
+        OE_RAISE_ERRNO(OE_EIO);
+
+    slot = &ring->slots[host_cqe.slot];
+
+    if (!slot->in_use)
+        OE_RAISE_ERRNO(OE_EIO);
+
+    if ((res = host_cqe.res) < 0)
+        res = host_cqe.err > 0 ? -(int64_t)host_cqe.err : -OE_EIO;
+    else if (res > (int64_t)slot->len)
+        res = -OE_EIO;
+    else if (res && _reads_data(slot->opcode))
+        memcpy(
+            slot->addr,
+            ring->data + (size_t)host_cqe.slot * ring->buffer_size,
+            (size_t)res);
+
+    cqe->user_data = slot->user_data;
+    cqe->res = res;
+
+    if (slot->desc)
+        oe_fdtable_put(slot->desc);
+
+    memset(slot, 0, sizeof(slot_t));
+    _free_slot(ring, host_cqe.slot);
+
+    ring->cq_head++;
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Wait for the completion at the head of the completion ring. */
+static int _wait(ring_t* ring)
+{
+    int ret = -1;
+    const oe_io_ring_host_cqe_t* host_cqe =
+        &ring->cq[ring->cq_head % ring->num_entries];
+    int retval = -1;
+
+    for (size_t i = 0; i < REAP_SPIN_COUNT; i++)
+    {
+        if (__atomic_load_n(&host_cqe->seq, __ATOMIC_ACQUIRE) ==
+            ring->cq_head + 1)
+            return 0;
+
+        OE_CPU_RELAX();
+    }
+
+    /* The workers may have missed a wakeup if a wake ocall failed. */
+    _wake_workers(ring);
+
+    if (oe_syscall_io_ring_wait_ocall(&retval, ring->handle, ring->cq_head) !=
+        OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (retval != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static int _ring_reap(
+    oe_fd_t* ring_,
+    struct oe_io_ring_cqe* cqes,
+    unsigned int count,
+    unsigned int min_complete)
+{
+    int ret = -1;
+    ring_t* ring = _cast_ring(ring_);
+    unsigned int n = 0;
+    bool locked = false;
+
+    oe_errno = 0;
+
+    if (!ring || (!cqes && count) || count > OE_INT_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&ring->reap_lock);
+    locked = true;
+
+    while (n < count)
+    {
+        const oe_io_ring_host_cqe_t* host_cqe =
+            &ring->cq[ring->cq_head % ring->num_entries];
+
+        if (__atomic_load_n(&host_cqe->seq, __ATOMIC_ACQUIRE) !=
+            ring->cq_head + 1)
+        {
+            if (n >= min_complete || _num_in_flight(ring) == 0)
+                break;
+
+            if (_wait(ring) != 0)
+            {
+                if (n == 0)
+                    OE_RAISE_ERRNO(oe_errno);
+                break;
+            }
+
+            continue;
+        }
+
+        if (_complete(ring, &cqes[n]) != 0)
+        {
+            if (n == 0)
+                OE_RAISE_ERRNO(oe_errno);
+            break;
+        }
+
+        n++;
+    }
+
+    oe_errno = 0;
+    ret = (int)n;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&ring->reap_lock);
+
+    return ret;
+}
+
+static ssize_t _ring_read(oe_fd_t* desc, void* buf, size_t count)
+{
+    OE_UNUSED(desc);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    oe_errno = OE_EINVAL;
+    return -1;
+}
+
+static ssize_t _ring_write(oe_fd_t* desc, const void* buf, size_t count)
+{
+    OE_UNUSED(desc);
+    OE_UNUSED(buf);
+    OE_UNUSED(count);
+    oe_errno = OE_EINVAL;
+    return -1;
+}
+
+static ssize_t _ring_readv(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    OE_UNUSED(desc);
+    OE_UNUSED(iov);
+    OE_UNUSED(iovcnt);
+    oe_errno = OE_EINVAL;
+    return -1;
+}
+
+static ssize_t _ring_writev(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    OE_UNUSED(desc);
+    OE_UNUSED(iov);
+    OE_UNUSED(iovcnt);
+    oe_errno = OE_EINVAL;
+    return -1;
+}
+
+static int _ring_dup(oe_fd_t* desc, oe_fd_t** new_desc)
+{
+    OE_UNUSED(desc);
+    OE_UNUSED(new_desc);
+    oe_errno = OE_ENOTSUP;
+    return -1;
+}
+
+static int _ring_ioctl(oe_fd_t* desc, unsigned long request, uint64_t arg)
+{
+    OE_UNUSED(desc);
+    OE_UNUSED(request);
+    OE_UNUSED(arg);
+    oe_errno = OE_ENOTTY;
+    return -1;
+}
+
+static int _ring_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
+{
+    int ret = -1;
+    ring_t* ring = _cast_ring(desc);
+
+    OE_UNUSED(arg);
+
+    if (!ring)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    switch (cmd)
+    {
+        case OE_F_GETFD:
+        case OE_F_SETFD:
+        case OE_F_GETFL:
+        case OE_F_SETFL:
+            break;
+
+        default:
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static int _ring_close(oe_fd_t* desc)
+{
+    int ret = -1;
+    ring_t* ring = _cast_ring(desc);
+
+    oe_errno = 0;
+
+    if (!ring)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    _free_ring(ring);
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static oe_host_fd_t _ring_get_host_fd(oe_fd_t* desc)
+{
+    OE_UNUSED(desc);
+    return -1;
+}
+
+static int _io_ring_release(oe_device_t* device_)
+{
+    int ret = -1;
+    device_t* device = _cast_device(device_);
+
+    oe_errno = 0;
+
+    if (!device)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static oe_io_ring_ops_t _ring_ops = {
+    .fd.read = _ring_read,
+    .fd.write = _ring_write,
+    .fd.readv = _ring_readv,
+    .fd.writev = _ring_writev,
+    .fd.dup = _ring_dup,
+    .fd.ioctl = _ring_ioctl,
+    .fd.fcntl = _ring_fcntl,
+    .fd.close = _ring_close,
+    .fd.get_host_fd = _ring_get_host_fd,
+    .submit = _ring_submit,
+    .reap = _ring_reap,
+};
+
+static oe_io_ring_ops_t _get_ring_ops(void)
+{
+    return _ring_ops;
+}
+
+// clang-format off
+static device_t _device =
+{
+    .base.type = OE_DEVICE_TYPE_IO_RING,
+    .base.name = OE_DEVICE_NAME_HOST_IO_RING,
+    .base.ops.io_ring =
+    {
+        .base.release = _io_ring_release,
+        .io_ring_setup = _io_ring_setup,
+    },
+    .magic = DEVICE_MAGIC,
+};
+// clang-format on
+
+oe_result_t oe_load_module_host_io_ring(void)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+    static bool _loaded = false;
+
+    oe_spin_lock(&_lock);
+
+    if (!_loaded)
+    {
+        if (oe_device_table_set(OE_DEVID_HOST_IO_RING, &_device.base) != 0)
+        {
+            /* Do not propagate errno to caller. */
+            oe_errno = 0;
+            OE_RAISE(OE_FAILURE);
+        }
+
+        _loaded = true;
+    }
+
+    result = OE_OK;
+
+done:
+    oe_spin_unlock(&_lock);
+
+    return result;
+}
@@ -0,0 +1,510 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+/*
+**==============================================================================
+**
+** host resolver cache:
+**
+**     With the cache enabled by oe_configure_host_resolver_cache(), the
+**     results of getaddrinfo() are kept in the enclave, keyed by the node,
+**     the service and the hints of the lookup, so that a service resolving
+**     the same names over and over does not go to the host every time.
+**
+**     Successful lookups are reused for the configured time to live, and
+**     lookups of names that do not exist (EAI_NONAME, EAI_NODATA) for the
+**     negative time to live. Other failures, which may be transient, are not
+**     reused.
+**
+**     A thread that misses marks the entry as pending while it asks the host.
+**     Threads looking up the same key in the meantime wait for that lookup and
+**     share its result instead of issuing their own.
+**
+**     The least recently used entries are evicted when there are more than
+**     the configured maximum. Entries with a lookup in progress or with
+**     waiters are never evicted, so the cache may exceed its maximum by the
+**     number of concurrent lookups until they complete.
+**
+**     Every caller gets its own copy of the cached list.
+**
+**==============================================================================
+*/
+
+// clang-format off
+#include <openenclave/enclave.h>
+// clang-format on
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/syscall/netdb.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/time.h>
+
+#include "cache.h"
+
+#define NUM_BUCKETS 256
+
+#define MS_PER_SECOND 1000
+
+typedef struct _entry
+{
+    /* Chains of the hash table and of the LRU list. */
+    struct _entry* hash_next;
+    struct _entry* lru_prev;
+    struct _entry* lru_next;
+
+    /* The key. The strings are null when the lookup passed null. */
+    uint64_t hash;
+    char* node;
+    char* service;
+    bool has_hints;
+    int flags;
+    int family;
+    int socktype;
+    int protocol;
+
+    /* A host lookup for this key is in progress. */
+    bool pending;
+
+    /* Number of threads waiting for the pending lookup. */
+    size_t waiters;
+
+    /* The result of the last lookup, valid until expires (milliseconds since
+     * the Epoch). */
+    int result;
+    struct oe_addrinfo* res;
+    uint64_t expires;
+} entry_t;
+
+static oe_mutex_t _lock = OE_MUTEX_INITIALIZER;
+
+/* Broadcast when a pending lookup completes. */
+static oe_cond_t _done = OE_COND_INITIALIZER;
+
+/* Also read without the lock, to skip the cache when it is disabled. */
+static size_t _max_entries;
+
+static uint32_t _ttl;
+static uint32_t _negative_ttl;
+
+static entry_t* _buckets[NUM_BUCKETS];
+static size_t _num_entries;
+
+/* Incremented by each configuration, so that lookups that were in progress
+ * during it do not cache their results. */
+static uint64_t _generation;
+
+/* Most recently used entry first. */
+static entry_t* _lru_head;
+static entry_t* _lru_tail;
+
+/*
+**==============================================================================
+**
+** Entry management. These functions are called with the lock held.
+**
+**==============================================================================
+*/
+
+static uint64_t _hash_bytes(uint64_t h, const void* data, size_t size)
+{
+    const uint8_t* p = (const uint8_t*)data;
+
+    /* FNV-1a */
+    for (size_t i = 0; i < size; i++)
+    {
+        h ^= p[i];
+        h *= 0x100000001b3;
+    }
+
+    return h;
+}
+
+static uint64_t _hash_key(
+    const char* node,
+    const char* service,
+    const struct oe_addrinfo* hints)
+{
+    uint64_t h = 0xcbf29ce484222325;
+    uint8_t present = (uint8_t)((node ? 1 : 0) | (service ? 2 : 0));
+
+    h = _hash_bytes(h, &present, sizeof(present));
+
+    /* Include the null terminators, so that the two strings cannot be
+     * confused with each other. */
+    if (node)
+        h = _hash_bytes(h, node, oe_strlen(node) + 1);
+
+    if (service)
+        h = _hash_bytes(h, service, oe_strlen(service) + 1);
+
+    if (hints)
+    {
+        int fields[] = {hints->ai_flags,
+                        hints->ai_family,
+                        hints->ai_socktype,
+                        hints->ai_protocol};
+
+        h = _hash_bytes(h, fields, sizeof(fields));
+    }
+
+    return h;
+}
+
+OE_INLINE bool _strings_equal(const char* s1, const char* s2)
+{
+    if (!s1 || !s2)
+        return s1 == s2;
+
+    return oe_strcmp(s1, s2) == 0;
+}
+
+static bool _matches(
+    const entry_t* entry,
+    uint64_t hash,
+    const char* node,
+    const char* service,
+    const struct oe_addrinfo* hints)
+{
+    if (entry->hash != hash || entry->has_hints != (hints != NULL))
+        return false;
+
+    if (hints &&
+        (entry->flags != hints->ai_flags || entry->family != hints->ai_family ||
+         entry->socktype != hints->ai_socktype ||
+         entry->protocol != hints->ai_protocol))
+    {
+        return false;
+    }
+
+    return _strings_equal(entry->node, node) &&
+           _strings_equal(entry->service, service);
+}
+
+static void _lru_remove(entry_t* entry)
+{
+    if (entry->lru_prev)
+        entry->lru_prev->lru_next = entry->lru_next;
+    else
+        _lru_head = entry->lru_next;
+
+    if (entry->lru_next)
+        entry->lru_next->lru_prev = entry->lru_prev;
+    else
+        _lru_tail = entry->lru_prev;
+
+    entry->lru_prev = NULL;
+    entry->lru_next = NULL;
+}
+
+static void _lru_push(entry_t* entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = _lru_head;
+
+    if (_lru_head)
+        _lru_head->lru_prev = entry;
+    else
+        _lru_tail = entry;
+
+    _lru_head = entry;
+}
+
+static void _touch(entry_t* entry)
+{
+    if (entry != _lru_head)
+    {
+        _lru_remove(entry);
+        _lru_push(entry);
+    }
+}
+
+static entry_t* _find(
+    uint64_t hash,
+    const char* node,
+    const char* service,
+    const struct oe_addrinfo* hints)
+{
+    entry_t* entry = _buckets[hash % NUM_BUCKETS];
+
+    while (entry && !_matches(entry, hash, node, service, hints))
+        entry = entry->hash_next;
+
+    return entry;
+}
+
+static void _free_entry(entry_t* entry)
+{
+    oe_freeaddrinfo(entry->res);
+    oe_free(entry->node);
+    oe_free(entry->service);
+    oe_free(entry);
+}
+
+static entry_t* _insert(
+    uint64_t hash,
+    const char* node,
+    const char* service,
+    const struct oe_addrinfo* hints)
+{
+    entry_t* ret = NULL;
+    entry_t* entry = NULL;
+    size_t bucket = hash % NUM_BUCKETS;
+
+    if (!(entry = oe_calloc(1, sizeof(entry_t))))
+        goto done;
+
+    if (node && !(entry->node = oe_strdup(node)))
+        goto done;
+
+    if (service && !(entry->service = oe_strdup(service)))
+        goto done;
+
+    entry->hash = hash;
+
+    if (hints)
+    {
+        entry->has_hints = true;
+        entry->flags = hints->ai_flags;
+        entry->family = hints->ai_family;
+        entry->socktype = hints->ai_socktype;
+        entry->protocol = hints->ai_protocol;
+    }
+
+    entry->hash_next = _buckets[bucket];
+    _buckets[bucket] = entry;
+    _lru_push(entry);
+    _num_entries++;
+
+    ret = entry;
+    entry = NULL;
+
+done:
+
+    if (entry)
+        _free_entry(entry);
+
+    return ret;
+}
+
+static void _remove(entry_t* entry)
+{
+    entry_t** p = &_buckets[entry->hash % NUM_BUCKETS];
+
+    while (*p != entry)
+        p = &(*p)->hash_next;
+
+    *p = entry->hash_next;
+    _lru_remove(entry);
+    _num_entries--;
+    _free_entry(entry);
+}
+
+/* Evict the least recently used entries that are not in use until there are
+ * at most max_entries. */
+static void _trim(size_t max_entries)
+{
+    entry_t* entry = _lru_tail;
+
+    while (entry && _num_entries > max_entries)
+    {
+        entry_t* prev = entry->lru_prev;
+
+        if (!entry->pending && !entry->waiters)
+            _remove(entry);
+
+        entry = prev;
+    }
+}
+
+static uint64_t _expiry(int result, uint64_t now)
+{
+    uint32_t ttl;
+
+    if (now == (uint64_t)-1)
+        return 0;
+
+    if (result == 0)
+        ttl = _ttl;
+    else if (result == OE_EAI_NONAME || result == OE_EAI_NODATA)
+        ttl = _negative_ttl;
+    else
+        return 0;
+
+    return now + (uint64_t)ttl * MS_PER_SECOND;
+}
+
+/* Copy the cached result for a caller. */
+static int _copy_result(const entry_t* entry, struct oe_addrinfo** res)
+{
+    int ret = OE_EAI_MEMORY;
+    struct oe_addrinfo* head = NULL;
+    struct oe_addrinfo** tail = &head;
+    const struct oe_addrinfo* ai;
+
+    if (entry->result != 0)
+    {
+        ret = entry->result;
+        goto done;
+    }
+
+    for (ai = entry->res; ai; ai = ai->ai_next)
+    {
+        struct oe_addrinfo* p;
+
+        if (!(p = oe_calloc(1, sizeof(struct oe_addrinfo))))
+            goto done;
+
+        *tail = p;
+        tail = &p->ai_next;
+
+        p->ai_flags = ai->ai_flags;
+        p->ai_family = ai->ai_family;
+        p->ai_socktype = ai->ai_socktype;
+        p->ai_protocol = ai->ai_protocol;
+        p->ai_addrlen = ai->ai_addrlen;
+
+        if (ai->ai_addr)
+        {
+            if (!(p->ai_addr = oe_malloc(ai->ai_addrlen)))
+                goto done;
+
+            memcpy(p->ai_addr, ai->ai_addr, ai->ai_addrlen);
+        }
+
+        if (ai->ai_canonname &&
+            !(p->ai_canonname = oe_strdup(ai->ai_canonname)))
+        {
+            goto done;
+        }
+    }
+
+    *res = head;
+    head = NULL;
+    ret = 0;
+
+done:
+
+    if (head)
+        oe_freeaddrinfo(head);
+
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** Public functions.
+**
+**==============================================================================
+*/
+
+int oe_hostresolver_cache_configure(
+    const oe_host_resolver_cache_options_t* options)
+{
+    if (options && options->max_entries > OE_HOST_RESOLVER_CACHE_MAX_ENTRIES)
+        return -1;
+
+    oe_mutex_lock(&_lock);
+
+    _trim(0);
+    _generation++;
+
+    _ttl = options ? options->ttl : 0;
+    _negative_ttl = options ? options->negative_ttl : 0;
+    __atomic_store_n(
+        &_max_entries, options ? options->max_entries : 0, __ATOMIC_RELEASE);
+
+    oe_mutex_unlock(&_lock);
+
+    return 0;
+}
+
+int oe_hostresolver_cache_getaddrinfo(
+    oe_hostresolver_lookup_t lookup,
+    const char* node,
+    const char* service,
+    const struct oe_addrinfo* hints,
+    struct oe_addrinfo** res)
+{
+    int ret = OE_EAI_FAIL;
+    entry_t* entry;
+    struct oe_addrinfo* result = NULL;
+    uint64_t hash;
+    uint64_t now;
+    uint64_t generation;
+
+    if (!res || !__atomic_load_n(&_max_entries, __ATOMIC_ACQUIRE))
+        return lookup(node, service, hints, res);
+
+    *res = NULL;
+    hash = _hash_key(node, service, hints);
+    now = oe_get_time();
+
+    oe_mutex_lock(&_lock);
+
+    if ((entry = _find(hash, node, service, hints)))
+    {
+        _touch(entry);
+
+        if (entry->pending)
+        {
+            /* Share the result of the lookup in progress. */
+            entry->waiters++;
+
+            while (entry->pending)
+                oe_cond_wait(&_done, &_lock);
+
+            entry->waiters--;
+            ret = _copy_result(entry, res);
+            _trim(_max_entries);
+            goto done;
+        }
+
+        if (now < entry->expires)
+        {
+            ret = _copy_result(entry, res);
+            goto done;
+        }
+
+        /* The result has expired, so look it up again. */
+        oe_freeaddrinfo(entry->res);
+        entry->res = NULL;
+    }
+    else if (!(entry = _insert(hash, node, service, hints)))
+    {
+        oe_mutex_unlock(&_lock);
+        return lookup(node, service, hints, res);
+    }
+
+    entry->pending = true;
+    generation = _generation;
+    _trim(_max_entries);
+    oe_mutex_unlock(&_lock);
+
+    ret = lookup(node, service, hints, &result);
+    now = oe_get_time();
+
+    oe_mutex_lock(&_lock);
+
+    entry->pending = false;
+    entry->result = ret;
+    entry->res = result;
+    entry->expires = generation == _generation ? _expiry(ret, now) : 0;
+    oe_cond_broadcast(&_done);
+
+    ret = _copy_result(entry, res);
+    _trim(_max_entries);
+
+done:
+    oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+void oe_hostresolver_cache_release(void)
+{
+    oe_mutex_lock(&_lock);
+    _trim(0);
+    oe_mutex_unlock(&_lock);
+}
@@ -0,0 +1,40 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_DEVICES_HOSTRESOLVER_CACHE_H
+#define _OE_SYSCALL_DEVICES_HOSTRESOLVER_CACHE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/module.h>
+#include <openenclave/internal/syscall/netdb.h>
+
+OE_EXTERNC_BEGIN
+
+/* Performs a lookup on the host. */
+typedef int (*oe_hostresolver_lookup_t)(
+    const char* node,
+    const char* service,
+    const struct oe_addrinfo* hints,
+    struct oe_addrinfo** res);
+
+/* Replace the options of the cache and drop the cached results. A null
+ * options pointer or a max_entries of zero disables the cache. */
+int oe_hostresolver_cache_configure(
+    const oe_host_resolver_cache_options_t* options);
+
+/* Answer from the cache, or with the given lookup when the cache is disabled,
+ * misses or has expired. The result is always a new list, which the caller
+ * releases with oe_freeaddrinfo(). */
+int oe_hostresolver_cache_getaddrinfo(
+    oe_hostresolver_lookup_t lookup,
+    const char* node,
+    const char* service,
+    const struct oe_addrinfo* hints,
+    struct oe_addrinfo** res);
+
+/* Release the cached results. */
+void oe_hostresolver_cache_release(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_SYSCALL_DEVICES_HOSTRESOLVER_CACHE_H */
@@ -8,6 +8,7 @@
 // clang-format on
 
 #include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/raise.h>
 #include <openenclave/internal/syscall/raise.h>
 #include <openenclave/internal/syscall/sys/socket.h>
 #include <openenclave/internal/syscall/netdb.h>
@@ -21,6 +22,7 @@
 #include <openenclave/corelibc/string.h>
 #include <openenclave/bits/module.h>
 #include <openenclave/internal/trace.h>
+#include "cache.h"
 #include "syscall_t.h"
 
 #define RESOLV_MAGIC 0x536f636b
@@ -79,8 +81,8 @@ done:
     return ret;
 }
 
-static int _hostresolver_getaddrinfo(
-    oe_resolver_t* resolver,
+/* Look up the node and service on the host. */
+static int _getaddrinfo(
     const char* node,
     const char* service,
     const struct oe_addrinfo* hints,
@@ -92,8 +94,6 @@ static int _hostresolver_getaddrinfo(
     struct oe_addrinfo* tail = NULL;
     struct oe_addrinfo* p = NULL;
 
-    OE_UNUSED(resolver);
-
     if (res)
         *res = NULL;
 
@@ -315,6 +315,19 @@ done:
     return ret;
 }
 
+static int _hostresolver_getaddrinfo(
+    oe_resolver_t* resolver,
+    const char* node,
+    const char* service,
+    const struct oe_addrinfo* hints,
+    struct oe_addrinfo** res)
+{
+    OE_UNUSED(resolver);
+
+    return oe_hostresolver_cache_getaddrinfo(
+        _getaddrinfo, node, service, hints, res);
+}
+
 static int _hostresolver_release(oe_resolver_t* resolv_)
 {
     int ret = -1;
@@ -326,6 +339,7 @@ static int _hostresolver_release(oe_resolver_t* resolv_)
         OE_RAISE_ERRNO(OE_EINVAL);
 
     // resolv_ is a static object, there is no need to free
+    oe_hostresolver_cache_release();
     ret = 0;
 
 done:
@@ -373,3 +387,17 @@ done:
 
     return result;
 }
+
+oe_result_t oe_configure_host_resolver_cache(
+    const oe_host_resolver_cache_options_t* options)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (oe_hostresolver_cache_configure(options) != 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
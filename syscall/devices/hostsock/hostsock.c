@@ -18,6 +18,7 @@
 #include <openenclave/internal/syscall/iov.h>
 #include <openenclave/internal/syscall/fcntl.h>
 #include <openenclave/corelibc/stdlib.h>
+#include <openenclave/internal/calls.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/safecrt.h>
 #include "syscall_t.h"
@@ -27,6 +28,9 @@
 
 static oe_socket_ops_t _get_socket_ops(void);
 
+/* True if the enclave does not import oe_syscall_recv_host_buffer_ocall(). */
+static bool _no_recv_host_buffer;
+
 typedef struct _device
 {
     struct _oe_device base;
@@ -346,6 +350,8 @@ static ssize_t _hostsock_recv(
 {
     ssize_t ret = -1;
     sock_t* sock = _cast_sock(sock_);
+    void* host_buf = NULL;
+    oe_result_t result;
 
     oe_errno = 0;
 
@@ -360,10 +366,36 @@ static ssize_t _hostsock_recv(
     if (!sock || (count && !buf) || count > OE_SSIZE_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    if (buf)
+    /*
+     * Receive into a host staging buffer, so that only the bytes received
+     * are copied into the enclave. Marshalling buf as an [out] parameter
+     * copies all count bytes, however few arrive.
+     */
+    if (count && !__atomic_load_n(&_no_recv_host_buffer, __ATOMIC_RELAXED) &&
+        (host_buf = oe_allocate_ocall_staging_buffer(count)))
     {
-        if (oe_memset_s(buf, count, 0, count) != OE_OK)
+        result = oe_syscall_recv_host_buffer_ocall(
+            &ret, sock->host_fd, host_buf, count, flags);
+
+        if (result == OE_OK)
+        {
+            /* The host must not report more bytes than it was given. */
+            if (ret > (ssize_t)count ||
+                (ret > 0 &&
+                 oe_memcpy_s(buf, count, host_buf, (size_t)ret) != OE_OK))
+            {
+                ret = -1;
+                OE_RAISE_ERRNO(OE_EINVAL);
+            }
+
+            goto done;
+        }
+
+        if (result != OE_UNSUPPORTED)
             OE_RAISE_ERRNO(OE_EINVAL);
+
+        /* The enclave does not import the ocall. */
+        __atomic_store_n(&_no_recv_host_buffer, true, __ATOMIC_RELAXED);
     }
 
     if (oe_syscall_recv_ocall(&ret, sock->host_fd, buf, count, flags) != OE_OK)
@@ -380,6 +412,7 @@ static ssize_t _hostsock_recv(
     }
 
 done:
+    oe_free_ocall_staging_buffer(host_buf);
     return ret;
 }
 
@@ -106,7 +106,7 @@ void oe_rewinddir(OE_DIR* dir)
 int oe_getdents64(unsigned int fd, struct oe_dirent* dirp, unsigned int count)
 {
     int ret = -1;
-    oe_fd_t* file;
+    oe_fd_t* file = NULL;
 
     if (!(file = oe_fdtable_get((int)fd, OE_FD_TYPE_FILE)))
         OE_RAISE_ERRNO(oe_errno);
@@ -114,5 +114,8 @@ int oe_getdents64(unsigned int fd, struct oe_dirent* dirp, unsigned int count)
     ret = file->ops.file.getdents64(file, dirp, count);
 
 done:
+    if (file)
+        oe_fdtable_put(file);
+
     return ret;
 }
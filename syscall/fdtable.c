@@ -29,18 +29,55 @@
 /* The table allocation grows in multiples of the chunk size. */
 #define TABLE_CHUNK_SIZE 1024
 
-/* Define a table of file-descriptors. */
-typedef oe_fd_t* entry_t;
-static entry_t* _table;
-static size_t _table_size;
+/* Number of counters that lookups in progress are spread over. A lookup
+ * picks one with the top READER_STRIPE_BITS bits of a hash of its thread. */
+#define READER_STRIPE_BITS 5
+#define READER_STRIPES (1 << READER_STRIPE_BITS)
+
+/*
+ * The table of file-descriptors.
+ *
+ * Lookups do not take _lock. The table is published with an atomic store, and
+ * a lookup announces itself on one of the reader counters for the short time
+ * that it reads the table and takes a reference to the descriptor.
+ * Operations that remove a descriptor or replace the table wait for a grace
+ * period, in which all the lookups that may still see the old state finish,
+ * before dropping the reference of the table or freeing the old table.
+ *
+ * Descriptors are reference counted. The table holds one reference, and each
+ * call using a descriptor holds another, so that a descriptor closed by one
+ * thread while another thread uses it is only closed when the other thread is
+ * done with it.
+ */
+typedef struct _table
+{
+    size_t size;
+    oe_fd_t* entries[];
+} table_t;
+
+/* Each counter has a cache line of its own. */
+typedef struct _reader_count
+{
+    OE_ALIGNED(64) uint64_t count;
+} reader_count_t;
+
+static table_t* _table;
+static bool _initialized;
 static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
 
+/* Lookups count themselves in _readers[_reader_epoch & 1]. */
+static reader_count_t _readers[2][READER_STRIPES];
+static uint64_t _reader_epoch;
+
+/* Number of descriptors closed by _put(). */
+static uint64_t _close_count;
+
 static void _atexit_handler(void)
 {
     /* Free the standard fds (but do not close them). */
     for (size_t i = 0; i <= OE_STDERR_FILENO; i++)
     {
-        oe_fd_t* desc = _table[i];
+        oe_fd_t* desc = _table->entries[i];
 
         if (desc)
             desc->ops.fd.close(desc);
@@ -49,9 +86,80 @@ static void _atexit_handler(void)
     oe_free(_table);
 }
 
+static uint64_t* _reader_enter(void)
+{
+    const uint64_t hash = oe_thread_self() * 0x9e3779b97f4a7c15;
+    const uint64_t stripe = hash >> (64 - READER_STRIPE_BITS);
+
+    for (;;)
+    {
+        const uint64_t epoch =
+            __atomic_load_n(&_reader_epoch, __ATOMIC_SEQ_CST);
+        uint64_t* count = &_readers[epoch & 1][stripe].count;
+
+        __atomic_add_fetch(count, 1, __ATOMIC_SEQ_CST);
+
+        /* A writer may have flipped the epoch and found the counter drained
+         * between the load and the increment, so the increment does not
+         * protect anything the writer removed. Count in the new epoch then. */
+        if (__atomic_load_n(&_reader_epoch, __ATOMIC_SEQ_CST) == epoch)
+            return count;
+
+        __atomic_sub_fetch(count, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+static void _reader_exit(uint64_t* count)
+{
+    __atomic_sub_fetch(count, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Wait until no lookup can still see what was removed from the table before
+ * the call. Called with _lock held. */
+static void _synchronize(void)
+{
+    /* New lookups count themselves in the other counters, so the old ones
+     * drain even if lookups keep coming. */
+    const uint64_t epoch =
+        __atomic_fetch_add(&_reader_epoch, 1, __ATOMIC_SEQ_CST);
+    reader_count_t* readers = _readers[epoch & 1];
+
+    for (size_t i = 0; i < READER_STRIPES; i++)
+    {
+        while (__atomic_load_n(&readers[i].count, __ATOMIC_SEQ_CST))
+        {
+#if defined(__x86_64__)
+            asm volatile("pause");
+#endif
+        }
+    }
+}
+
+/* Drop a reference to a descriptor, closing it if it was the last one.
+ * Returns the result of close(), or 0 if the descriptor is still in use. */
+static int _put(oe_fd_t* desc)
+{
+    int ret;
+
+    if (__atomic_sub_fetch(&desc->refcount, 1, __ATOMIC_ACQ_REL) != 0)
+        return 0;
+
+    ret = desc->ops.fd.close(desc);
+    __atomic_add_fetch(&_close_count, 1, __ATOMIC_RELEASE);
+
+    return ret;
+}
+
+static size_t _table_size(void)
+{
+    return _table ? _table->size : 0;
+}
+
 static int _resize_table(size_t new_size)
 {
     int ret = -1;
+    table_t* old_table = _table;
+    size_t old_size = _table_size();
 
     /* The fdtable cannot be bigger than the maximum int file descriptor. */
     if (new_size > OE_INT_MAX)
@@ -63,25 +171,31 @@ static int _resize_table(size_t new_size)
     if (new_size > OE_INT_MAX)
         new_size = OE_INT_MAX;
 
-    if (new_size > _table_size)
+    if (new_size > old_size)
     {
-        entry_t* p;
-        size_t n = new_size;
+        table_t* p;
+        const size_t num_bytes = new_size * sizeof(oe_fd_t*);
 
-        /* Reallocate the table. */
-        if (!(p = oe_realloc(_table, n * sizeof(entry_t))))
+        /* Allocate the new table, so that lookups can keep using the old one
+         * until it is replaced. */
+        if (!(p = oe_calloc(1, sizeof(table_t) + num_bytes)))
             goto done;
 
-        /* Zero-fill the unused portion. */
-        {
-            const size_t num_bytes = (n - _table_size) * sizeof(entry_t);
+        p->size = new_size;
 
-            if (oe_memset_s(p + _table_size, num_bytes, 0, num_bytes) != OE_OK)
-                goto done;
+        if (old_table)
+        {
+            memcpy(
+                p->entries, old_table->entries, old_size * sizeof(oe_fd_t*));
         }
 
-        _table = p;
-        _table_size = new_size;
+        __atomic_store_n(&_table, p, __ATOMIC_SEQ_CST);
+
+        if (old_table)
+        {
+            _synchronize();
+            oe_free(old_table);
+        }
     }
 
     ret = 0;
@@ -90,10 +204,15 @@ done:
     return ret;
 }
 
+/* Set an entry of the table. Called with _lock held. */
+static void _set_entry(size_t index, oe_fd_t* desc)
+{
+    __atomic_store_n(&_table->entries[index], desc, __ATOMIC_SEQ_CST);
+}
+
 static int _initialize(void)
 {
     int ret = -1;
-    static bool _initialized;
 
     /* Do this the first time only. */
     if (!_initialized)
@@ -109,7 +228,8 @@ static int _initialize(void)
             if (!(file = oe_consolefs_create_file(OE_STDIN_FILENO)))
                 OE_RAISE_ERRNO(OE_ENOMEM);
 
-            _table[OE_STDIN_FILENO] = file;
+            file->refcount = 1;
+            _set_entry(OE_STDIN_FILENO, file);
         }
 
         /* Create the STDOUT file. */
@@ -119,7 +239,8 @@ static int _initialize(void)
             if (!(file = oe_consolefs_create_file(OE_STDOUT_FILENO)))
                 OE_RAISE_ERRNO(OE_ENOMEM);
 
-            _table[OE_STDOUT_FILENO] = file;
+            file->refcount = 1;
+            _set_entry(OE_STDOUT_FILENO, file);
         }
 
         /* Create the STDERR file. */
@@ -129,13 +250,15 @@ static int _initialize(void)
             if (!(file = oe_consolefs_create_file(OE_STDERR_FILENO)))
                 OE_RAISE_ERRNO(OE_ENOMEM);
 
-            _table[OE_STDERR_FILENO] = file;
+            file->refcount = 1;
+            _set_entry(OE_STDERR_FILENO, file);
         }
 
         /* Install the atexit handler that will release the table. */
         oe_atexit(_atexit_handler);
 
-        _initialized = true;
+        /* Lookups check this without taking the lock. */
+        __atomic_store_n(&_initialized, true, __ATOMIC_RELEASE);
     }
 
     ret = 0;
@@ -200,6 +323,12 @@ static void _assert_fd(oe_fd_t* desc)
             oe_assert(desc->ops.epoll.on_close);
             break;
         }
+        case OE_FD_TYPE_IO_RING:
+        {
+            oe_assert(desc->ops.io_ring.submit);
+            oe_assert(desc->ops.io_ring.reap);
+            break;
+        }
     }
 }
 #endif /* !defined(NDEBUG) */
@@ -232,20 +361,22 @@ int oe_fdtable_assign(oe_fd_t* desc)
 #endif
 
     /* Find the first available file descriptor. */
-    for (index = 0; index < _table_size; index++)
+    for (index = 0; index < _table->size; index++)
     {
-        if (!_table[index])
+        if (!_table->entries[index])
             break;
     }
 
     /* If no free slot found, expand size of the file descriptor table. */
-    if (index == _table_size)
+    if (index == _table->size)
     {
-        if (_resize_table(_table_size + 1) != 0)
+        if (_resize_table(_table->size + 1) != 0)
             OE_RAISE_ERRNO(OE_ENOMEM);
     }
 
-    _table[index] = desc;
+    /* The reference of the table. */
+    desc->refcount = 1;
+    _set_entry(index, desc);
     ret = (int)index;
 
 done:
@@ -259,6 +390,7 @@ done:
 int oe_fdtable_release(int fd)
 {
     int ret = -1;
+    oe_fd_t* desc = NULL;
 
     oe_spin_lock(&_lock);
 
@@ -266,14 +398,15 @@ int oe_fdtable_release(int fd)
         OE_RAISE_ERRNO(oe_errno);
 
     /* Fail if fd is out of range. */
-    if (!(fd >= 0 && (size_t)fd < _table_size))
+    if (!(fd >= 0 && (size_t)fd < _table->size))
         OE_RAISE_ERRNO(OE_EBADF);
 
     /* Fail if entry was never assigned. */
-    if (!_table[fd])
+    if (!(desc = _table->entries[fd]))
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    _table[fd] = NULL;
+    _set_entry((size_t)fd, NULL);
+    _synchronize();
 
     ret = 0;
 
@@ -281,6 +414,11 @@ done:
 
     oe_spin_unlock(&_lock);
 
+    /* Drop the reference of the table outside the lock, since closing the
+     * descriptor calls the host. */
+    if (ret == 0)
+        ret = _put(desc);
+
     return ret;
 }
 
@@ -308,12 +446,17 @@ int oe_fdtable_reassign(int fd, oe_fd_t* new_desc, oe_fd_t** old_desc)
     if (fd >= 0)
         _resize_table((size_t)fd + 1);
 
-    if (fd < 0 || (size_t)fd >= _table_size)
+    if (fd < 0 || (size_t)fd >= _table->size)
         OE_RAISE_ERRNO(OE_EBADF);
 
-    *old_desc = _table[fd];
+    *old_desc = _table->entries[fd];
 
-    _table[fd] = new_desc;
+    new_desc->refcount = 1;
+    _set_entry((size_t)fd, new_desc);
+
+    /* The caller gets the reference of the table to the old descriptor. */
+    if (*old_desc)
+        _synchronize();
 
     ret = 0;
 
@@ -328,24 +471,38 @@ done:
 static oe_fd_t* _get_fd(int fd)
 {
     oe_fd_t* ret = NULL;
+    table_t* table;
+    uint64_t* count;
 
-    oe_spin_lock(&_lock);
+    /* Create the table and the standard files on first use. */
+    if (!__atomic_load_n(&_initialized, __ATOMIC_ACQUIRE))
+    {
+        int rc;
 
-    if (_initialize() != 0)
-        OE_RAISE_ERRNO(oe_errno);
+        oe_spin_lock(&_lock);
+        rc = _initialize();
+        oe_spin_unlock(&_lock);
 
-    if (fd < 0 || (size_t)fd >= _table_size)
-        OE_RAISE_ERRNO(OE_EBADF);
+        if (rc != 0)
+            OE_RAISE_ERRNO(oe_errno);
+    }
 
-    if (_table[fd] == NULL)
-        OE_RAISE_ERRNO(OE_EBADF);
+    count = _reader_enter();
+    {
+        table = __atomic_load_n(&_table, __ATOMIC_SEQ_CST);
 
-    ret = _table[fd];
+        if (fd >= 0 && (size_t)fd < table->size)
+            ret = __atomic_load_n(&table->entries[fd], __ATOMIC_SEQ_CST);
 
-done:
+        if (ret)
+            __atomic_add_fetch(&ret->refcount, 1, __ATOMIC_ACQ_REL);
+    }
+    _reader_exit(count);
 
-    oe_spin_unlock(&_lock);
+    if (!ret)
+        OE_RAISE_ERRNO(OE_EBADF);
 
+done:
     return ret;
 }
 
@@ -359,6 +516,7 @@ oe_fd_t* oe_fdtable_get(int fd, oe_fd_type_t type)
 
     if (type != OE_FD_TYPE_ANY && desc->type != type)
     {
+        oe_fdtable_put(desc);
         OE_RAISE_ERRNO_MSG(
             OE_EINVAL, "fd=%d type=%u fd->type=%u", fd, type, desc->type);
     }
@@ -369,6 +527,21 @@ done:
     return ret;
 }
 
+void oe_fdtable_put(oe_fd_t* desc)
+{
+    /* If the descriptor was released while in use, it is closed here. Keep
+     * the errno of the call that used it. */
+    const int err = oe_errno;
+
+    _put(desc);
+    oe_errno = err;
+}
+
+uint64_t oe_fdtable_get_close_count(void)
+{
+    return __atomic_load_n(&_close_count, __ATOMIC_ACQUIRE);
+}
+
 void oe_fdtable_foreach(
     oe_fd_type_t type,
     void* arg,
@@ -378,9 +551,9 @@ void oe_fdtable_foreach(
 
     oe_spin_lock(&_lock);
 
-    for (size_t i = 0; i < _table_size; ++i)
+    for (size_t i = 0; i < _table_size(); ++i)
     {
-        oe_fd_t* const desc = _table[i];
+        oe_fd_t* const desc = _table->entries[i];
         if (desc && (type == OE_FD_TYPE_ANY || desc->type == type))
             callback(desc, arg);
     }
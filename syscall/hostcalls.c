@@ -169,6 +169,13 @@ oe_result_t _oe_syscall_pwrite_ocall(
     const void* buf,
     size_t count,
     oe_off_t offset);
+oe_result_t _oe_syscall_splice_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t in_fd,
+    oe_off_t in_offset,
+    oe_host_fd_t out_fd,
+    oe_off_t out_offset,
+    size_t count);
 oe_result_t _oe_syscall_close_ocall(int* _retval, oe_host_fd_t fd);
 oe_result_t _oe_syscall_flock_ocall(
     int* _retval,
@@ -181,6 +188,11 @@ oe_result_t _oe_syscall_readdir_ocall(
     int* _retval,
     uint64_t dirp,
     struct oe_dirent* entry);
+oe_result_t _oe_syscall_readdir_batch_ocall(
+    ssize_t* _retval,
+    uint64_t dirp,
+    struct oe_dirent* entries,
+    size_t count);
 oe_result_t _oe_syscall_rewinddir_ocall(uint64_t dirp);
 oe_result_t _oe_syscall_closedir_ocall(int* _retval, uint64_t dirp);
 oe_result_t _oe_syscall_stat_ocall(
@@ -345,6 +357,24 @@ oe_result_t _oe_syscall_pwrite_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_pwrite_ocall, oe_syscall_pwrite_ocall);
 
+oe_result_t _oe_syscall_splice_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t in_fd,
+    oe_off_t in_offset,
+    oe_host_fd_t out_fd,
+    oe_off_t out_offset,
+    size_t count)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(in_fd);
+    OE_UNUSED(in_offset);
+    OE_UNUSED(out_fd);
+    OE_UNUSED(out_offset);
+    OE_UNUSED(count);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_splice_ocall, oe_syscall_splice_ocall);
+
 oe_result_t _oe_syscall_close_ocall(int* _retval, oe_host_fd_t fd)
 {
     OE_UNUSED(_retval);
@@ -402,6 +432,20 @@ oe_result_t _oe_syscall_readdir_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_readdir_ocall, oe_syscall_readdir_ocall);
 
+oe_result_t _oe_syscall_readdir_batch_ocall(
+    ssize_t* _retval,
+    uint64_t dirp,
+    struct oe_dirent* entries,
+    size_t count)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(dirp);
+    OE_UNUSED(entries);
+    OE_UNUSED(count);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_readdir_batch_ocall, oe_syscall_readdir_batch_ocall);
+
 oe_result_t _oe_syscall_rewinddir_ocall(uint64_t dirp)
 {
     OE_UNUSED(dirp);
@@ -577,6 +621,81 @@ oe_result_t _oe_syscall_ioctl_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_ioctl_ocall, oe_syscall_ioctl_ocall);
 
+/*
+**==============================================================================
+**
+** ioring.edl
+**
+**==============================================================================
+*/
+
+/**
+ * Declare the prototypes of the following functions to avoid the
+ * missing-prototypes warning.
+ */
+oe_result_t _oe_syscall_io_ring_setup_ocall(
+    uint64_t* _retval,
+    uint32_t num_entries,
+    uint32_t buffer_size,
+    uint32_t num_workers,
+    uint64_t* ring);
+oe_result_t _oe_syscall_io_ring_wake_ocall(int* _retval, uint64_t handle);
+oe_result_t _oe_syscall_io_ring_wait_ocall(
+    int* _retval,
+    uint64_t handle,
+    uint64_t position);
+oe_result_t _oe_syscall_io_ring_teardown_ocall(int* _retval, uint64_t handle);
+
+/**
+ * Implement the functions and make them as the weak aliases of
+ * the public ocall wrappers.
+ */
+oe_result_t _oe_syscall_io_ring_setup_ocall(
+    uint64_t* _retval,
+    uint32_t num_entries,
+    uint32_t buffer_size,
+    uint32_t num_workers,
+    uint64_t* ring)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(num_entries);
+    OE_UNUSED(buffer_size);
+    OE_UNUSED(num_workers);
+    OE_UNUSED(ring);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_io_ring_setup_ocall, oe_syscall_io_ring_setup_ocall);
+
+oe_result_t _oe_syscall_io_ring_wake_ocall(int* _retval, uint64_t handle)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(handle);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_io_ring_wake_ocall, oe_syscall_io_ring_wake_ocall);
+
+oe_result_t _oe_syscall_io_ring_wait_ocall(
+    int* _retval,
+    uint64_t handle,
+    uint64_t position)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(handle);
+    OE_UNUSED(position);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_io_ring_wait_ocall, oe_syscall_io_ring_wait_ocall);
+
+oe_result_t _oe_syscall_io_ring_teardown_ocall(int* _retval, uint64_t handle)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(handle);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_syscall_io_ring_teardown_ocall,
+    oe_syscall_io_ring_teardown_ocall);
+
 /*
 **==============================================================================
 **
@@ -681,6 +800,12 @@ oe_result_t _oe_syscall_recv_ocall(
     void* buf,
     size_t len,
     int flags);
+oe_result_t _oe_syscall_recv_host_buffer_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t sockfd,
+    void* host_buf,
+    size_t len,
+    int flags);
 oe_result_t _oe_syscall_recvfrom_ocall(
     ssize_t* _retval,
     oe_host_fd_t sockfd,
@@ -959,6 +1084,24 @@ oe_result_t _oe_syscall_recv_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_recv_ocall, oe_syscall_recv_ocall);
 
+oe_result_t _oe_syscall_recv_host_buffer_ocall(
+    ssize_t* _retval,
+    oe_host_fd_t sockfd,
+    void* host_buf,
+    size_t len,
+    int flags)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(sockfd);
+    OE_UNUSED(host_buf);
+    OE_UNUSED(len);
+    OE_UNUSED(flags);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(
+    _oe_syscall_recv_host_buffer_ocall,
+    oe_syscall_recv_host_buffer_ocall);
+
 oe_result_t _oe_syscall_recvfrom_ocall(
     ssize_t* _retval,
     oe_host_fd_t sockfd,
@@ -1231,6 +1374,20 @@ oe_result_t _oe_syscall_poll_ocall(
     oe_nfds_t nfds,
     int timeout);
 
+oe_result_t _oe_syscall_poll_create_ocall(oe_host_fd_t* _retval);
+
+oe_result_t _oe_syscall_poll_wait_ocall(
+    int* _retval,
+    oe_host_fd_t epfd,
+    bool reset,
+    struct oe_host_poll_change* changes,
+    size_t nchanges,
+    struct oe_host_pollfd* events,
+    size_t maxevents,
+    int timeout);
+
+oe_result_t _oe_syscall_poll_close_ocall(int* _retval, oe_host_fd_t epfd);
+
 /**
  * Implement the functions and make them as the weak aliases of
  * the public ocall wrappers.
@@ -1249,6 +1406,43 @@ oe_result_t _oe_syscall_poll_ocall(
 }
 OE_WEAK_ALIAS(_oe_syscall_poll_ocall, oe_syscall_poll_ocall);
 
+oe_result_t _oe_syscall_poll_create_ocall(oe_host_fd_t* _retval)
+{
+    OE_UNUSED(_retval);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_poll_create_ocall, oe_syscall_poll_create_ocall);
+
+oe_result_t _oe_syscall_poll_wait_ocall(
+    int* _retval,
+    oe_host_fd_t epfd,
+    bool reset,
+    struct oe_host_poll_change* changes,
+    size_t nchanges,
+    struct oe_host_pollfd* events,
+    size_t maxevents,
+    int timeout)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(epfd);
+    OE_UNUSED(reset);
+    OE_UNUSED(changes);
+    OE_UNUSED(nchanges);
+    OE_UNUSED(events);
+    OE_UNUSED(maxevents);
+    OE_UNUSED(timeout);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_poll_wait_ocall, oe_syscall_poll_wait_ocall);
+
+oe_result_t _oe_syscall_poll_close_ocall(int* _retval, oe_host_fd_t epfd)
+{
+    OE_UNUSED(_retval);
+    OE_UNUSED(epfd);
+    return OE_UNSUPPORTED;
+}
+OE_WEAK_ALIAS(_oe_syscall_poll_close_ocall, oe_syscall_poll_close_ocall);
+
 /*
 **==============================================================================
 **
@@ -0,0 +1,78 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+
+#include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/sys/ioring.h>
+
+int oe_io_ring_setup(const struct oe_io_ring_params* params)
+{
+    int fd = -1;
+    oe_device_t* dev = NULL;
+    oe_fd_t* ring = NULL;
+
+    if (!(dev = oe_device_table_get(
+              OE_DEVID_HOST_IO_RING, OE_DEVICE_TYPE_IO_RING)))
+        OE_RAISE_ERRNO(OE_ENOSYS);
+
+    if (!(ring = dev->ops.io_ring.io_ring_setup(dev, params)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if ((fd = oe_fdtable_assign(ring)) == -1)
+        OE_RAISE_ERRNO(oe_errno);
+
+    ring = NULL;
+
+done:
+
+    if (ring)
+        ring->ops.fd.close(ring);
+
+    return fd;
+}
+
+int oe_io_ring_submit(
+    int ring,
+    const struct oe_io_ring_sqe* sqes,
+    unsigned int count)
+{
+    int ret = -1;
+    oe_fd_t* desc = NULL;
+
+    if (!(desc = oe_fdtable_get(ring, OE_FD_TYPE_IO_RING)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = desc->ops.io_ring.submit(desc, sqes, count);
+
+done:
+
+    if (desc)
+        oe_fdtable_put(desc);
+
+    return ret;
+}
+
+int oe_io_ring_reap(
+    int ring,
+    struct oe_io_ring_cqe* cqes,
+    unsigned int count,
+    unsigned int min_complete)
+{
+    int ret = -1;
+    oe_fd_t* desc = NULL;
+
+    if (!(desc = oe_fdtable_get(ring, OE_FD_TYPE_IO_RING)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = desc->ops.io_ring.reap(desc, cqes, count, min_complete);
+
+done:
+
+    if (desc)
+        oe_fdtable_put(desc);
+
+    return ret;
+}
@@ -15,8 +15,16 @@
 #include <openenclave/internal/syscall/raise.h>
 #include <openenclave/internal/safecrt.h>
 
+#include "mount.h"
+
 #define MAX_MOUNT_TABLE_SIZE 64
 
+/* Number of entries of the resolution cache. */
+#define RESOLVE_CACHE_SIZE 64
+
+/* Paths and suffixes of this size or longer are not cached. */
+#define RESOLVE_CACHE_PATH_MAX 128
+
 typedef struct _mount_point
 {
     char* path;
@@ -31,18 +39,309 @@ static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
 
 static bool _installed_free_mount_table = false;
 
+/*
+**==============================================================================
+**
+** The mount index:
+**
+**     A trie of the components of the mount point paths, rooted at "/". A
+**     path is resolved by walking its components down the trie; the deepest
+**     node with a file system is the longest mount point containing the path.
+**     It is protected by _lock.
+**
+**==============================================================================
+*/
+
+typedef struct _mount_node
+{
+    /* The path component of this node (not null-terminated). */
+    char* name;
+    size_t name_len;
+
+    struct _mount_node* parent;
+    struct _mount_node* children;
+    struct _mount_node* next;
+
+    /* The file system mounted at this path, or null. */
+    oe_device_t* fs;
+} mount_node_t;
+
+static mount_node_t _root;
+
+static mount_node_t* _find_child(
+    const mount_node_t* node,
+    const char* name,
+    size_t name_len)
+{
+    mount_node_t* child = node->children;
+
+    while (child && (child->name_len != name_len ||
+                     memcmp(child->name, name, name_len) != 0))
+    {
+        child = child->next;
+    }
+
+    return child;
+}
+
+/* Remove the nodes from this one up that no longer lead to a mount point. */
+static void _prune_nodes(mount_node_t* node)
+{
+    while (node != &_root && !node->fs && !node->children)
+    {
+        mount_node_t* parent = node->parent;
+        mount_node_t** p = &parent->children;
+
+        while (*p != node)
+            p = &(*p)->next;
+
+        *p = node->next;
+        oe_free(node->name);
+        oe_free(node);
+        node = parent;
+    }
+}
+
+/* Find the node of a normalized absolute path, creating it if requested. */
+static mount_node_t* _find_node(const char* path, bool create)
+{
+    mount_node_t* node = &_root;
+    const char* p = path;
+
+    while (*p == '/' && p[1] != '\0')
+    {
+        const char* name = p + 1;
+        size_t name_len = (size_t)(oe_strchrnul(name, '/') - name);
+        mount_node_t* child = _find_child(node, name, name_len);
+
+        if (!child)
+        {
+            if (!create)
+                return NULL;
+
+            if (!(child = oe_calloc(1, sizeof(mount_node_t))) ||
+                !(child->name = oe_malloc(name_len)))
+            {
+                oe_free(child);
+                _prune_nodes(node);
+                return NULL;
+            }
+
+            memcpy(child->name, name, name_len);
+            child->name_len = name_len;
+            child->parent = node;
+            child->next = node->children;
+            node->children = child;
+        }
+
+        node = child;
+        p = name + name_len;
+    }
+
+    return node;
+}
+
+static int _index_insert(const char* path, oe_device_t* fs)
+{
+    mount_node_t* node;
+
+    if (!(node = _find_node(path, true)))
+        return -1;
+
+    node->fs = fs;
+    return 0;
+}
+
+static void _index_remove(const char* path)
+{
+    mount_node_t* node;
+
+    if ((node = _find_node(path, false)))
+    {
+        node->fs = NULL;
+        _prune_nodes(node);
+    }
+}
+
+/* Find the file system of a normalized absolute path and the position of the
+ * path within that file system. */
+static oe_device_t* _index_lookup(const char* path, const char** suffix)
+{
+    const mount_node_t* node = &_root;
+    oe_device_t* fs = _root.fs;
+    const char* p = path;
+
+    *suffix = path;
+
+    while (*p == '/' && p[1] != '\0')
+    {
+        const char* name = p + 1;
+        size_t name_len = (size_t)(oe_strchrnul(name, '/') - name);
+
+        if (!(node = _find_child(node, name, name_len)))
+            break;
+
+        p = name + name_len;
+
+        if (node->fs)
+        {
+            fs = node->fs;
+            *suffix = p;
+        }
+    }
+
+    return fs;
+}
+
+/*
+**==============================================================================
+**
+** The resolution cache:
+**
+**     Maps the paths passed to oe_mount_resolve() to their file system and
+**     suffix, so that paths that are resolved often skip oe_realpath() and the
+**     mount index. The cache is direct-mapped, and each entry is a sequence
+**     lock: the sequence is odd while the entry is written, and readers retry
+**     as a miss if it changed while they copied the entry. Lookups therefore
+**     take no lock and write no shared memory.
+**
+**     Entries are tagged with the generation of the mount table, which is
+**     incremented by mount(), umount() and chdir() (relative paths depend on
+**     the current directory). Entries of an older generation are misses.
+**
+**==============================================================================
+*/
+
+typedef struct _resolve_cache_entry
+{
+    uint64_t seq;
+    uint64_t generation;
+    oe_device_t* fs;
+    char path[RESOLVE_CACHE_PATH_MAX];
+    char suffix[RESOLVE_CACHE_PATH_MAX];
+} resolve_cache_entry_t;
+
+static resolve_cache_entry_t _resolve_cache[RESOLVE_CACHE_SIZE];
+
+/* Starts at 1, so that the zeroed entries are never current. */
+static uint64_t _generation = 1;
+
+static resolve_cache_entry_t* _cache_entry(const char* path, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325;
+
+    /* FNV-1a */
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (uint8_t)path[i];
+        h *= 0x100000001b3;
+    }
+
+    return &_resolve_cache[h % RESOLVE_CACHE_SIZE];
+}
+
+static oe_device_t* _cache_lookup(
+    const char* path,
+    size_t len,
+    uint64_t generation,
+    char suffix[OE_PATH_MAX])
+{
+    resolve_cache_entry_t* entry = _cache_entry(path, len);
+    char entry_path[RESOLVE_CACHE_PATH_MAX];
+    char entry_suffix[RESOLVE_CACHE_PATH_MAX];
+    oe_device_t* fs;
+    uint64_t entry_generation;
+    uint64_t seq;
+
+    if (len >= RESOLVE_CACHE_PATH_MAX)
+        return NULL;
+
+    if ((seq = __atomic_load_n(&entry->seq, __ATOMIC_ACQUIRE)) & 1)
+        return NULL;
+
+    memcpy(entry_path, entry->path, len + 1);
+    memcpy(entry_suffix, entry->suffix, sizeof(entry_suffix));
+    fs = entry->fs;
+    entry_generation = entry->generation;
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    if (__atomic_load_n(&entry->seq, __ATOMIC_RELAXED) != seq)
+        return NULL;
+
+    if (!fs || entry_generation != generation ||
+        memcmp(entry_path, path, len + 1) != 0)
+    {
+        return NULL;
+    }
+
+    entry_suffix[sizeof(entry_suffix) - 1] = '\0';
+    oe_strlcpy(suffix, entry_suffix, OE_PATH_MAX);
+
+    return fs;
+}
+
+static void _cache_store(
+    const char* path,
+    size_t len,
+    uint64_t generation,
+    oe_device_t* fs,
+    const char* suffix)
+{
+    resolve_cache_entry_t* entry = _cache_entry(path, len);
+    size_t suffix_len = oe_strlen(suffix);
+    uint64_t seq;
+
+    if (len >= RESOLVE_CACHE_PATH_MAX || suffix_len >= RESOLVE_CACHE_PATH_MAX)
+        return;
+
+    /* Give up if another thread is writing the entry. */
+    seq = __atomic_load_n(&entry->seq, __ATOMIC_RELAXED);
+
+    if ((seq & 1) ||
+        !__atomic_compare_exchange_n(
+            &entry->seq,
+            &seq,
+            seq + 1,
+            false,
+            __ATOMIC_ACQ_REL,
+            __ATOMIC_RELAXED))
+    {
+        return;
+    }
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy(entry->path, path, len + 1);
+    memcpy(entry->suffix, suffix, suffix_len + 1);
+    entry->fs = fs;
+    entry->generation = generation;
+
+    __atomic_store_n(&entry->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void oe_mount_invalidate_cache(void)
+{
+    __atomic_add_fetch(&_generation, 1, __ATOMIC_ACQ_REL);
+}
+
 static void _free_mount_table(void)
 {
     for (size_t i = 0; i < _mount_table_size; i++)
+    {
+        _index_remove(_mount_table[i].path);
         oe_free(_mount_table[i].path);
+    }
 }
 
 oe_device_t* oe_mount_resolve(const char* path, char suffix[OE_PATH_MAX])
 {
     oe_device_t* ret = NULL;
-    size_t match_len = 0;
     oe_syscall_path_t realpath;
+    const char* match = NULL;
     bool locked = false;
+    uint64_t generation;
+    size_t len;
 
     if (!path || !suffix)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -70,6 +369,14 @@ oe_device_t* oe_mount_resolve(const char* path, char suffix[OE_PATH_MAX])
         }
     }
 
+    /* Read the generation before resolving, so that the result is not cached
+     * as current if the mount table changes in the meantime. */
+    generation = __atomic_load_n(&_generation, __ATOMIC_ACQUIRE);
+    len = oe_strlen(path);
+
+    if ((ret = _cache_lookup(path, len, generation, suffix)))
+        goto done;
+
     /* Find the real path (the absolute non-relative path). */
     if (!oe_realpath(path, &realpath))
         OE_RAISE_ERRNO(oe_errno);
@@ -78,36 +385,8 @@ oe_device_t* oe_mount_resolve(const char* path, char suffix[OE_PATH_MAX])
     locked = true;
 
     /* Find the longest binding point that contains this path. */
-    for (size_t i = 0; i < _mount_table_size; i++)
-    {
-        size_t len = oe_strlen(_mount_table[i].path);
-        const char* mpath = _mount_table[i].path;
-
-        if (mpath[0] == '/' && mpath[1] == '\0')
-        {
-            if (len > match_len)
-            {
-                oe_strlcpy(suffix, realpath.buf, OE_PATH_MAX);
-                match_len = len;
-                ret = _mount_table[i].fs;
-            }
-        }
-        else if (
-            oe_strncmp(mpath, realpath.buf, len) == 0 &&
-            (realpath.buf[len] == '/' || realpath.buf[len] == '\0'))
-        {
-            if (len > match_len)
-            {
-                oe_strlcpy(suffix, realpath.buf + len, OE_PATH_MAX);
-
-                if (*suffix == '\0')
-                    oe_strlcpy(suffix, "/", OE_PATH_MAX);
-
-                match_len = len;
-                ret = _mount_table[i].fs;
-            }
-        }
-    }
+    if ((ret = _index_lookup(realpath.buf, &match)))
+        oe_strlcpy(suffix, *match ? match : "/", OE_PATH_MAX);
 
     if (locked)
     {
@@ -118,6 +397,8 @@ oe_device_t* oe_mount_resolve(const char* path, char suffix[OE_PATH_MAX])
     if (!ret)
         OE_RAISE_ERRNO_MSG(OE_ENOENT, "path=%s", path);
 
+    _cache_store(path, len, generation, ret, suffix);
+
 done:
 
     if (locked)
@@ -214,14 +495,20 @@ int oe_mount(
         mount_point.flags = 0;
     }
 
+    /* Add the mount point to the index. */
+    if (_index_insert(target, new_device) != 0)
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
     /* Notify the device that it has been mounted. */
     if (new_device->ops.fs.mount(
             new_device, source, target, filesystemtype, mountflags, data) != 0)
     {
+        _index_remove(target);
         goto done;
     }
 
     _mount_table[_mount_table_size++] = mount_point;
+    oe_mount_invalidate_cache();
     new_device = NULL;
     mount_point.path = NULL;
     ret = 0;
@@ -285,9 +572,11 @@ int oe_umount2(const char* target, int flags)
     {
         oe_device_t* fs = _mount_table[index].fs;
 
+        _index_remove(_mount_table[index].path);
         oe_free(_mount_table[index].path);
         _mount_table[index] = _mount_table[_mount_table_size - 1];
         _mount_table_size--;
+        oe_mount_invalidate_cache();
 
         if (fs->ops.fs.umount2(fs, target, flags) != 0)
             OE_RAISE_ERRNO(oe_errno);
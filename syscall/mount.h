@@ -13,6 +13,10 @@ OE_EXTERNC_BEGIN
 /* Use mounter to resolve this path to a target path. */
 oe_device_t* oe_mount_resolve(const char* path, char suffix[OE_PATH_MAX]);
 
+/* Discard the cached results of oe_mount_resolve(), e.g., when the current
+ * directory changes. */
+void oe_mount_invalidate_cache(void);
+
 OE_EXTERNC_END
 
 #endif // _OE_SYSCALL_MOUNT_H
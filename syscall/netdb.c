@@ -13,6 +13,20 @@ static oe_resolver_t* _resolver;
 static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
 static bool _installed_atexit_handler = false;
 
+/* The resolver is registered once and never replaced, so lookups only hold
+ * the lock to read it. Holding it during the lookup would serialize all the
+ * lookups of the enclave. */
+static oe_resolver_t* _get_resolver(void)
+{
+    oe_resolver_t* resolver;
+
+    oe_spin_lock(&_lock);
+    resolver = _resolver;
+    oe_spin_unlock(&_lock);
+
+    return resolver;
+}
+
 static void _atexit_handler(void)
 {
     if (_resolver)
@@ -65,32 +79,26 @@ int oe_getaddrinfo(
 {
     int ret = OE_EAI_FAIL;
     struct oe_addrinfo* res;
-    bool locked = false;
+    oe_resolver_t* resolver;
 
     if (res_out)
         *res_out = NULL;
     else
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    oe_spin_lock(&_lock);
-    locked = true;
-
-    if (!_resolver)
+    if (!(resolver = _get_resolver()))
     {
         ret = OE_EAI_SYSTEM;
         OE_RAISE_ERRNO(OE_EINVAL);
     }
 
-    ret = (_resolver->ops->getaddrinfo)(_resolver, node, service, hints, &res);
+    ret = (resolver->ops->getaddrinfo)(resolver, node, service, hints, &res);
 
     if (ret == 0)
         *res_out = res;
 
 done:
 
-    if (locked)
-        oe_spin_unlock(&_lock);
-
     return ret;
 }
 
@@ -104,25 +112,19 @@ int oe_getnameinfo(
     int flags)
 {
     ssize_t ret = OE_EAI_FAIL;
-    bool locked = false;
-
-    oe_spin_lock(&_lock);
-    locked = true;
+    oe_resolver_t* resolver;
 
-    if (!_resolver)
+    if (!(resolver = _get_resolver()))
     {
         ret = OE_EAI_SYSTEM;
         OE_RAISE_ERRNO(OE_EINVAL);
     }
 
-    ret = (*_resolver->ops->getnameinfo)(
-        _resolver, sa, salen, host, hostlen, serv, servlen, flags);
+    ret = (*resolver->ops->getnameinfo)(
+        resolver, sa, salen, host, hostlen, serv, servlen, flags);
 
 done:
 
-    if (locked)
-        oe_spin_unlock(&_lock);
-
     return (int)ret;
 }
 
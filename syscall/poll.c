@@ -6,14 +6,474 @@
 #include <openenclave/corelibc/stdlib.h>
 #include <openenclave/internal/syscall/fdtable.h>
 #include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/sys/epoll.h>
 #include <openenclave/internal/syscall/sys/poll.h>
+#include <openenclave/internal/thread.h>
 #include "syscall_t.h"
 
+/*
+**==============================================================================
+**
+** Persistent interest sets:
+**
+**     A poll() ocall passes every fd and its events to the host, although
+**     event loops mostly poll the same fds over and over. Instead, each
+**     thread keeps a host epoll instance whose interest set is the set of
+**     host fds of its last call, and a call only passes the fds that were
+**     added, removed or changed since, with the wait for events in the same
+**     ocall. Only the ready fds are passed back.
+**
+**     The interest set is keyed by host fd, which the host may reuse once the
+**     descriptor using it is closed. When any descriptor has been closed since
+**     the last call, the instance is emptied and the whole set is registered
+**     again.
+**
+**     Small sets are polled directly, since keeping them in sync costs more
+**     than it saves. Sets that the host cannot add to an epoll instance, such
+**     as regular files, are also polled directly once the instance fails.
+**
+**     The instance lives until the thread returns from its outermost ecall.
+**     Creating and closing it costs two ocalls, which a thread that polls
+**     once per ecall would never recover, so it is only created once the
+**     thread has polled EPOLL_MIN_REPEATS large sets during the ecall.
+**
+**==============================================================================
+*/
+
+/* Sets with fewer fds are passed to a poll() ocall. */
+#define EPOLL_MIN_FDS 8
+
+/* After this many consecutive failures, the thread stops using its instance. */
+#define EPOLL_MAX_FAILURES 4
+
+/* Large sets that a thread polls directly before it creates its instance. */
+#define EPOLL_MIN_REPEATS 3
+
+#define POLL_ALWAYS_EVENTS (OE_POLLERR | OE_POLLHUP | OE_POLLNVAL)
+
+typedef struct _poll_context
+{
+    oe_host_fd_t epfd;
+
+    /* The interest set of epfd, sorted by host fd. */
+    struct oe_host_pollfd* registered;
+    size_t num_registered;
+
+    /* The interest set of the current call, sorted by host fd. */
+    struct oe_host_pollfd* wanted;
+
+    /* The ready fds returned by the host. */
+    struct oe_host_pollfd* ready;
+
+    /* Capacity of the three arrays above. */
+    size_t capacity;
+
+    /* Changes to the interest set, with room for 2 * capacity entries. */
+    struct oe_host_poll_change* changes;
+
+    /* Whether the interest set of epfd is known to be registered. */
+    bool synced;
+
+    /* The oe_fdtable_get_close_count() when the set was registered. */
+    uint64_t close_count;
+
+    size_t failures;
+
+    /* Number of large sets polled without an instance. */
+    size_t num_direct_polls;
+} poll_context_t;
+
+static oe_once_t _once = OE_ONCE_INIT;
+static oe_thread_key_t _key;
+static bool _have_key;
+
+/* Set when the host does not support persistent interest sets. */
+static bool _unsupported;
+
+static void _free_context(void* arg)
+{
+    poll_context_t* context = (poll_context_t*)arg;
+
+    if (context)
+    {
+        if (context->epfd != -1)
+        {
+            int retval;
+            oe_syscall_poll_close_ocall(&retval, context->epfd);
+        }
+
+        oe_free(context->registered);
+        oe_free(context->wanted);
+        oe_free(context->ready);
+        oe_free(context->changes);
+        oe_free(context);
+    }
+}
+
+static void _create_key(void)
+{
+    if (oe_thread_key_create(&_key, _free_context) == OE_OK)
+        _have_key = true;
+}
+
+/* Get the context of the calling thread, creating it without an instance on
+ * first use. */
+static poll_context_t* _get_context(void)
+{
+    poll_context_t* context;
+
+    oe_once(&_once, _create_key);
+
+    if (!_have_key)
+        return NULL;
+
+    if ((context = oe_thread_getspecific(_key)))
+        return context;
+
+    if (!(context = oe_calloc(1, sizeof(poll_context_t))))
+        return NULL;
+
+    context->epfd = -1;
+
+    if (oe_thread_setspecific(_key, context) != OE_OK)
+    {
+        _free_context(context);
+        return NULL;
+    }
+
+    return context;
+}
+
+/* Whether the thread polls a large set with its instance, which is created
+ * on the EPOLL_MIN_REPEATS-th large set. */
+static bool _use_instance(poll_context_t* context)
+{
+    oe_host_fd_t epfd = -1;
+    oe_result_t result;
+
+    if (context->failures >= EPOLL_MAX_FAILURES)
+        return false;
+
+    if (context->epfd != -1)
+        return true;
+
+    if (++context->num_direct_polls < EPOLL_MIN_REPEATS)
+        return false;
+
+    result = oe_syscall_poll_create_ocall(&epfd);
+
+    if (result == OE_UNSUPPORTED ||
+        (result == OE_OK && epfd == -1 && oe_errno == OE_ENOSYS))
+    {
+        __atomic_store_n(&_unsupported, true, __ATOMIC_RELAXED);
+    }
+
+    /* Without an instance, the thread polls directly until it exits. */
+    if (result != OE_OK || epfd == -1)
+    {
+        context->failures = EPOLL_MAX_FAILURES;
+        return false;
+    }
+
+    context->epfd = epfd;
+
+    return true;
+}
+
+static int _reserve(poll_context_t* context, size_t n)
+{
+    struct oe_host_pollfd* registered;
+    struct oe_host_pollfd* wanted;
+    struct oe_host_pollfd* ready;
+    struct oe_host_poll_change* changes;
+    const size_t size = sizeof(struct oe_host_pollfd);
+
+    if (n <= context->capacity)
+        return 0;
+
+    if (!(registered = oe_realloc(context->registered, n * size)))
+        return -1;
+
+    context->registered = registered;
+
+    if (!(wanted = oe_realloc(context->wanted, n * size)))
+        return -1;
+
+    context->wanted = wanted;
+
+    if (!(ready = oe_realloc(context->ready, n * size)))
+        return -1;
+
+    context->ready = ready;
+
+    if (!(changes = oe_realloc(
+              context->changes, 2 * n * sizeof(struct oe_host_poll_change))))
+    {
+        return -1;
+    }
+
+    context->changes = changes;
+    context->capacity = n;
+
+    return 0;
+}
+
+/* Heapsort by host fd, since event loops may pass their fds in any order. */
+static void _sift_down(struct oe_host_pollfd* a, size_t root, size_t n)
+{
+    for (;;)
+    {
+        size_t child = 2 * root + 1;
+        struct oe_host_pollfd tmp;
+
+        if (child >= n)
+            break;
+
+        if (child + 1 < n && a[child + 1].fd > a[child].fd)
+            child++;
+
+        if (a[root].fd >= a[child].fd)
+            break;
+
+        tmp = a[root];
+        a[root] = a[child];
+        a[child] = tmp;
+        root = child;
+    }
+}
+
+static void _sort(struct oe_host_pollfd* a, size_t n)
+{
+    size_t i;
+
+    /* Most loops pass the same sorted array every time. */
+    for (i = 1; i < n && a[i - 1].fd <= a[i].fd; i++)
+        ;
+
+    if (i >= n)
+        return;
+
+    for (i = n / 2; i-- > 0;)
+        _sift_down(a, i, n);
+
+    for (i = n; i-- > 1;)
+    {
+        struct oe_host_pollfd tmp = a[0];
+        a[0] = a[i];
+        a[i] = tmp;
+        _sift_down(a, 0, i);
+    }
+}
+
+static struct oe_host_pollfd* _find(
+    struct oe_host_pollfd* a,
+    size_t n,
+    oe_host_fd_t fd)
+{
+    size_t lo = 0;
+    size_t hi = n;
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+
+        if (a[mid].fd == fd)
+            return &a[mid];
+
+        if (a[mid].fd < fd)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return NULL;
+}
+
+static void _add_change(
+    poll_context_t* context,
+    size_t* n,
+    int op,
+    const struct oe_host_pollfd* p)
+{
+    struct oe_host_poll_change* change = &context->changes[(*n)++];
+
+    change->fd = p->fd;
+    change->op = op;
+    change->events = p->events;
+}
+
+/* Poll with the epoll instance of the thread. Returns false if the caller
+ * should poll directly instead. */
+static bool _epoll_poll(
+    poll_context_t* context,
+    struct oe_host_pollfd* host_fds,
+    oe_nfds_t nfds,
+    int timeout,
+    int* ret)
+{
+    size_t num_wanted = 0;
+    size_t num_changes = 0;
+    size_t i = 0;
+    size_t j = 0;
+    uint64_t close_count = oe_fdtable_get_close_count();
+    bool reset;
+    int retval = -1;
+    oe_result_t result;
+
+    if (_reserve(context, nfds) != 0)
+        return false;
+
+    /* Build the wanted set, merging the events of repeated host fds. */
+    for (oe_nfds_t k = 0; k < nfds; k++)
+    {
+        context->wanted[k].fd = host_fds[k].fd;
+        context->wanted[k].events = host_fds[k].events;
+        context->wanted[k].revents = 0;
+    }
+
+    _sort(context->wanted, nfds);
+
+    for (oe_nfds_t k = 0; k < nfds; k++)
+    {
+        if (num_wanted &&
+            context->wanted[num_wanted - 1].fd == context->wanted[k].fd)
+        {
+            context->wanted[num_wanted - 1].events |= context->wanted[k].events;
+        }
+        else
+        {
+            context->wanted[num_wanted++] = context->wanted[k];
+        }
+    }
+
+    /* Diff the wanted set against the registered one. After a reset, the
+     * whole wanted set is added. */
+    reset = !context->synced || close_count != context->close_count;
+
+    if (reset)
+    {
+        for (i = 0; i < num_wanted; i++)
+            _add_change(
+                context, &num_changes, OE_EPOLL_CTL_ADD, &context->wanted[i]);
+    }
+    else
+    {
+        const struct oe_host_pollfd* r = context->registered;
+        const struct oe_host_pollfd* w = context->wanted;
+
+        while (i < context->num_registered || j < num_wanted)
+        {
+            if (j == num_wanted ||
+                (i < context->num_registered && r[i].fd < w[j].fd))
+            {
+                _add_change(context, &num_changes, OE_EPOLL_CTL_DEL, &r[i++]);
+            }
+            else if (i == context->num_registered || w[j].fd < r[i].fd)
+            {
+                _add_change(context, &num_changes, OE_EPOLL_CTL_ADD, &w[j++]);
+            }
+            else
+            {
+                if (r[i].events != w[j].events)
+                    _add_change(context, &num_changes, OE_EPOLL_CTL_MOD, &w[j]);
+
+                i++;
+                j++;
+            }
+        }
+    }
+
+    result = oe_syscall_poll_wait_ocall(
+        &retval,
+        context->epfd,
+        reset,
+        context->changes,
+        num_changes,
+        context->ready,
+        num_wanted,
+        timeout);
+
+    if (result != OE_OK)
+    {
+        if (result == OE_UNSUPPORTED)
+            __atomic_store_n(&_unsupported, true, __ATOMIC_RELAXED);
+
+        return false;
+    }
+
+    /* The changes were applied, but the wait was interrupted. */
+    if (retval == -1 && oe_errno == OE_EINTR)
+        goto synced;
+
+    /* A change failed, e.g., for a regular file, which epoll does not
+     * support, so the interest set of the instance is unknown. */
+    if (retval < 0 || (size_t)retval > num_wanted)
+    {
+        context->synced = false;
+        context->failures++;
+        return false;
+    }
+
+synced:
+    {
+        struct oe_host_pollfd* tmp = context->registered;
+        context->registered = context->wanted;
+        context->wanted = tmp;
+        context->num_registered = num_wanted;
+        context->synced = true;
+        context->close_count = close_count;
+        context->failures = 0;
+    }
+
+    if (retval == -1)
+    {
+        *ret = -1;
+        return true;
+    }
+
+    /* Hand out the events of each ready host fd to the fds that use it. */
+    for (int k = 0; k < retval; k++)
+    {
+        struct oe_host_pollfd* p = _find(
+            context->registered, context->num_registered, context->ready[k].fd);
+
+        if (p)
+            p->revents = context->ready[k].revents;
+    }
+
+    *ret = 0;
+
+    for (oe_nfds_t k = 0; k < nfds; k++)
+    {
+        struct oe_host_pollfd* p = _find(
+            context->registered, context->num_registered, host_fds[k].fd);
+        const short events = host_fds[k].events | POLL_ALWAYS_EVENTS;
+
+        host_fds[k].revents = p ? (short)(p->revents & events) : 0;
+
+        if (host_fds[k].revents)
+            (*ret)++;
+    }
+
+    /* Clear the events for the next call. */
+    for (int k = 0; k < retval; k++)
+    {
+        struct oe_host_pollfd* p = _find(
+            context->registered, context->num_registered, context->ready[k].fd);
+
+        if (p)
+            p->revents = 0;
+    }
+
+    return true;
+}
+
 int oe_poll(struct oe_pollfd* fds, oe_nfds_t nfds, int timeout)
 {
     int ret = -1;
     int retval = -1;
     struct oe_host_pollfd* host_fds = NULL;
+    poll_context_t* context;
     oe_nfds_t i;
 
     if (!fds || nfds == 0)
@@ -33,16 +493,29 @@ int oe_poll(struct oe_pollfd* fds, oe_nfds_t nfds, int timeout)
             OE_RAISE_ERRNO(OE_EBADF);
 
         /* Get the host fd for this fd struct. */
-        if ((host_fd = desc->ops.fd.get_host_fd(desc)) == -1)
+        host_fd = desc->ops.fd.get_host_fd(desc);
+        oe_fdtable_put(desc);
+
+        if (host_fd == -1)
             OE_RAISE_ERRNO(OE_EBADF);
 
         host_fds[i].events = fds[i].events;
         host_fds[i].fd = host_fd;
     }
 
+    if (nfds >= EPOLL_MIN_FDS &&
+        !__atomic_load_n(&_unsupported, __ATOMIC_RELAXED) &&
+        (context = _get_context()) && _use_instance(context) &&
+        _epoll_poll(context, host_fds, nfds, timeout, &retval))
+    {
+        goto polled;
+    }
+
     if (oe_syscall_poll_ocall(&retval, host_fds, nfds, timeout) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+polled:
+
     /* Update fds[] with any recieved events. */
     for (i = 0; i < nfds; i++)
         fds[i].revents = host_fds[i].revents;
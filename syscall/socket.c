@@ -128,7 +128,7 @@ int oe_socket(int domain, int type, int protocol)
 int oe_connect(int sockfd, const struct oe_sockaddr* addr, oe_socklen_t addrlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -136,12 +136,15 @@ int oe_connect(int sockfd, const struct oe_sockaddr* addr, oe_socklen_t addrlen)
     ret = sock->ops.socket.connect(sock, addr, addrlen);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 int oe_accept(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
 {
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
     oe_fd_t* new_sock = NULL;
     int ret = -1;
 
@@ -161,13 +164,16 @@ done:
     if (new_sock)
         new_sock->ops.fd.close(new_sock);
 
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 int oe_listen(int sockfd, int backlog)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -175,13 +181,16 @@ int oe_listen(int sockfd, int backlog)
     ret = sock->ops.socket.listen(sock, backlog);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 ssize_t oe_recv(int sockfd, void* buf, size_t len, int flags)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -189,6 +198,9 @@ ssize_t oe_recv(int sockfd, void* buf, size_t len, int flags)
     ret = sock->ops.socket.recv(sock, buf, len, flags);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
@@ -201,7 +213,7 @@ ssize_t oe_recvfrom(
     oe_socklen_t* addrlen)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -209,13 +221,16 @@ ssize_t oe_recvfrom(
     ret = sock->ops.socket.recvfrom(sock, buf, len, flags, src_addr, addrlen);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 ssize_t oe_send(int sockfd, const void* buf, size_t len, int flags)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -223,6 +238,9 @@ ssize_t oe_send(int sockfd, const void* buf, size_t len, int flags)
     ret = sock->ops.socket.send(sock, buf, len, flags);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
@@ -235,7 +253,7 @@ ssize_t oe_sendto(
     oe_socklen_t addrlen)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -243,13 +261,16 @@ ssize_t oe_sendto(
     ret = sock->ops.socket.sendto(sock, buf, len, flags, dest_addr, addrlen);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 ssize_t oe_recvmsg(int sockfd, struct oe_msghdr* buf, int flags)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -257,13 +278,16 @@ ssize_t oe_recvmsg(int sockfd, struct oe_msghdr* buf, int flags)
     ret = sock->ops.socket.recvmsg(sock, buf, flags);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 ssize_t oe_sendmsg(int sockfd, const struct oe_msghdr* buf, int flags)
 {
     ssize_t ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -271,13 +295,16 @@ ssize_t oe_sendmsg(int sockfd, const struct oe_msghdr* buf, int flags)
     ret = sock->ops.socket.sendmsg(sock, buf, flags);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 int oe_shutdown(int sockfd, int how)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -285,13 +312,16 @@ int oe_shutdown(int sockfd, int how)
     ret = sock->ops.socket.shutdown(sock, how);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 int oe_getsockname(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -299,13 +329,16 @@ int oe_getsockname(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
     ret = sock->ops.socket.getsockname(sock, addr, addrlen);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 int oe_getpeername(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -313,6 +346,9 @@ int oe_getpeername(int sockfd, struct oe_sockaddr* addr, oe_socklen_t* addrlen)
     ret = sock->ops.socket.getpeername(sock, addr, addrlen);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
@@ -324,7 +360,7 @@ int oe_getsockopt(
     oe_socklen_t* optlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -332,6 +368,9 @@ int oe_getsockopt(
     ret = sock->ops.socket.getsockopt(sock, level, optname, optval, optlen);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
@@ -343,7 +382,7 @@ int oe_setsockopt(
     oe_socklen_t optlen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -351,13 +390,16 @@ int oe_setsockopt(
     ret = sock->ops.socket.setsockopt(sock, level, optname, optval, optlen);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
 
 int oe_bind(int sockfd, const struct oe_sockaddr* name, oe_socklen_t namelen)
 {
     int ret = -1;
-    oe_fd_t* sock;
+    oe_fd_t* sock = NULL;
 
     if (!(sock = oe_fdtable_get(sockfd, OE_FD_TYPE_SOCKET)))
         OE_RAISE_ERRNO(oe_errno);
@@ -365,5 +407,8 @@ int oe_bind(int sockfd, const struct oe_sockaddr* name, oe_socklen_t namelen)
     ret = sock->ops.socket.bind(sock, name, namelen);
 
 done:
+    if (sock)
+        oe_fdtable_put(sock);
+
     return ret;
 }
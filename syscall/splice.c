@@ -0,0 +1,252 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+/*
+**==============================================================================
+**
+** sendfile() and splice():
+**
+**     When both descriptors are backed by host descriptors, the host moves
+**     the data between them and the enclave only learns how many bytes were
+**     moved. Otherwise, or if the host cannot move the data, it is copied
+**     through the enclave with read() and write(), in chunks of
+**     COPY_BUFFER_SIZE bytes.
+**
+**     A null offset uses and advances the file position of the descriptor.
+**     A non-null offset is only valid for files, and is advanced by the
+**     number of bytes moved, leaving the file position unchanged.
+**
+**==============================================================================
+*/
+
+#include <openenclave/corelibc/errno.h>
+#include <openenclave/corelibc/limits.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/internal/syscall/fcntl.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/sys/sendfile.h>
+#include "syscall_t.h"
+
+#define COPY_BUFFER_SIZE (64 * 1024)
+
+#define SPLICE_FLAGS \
+    (OE_SPLICE_F_MOVE | OE_SPLICE_F_NONBLOCK | OE_SPLICE_F_MORE | \
+     OE_SPLICE_F_GIFT)
+
+static oe_fd_t* _get_desc(int fd, const oe_off_t* offset)
+{
+    oe_fd_t* ret = NULL;
+    oe_fd_t* desc = NULL;
+
+    if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (offset)
+    {
+        if (desc->type != OE_FD_TYPE_FILE)
+            OE_RAISE_ERRNO(OE_ESPIPE);
+
+        if (*offset < 0)
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    ret = desc;
+    desc = NULL;
+
+done:
+    if (desc)
+        oe_fdtable_put(desc);
+
+    return ret;
+}
+
+/* Copy through an enclave buffer, stopping at the first short read. */
+static ssize_t _copy(
+    oe_fd_t* in,
+    oe_off_t in_offset,
+    oe_fd_t* out,
+    oe_off_t out_offset,
+    size_t count)
+{
+    ssize_t ret = -1;
+    size_t buf_size = count < COPY_BUFFER_SIZE ? count : COPY_BUFFER_SIZE;
+    uint8_t* buf = NULL;
+    size_t total = 0;
+
+    if (!(buf = oe_malloc(buf_size)))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    while (total < count)
+    {
+        size_t chunk = count - total;
+        size_t written = 0;
+        ssize_t n;
+
+        if (chunk > buf_size)
+            chunk = buf_size;
+
+        if (in_offset == -1)
+            n = in->ops.fd.read(in, buf, chunk);
+        else
+            n = in->ops.file.pread(
+                in, buf, chunk, in_offset + (oe_off_t)total);
+
+        if (n < 0 && !total)
+            OE_RAISE_ERRNO(oe_errno);
+
+        if (n <= 0)
+            break;
+
+        while (written < (size_t)n)
+        {
+            ssize_t w;
+
+            if (out_offset == -1)
+                w = out->ops.fd.write(
+                    out, buf + written, (size_t)n - written);
+            else
+                w = out->ops.file.pwrite(
+                    out,
+                    buf + written,
+                    (size_t)n - written,
+                    out_offset + (oe_off_t)(total + written));
+
+            if (w <= 0)
+            {
+                total += written;
+
+                if (!total)
+                    OE_RAISE_ERRNO(w ? oe_errno : OE_EIO);
+
+                ret = (ssize_t)total;
+                goto done;
+            }
+
+            written += (size_t)w;
+        }
+
+        total += (size_t)n;
+
+        if ((size_t)n < chunk)
+            break;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    oe_free(buf);
+
+    return ret;
+}
+
+static ssize_t _transfer(
+    int in_fd,
+    oe_off_t* in_offset,
+    int out_fd,
+    oe_off_t* out_offset,
+    size_t count)
+{
+    ssize_t ret = -1;
+    oe_fd_t* in = NULL;
+    oe_fd_t* out = NULL;
+    oe_off_t in_off;
+    oe_off_t out_off;
+    oe_host_fd_t in_host_fd;
+    oe_host_fd_t out_host_fd;
+    oe_result_t result;
+
+    if (count > OE_SSIZE_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(in = _get_desc(in_fd, in_offset)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!(out = _get_desc(out_fd, out_offset)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    in_off = in_offset ? *in_offset : -1;
+    out_off = out_offset ? *out_offset : -1;
+
+    if (count == 0)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    /* The data and the offset of cached files are in the enclave. */
+    if (oe_fd_is_cached(in) || oe_fd_is_cached(out))
+        goto copy;
+
+    in_host_fd = in->ops.fd.get_host_fd(in);
+    out_host_fd = out->ops.fd.get_host_fd(out);
+
+    if (in_host_fd != -1 && out_host_fd != -1)
+    {
+        result = oe_syscall_splice_ocall(
+            &ret, in_host_fd, in_off, out_host_fd, out_off, count);
+
+        if (result == OE_OK && !(ret == -1 && oe_errno == OE_ENOSYS))
+        {
+            /* The host must not report more bytes than it was asked for. */
+            if (ret > (ssize_t)count)
+            {
+                ret = -1;
+                OE_RAISE_ERRNO(OE_EINVAL);
+            }
+
+            goto moved;
+        }
+
+        if (result != OE_OK && result != OE_UNSUPPORTED)
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+copy:
+    ret = _copy(in, in_off, out, out_off, count);
+
+moved:
+    if (ret > 0)
+    {
+        if (in_offset)
+            *in_offset += ret;
+
+        if (out_offset)
+            *out_offset += ret;
+    }
+
+done:
+    if (in)
+        oe_fdtable_put(in);
+
+    if (out)
+        oe_fdtable_put(out);
+
+    return ret;
+}
+
+ssize_t oe_sendfile(int out_fd, int in_fd, oe_off_t* offset, size_t count)
+{
+    return _transfer(in_fd, offset, out_fd, NULL, count);
+}
+
+ssize_t oe_splice(
+    int fd_in,
+    oe_off_t* off_in,
+    int fd_out,
+    oe_off_t* off_out,
+    size_t len,
+    unsigned int flags)
+{
+    ssize_t ret = -1;
+
+    /* There are no pipe buffers to move pages between, so the flags are
+     * only hints, and the descriptors' own O_NONBLOCK flags apply. */
+    if (flags & ~(unsigned int)SPLICE_FLAGS)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = _transfer(fd_in, off_in, fd_out, off_out, len);
+
+done:
+    return ret;
+}
@@ -52,6 +52,7 @@ int oe_fstat(int fd, struct oe_stat_t* buf)
     if (!file)
         OE_RAISE_ERRNO(oe_errno);
     ret = file->ops.file.fstat(file, buf);
+    oe_fdtable_put(file);
 done:
     return ret;
 }
@@ -18,6 +18,7 @@
 #include <openenclave/internal/syscall/sys/mount.h>
 #include <openenclave/internal/syscall/sys/poll.h>
 #include <openenclave/internal/syscall/sys/select.h>
+#include <openenclave/internal/syscall/sys/sendfile.h>
 #include <openenclave/internal/syscall/sys/socket.h>
 #include <openenclave/internal/syscall/sys/stat.h>
 #include <openenclave/internal/syscall/sys/syscall.h>
@@ -807,6 +808,17 @@ OE_DEFINE_SYSCALL5(SYS_select)
 }
 #endif
 
+OE_DEFINE_SYSCALL4(SYS_sendfile)
+{
+    oe_errno = 0;
+    int out_fd = (int)arg1;
+    int in_fd = (int)arg2;
+    oe_off_t* offset = (oe_off_t*)arg3;
+    size_t count = (size_t)arg4;
+
+    return oe_sendfile(out_fd, in_fd, offset, count);
+}
+
 OE_DEFINE_SYSCALL6(SYS_sendto)
 {
     oe_errno = 0;
@@ -869,6 +881,19 @@ OE_DEFINE_SYSCALL4(SYS_socketpair)
     return oe_socketpair(domain, type, protocol, sv);
 }
 
+OE_DEFINE_SYSCALL6(SYS_splice)
+{
+    oe_errno = 0;
+    int fd_in = (int)arg1;
+    oe_off_t* off_in = (oe_off_t*)arg2;
+    int fd_out = (int)arg3;
+    oe_off_t* off_out = (oe_off_t*)arg4;
+    size_t len = (size_t)arg5;
+    unsigned int flags = (unsigned int)arg6;
+
+    return oe_splice(fd_in, off_in, fd_out, off_out, len, flags);
+}
+
 #if __x86_64__ || _M_X64
 OE_DEFINE_SYSCALL2(SYS_stat)
 {
@@ -1068,12 +1093,14 @@ static long _syscall(
 #if __x86_64__ || _M_X64
         OE_SYSCALL_DISPATCH(SYS_select, arg1, arg2, arg3, arg4, arg5);
 #endif
+        OE_SYSCALL_DISPATCH(SYS_sendfile, arg1, arg2, arg3, arg4);
         OE_SYSCALL_DISPATCH(SYS_sendto, arg1, arg2, arg3, arg4, arg5, arg6);
         OE_SYSCALL_DISPATCH(SYS_sendmsg, arg1, arg2, arg3);
         OE_SYSCALL_DISPATCH(SYS_setsockopt, arg1, arg2, arg3, arg4, arg5);
         OE_SYSCALL_DISPATCH(SYS_shutdown, arg1, arg2);
         OE_SYSCALL_DISPATCH(SYS_socket, arg1, arg2, arg3);
         OE_SYSCALL_DISPATCH(SYS_socketpair, arg1, arg2, arg3, arg4);
+        OE_SYSCALL_DISPATCH(SYS_splice, arg1, arg2, arg3, arg4, arg5, arg6);
 #if __x86_64__ || _M_X64
         OE_SYSCALL_DISPATCH(SYS_stat, arg1, arg2);
 #endif
@@ -128,6 +128,8 @@ int oe_chdir(const char* path)
     if (oe_strlcpy(_cwd, real_path.buf, OE_PATH_MAX) >= OE_PATH_MAX)
         OE_RAISE_ERRNO(OE_ENAMETOOLONG);
 
+    /* Relative paths now resolve differently. */
+    oe_mount_invalidate_cache();
     ret = 0;
 
 done:
@@ -231,7 +233,7 @@ done:
 ssize_t oe_read(int fd, void* buf, size_t count)
 {
     ssize_t ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
@@ -239,13 +241,16 @@ ssize_t oe_read(int fd, void* buf, size_t count)
     ret = desc->ops.fd.read(desc, buf, count);
 
 done:
+    if (desc)
+        oe_fdtable_put(desc);
+
     return ret;
 }
 
 ssize_t oe_write(int fd, const void* buf, size_t count)
 {
     ssize_t ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
@@ -253,6 +258,9 @@ ssize_t oe_write(int fd, const void* buf, size_t count)
     ret = desc->ops.fd.write(desc, buf, count);
 
 done:
+    if (desc)
+        oe_fdtable_put(desc);
+
     return ret;
 }
 
@@ -270,19 +278,19 @@ static void _close_epoll_callback(oe_fd_t* desc, void* arg)
 int oe_close(int fd)
 {
     int ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
 
-    if ((ret = desc->ops.fd.close(desc)) == 0)
-    {
-        // Notify epoll instances that this fd has been closed.
-        oe_fdtable_foreach(
-            OE_FD_TYPE_EPOLL, (void*)(intptr_t)fd, _close_epoll_callback);
+    oe_fdtable_put(desc);
 
-        oe_fdtable_release(fd);
-    }
+    // Notify epoll instances that this fd is being closed.
+    oe_fdtable_foreach(
+        OE_FD_TYPE_EPOLL, (void*)(intptr_t)fd, _close_epoll_callback);
+
+    // The descriptor is closed now, or by the last thread still using it.
+    ret = oe_fdtable_release(fd);
 
 done:
     return ret;
@@ -291,7 +299,7 @@ done:
 int oe_flock(int fd, int operation)
 {
     int ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
@@ -299,13 +307,16 @@ int oe_flock(int fd, int operation)
     ret = desc->ops.fd.flock(desc, operation);
 
 done:
+    if (desc)
+        oe_fdtable_put(desc);
+
     return ret;
 }
 
 int oe_fsync(int fd)
 {
     int ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
         OE_RAISE_ERRNO(oe_errno);
@@ -313,13 +324,16 @@ int oe_fsync(int fd)
     ret = desc->ops.file.fsync(desc);
 
 done:
+    if (desc)
+        oe_fdtable_put(desc);
+
     return ret;
 }
 
 int oe_fdatasync(int fd)
 {
     int ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
         OE_RAISE_ERRNO(oe_errno);
@@ -327,13 +341,16 @@ int oe_fdatasync(int fd)
     ret = desc->ops.file.fdatasync(desc);
 
 done:
+    if (desc)
+        oe_fdtable_put(desc);
+
     return ret;
 }
 
 int oe_dup(int oldfd)
 {
     int ret = -1;
-    oe_fd_t* old_desc;
+    oe_fd_t* old_desc = NULL;
     oe_fd_t* new_desc = NULL;
     int newfd;
 
@@ -354,12 +371,15 @@ done:
     if (new_desc)
         new_desc->ops.fd.close(new_desc);
 
+    if (old_desc)
+        oe_fdtable_put(old_desc);
+
     return ret;
 }
 
 int oe_dup2(int oldfd, int newfd)
 {
-    oe_fd_t* old_desc;
+    oe_fd_t* old_desc = NULL;
     oe_fd_t* new_desc = NULL;
     oe_fd_t* reassigned_desc;
     int retval = -1;
@@ -377,7 +397,7 @@ int oe_dup2(int oldfd, int newfd)
         OE_RAISE_ERRNO(OE_EINVAL);
 
     if (reassigned_desc)
-        reassigned_desc->ops.fd.close(reassigned_desc);
+        oe_fdtable_put(reassigned_desc);
 
     new_desc = NULL;
 
@@ -386,6 +406,9 @@ done:
     if (new_desc)
         new_desc->ops.fd.close(new_desc);
 
+    if (old_desc)
+        oe_fdtable_put(old_desc);
+
     return newfd;
 }
 
@@ -548,7 +571,7 @@ done:
 oe_off_t oe_lseek(int fd, oe_off_t offset, int whence)
 {
     oe_off_t ret = -1;
-    oe_fd_t* file;
+    oe_fd_t* file = NULL;
 
     if (!(file = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
         OE_RAISE_ERRNO(oe_errno);
@@ -556,13 +579,16 @@ oe_off_t oe_lseek(int fd, oe_off_t offset, int whence)
     ret = file->ops.file.lseek(file, offset, whence);
 
 done:
+    if (file)
+        oe_fdtable_put(file);
+
     return ret;
 }
 
 ssize_t oe_pread(int fd, void* buf, size_t count, oe_off_t offset)
 {
     ssize_t ret = -1;
-    oe_fd_t* file;
+    oe_fd_t* file = NULL;
 
     if (!(file = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
         OE_RAISE_ERRNO(oe_errno);
@@ -570,13 +596,16 @@ ssize_t oe_pread(int fd, void* buf, size_t count, oe_off_t offset)
     ret = file->ops.file.pread(file, buf, count, offset);
 
 done:
+    if (file)
+        oe_fdtable_put(file);
+
     return ret;
 }
 
 ssize_t oe_pwrite(int fd, const void* buf, size_t count, oe_off_t offset)
 {
     ssize_t ret = -1;
-    oe_fd_t* file;
+    oe_fd_t* file = NULL;
 
     if (!(file = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
         OE_RAISE_ERRNO(oe_errno);
@@ -584,13 +613,16 @@ ssize_t oe_pwrite(int fd, const void* buf, size_t count, oe_off_t offset)
     ret = file->ops.file.pwrite(file, buf, count, offset);
 
 done:
+    if (file)
+        oe_fdtable_put(file);
+
     return ret;
 }
 
 ssize_t oe_readv(int fd, const struct oe_iovec* iov, int iovcnt)
 {
     ssize_t ret = -1;
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
@@ -598,6 +630,9 @@ ssize_t oe_readv(int fd, const struct oe_iovec* iov, int iovcnt)
     ret = desc->ops.fd.readv(desc, iov, iovcnt);
 
 done:
+    if (desc)
+        oe_fdtable_put(desc);
+
     return ret;
 }
 
@@ -605,7 +640,7 @@ ssize_t oe_writev(int fd, const struct oe_iovec* iov, int iovcnt)
 {
     ssize_t ret = -1;
 
-    oe_fd_t* desc;
+    oe_fd_t* desc = NULL;
 
     if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
         OE_RAISE_ERRNO(oe_errno);
@@ -613,6 +648,9 @@ ssize_t oe_writev(int fd, const struct oe_iovec* iov, int iovcnt)
     ret = desc->ops.fd.writev(desc, iov, iovcnt);
 
 done:
+    if (desc)
+        oe_fdtable_put(desc);
+
     return ret;
 }
 
@@ -0,0 +1,30 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include "call_stats_t.h"
+
+int enc_ping(size_t num_ocalls, size_t num_switchless_ocalls)
+{
+    for (size_t i = 0; i < num_ocalls; i++)
+    {
+        if (host_ping() != OE_OK)
+            return -1;
+    }
+
+    for (size_t i = 0; i < num_switchless_ocalls; i++)
+    {
+        if (host_ping_switchless() != OE_OK)
+            return -1;
+    }
+
+    return 0;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    16,   /* NumStackPages */
+    2);   /* NumTCS */
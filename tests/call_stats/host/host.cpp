@@ -0,0 +1,152 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <cstdio>
+#include <vector>
+#include "call_stats_u.h"
+
+#define NUM_ECALLS 17
+#define NUM_OCALLS 1001
+#define NUM_SWITCHLESS_OCALLS 2003
+
+void host_ping()
+{
+}
+
+void host_ping_switchless()
+{
+}
+
+/* Find the statistics of the only function called count times. The function
+ * ids are private to the generated code. */
+static const oe_call_stats_t* _find_stats(
+    const std::vector<oe_call_stats_t>& stats,
+    uint64_t count)
+{
+    const oe_call_stats_t* found = NULL;
+
+    for (const oe_call_stats_t& s : stats)
+    {
+        if (s.count == count)
+        {
+            OE_TEST(found == NULL);
+            found = &s;
+        }
+    }
+
+    OE_TEST(found != NULL);
+    return found;
+}
+
+static uint64_t _histogram_total(const oe_call_stats_t* stats)
+{
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < OE_CALL_STATS_HISTOGRAM_SIZE; i++)
+        total += stats->histogram[i];
+
+    return total;
+}
+
+static void _test_call_stats(oe_enclave_t* enclave)
+{
+    size_t num_ecalls = 0;
+    size_t num_ocalls = 0;
+    int ret = -1;
+
+    for (size_t i = 0; i < NUM_ECALLS; i++)
+    {
+        OE_TEST(enc_ping(enclave, &ret, NUM_OCALLS / NUM_ECALLS, 0) == OE_OK);
+        OE_TEST(ret == 0);
+    }
+    OE_TEST(
+        enc_ping(
+            enclave,
+            &ret,
+            NUM_OCALLS % NUM_ECALLS,
+            NUM_SWITCHLESS_OCALLS) == OE_OK);
+    OE_TEST(ret == 0);
+
+    // Query the sizes first.
+    OE_TEST(
+        oe_get_enclave_call_stats(
+            enclave, NULL, &num_ecalls, NULL, &num_ocalls) ==
+        OE_BUFFER_TOO_SMALL);
+    OE_TEST(num_ecalls > 0 && num_ocalls >= 2);
+
+    std::vector<oe_call_stats_t> ecall_stats(num_ecalls);
+    std::vector<oe_call_stats_t> ocall_stats(num_ocalls);
+
+    OE_TEST(
+        oe_get_enclave_call_stats(
+            enclave,
+            ecall_stats.data(),
+            &num_ecalls,
+            ocall_stats.data(),
+            &num_ocalls) == OE_OK);
+
+    const oe_call_stats_t* ping_stats =
+        _find_stats(ecall_stats, NUM_ECALLS + 1);
+    OE_TEST(ping_stats->cycles > 0);
+    OE_TEST(_histogram_total(ping_stats) == ping_stats->count);
+
+    const oe_call_stats_t* regular_stats =
+        _find_stats(ocall_stats, NUM_OCALLS);
+    OE_TEST(_histogram_total(regular_stats) == regular_stats->count);
+    OE_TEST(regular_stats->switchless_hits == 0);
+    OE_TEST(regular_stats->switchless_misses == 0);
+
+    const oe_call_stats_t* switchless_stats =
+        _find_stats(ocall_stats, NUM_SWITCHLESS_OCALLS);
+    OE_TEST(_histogram_total(switchless_stats) == switchless_stats->count);
+    OE_TEST(
+        switchless_stats->switchless_hits +
+            switchless_stats->switchless_misses ==
+        NUM_SWITCHLESS_OCALLS);
+
+    printf(
+        "switchless ocalls: %llu hits, %llu misses\n",
+        (unsigned long long)switchless_stats->switchless_hits,
+        (unsigned long long)switchless_stats->switchless_misses);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    // One host worker, so that some switchless ocalls may miss.
+    oe_enclave_setting_context_switchless_t switchless_setting = {1, 0, 0, 0};
+    oe_enclave_setting_t settings[1];
+    settings[0].setting_type = OE_ENCLAVE_SETTING_CONTEXT_SWITCHLESS;
+    settings[0].u.context_switchless_setting = &switchless_setting;
+
+    result = oe_create_call_stats_enclave(
+        argv[1],
+        OE_ENCLAVE_TYPE_AUTO,
+        flags,
+        settings,
+        OE_COUNTOF(settings),
+        &enclave);
+    if (result != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    _test_call_stats(enclave);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (call_stats)\n");
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/report.h>
+#include <openenclave/internal/tests.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../common/sgx/collateral.h"
+#include "../../../common/sgx/collateralcache.h"
+#include "collateral_cache_t.h"
+
+#define NUM_TCS 8
+
+static const char _issuer_chain[] = "issuer chain";
+
+/* The collateral returned by _fetch() */
+static uint8_t* _tcb_info;
+static size_t _tcb_info_size;
+static uint8_t* _qe_identity;
+static size_t _qe_identity_size;
+static uint8_t* _crl;
+static size_t _crl_size;
+
+static oe_result_t _fetch_result = OE_OK;
+static uint64_t _fetches;
+static bool _gate_closed;
+
+static uint8_t* _copy(const void* data, size_t size)
+{
+    uint8_t* copy = (uint8_t*)malloc(size);
+
+    if (copy)
+        memcpy(copy, data, size);
+
+    return copy;
+}
+
+static void _set(
+    uint8_t** item,
+    size_t* item_size,
+    const void* data,
+    size_t size)
+{
+    free(*item);
+    OE_TEST(*item = _copy(data, size));
+    *item_size = size;
+}
+
+static oe_result_t _fetch(
+    oe_get_sgx_quote_verification_collateral_args_t* args)
+{
+    __atomic_add_fetch(&_fetches, 1, __ATOMIC_SEQ_CST);
+
+    while (__atomic_load_n(&_gate_closed, __ATOMIC_ACQUIRE))
+        asm volatile("pause");
+
+    if (_fetch_result != OE_OK)
+        return _fetch_result;
+
+    args->tcb_info = _copy(_tcb_info, _tcb_info_size);
+    args->tcb_info_size = _tcb_info_size;
+    args->tcb_info_issuer_chain = _copy(_issuer_chain, sizeof(_issuer_chain));
+    args->tcb_info_issuer_chain_size = sizeof(_issuer_chain);
+    args->pck_crl = _copy(_crl, _crl_size);
+    args->pck_crl_size = _crl_size;
+    args->pck_crl_issuer_chain = _copy(_issuer_chain, sizeof(_issuer_chain));
+    args->pck_crl_issuer_chain_size = sizeof(_issuer_chain);
+    args->root_ca_crl = _copy(_crl, _crl_size);
+    args->root_ca_crl_size = _crl_size;
+    args->qe_identity = _copy(_qe_identity, _qe_identity_size);
+    args->qe_identity_size = _qe_identity_size;
+    args->qe_identity_issuer_chain =
+        _copy(_issuer_chain, sizeof(_issuer_chain));
+    args->qe_identity_issuer_chain_size = sizeof(_issuer_chain);
+
+    if (!args->tcb_info || !args->tcb_info_issuer_chain || !args->pck_crl ||
+        !args->pck_crl_issuer_chain || !args->root_ca_crl ||
+        !args->qe_identity || !args->qe_identity_issuer_chain)
+    {
+        oe_free_sgx_quote_verification_collateral_args(args);
+        return OE_OUT_OF_MEMORY;
+    }
+
+    return OE_OK;
+}
+
+static void _check_item(
+    const uint8_t* item,
+    size_t item_size,
+    const void* expected,
+    size_t expected_size)
+{
+    OE_TEST(item_size == expected_size);
+    OE_TEST(memcmp(item, expected, expected_size) == 0);
+}
+
+void enc_set_collateral(
+    const void* tcb_info,
+    size_t tcb_info_size,
+    const void* qe_identity,
+    size_t qe_identity_size,
+    const void* crl,
+    size_t crl_size)
+{
+    _set(&_tcb_info, &_tcb_info_size, tcb_info, tcb_info_size);
+    _set(&_qe_identity, &_qe_identity_size, qe_identity, qe_identity_size);
+    _set(&_crl, &_crl_size, crl, crl_size);
+    _fetch_result = OE_OK;
+}
+
+void enc_set_fetch_result(oe_result_t result)
+{
+    _fetch_result = result;
+}
+
+void enc_close_gate()
+{
+    __atomic_store_n(&_gate_closed, true, __ATOMIC_RELEASE);
+}
+
+void enc_open_gate()
+{
+    __atomic_store_n(&_gate_closed, false, __ATOMIC_RELEASE);
+}
+
+oe_result_t enc_get_collateral(uint8_t fmspc)
+{
+    oe_get_sgx_quote_verification_collateral_args_t args = {0};
+    oe_result_t result;
+
+    args.fmspc[0] = fmspc;
+    args.collateral_provider = CRL_CA_PROCESSOR;
+
+    result = oe_get_cached_sgx_quote_verification_collateral(&args, _fetch);
+
+    if (result == OE_OK)
+    {
+        _check_item(
+            args.tcb_info, args.tcb_info_size, _tcb_info, _tcb_info_size);
+        _check_item(
+            args.qe_identity,
+            args.qe_identity_size,
+            _qe_identity,
+            _qe_identity_size);
+        _check_item(args.pck_crl, args.pck_crl_size, _crl, _crl_size);
+        _check_item(args.root_ca_crl, args.root_ca_crl_size, _crl, _crl_size);
+        _check_item(
+            args.qe_identity_issuer_chain,
+            args.qe_identity_issuer_chain_size,
+            _issuer_chain,
+            sizeof(_issuer_chain));
+    }
+
+    // Frees the copies of _fetch() on a miss, and the single buffer that
+    // holds the items on a hit.
+    oe_free_sgx_quote_verification_collateral_args(&args);
+
+    return result;
+}
+
+void enc_tear_down()
+{
+    free(_tcb_info);
+    free(_qe_identity);
+    free(_crl);
+    _tcb_info = _qe_identity = _crl = NULL;
+}
+
+void enc_get_stats(uint64_t* hits, uint64_t* misses, uint64_t* fetches)
+{
+    oe_get_collateral_cache_stats(hits, misses);
+    *fetches = __atomic_load_n(&_fetches, __ATOMIC_SEQ_CST);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,                             /* ProductID */
+    1,                             /* SecurityVersion */
+    true,                          /* Debug */
+    OE_TEST_MT_HEAP_SIZE(NUM_TCS), /* NumHeapPages */
+    16,                            /* NumStackPages */
+    NUM_TCS);                      /* NumTCS */
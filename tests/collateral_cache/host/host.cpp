@@ -0,0 +1,232 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "collateral_cache_u.h"
+
+#define NUM_WAITERS 4
+
+// Dates relative to now, in seconds.
+#define PAST (-60)
+#define SOON 2
+#define LATER (24 * 60 * 60)
+
+typedef struct _stats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t fetches;
+} stats_t;
+
+static std::vector<uint8_t> _crl;
+
+static std::string _date(long offset)
+{
+    time_t t = time(NULL) + offset;
+    char str[32];
+
+    OE_TEST(strftime(str, sizeof(str), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t)) > 0);
+    return str;
+}
+
+static std::string _json(const char* name, long issued, long next)
+{
+    return std::string("{\"") + name +
+           "\":{\"version\":2,\"issueDate\":\"" + _date(issued) +
+           "\",\"nextUpdate\":\"" + _date(next) + "\",\"tcbType\":0}}";
+}
+
+// The TCB info and the QE identity are valid from the given issue dates
+// until the given next updates. The CRL is valid until 2048.
+static void _set_collateral(
+    oe_enclave_t* enclave,
+    long tcb_info_issued,
+    long tcb_info_next,
+    long qe_identity_issued,
+    long qe_identity_next)
+{
+    std::string tcb_info = _json("tcbInfo", tcb_info_issued, tcb_info_next);
+    std::string qe_identity =
+        _json("enclaveIdentity", qe_identity_issued, qe_identity_next);
+
+    OE_TEST(
+        enc_set_collateral(
+            enclave,
+            tcb_info.data(),
+            tcb_info.size(),
+            qe_identity.data(),
+            qe_identity.size(),
+            _crl.data(),
+            _crl.size()) == OE_OK);
+}
+
+static void _get(oe_enclave_t* enclave, uint8_t fmspc, oe_result_t expected)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    OE_TEST(enc_get_collateral(enclave, &result, fmspc) == OE_OK);
+    OE_TEST(result == expected);
+}
+
+static stats_t _get_stats(oe_enclave_t* enclave)
+{
+    stats_t stats = {0, 0, 0};
+
+    OE_TEST(
+        enc_get_stats(enclave, &stats.hits, &stats.misses, &stats.fetches) ==
+        OE_OK);
+    return stats;
+}
+
+static void _check_stats(
+    oe_enclave_t* enclave,
+    const stats_t& before,
+    uint64_t hits,
+    uint64_t misses)
+{
+    stats_t after = _get_stats(enclave);
+
+    OE_TEST(after.hits - before.hits == hits);
+    OE_TEST(after.misses - before.misses == misses);
+    OE_TEST(after.fetches - before.fetches == misses);
+}
+
+// Valid collateral is fetched once and then served from the cache.
+static void _test_hits(oe_enclave_t* enclave)
+{
+    stats_t before = _get_stats(enclave);
+
+    _set_collateral(enclave, PAST, LATER, PAST, LATER);
+    _get(enclave, 1, OE_OK);
+    _check_stats(enclave, before, 0, 1);
+
+    for (size_t i = 0; i < 3; i++)
+        _get(enclave, 1, OE_OK);
+    _check_stats(enclave, before, 3, 1);
+
+    // Another FMSPC has its own entry.
+    _get(enclave, 2, OE_OK);
+    _get(enclave, 2, OE_OK);
+    _check_stats(enclave, before, 4, 2);
+}
+
+// Collateral expires at the earliest next update of its parts, here the one
+// of the QE identity.
+static void _test_expiry(oe_enclave_t* enclave)
+{
+    stats_t before = _get_stats(enclave);
+
+    _set_collateral(enclave, PAST, LATER, PAST, SOON);
+    _get(enclave, 3, OE_OK);
+    _get(enclave, 3, OE_OK);
+    _check_stats(enclave, before, 1, 1);
+
+    std::this_thread::sleep_for(std::chrono::seconds(SOON + 1));
+
+    // Expired collateral is fetched again, and not kept since it is still
+    // expired.
+    _get(enclave, 3, OE_OK);
+    _get(enclave, 3, OE_OK);
+    _check_stats(enclave, before, 1, 3);
+}
+
+// Collateral that is not valid yet is not kept.
+static void _test_not_yet_valid(oe_enclave_t* enclave)
+{
+    stats_t before = _get_stats(enclave);
+
+    _set_collateral(enclave, LATER, 2 * LATER, PAST, LATER);
+    _get(enclave, 4, OE_OK);
+    _get(enclave, 4, OE_OK);
+    _check_stats(enclave, before, 0, 2);
+}
+
+// Failed fetches are reported and not kept.
+static void _test_failed_fetch(oe_enclave_t* enclave)
+{
+    stats_t before = _get_stats(enclave);
+
+    _set_collateral(enclave, PAST, LATER, PAST, LATER);
+    OE_TEST(enc_set_fetch_result(enclave, OE_FAILURE) == OE_OK);
+    _get(enclave, 5, OE_FAILURE);
+    _get(enclave, 5, OE_FAILURE);
+    _check_stats(enclave, before, 0, 2);
+
+    OE_TEST(enc_set_fetch_result(enclave, OE_OK) == OE_OK);
+    _get(enclave, 5, OE_OK);
+    _get(enclave, 5, OE_OK);
+    _check_stats(enclave, before, 1, 3);
+}
+
+// Concurrent misses on the same FMSPC share one fetch.
+static void _test_single_flight(oe_enclave_t* enclave)
+{
+    std::vector<std::thread> threads;
+    stats_t before = _get_stats(enclave);
+
+    _set_collateral(enclave, PAST, LATER, PAST, LATER);
+    OE_TEST(enc_close_gate(enclave) == OE_OK);
+
+    for (size_t i = 0; i < NUM_WAITERS; i++)
+        threads.push_back(std::thread(_get, enclave, 6, OE_OK));
+
+    // Let the threads reach the cache. A thread that comes late is a hit
+    // as well.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    OE_TEST(enc_open_gate(enclave) == OE_OK);
+
+    for (auto& t : threads)
+        t.join();
+
+    _check_stats(enclave, before, NUM_WAITERS - 1, 1);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream file("./data/root.crl.pem", std::ios::binary);
+    OE_TEST(file.good());
+    _crl.assign(
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    OE_TEST(!_crl.empty());
+
+    const uint32_t flags = oe_get_create_flags();
+
+    result = oe_create_collateral_cache_enclave(
+        argv[1], OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave);
+    if (result != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    _test_hits(enclave);
+    _test_expiry(enclave);
+    _test_not_yet_valid(enclave);
+    _test_failed_fetch(enclave);
+    _test_single_flight(enclave);
+
+    // The cache still holds collateral, which the enclave must release
+    // before its leak check.
+    OE_TEST(enc_tear_down(enclave) == OE_OK);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (collateral_cache)\n");
+
+    return 0;
+}
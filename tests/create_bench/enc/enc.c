@@ -0,0 +1,38 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/globals.h>
+#include <openenclave/internal/tests.h>
+#include "create_bench_t.h"
+
+/* 64 MB of heap, enough for the time to add the heap pages to dominate the
+ * creation of the enclave. */
+#define NUM_HEAP_PAGES 16384
+
+size_t enc_get_heap_size()
+{
+    return __oe_get_heap_size();
+}
+
+int enc_check_heap()
+{
+    const uint8_t* end = (const uint8_t*)__oe_get_heap_end();
+    const uint8_t* p = end - __oe_get_heap_size() / 2;
+
+    for (; p < end; p++)
+    {
+        if (*p)
+            return -1;
+    }
+
+    return 0;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,              /* ProductID */
+    1,              /* SecurityVersion */
+    true,           /* Debug */
+    NUM_HEAP_PAGES, /* NumHeapPages */
+    16,             /* NumStackPages */
+    1);             /* NumTCS */
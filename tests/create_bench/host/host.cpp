@@ -0,0 +1,94 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include "../../../host/sgx/enclave.h"
+#include "../../../host/sgx/measurecache.h"
+#include "create_bench_u.h"
+
+#define ITERATIONS 8
+#define PAGE_SIZE 4096
+
+static void _run_benchmark(const char* path, uint32_t flags)
+{
+    double seconds = 0;
+    size_t heap_size = 0;
+    OE_SHA256 mrenclave;
+    uint64_t hits_before = 0;
+    uint64_t hits_after = 0;
+
+    oe_sgx_get_measure_cache_stats(&hits_before, NULL);
+
+    for (size_t i = 0; i < ITERATIONS; i++)
+    {
+        oe_result_t result;
+        oe_enclave_t* enclave = NULL;
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        result = oe_create_create_bench_enclave(
+            path, OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        if (result != OE_OK)
+            oe_put_err("oe_create_enclave(): result=%u", result);
+
+        seconds += std::chrono::duration<double>(end - begin).count();
+
+        // In hardware mode, only the first enclave is measured and the
+        // others reuse its MRENCLAVE. Simulated enclaves are all measured.
+        if (i == 0)
+            mrenclave = enclave->hash;
+        else
+            OE_TEST(memcmp(&enclave->hash, &mrenclave, sizeof(mrenclave)) == 0);
+
+        // The heap pages are added without a copy of their contents in
+        // simulation mode, so check that they are still zero.
+        if (i == 0)
+        {
+            int ret = -1;
+
+            OE_TEST(enc_get_heap_size(enclave, &heap_size) == OE_OK);
+            OE_TEST(enc_check_heap(enclave, &ret) == OE_OK);
+            OE_TEST(ret == 0);
+        }
+
+        OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+    }
+
+    oe_sgx_get_measure_cache_stats(&hits_after, NULL);
+    if (flags & OE_ENCLAVE_FLAG_SIMULATE)
+        OE_TEST(hits_after == hits_before);
+    else
+        OE_TEST(hits_after - hits_before >= ITERATIONS - 1);
+
+    printf(
+        "%s: %.1f ms per enclave, %.0f heap pages/s\n",
+        (flags & OE_ENCLAVE_FLAG_SIMULATE) ? "simulation" : "hardware",
+        seconds * 1000 / ITERATIONS,
+        (double)(ITERATIONS * (heap_size / PAGE_SIZE)) / seconds);
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    if (!(flags & OE_ENCLAVE_FLAG_SIMULATE))
+        _run_benchmark(argv[1], flags);
+
+    _run_benchmark(argv[1], flags | OE_ENCLAVE_FLAG_SIMULATE);
+
+    printf("=== passed all tests (create_bench)\n");
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/sgx/ecall_context.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ecall_bandwidth_t.h"
+
+static uint64_t _checksum(const uint8_t* buffer, size_t size)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+        sum += buffer[i];
+
+    return sum;
+}
+
+uint64_t enc_checksum(const uint8_t* buffer, size_t size)
+{
+    if (!oe_is_within_enclave(buffer, size))
+        return 0;
+
+    return _checksum(buffer, size);
+}
+
+uint64_t enc_checksum_zero_copy(const uint8_t* buffer, size_t size)
+{
+    if (!oe_is_within_enclave(buffer, size))
+        return 0;
+
+    return _checksum(buffer, size);
+}
+
+int enc_echo_zero_copy(const char* in, char* out, size_t out_size)
+{
+    size_t length = strlen(in);
+
+    if (!oe_is_within_enclave(in, length + 1) ||
+        !oe_is_within_enclave(out, out_size) || length >= out_size)
+        return -1;
+
+    memcpy(out, in, length + 1);
+    return 0;
+}
+
+int enc_make_large_ocalls(
+    size_t size,
+    size_t count,
+    uint64_t* grow_count,
+    uint64_t* fallback_count)
+{
+    int ret = -1;
+    uint64_t grow_before = 0;
+    uint64_t fallback_before = 0;
+    uint8_t* buffer = (uint8_t*)malloc(size);
+
+    if (!buffer)
+        return -1;
+
+    for (size_t i = 0; i < size; i++)
+        buffer[i] = (uint8_t)i;
+
+    oe_get_ocall_buffer_statistics(&grow_before, &fallback_before);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t sum = 0;
+
+        if (host_checksum(&sum, buffer, size) != OE_OK ||
+            sum != _checksum(buffer, size))
+            goto done;
+    }
+
+    oe_get_ocall_buffer_statistics(grow_count, fallback_count);
+    *grow_count -= grow_before;
+    *fallback_count -= fallback_before;
+    ret = 0;
+
+done:
+    free(buffer);
+    return ret;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,     /* ProductID */
+    1,     /* SecurityVersion */
+    true,  /* Debug */
+    12288, /* NumHeapPages */
+    16,    /* NumStackPages */
+    2);    /* NumTCS */
@@ -0,0 +1,150 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/sgx/ecall_context.h>
+#include <openenclave/internal/tests.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "ecall_bandwidth_u.h"
+
+#define ITERATIONS 16
+
+static uint64_t _checksum(const std::vector<uint8_t>& buffer)
+{
+    uint64_t sum = 0;
+
+    for (uint8_t b : buffer)
+        sum += b;
+
+    return sum;
+}
+
+uint64_t host_checksum(const uint8_t* buffer, size_t size)
+{
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+        sum += buffer[i];
+
+    return sum;
+}
+
+static void _test_large_ocalls(oe_enclave_t* enclave)
+{
+    const size_t size = 1024 * 1024;
+    uint64_t grow_count = 0;
+    uint64_t fallback_count = 0;
+    int ret = -1;
+
+    // The first large ocall grows the ocall buffer of the thread binding.
+    OE_TEST(
+        enc_make_large_ocalls(
+            enclave, &ret, size, 8, &grow_count, &fallback_count) == OE_OK);
+    OE_TEST(ret == 0);
+    OE_TEST(grow_count == 1);
+    OE_TEST(fallback_count == 0);
+
+    // Later ecalls on the same thread reuse the grown buffer.
+    OE_TEST(
+        enc_make_large_ocalls(
+            enclave, &ret, size, 8, &grow_count, &fallback_count) == OE_OK);
+    OE_TEST(ret == 0);
+    OE_TEST(grow_count == 0);
+    OE_TEST(fallback_count == 0);
+
+    // Buffers beyond the maximum size are allocated with oe_host_malloc.
+    OE_TEST(
+        enc_make_large_ocalls(
+            enclave,
+            &ret,
+            OE_MAX_OCALL_BUFFER_SIZE + 1,
+            1,
+            &grow_count,
+            &fallback_count) == OE_OK);
+    OE_TEST(ret == 0);
+    OE_TEST(grow_count == 0);
+    OE_TEST(fallback_count == 1);
+}
+
+static void _test_echo_zero_copy(oe_enclave_t* enclave)
+{
+    char out[32] = {0};
+    int ret = -1;
+
+    OE_TEST(
+        enc_echo_zero_copy(enclave, &ret, "zero copy", out, sizeof(out)) ==
+        OE_OK);
+    OE_TEST(ret == 0);
+    OE_TEST(strcmp(out, "zero copy") == 0);
+
+    // Too small output buffer.
+    OE_TEST(enc_echo_zero_copy(enclave, &ret, "zero copy", out, 4) == OE_OK);
+    OE_TEST(ret == -1);
+}
+
+static void _run_bandwidth_benchmark(oe_enclave_t* enclave, bool zero_copy)
+{
+    for (size_t size = 1024 * 1024; size <= 16 * 1024 * 1024; size *= 2)
+    {
+        std::vector<uint8_t> buffer(size);
+        for (size_t i = 0; i < size; i++)
+            buffer[i] = (uint8_t)(i * 31);
+
+        uint64_t expected = _checksum(buffer);
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < ITERATIONS; i++)
+        {
+            uint64_t sum = 0;
+            oe_result_t result =
+                zero_copy ? enc_checksum_zero_copy(
+                                enclave, &sum, buffer.data(), buffer.size())
+                          : enc_checksum(
+                                enclave, &sum, buffer.data(), buffer.size());
+            OE_TEST(result == OE_OK);
+            OE_TEST(sum == expected);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - begin).count();
+
+        printf(
+            "%s ecalls with %zu KB input: %.1f MB/s\n",
+            zero_copy ? "zero_copy" : "regular",
+            size / 1024,
+            (double)(size * ITERATIONS) / (1024 * 1024) / seconds);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    result = oe_create_ecall_bandwidth_enclave(
+        argv[1], OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave);
+    if (result != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    _test_echo_zero_copy(enclave);
+    _test_large_ocalls(enclave);
+    _run_bandwidth_benchmark(enclave, false);
+    _run_bandwidth_benchmark(enclave, true);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (ecall_bandwidth)\n");
+
+    return 0;
+}
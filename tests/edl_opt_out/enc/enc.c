@@ -24,10 +24,13 @@ void enc_edl_opt_out()
     OE_TEST(oe_syscall_write_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_pread_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_pwrite_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(oe_syscall_splice_ocall(NULL, 0, 0, 0, 0, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_fsync_ocall(NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_fdatasync_ocall(NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_opendir_ocall(NULL, NULL) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_readdir_ocall(NULL, 0, NULL) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_readdir_batch_ocall(NULL, 0, NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_rewinddir_ocall(0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_closedir_ocall(NULL, 0) == OE_UNSUPPORTED);
     OE_TEST(oe_syscall_stat_ocall(NULL, NULL, NULL) == OE_UNSUPPORTED);
@@ -65,6 +68,9 @@ void enc_edl_opt_out()
         oe_syscall_sendmsg_ocall(NULL, 0, NULL, 0, NULL, 0, 0, NULL, 0, 0) ==
         OE_UNSUPPORTED);
     OE_TEST(oe_syscall_recv_ocall(NULL, 0, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_recv_host_buffer_ocall(NULL, 0, NULL, 0, 0) ==
+        OE_UNSUPPORTED);
     OE_TEST(
         oe_syscall_recvfrom_ocall(NULL, 0, NULL, 0, 0, NULL, 0, NULL) ==
         OE_UNSUPPORTED);
@@ -95,6 +101,18 @@ void enc_edl_opt_out()
 
     /* poll.edl */
     OE_TEST(oe_syscall_poll_ocall(NULL, NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(oe_syscall_poll_create_ocall(NULL) == OE_UNSUPPORTED);
+    OE_TEST(
+        oe_syscall_poll_wait_ocall(NULL, 0, false, NULL, 0, NULL, 0, 0) ==
+        OE_UNSUPPORTED);
+    OE_TEST(oe_syscall_poll_close_ocall(NULL, 0) == OE_UNSUPPORTED);
+
+    /* ioring.edl */
+    OE_TEST(
+        oe_syscall_io_ring_setup_ocall(NULL, 0, 0, 0, NULL) == OE_UNSUPPORTED);
+    OE_TEST(oe_syscall_io_ring_wake_ocall(NULL, 0) == OE_UNSUPPORTED);
+    OE_TEST(oe_syscall_io_ring_wait_ocall(NULL, 0, 0) == OE_UNSUPPORTED);
+    OE_TEST(oe_syscall_io_ring_teardown_ocall(NULL, 0) == OE_UNSUPPORTED);
 
     /* time.edl */
     OE_TEST(oe_syscall_nanosleep_ocall(NULL, NULL, NULL) == OE_UNSUPPORTED);
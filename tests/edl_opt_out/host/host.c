@@ -66,7 +66,7 @@ int main(int argc, const char* argv[])
     /* sgx/switchless.edl */
     result = OE_OK;
     OE_TEST(
-        oe_sgx_init_context_switchless_ecall(NULL, &result, NULL, 0) ==
+        oe_sgx_init_context_switchless_ecall(NULL, &result, NULL, 0, NULL) ==
         OE_UNSUPPORTED);
     OE_TEST(result == OE_UNSUPPORTED);
     OE_TEST(
@@ -0,0 +1,56 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include "large_image_t.h"
+
+#define MB (1024 * 1024)
+
+/* The host stages the image in chunks of 4 MB. The sizes and the splits
+ * between the fill values are not multiples of the page size, so that the
+ * segments and the changes of their contents straddle chunk boundaries. */
+#define RODATA_SIZE (5 * MB + 1000)
+#define RODATA_SPLIT (3 * MB + 10)
+#define DATA_SIZE (9 * MB + 3000)
+#define DATA_SPLIT (4 * MB + 3000)
+#define BSS_SIZE (3 * MB)
+
+/* Contents of the read-only segment */
+static const uint8_t _rodata[RODATA_SIZE] = {
+    [0 ... RODATA_SPLIT - 1] = 0x11,
+    [RODATA_SPLIT ... RODATA_SIZE - 1] = 0x22};
+
+/* Contents of the writable segment, followed by the zeros of .bss */
+static uint8_t _data[DATA_SIZE] = {
+    [0 ... DATA_SPLIT - 1] = 0x33,
+    [DATA_SPLIT ... DATA_SIZE - 1] = 0x44};
+
+static uint8_t _bss[BSS_SIZE];
+
+/* Reads through a volatile pointer so that the arrays are not folded */
+static void _check(
+    const volatile uint8_t* p,
+    size_t size,
+    size_t split,
+    uint8_t first,
+    uint8_t second)
+{
+    for (size_t i = 0; i < size; i++)
+        OE_TEST(p[i] == (i < split ? first : second));
+}
+
+void enc_check_data()
+{
+    _check(_rodata, RODATA_SIZE, RODATA_SPLIT, 0x11, 0x22);
+    _check(_data, DATA_SIZE, DATA_SPLIT, 0x33, 0x44);
+    _check(_bss, BSS_SIZE, BSS_SIZE, 0, 0);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    256,  /* NumHeapPages */
+    16,   /* NumStackPages */
+    1);   /* NumTCS */
@@ -0,0 +1,147 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/elf.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/load.h>
+#include <openenclave/internal/properties.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../host/sgx/enclave.h"
+#include "../../../host/sgx/measurecache.h"
+#include "large_image_u.h"
+
+/* Size of the chunks that the loader stages in parallel */
+#define CHUNK_SIZE (4 * 1024 * 1024)
+
+/* Stages the loadable segments of the file one after the other, the way the
+ * loader did before it staged chunks in parallel. Also counts the segments
+ * that straddle a chunk boundary and those that end with zeros. */
+static char* _stage_sequentially(
+    const char* path,
+    size_t image_size,
+    size_t* num_straddling,
+    size_t* num_zero_filled)
+{
+    elf64_t elf = ELF64_INIT;
+    const elf64_ehdr_t* ehdr;
+    char* image_base;
+
+    OE_TEST(elf64_load(path, &elf) == 0);
+    OE_TEST((image_base = (char*)calloc(1, image_size)) != NULL);
+
+    ehdr = (const elf64_ehdr_t*)elf.data;
+    *num_straddling = 0;
+    *num_zero_filled = 0;
+
+    for (size_t i = 0; i < ehdr->e_phnum; i++)
+    {
+        const elf64_phdr_t* ph = elf64_get_program_header(&elf, i);
+
+        OE_TEST(ph != NULL);
+
+        if (ph->p_type != PT_LOAD)
+            continue;
+
+        OE_TEST(ph->p_vaddr + ph->p_memsz <= image_size);
+        OE_TEST(ph->p_offset + ph->p_filesz <= elf.size);
+        memcpy(
+            image_base + ph->p_vaddr,
+            (const uint8_t*)elf.data + ph->p_offset,
+            ph->p_filesz);
+
+        if (ph->p_vaddr / CHUNK_SIZE !=
+            (ph->p_vaddr + ph->p_memsz - 1) / CHUNK_SIZE)
+            (*num_straddling)++;
+
+        if (ph->p_memsz > ph->p_filesz)
+            (*num_zero_filled)++;
+    }
+
+    elf64_unload(&elf);
+    return image_base;
+}
+
+static void _test_staging(const char* path)
+{
+    oe_enclave_image_t image = {0};
+    size_t num_straddling;
+    size_t num_zero_filled;
+    char* expected;
+
+    OE_TEST(oe_load_enclave_image(path, &image) == OE_OK);
+
+    /* The image spans several chunks, which are staged on several threads,
+     * and its segments cross chunk boundaries. */
+    OE_TEST(image.elf.image_size > 4 * CHUNK_SIZE);
+
+    expected = _stage_sequentially(
+        path, image.elf.image_size, &num_straddling, &num_zero_filled);
+    OE_TEST(num_straddling >= 2);
+    OE_TEST(num_zero_filled >= 1);
+
+    OE_TEST(
+        memcmp(image.elf.image_base, expected, image.elf.image_size) == 0);
+
+    free(expected);
+    OE_TEST(oe_unload_enclave_image(&image) == OE_OK);
+}
+
+/* The MRENCLAVE measured from the staged image is the ENCLAVEHASH that
+ * oesign computed when it signed the image. */
+static void _test_measurement(const char* path, uint32_t flags)
+{
+    oe_enclave_image_t image = {0};
+    oe_sgx_enclave_properties_t properties;
+    const sgx_sigstruct_t* sigstruct;
+    oe_enclave_t* enclave = NULL;
+    uint64_t hits;
+    uint64_t misses;
+    oe_result_t result;
+
+    OE_TEST(oe_load_enclave_image(path, &image) == OE_OK);
+    OE_TEST(
+        oe_sgx_load_enclave_properties(
+            &image, OE_INFO_SECTION_NAME, &properties) == OE_OK);
+    OE_TEST(oe_unload_enclave_image(&image) == OE_OK);
+
+    result = oe_create_large_image_enclave(
+        path, OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave);
+    if (result != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    /* The first enclave of the process is measured, not looked up */
+    oe_sgx_get_measure_cache_stats(&hits, &misses);
+    OE_TEST(hits == 0);
+
+    sigstruct = (const sgx_sigstruct_t*)properties.sigstruct;
+    OE_TEST(
+        memcmp(
+            &enclave->hash,
+            sigstruct->enclavehash,
+            sizeof(sigstruct->enclavehash)) == 0);
+
+    OE_TEST(enc_check_data(enclave) == OE_OK);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    _test_staging(argv[1]);
+    _test_measurement(argv[1], flags);
+
+    printf("=== passed all tests (large_image)\n");
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/advanced/mallinfo.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "malloc_bench_t.h"
+
+#define NUM_TCS 8
+#define NUM_SLOTS 64
+
+static uint32_t _next_random(uint32_t* state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+
+    return *state = x;
+}
+
+/* Mostly small sizes, with the occasional larger one */
+static size_t _random_size(uint32_t* state)
+{
+    uint32_t r = _next_random(state);
+
+    if (r % 16 == 0)
+        return 512 + r % 2048;
+
+    return 1 + r % 256;
+}
+
+int enc_malloc_bench(size_t num_iterations, uint32_t seed)
+{
+    uint8_t* slots[NUM_SLOTS] = {0};
+    size_t sizes[NUM_SLOTS] = {0};
+    uint32_t state = seed ? seed : 1;
+    int ret = -1;
+
+    for (size_t i = 0; i < num_iterations; i++)
+    {
+        size_t slot = _next_random(&state) % NUM_SLOTS;
+
+        if (slots[slot])
+        {
+            // Check that no other allocation overlapped the block.
+            if (slots[slot][0] != (uint8_t)sizes[slot] ||
+                slots[slot][sizes[slot] - 1] != (uint8_t)slot)
+                goto done;
+
+            free(slots[slot]);
+        }
+
+        sizes[slot] = _random_size(&state);
+
+        if (!(slots[slot] = (uint8_t*)malloc(sizes[slot])))
+            goto done;
+
+        slots[slot][0] = (uint8_t)sizes[slot];
+        slots[slot][sizes[slot] - 1] = (uint8_t)slot;
+    }
+
+    ret = 0;
+
+done:
+    for (size_t i = 0; i < NUM_SLOTS; i++)
+        free(slots[i]);
+
+    return ret;
+}
+
+int enc_test_calloc()
+{
+    uint8_t* p;
+    // Volatile, so that the compiler does not flag the overflow below.
+    volatile size_t huge = SIZE_MAX / 2;
+
+    // Zero-sized allocations must not reach the thread cache size checks.
+    p = (uint8_t*)calloc(1, 0);
+    free(p);
+    p = (uint8_t*)calloc(0, 1);
+    free(p);
+    p = (uint8_t*)calloc(0, 0);
+    free(p);
+
+    // Overflowing sizes fail.
+    if (calloc(huge, 4))
+        return -1;
+
+    // Blocks served by the thread cache are zeroed, even when they were
+    // used before.
+    for (size_t size = 1; size <= 256; size++)
+    {
+        if (!(p = (uint8_t*)malloc(size)))
+            return -1;
+
+        memset(p, 0xff, size);
+        free(p);
+
+        if (!(p = (uint8_t*)calloc(size, 1)))
+            return -1;
+
+        for (size_t i = 0; i < size; i++)
+        {
+            if (p[i])
+            {
+                free(p);
+                return -1;
+            }
+        }
+
+        free(p);
+    }
+
+    return 0;
+}
+
+size_t enc_get_allocated_heap_size()
+{
+    oe_mallinfo_t info;
+
+    OE_TEST(oe_allocator_mallinfo(&info) == OE_OK);
+    return info.current_allocated_heap_size;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,                             /* ProductID */
+    1,                             /* SecurityVersion */
+    true,                          /* Debug */
+    OE_TEST_MT_HEAP_SIZE(NUM_TCS), /* NumHeapPages */
+    16,                            /* NumStackPages */
+    NUM_TCS);                      /* NumTCS */
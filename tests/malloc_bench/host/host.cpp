@@ -0,0 +1,83 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "malloc_bench_u.h"
+
+#define MAX_THREADS 8
+#define ITERATIONS_PER_THREAD 1000000
+
+static void _run_thread(oe_enclave_t* enclave, uint32_t seed)
+{
+    int ret = -1;
+
+    OE_TEST(
+        enc_malloc_bench(enclave, &ret, ITERATIONS_PER_THREAD, seed) == OE_OK);
+    OE_TEST(ret == 0);
+}
+
+static void _run_benchmark(oe_enclave_t* enclave, size_t num_threads)
+{
+    std::vector<std::thread> threads;
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < num_threads; i++)
+        threads.push_back(
+            std::thread(_run_thread, enclave, (uint32_t)(i + 1) * 2654435761u));
+
+    for (auto& t : threads)
+        t.join();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    printf(
+        "%zu thread(s): %.0f malloc/free pairs/s\n",
+        num_threads,
+        (double)(num_threads * ITERATIONS_PER_THREAD) / seconds);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    size_t heap_size_before = 0;
+    size_t heap_size_after = 0;
+    int ret = -1;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    result = oe_create_malloc_bench_enclave(
+        argv[1], OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave);
+    if (result != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    OE_TEST(enc_get_allocated_heap_size(enclave, &heap_size_before) == OE_OK);
+
+    OE_TEST(enc_test_calloc(enclave, &ret) == OE_OK);
+    OE_TEST(ret == 0);
+
+    for (size_t num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2)
+        _run_benchmark(enclave, num_threads);
+
+    // The blocks cached by each thread are returned when its ecall exits.
+    OE_TEST(enc_get_allocated_heap_size(enclave, &heap_size_after) == OE_OK);
+    OE_TEST(heap_size_after == heap_size_before);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (malloc_bench)\n");
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <errno.h>
+#include <openenclave/edger8r/enclave.h>
+#include <openenclave/enclave.h>
+#include <stdlib.h>
+#include "ocall_batch_t.h"
+
+int enc_test_batch(size_t count)
+{
+    int ret = -1;
+    oe_ocall_batch_t* batch = NULL;
+    oe_result_t* results = NULL;
+    uint64_t* values = NULL;
+
+    if (!(results = (oe_result_t*)calloc(count, sizeof(*results))) ||
+        !(values = (uint64_t*)calloc(count, sizeof(*values))))
+        goto done;
+
+    if (oe_ocall_batch_begin(&batch) != OE_OK)
+        goto done;
+
+    // Batches larger than the maximum number of calls are submitted in parts.
+    for (size_t i = 0; i < count; i++)
+    {
+        results[i] = OE_UNEXPECTED;
+        if (host_append_batch(batch, &results[i], &values[i], i, "batch") !=
+            OE_OK)
+            goto done;
+    }
+
+    // Calls without a result location or return value.
+    if (host_touch_batch(batch, NULL) != OE_OK)
+        goto done;
+
+    errno = 0;
+    if (oe_ocall_batch_submit(batch) != OE_OK)
+        goto done;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (results[i] != OE_OK || values[i] != i * 2)
+            goto done;
+    }
+
+    // errno is propagated in call order, so the last call wins.
+    if (errno != (int)(count - 1))
+        goto done;
+
+    // An empty batch can be submitted, and the batch can be reused.
+    if (oe_ocall_batch_submit(batch) != OE_OK)
+        goto done;
+
+    if (host_append_batch(batch, NULL, NULL, count, "reuse") != OE_OK)
+        goto done;
+
+    ret = 0;
+
+done:
+    if (batch && oe_ocall_batch_end(batch) != OE_OK)
+        ret = -1;
+
+    free(values);
+    free(results);
+    return ret;
+}
+
+int enc_append(size_t count, bool batched)
+{
+    oe_ocall_batch_t* batch = NULL;
+    uint64_t value = 0;
+
+    if (!batched)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (host_append(&value, i, "single") != OE_OK)
+                return -1;
+        }
+        return 0;
+    }
+
+    if (oe_ocall_batch_begin(&batch) != OE_OK)
+        return -1;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (host_append_batch(batch, NULL, NULL, i, "batched") != OE_OK)
+        {
+            oe_ocall_batch_end(batch);
+            return -1;
+        }
+    }
+
+    return oe_ocall_batch_end(batch) == OE_OK ? 0 : -1;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    16,   /* NumStackPages */
+    1);   /* NumTCS */
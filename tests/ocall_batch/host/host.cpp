@@ -0,0 +1,98 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <errno.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ocall_batch_u.h"
+
+#define BATCH_TEST_CALLS 200
+#define BENCHMARK_CALLS 100000
+
+static std::vector<uint64_t> _values;
+static size_t _touches;
+
+uint64_t host_append(uint64_t value, const char* tag)
+{
+    OE_TEST(tag != NULL);
+    _values.push_back(value);
+    errno = (int)value;
+    return value * 2;
+}
+
+void host_touch()
+{
+    _touches++;
+}
+
+static void _test_batch(oe_enclave_t* enclave)
+{
+    int ret = -1;
+
+    _values.clear();
+    _touches = 0;
+
+    OE_TEST(enc_test_batch(enclave, &ret, BATCH_TEST_CALLS) == OE_OK);
+    OE_TEST(ret == 0);
+
+    // The calls are performed in the order they were added.
+    OE_TEST(_values.size() == BATCH_TEST_CALLS + 1);
+    for (size_t i = 0; i < _values.size(); i++)
+        OE_TEST(_values[i] == i);
+
+    OE_TEST(_touches == 1);
+}
+
+static void _run_benchmark(oe_enclave_t* enclave, bool batched)
+{
+    int ret = -1;
+
+    _values.clear();
+    _values.reserve(BENCHMARK_CALLS);
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    OE_TEST(enc_append(enclave, &ret, BENCHMARK_CALLS, batched) == OE_OK);
+    auto end = std::chrono::high_resolution_clock::now();
+    OE_TEST(ret == 0);
+    OE_TEST(_values.size() == BENCHMARK_CALLS);
+
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    printf(
+        "%s ocalls: %.0f calls/s\n",
+        batched ? "batched" : "single",
+        BENCHMARK_CALLS / seconds);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    result = oe_create_ocall_batch_enclave(
+        argv[1], OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave);
+    if (result != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    _test_batch(enclave);
+    _run_benchmark(enclave, false);
+    _run_benchmark(enclave, true);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (ocall_batch)\n");
+
+    return 0;
+}
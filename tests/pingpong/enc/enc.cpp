@@ -9,13 +9,17 @@ void Ping(const char* in, char* out, int out_length)
     Pong(in, out, out_length);
 }
 
+void Noop()
+{
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
     true, /* Debug */
     1024, /* NumHeapPages */
     256,  /* NumStackPages */
-    4);   /* NumTCS */
+    32);  /* NumTCS */
 
 #define TA_UUID                                            \
     { /* 0a6cbbd3-160a-4c86-9d9d-c9cf1956be16 */           \
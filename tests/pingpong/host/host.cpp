@@ -5,6 +5,10 @@
 #include <openenclave/host.h>
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/types.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 #include "pingpong_u.h"
 
 static bool got_pong = false;
@@ -28,6 +32,57 @@ void Pong(const char* in, char* out, int out_length)
 
 static char buf[128];
 
+// Number of ecalls made by each thread of the scaling benchmark.
+static const size_t ECALLS_PER_THREAD = 10000;
+
+// Must not exceed the NumTCS of the enclave.
+static const size_t MAX_BENCHMARK_THREADS = 32;
+
+// Measure the aggregate ecall rate with an increasing number of host threads
+// ecalling concurrently. Every ecall binds and releases a TCS, so this shows
+// how well TCS assignment scales with the number of threads.
+static void run_ecall_scaling_benchmark(oe_enclave_t* enclave)
+{
+    for (size_t num_threads = 1; num_threads <= MAX_BENCHMARK_THREADS;
+         num_threads *= 2)
+    {
+        std::atomic<bool> start(false);
+        std::atomic<size_t> failures(0);
+        std::vector<std::thread> threads;
+
+        for (size_t i = 0; i < num_threads; i++)
+        {
+            threads.push_back(std::thread([&]() {
+                while (!start)
+                    std::this_thread::yield();
+
+                for (size_t j = 0; j < ECALLS_PER_THREAD; j++)
+                {
+                    if (Noop(enclave) != OE_OK)
+                        failures++;
+                }
+            }));
+        }
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        start = true;
+
+        for (auto& t : threads)
+            t.join();
+
+        auto end = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end - begin).count();
+        double rate = (double)(num_threads * ECALLS_PER_THREAD) / seconds;
+
+        OE_TEST(failures == 0);
+        printf(
+            "%2zu threads: %10.0f ecalls/sec (%.0f ecalls/sec/thread)\n",
+            num_threads,
+            rate,
+            rate / (double)num_threads);
+    }
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -57,6 +112,8 @@ int main(int argc, const char* argv[])
         return 1;
     }
 
+    run_ecall_scaling_benchmark(enclave);
+
     oe_terminate_enclave(enclave);
 
     if (!got_pong)
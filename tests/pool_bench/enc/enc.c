@@ -0,0 +1,32 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include "pool_bench_t.h"
+
+static int _uses;
+static int _total_uses;
+
+int enc_use()
+{
+    _total_uses++;
+    return ++_uses;
+}
+
+int enc_reset(int max_uses)
+{
+    if (_total_uses >= max_uses)
+        return -1;
+
+    _uses = 0;
+    return 0;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    16,   /* NumStackPages */
+    2);   /* NumTCS */
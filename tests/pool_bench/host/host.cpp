@@ -0,0 +1,207 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <chrono>
+#include <cstdio>
+#include "pool_bench_u.h"
+
+#define POOL_SIZE 4
+#define NUM_CREATIONS 4
+#define ITERATIONS 256
+
+/* Each enclave is handed out at most this many times before the pool
+ * replaces it, so that the benchmark also covers the background creation. */
+#define MAX_USES 16
+
+static oe_result_t _reset(oe_enclave_t* enclave, void* arg)
+{
+    int ret = -1;
+    oe_result_t result = enc_reset(enclave, &ret, *(int*)arg);
+
+    if (result != OE_OK)
+        return result;
+
+    return ret == 0 ? OE_OK : OE_FAILURE;
+}
+
+static void _use(oe_enclave_t* enclave)
+{
+    int uses = 0;
+
+    // Released enclaves are either reset or replaced by new ones.
+    OE_TEST(enc_use(enclave, &uses) == OE_OK);
+    OE_TEST(uses == 1);
+}
+
+static oe_enclave_pool_settings_t _get_settings(
+    const char* path,
+    uint32_t flags)
+{
+    oe_enclave_pool_settings_t settings = {};
+
+    settings.path = path;
+    settings.type = OE_ENCLAVE_TYPE_AUTO;
+    settings.flags = flags;
+    settings.create = oe_create_pool_bench_enclave;
+    settings.size = POOL_SIZE;
+    settings.num_threads = 2;
+
+    return settings;
+}
+
+static void _test_invalid_parameters(const char* path, uint32_t flags)
+{
+    oe_enclave_pool_settings_t settings = _get_settings(path, flags);
+    oe_enclave_pool_t* pool = NULL;
+    oe_enclave_t* enclave = NULL;
+    int not_an_enclave = 0;
+
+    OE_TEST(oe_create_enclave_pool(NULL, &pool) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_create_enclave_pool(&settings, NULL) == OE_INVALID_PARAMETER);
+
+    settings.size = 0;
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_INVALID_PARAMETER);
+    settings.size = OE_ENCLAVE_POOL_MAX_SIZE + 1;
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_INVALID_PARAMETER);
+
+    settings = _get_settings(path, flags);
+    settings.create = NULL;
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_INVALID_PARAMETER);
+
+    OE_TEST(oe_enclave_pool_acquire(NULL, &enclave) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_terminate_enclave_pool(NULL) == OE_INVALID_PARAMETER);
+
+    // Only enclaves that exist can be released.
+    settings = _get_settings(path, flags);
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_OK);
+    OE_TEST(
+        oe_enclave_pool_release(pool, (oe_enclave_t*)&not_an_enclave) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(oe_enclave_pool_release(pool, NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_terminate_enclave_pool(pool) == OE_OK);
+}
+
+static double _benchmark_create(const char* path, uint32_t flags)
+{
+    double seconds = 0;
+
+    for (size_t i = 0; i < NUM_CREATIONS; i++)
+    {
+        oe_result_t result;
+        oe_enclave_t* enclave = NULL;
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        result = oe_create_pool_bench_enclave(
+            path, OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        if (result != OE_OK)
+            oe_put_err("oe_create_enclave(): result=%u", result);
+
+        seconds += std::chrono::duration<double>(end - begin).count();
+
+        _use(enclave);
+        OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+    }
+
+    return seconds / NUM_CREATIONS;
+}
+
+static void _benchmark_acquire(const char* path, uint32_t flags)
+{
+    oe_enclave_pool_settings_t settings = _get_settings(path, flags);
+    oe_enclave_pool_t* pool = NULL;
+    oe_enclave_t* enclaves[POOL_SIZE];
+    int max_uses = MAX_USES;
+    double seconds = 0;
+    double max_seconds = 0;
+    double create_seconds = _benchmark_create(path, flags);
+
+    settings.reset = _reset;
+    settings.reset_arg = &max_uses;
+
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_OK);
+
+    // Wait until the pool is full.
+    for (size_t i = 0; i < POOL_SIZE; i++)
+        OE_TEST(oe_enclave_pool_acquire(pool, &enclaves[i]) == OE_OK);
+
+    for (size_t i = 0; i < POOL_SIZE; i++)
+        OE_TEST(oe_enclave_pool_release(pool, enclaves[i]) == OE_OK);
+
+    for (size_t i = 0; i < ITERATIONS; i++)
+    {
+        oe_enclave_t* enclave = NULL;
+
+        auto begin = std::chrono::high_resolution_clock::now();
+        OE_TEST(oe_enclave_pool_acquire(pool, &enclave) == OE_OK);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double elapsed = std::chrono::duration<double>(end - begin).count();
+        seconds += elapsed;
+        if (elapsed > max_seconds)
+            max_seconds = elapsed;
+
+        _use(enclave);
+        OE_TEST(oe_enclave_pool_release(pool, enclave) == OE_OK);
+    }
+
+    OE_TEST(oe_terminate_enclave_pool(pool) == OE_OK);
+
+    printf(
+        "%s: create %.1f ms, acquire %.1f us (max %.1f us)\n",
+        (flags & OE_ENCLAVE_FLAG_SIMULATE) ? "simulation" : "hardware",
+        create_seconds * 1000,
+        seconds * 1000000 / ITERATIONS,
+        max_seconds * 1000000);
+}
+
+static void _test_without_reset(const char* path, uint32_t flags)
+{
+    oe_enclave_pool_settings_t settings = _get_settings(path, flags);
+    oe_enclave_pool_t* pool = NULL;
+    oe_enclave_t* kept = NULL;
+
+    settings.size = 2;
+    settings.num_threads = 0;
+
+    OE_TEST(oe_create_enclave_pool(&settings, &pool) == OE_OK);
+
+    // Released enclaves are terminated and replaced.
+    for (size_t i = 0; i < 2 * POOL_SIZE; i++)
+    {
+        oe_enclave_t* enclave = NULL;
+
+        OE_TEST(oe_enclave_pool_acquire(pool, &enclave) == OE_OK);
+        _use(enclave);
+        OE_TEST(oe_enclave_pool_release(pool, enclave) == OE_OK);
+    }
+
+    // Acquired enclaves outlive their pool.
+    OE_TEST(oe_enclave_pool_acquire(pool, &kept) == OE_OK);
+    OE_TEST(oe_terminate_enclave_pool(pool) == OE_OK);
+    _use(kept);
+    OE_TEST(oe_terminate_enclave(kept) == OE_OK);
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    _test_invalid_parameters(argv[1], flags);
+    _test_without_reset(argv[1], flags);
+    _benchmark_acquire(argv[1], flags);
+
+    printf("=== passed all tests (pool_bench)\n");
+
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/tests.h>
 #include <string.h>
+#include "../../../enclave/core/sgx/arena.h"
 #include "switchless_test_t.h"
 
 #define STRING_LEN 100
@@ -77,6 +78,134 @@ int enc_test_echo_regular(const char* in, char out[STRING_LEN], int repeats)
     return 0;
 }
 
+#define MAX_PENDING_ASYNC_OCALLS 16
+
+int enc_test_async_ocalls(int count)
+{
+    oe_async_ocall_t* pending[MAX_PENDING_ASYNC_OCALLS] = {NULL};
+    uint64_t values[4] = {1, 2, 3, 4};
+
+    for (int i = 0; i < count; i++)
+    {
+        oe_async_ocall_t** call = &pending[i % MAX_PENDING_ASYNC_OCALLS];
+
+        // Wait for the oldest call before reusing its slot.
+        if (*call && oe_wait_async_ocall(*call) != OE_OK)
+            return -1;
+
+        if (host_add_async_async(call, (uint64_t)i, values) != OE_OK)
+            return -1;
+
+        // Fire-and-forget calls are counted by the host.
+        if (host_count_async() != OE_OK)
+            return -1;
+    }
+
+    for (size_t i = 0; i < MAX_PENDING_ASYNC_OCALLS; i++)
+    {
+        if (pending[i] && oe_wait_async_ocall(pending[i]) != OE_OK)
+            return -1;
+    }
+
+    oe_host_printf("Enclave: completed %d async ocalls\n", count);
+
+    return 0;
+}
+
+// Larger than the default arena chunk of 1 MB
+#define LARGE_PAYLOAD_SIZE (2 * 1024 * 1024 + 1)
+#define SMALL_PAYLOAD_SIZE 16
+
+#define THREAD_CHUNK_CAPACITY (64 * 1024)
+
+static uint8_t _payload[LARGE_PAYLOAD_SIZE];
+
+static void _sum_switchless(size_t size)
+{
+    uint64_t expected = 0;
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+        expected += _payload[i];
+
+    OE_TEST(host_sum_switchless(&sum, _payload, size) == OE_OK);
+    OE_TEST(sum == expected);
+}
+
+static size_t _chunk_allocations(void)
+{
+    oe_arena_statistics_t statistics;
+
+    oe_get_arena_statistics(&statistics);
+    return statistics.chunk_allocations;
+}
+
+int enc_test_arena()
+{
+    oe_arena_statistics_t statistics;
+    size_t allocations;
+    size_t failed_allocations;
+
+    for (size_t i = 0; i < LARGE_PAYLOAD_SIZE; i++)
+        _payload[i] = (uint8_t)i;
+
+    // The arena of the thread is empty at the start of the ecall. The
+    // payload gets a chunk of its own and the ocall arguments a default one.
+    allocations = _chunk_allocations();
+    _sum_switchless(LARGE_PAYLOAD_SIZE);
+    OE_TEST(_chunk_allocations() - allocations == 2);
+
+    oe_get_arena_statistics(&statistics);
+    OE_TEST(statistics.max_chunk_count >= 2);
+    OE_TEST(statistics.high_water_mark > LARGE_PAYLOAD_SIZE);
+    failed_allocations = statistics.failed_allocations;
+
+    // Later calls reuse the chunks.
+    allocations = _chunk_allocations();
+    _sum_switchless(LARGE_PAYLOAD_SIZE);
+    for (size_t i = 0; i < OE_ARENA_IDLE_RESETS - 1; i++)
+        _sum_switchless(SMALL_PAYLOAD_SIZE);
+    _sum_switchless(LARGE_PAYLOAD_SIZE);
+    OE_TEST(_chunk_allocations() == allocations);
+
+    // The extra chunk is released after OE_ARENA_IDLE_RESETS calls that fit
+    // in the first chunk, and allocated again by the next large call.
+    for (size_t i = 0; i < OE_ARENA_IDLE_RESETS; i++)
+        _sum_switchless(SMALL_PAYLOAD_SIZE);
+    OE_TEST(_chunk_allocations() == allocations);
+    _sum_switchless(LARGE_PAYLOAD_SIZE);
+    OE_TEST(_chunk_allocations() - allocations == 1);
+
+    // Allocations above the maximum chunk capacity fail and are counted.
+    OE_TEST(oe_arena_malloc((1 << 30) + 1) == NULL);
+    oe_get_arena_statistics(&statistics);
+    OE_TEST(statistics.failed_allocations == failed_allocations + 1);
+
+    return 0;
+}
+
+int enc_test_arena_capacity()
+{
+    size_t allocations = _chunk_allocations();
+
+    OE_TEST(!oe_configure_thread_arena_capacity((1 << 30) + 1));
+    OE_TEST(oe_configure_thread_arena_capacity(THREAD_CHUNK_CAPACITY));
+
+    // A small call fits in a chunk of the configured capacity.
+    _sum_switchless(SMALL_PAYLOAD_SIZE);
+    OE_TEST(_chunk_allocations() - allocations == 1);
+
+    // A payload larger than the configured capacity gets a chunk of its own,
+    // and the ocall arguments a new chunk of the configured capacity. With
+    // the default capacity, the first chunk would have been large enough.
+    _sum_switchless(2 * THREAD_CHUNK_CAPACITY);
+    OE_TEST(_chunk_allocations() - allocations == 3);
+
+    OE_TEST(oe_configure_thread_arena_capacity(0));
+
+    return 0;
+}
+
 int enc_echo_switchless(
     const char* in,
     char* out,
@@ -76,6 +76,69 @@ int host_echo_regular(
     return 0;
 }
 
+uint64_t host_sum_switchless(const void* buf, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)buf;
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < size; i++)
+        sum += bytes[i];
+
+    return sum;
+}
+
+static volatile int64_t _async_sum;
+static volatile uint64_t _async_count;
+
+void host_add_async(uint64_t value, uint64_t values[4])
+{
+    OE_TEST(values[0] == 1 && values[3] == 4);
+
+    int64_t sum;
+    do
+    {
+        sum = _async_sum;
+    } while (!oe_atomic_compare_and_swap(
+        &_async_sum, sum, sum + (int64_t)value));
+}
+
+void host_count_async(void)
+{
+    oe_atomic_increment(&_async_count);
+}
+
+void test_async_ocalls(oe_enclave_t* enclave)
+{
+    const int count = NUM_OCALLS / 10;
+    const int64_t expected_sum = (int64_t)count * (count - 1) / 2;
+    int return_val = -1;
+
+    OE_TEST(enc_test_async_ocalls(enclave, &return_val, count) == OE_OK);
+    OE_TEST(return_val == 0);
+
+    // Every call with a handle has been waited upon by the enclave.
+    OE_TEST(_async_sum == expected_sum);
+
+    // Fire-and-forget calls may still be in flight.
+    while (oe_atomic_load(&_async_count) != (uint64_t)count)
+        oe_yield_cpu();
+
+    printf("%d async ocalls completed\n", count);
+}
+
+void test_arena(oe_enclave_t* enclave)
+{
+    int return_val = -1;
+
+    OE_TEST(enc_test_arena(enclave, &return_val) == OE_OK);
+    OE_TEST(return_val == 0);
+
+    OE_TEST(enc_test_arena_capacity(enclave, &return_val) == OE_OK);
+    OE_TEST(return_val == 0);
+
+    printf("Arena tests completed\n");
+}
+
 double make_repeated_switchless_ocalls(oe_enclave_t* enclave)
 {
     char out[STRING_LEN];
@@ -452,7 +515,11 @@ int main(int argc, const char* argv[])
     if (test_ecalls)
         test_switchless_ecalls(enclave, num_host_threads);
     else
+    {
         test_switchless_ocalls(enclave, num_enclave_threads);
+        test_async_ocalls(enclave);
+        test_arena(enclave);
+    }
 
     result = oe_terminate_enclave(enclave);
     OE_TEST(result == OE_OK);
@@ -5,6 +5,7 @@
 #include <limits.h>
 #include <openenclave/host.h>
 #include <openenclave/internal/error.h>
+#include <openenclave/internal/switchless.h>
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/thread.h>
 #include <chrono>
@@ -86,6 +87,67 @@ void* thread_func(void* arg)
     return NULL;
 }
 
+#define MIN_THRESHOLD OE_SWITCHLESS_DEFAULT_MIN_SPIN_COUNT_THRESHOLD
+#define MAX_THRESHOLD OE_SWITCHLESS_DEFAULT_MAX_SPIN_COUNT_THRESHOLD
+
+static void _update(
+    uint64_t spin_count,
+    bool slept,
+    uint64_t sleep_spin_count,
+    uint64_t* average,
+    uint64_t* threshold)
+{
+    oe_switchless_update_spin_policy(
+        spin_count,
+        slept,
+        sleep_spin_count,
+        MIN_THRESHOLD,
+        MAX_THRESHOLD,
+        average,
+        threshold);
+}
+
+/**
+ * Check the rule that adapts the spin budget of the workers.
+ */
+static void _test_spin_policy()
+{
+    uint64_t average = 1024;
+    uint64_t threshold = 4096;
+
+    // An idle worker sleeps long before every message. Its budget shrinks to
+    // the minimum instead of growing.
+    for (size_t i = 0; i < 16; i++)
+        _update(0, true, 1000000, &average, &threshold);
+    OE_TEST(threshold == MIN_THRESHOLD);
+
+    // Messages that arrive shortly after the budget ran out double it, up to
+    // the maximum.
+    _update(0, true, threshold / 2, &average, &threshold);
+    OE_TEST(threshold == 2 * MIN_THRESHOLD);
+    _update(0, true, threshold, &average, &threshold);
+    OE_TEST(threshold == 4 * MIN_THRESHOLD);
+
+    for (size_t i = 0; i < 16; i++)
+        _update(0, true, threshold, &average, &threshold);
+    OE_TEST(threshold == MAX_THRESHOLD);
+
+    // A sleep just longer than the budget halves it.
+    _update(0, true, threshold + 1, &average, &threshold);
+    OE_TEST(threshold == MAX_THRESHOLD / 2);
+
+    // Messages that arrive while spinning move the budget to a multiple of
+    // their average gap.
+    for (size_t i = 0; i < 200; i++)
+        _update(2000, false, 0, &average, &threshold);
+    OE_TEST(threshold >= 4 * 1900 && threshold <= 4 * 2100);
+
+    // Back-to-back messages keep the minimum budget.
+    for (size_t i = 0; i < 200; i++)
+        _update(0, false, 0, &average, &threshold);
+    OE_TEST(threshold == MIN_THRESHOLD);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_enclave_t* enclave = NULL;
@@ -97,6 +159,8 @@ int main(int argc, const char* argv[])
         exit(1);
     }
 
+    _test_spin_policy();
+
     printf("Run Sleep-Wake test.\n");
 
     // check number of cores, need at least 4
@@ -175,6 +239,19 @@ int main(int argc, const char* argv[])
     // remove threads from vector
     app_threads.clear();
 
+    // The workers must have gone to sleep during the idle periods and been
+    // woken up by the following calls.
+    oe_switchless_statistics_t stats;
+    OE_TEST(oe_get_switchless_statistics(enclave, &stats) == OE_OK);
+    printf(
+        "Host workers: %" PRIu64 " spins, %" PRIu64 " wakes\n"
+        "Enclave workers: %" PRIu64 " spins, %" PRIu64 " wakes\n",
+        stats.host_worker_spin_count,
+        stats.host_worker_wake_count,
+        stats.enclave_worker_spin_count,
+        stats.enclave_worker_wake_count);
+    OE_TEST(stats.enclave_worker_wake_count > 0);
+
     OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
 
     printf("=== passed all tests (switchless_worksleep)\n");
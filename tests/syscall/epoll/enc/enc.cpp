@@ -7,8 +7,10 @@
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cerrno>
 #include <cstdio>
+#include <vector>
 
 enum class action_t : uint8_t
 {
@@ -144,10 +146,71 @@ extern "C" void test_close_without_delete()
     OE_TEST(close(fd2) == 0);
 }
 
+static const int _benchmark_max_events = 512;
+static int _benchmark_epfd = -1;
+static std::vector<int> _benchmark_fds;
+
+extern "C" void benchmark_set_up(size_t num_fds)
+{
+    _benchmark_epfd = epoll_create1(0);
+    OE_TEST(_benchmark_epfd >= 0);
+
+    // Unconnected UDP sockets are always writable, so every wait returns as
+    // many events as it can.
+    for (size_t i = 0; i < num_fds; i++)
+    {
+        const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        OE_TEST(fd >= 0);
+
+        epoll_event event{};
+        event.events = EPOLLOUT;
+        event.data.u64 = i;
+        OE_TEST(epoll_ctl(_benchmark_epfd, EPOLL_CTL_ADD, fd, &event) == 0);
+
+        _benchmark_fds.push_back(fd);
+    }
+}
+
+extern "C" void benchmark_wait(size_t num_waits)
+{
+    std::vector<epoll_event> events(_benchmark_max_events);
+    const size_t num_fds = _benchmark_fds.size();
+    const int expected =
+        static_cast<int>(std::min<size_t>(num_fds, _benchmark_max_events));
+
+    for (size_t i = 0; i < num_waits; i++)
+    {
+        const int n = epoll_wait(
+            _benchmark_epfd, events.data(), _benchmark_max_events, 0);
+        OE_TEST(n == expected);
+
+        for (int j = 0; j < n; j++)
+            OE_TEST(events[j].data.u64 < num_fds);
+    }
+}
+
+extern "C" void benchmark_tear_down()
+{
+    // Delete half of the fds explicitly and let close() drop the others.
+    for (size_t i = 0; i < _benchmark_fds.size(); i += 2)
+        OE_TEST(
+            epoll_ctl(
+                _benchmark_epfd, EPOLL_CTL_DEL, _benchmark_fds[i], nullptr) ==
+            0);
+
+    for (int fd : _benchmark_fds)
+        OE_TEST(close(fd) == 0);
+
+    OE_TEST(close(_benchmark_epfd) == 0);
+
+    _benchmark_fds.clear();
+    _benchmark_epfd = -1;
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
     true, /* Debug */
-    1024, /* NumHeapPages */
+    4096, /* NumHeapPages */
     256,  /* NumStackPages */
     9);   /* NumTCS */
@@ -3,12 +3,47 @@
 
 #include <openenclave/host.h>
 #include <openenclave/internal/tests.h>
+#include <sys/resource.h>
+#include <chrono>
 #include <cstdio>
 #include <thread>
 #include "epoll_u.h"
 
 using namespace std;
 
+// Measure epoll_ctl() and epoll_wait() as the number of registered fds grows.
+static void _run_benchmark(oe_enclave_t* enclave)
+{
+    const size_t num_waits = 1000;
+    rlimit limit;
+
+    // Allow as many host fds as possible.
+    OE_TEST(getrlimit(RLIMIT_NOFILE, &limit) == 0);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    OE_TEST(getrlimit(RLIMIT_NOFILE, &limit) == 0);
+
+    for (size_t num_fds = 64; num_fds <= 16384; num_fds *= 4)
+    {
+        // Leave room for the fds of the host process.
+        if (num_fds + 64 > limit.rlim_cur)
+            break;
+
+        auto begin = chrono::high_resolution_clock::now();
+        OE_TEST(benchmark_set_up(enclave, num_fds) == OE_OK);
+        auto middle = chrono::high_resolution_clock::now();
+        OE_TEST(benchmark_wait(enclave, num_waits) == OE_OK);
+        auto end = chrono::high_resolution_clock::now();
+        OE_TEST(benchmark_tear_down(enclave) == OE_OK);
+
+        printf(
+            "%zu fds: %.0f epoll_ctl/s, %.0f epoll_wait/s\n",
+            num_fds,
+            (double)num_fds / chrono::duration<double>(middle - begin).count(),
+            (double)num_waits / chrono::duration<double>(end - middle).count());
+    }
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t r;
@@ -47,6 +82,8 @@ int main(int argc, const char* argv[])
     // instance
     OE_TEST(test_close_without_delete(enclave) == OE_OK);
 
+    _run_benchmark(enclave);
+
     r = oe_terminate_enclave(enclave);
     OE_TEST(r == OE_OK);
 
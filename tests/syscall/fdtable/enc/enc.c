@@ -0,0 +1,99 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include <openenclave/internal/tests.h>
+#include <stdlib.h>
+#include "fdtable_t.h"
+
+// Up to 32 threads run lookups at the same time.
+#define NUM_TCS 32
+
+static int* _fds;
+static size_t _num_fds;
+
+void set_up(size_t num_fds)
+{
+    OE_TEST(_fds = (int*)calloc(num_fds, sizeof(int)));
+
+    for (size_t i = 0; i < num_fds; i++)
+        OE_TEST((_fds[i] = oe_dup(OE_STDOUT_FILENO)) >= 0);
+
+    _num_fds = num_fds;
+}
+
+void tear_down(void)
+{
+    for (size_t i = 0; i < _num_fds; i++)
+        OE_TEST(oe_close(_fds[i]) == 0);
+
+    free(_fds);
+    _fds = NULL;
+    _num_fds = 0;
+}
+
+void run_lookups(size_t num_iterations, size_t first)
+{
+    for (size_t i = 0; i < num_iterations; i++)
+    {
+        const int fd = _fds[(first + i) % _num_fds];
+        oe_fd_t* desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY);
+
+        // The fd may be closed by run_closes(). A descriptor that is found
+        // stays valid until it is released.
+        if (desc)
+        {
+            OE_TEST(desc->type == OE_FD_TYPE_FILE);
+            OE_TEST(desc->refcount >= 1);
+            oe_fdtable_put(desc);
+        }
+    }
+}
+
+void run_closes(size_t num_iterations)
+{
+    for (size_t i = 0; i < num_iterations; i++)
+    {
+        const size_t index = i % _num_fds;
+        int fd;
+
+        OE_TEST(oe_close(_fds[index]) == 0);
+
+        // The lowest free fd is reused.
+        OE_TEST((fd = oe_dup(OE_STDOUT_FILENO)) == _fds[index]);
+    }
+}
+
+void run_dup2s(size_t num_iterations, size_t writer)
+{
+    for (size_t i = 0; i < num_iterations; i++)
+    {
+        const size_t index = (writer + i) % _num_fds;
+        const int source = (i & 1) ? OE_STDERR_FILENO : OE_STDOUT_FILENO;
+
+        // Replace the descriptor that other threads look up. The replaced
+        // one is closed once the last lookup using it releases it.
+        OE_TEST(oe_dup2(source, _fds[index]) == _fds[index]);
+
+        // Grow the table now and then, so that lookups also race with the
+        // table being replaced and freed.
+        if (index == 0)
+        {
+            const size_t step = (i / _num_fds) % 16 + 1;
+            const int fd = (int)(step * 1024 + writer);
+
+            OE_TEST(oe_dup2(source, fd) == fd);
+            OE_TEST(oe_close(fd) == 0);
+        }
+    }
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,                             /* ProductID */
+    1,                             /* SecurityVersion */
+    true,                          /* Debug */
+    OE_TEST_MT_HEAP_SIZE(NUM_TCS), /* NumHeapPages */
+    16,                            /* NumStackPages */
+    NUM_TCS);                      /* NumTCS */
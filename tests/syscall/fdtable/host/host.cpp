@@ -0,0 +1,112 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "fdtable_u.h"
+
+#define MAX_THREADS 32
+#define NUM_FDS 64
+#define LOOKUPS_PER_THREAD 1000000
+#define NUM_CLOSES 10000
+#define NUM_DUP2_WRITERS 2
+#define NUM_DUP2S 100000
+
+static void _run_lookups(oe_enclave_t* enclave, size_t first)
+{
+    OE_TEST(run_lookups(enclave, LOOKUPS_PER_THREAD, first) == OE_OK);
+}
+
+static void _run_benchmark(oe_enclave_t* enclave, size_t num_threads)
+{
+    std::vector<std::thread> threads;
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < num_threads; i++)
+        threads.push_back(std::thread(_run_lookups, enclave, i));
+
+    for (auto& t : threads)
+        t.join();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - begin).count();
+    printf(
+        "%zu thread(s): %.0f fd lookups/s\n",
+        num_threads,
+        (double)(num_threads * LOOKUPS_PER_THREAD) / seconds);
+}
+
+// Look up descriptors while one thread keeps closing and re-creating them.
+static void _test_concurrent_close(oe_enclave_t* enclave)
+{
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < 8; i++)
+        threads.push_back(std::thread(_run_lookups, enclave, i));
+
+    OE_TEST(run_closes(enclave, NUM_CLOSES) == OE_OK);
+
+    for (auto& t : threads)
+        t.join();
+}
+
+static void _run_dup2s(oe_enclave_t* enclave, size_t writer)
+{
+    OE_TEST(run_dup2s(enclave, NUM_DUP2S, writer) == OE_OK);
+}
+
+// Look up descriptors while other threads keep replacing them with dup2()
+// and growing the table. A lookup that used a table or descriptor freed by a
+// writer fails the type check, or the leak and double free checks in Debug.
+static void _test_concurrent_dup2(oe_enclave_t* enclave)
+{
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < 8; i++)
+        threads.push_back(std::thread(_run_lookups, enclave, i));
+
+    for (size_t i = 0; i < NUM_DUP2_WRITERS; i++)
+        threads.push_back(std::thread(_run_dup2s, enclave, i));
+
+    for (auto& t : threads)
+        t.join();
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    result = oe_create_fdtable_enclave(
+        argv[1], OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave);
+    if (result != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    OE_TEST(set_up(enclave, NUM_FDS) == OE_OK);
+
+    for (size_t num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2)
+        _run_benchmark(enclave, num_threads);
+
+    _test_concurrent_close(enclave);
+    _test_concurrent_dup2(enclave);
+
+    OE_TEST(tear_down(enclave) == OE_OK);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (fdtable)\n");
+
+    return 0;
+}
@@ -547,6 +547,239 @@ void _test_mount(const char* tmp_dir)
     OE_TEST(oe_umount("/") == 0);
 }
 
+static void _fill(uint8_t* buf, size_t size, size_t offset)
+{
+    for (size_t i = 0; i < size; i++)
+        buf[i] = (uint8_t)((offset + i) * 7);
+}
+
+static void _check(const uint8_t* buf, size_t size, size_t offset)
+{
+    for (size_t i = 0; i < size; i++)
+        OE_TEST(buf[i] == (uint8_t)((offset + i) * 7));
+}
+
+/* Test the page cache of mounts with OE_MS_HOSTFS_CACHE. */
+static void test_hostfs_cache(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    const size_t size = 64 * OE_PAGE_SIZE;
+    const size_t chunk = 1000;
+    uint8_t buf[chunk];
+    struct oe_stat_t st;
+    int fd;
+    int fd2;
+
+    printf("=== testing hostfs cache:\n");
+
+    mkpath(path, tmp_dir, "cached");
+
+    /* The cache is four times smaller than the file. */
+    {
+        oe_fd_cached_hostfs_file_system fs;
+
+        /* Write the file in chunks that straddle the pages. */
+        fd = fs.open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+        OE_TEST(fd != -1);
+
+        for (size_t offset = 0; offset < size; offset += chunk)
+        {
+            size_t n = size - offset < chunk ? size - offset : chunk;
+            _fill(buf, n, offset);
+            OE_TEST(fs.write(fd, buf, n) == (ssize_t)n);
+        }
+
+        OE_TEST(fs.fstat(fd, &st) == 0);
+        OE_TEST(st.st_size == (off_t)size);
+
+        /* A second descriptor sees the data not yet written back. */
+        fd2 = fs.open(path, OE_O_RDONLY, 0);
+        OE_TEST(fd2 != -1);
+        OE_TEST(fs.pread(fd2, buf, chunk, size - chunk) == (ssize_t)chunk);
+        _check(buf, chunk, size - chunk);
+
+        /* Read the file back sequentially. */
+        OE_TEST(fs.lseek(fd, 0, OE_SEEK_SET) == 0);
+        for (size_t offset = 0; offset < size; offset += chunk)
+        {
+            size_t n = size - offset < chunk ? size - offset : chunk;
+            OE_TEST(fs.read(fd, buf, chunk) == (ssize_t)n);
+            _check(buf, n, offset);
+        }
+
+        OE_TEST(fs.read(fd, buf, chunk) == 0);
+        OE_TEST(fs.lseek(fd, 0, OE_SEEK_END) == (off_t)size);
+
+        /* Overwrite a range and flush it. */
+        memset(buf, 0xff, chunk);
+        OE_TEST(fs.pwrite(fd, buf, chunk, OE_PAGE_SIZE - 10) == (ssize_t)chunk);
+        OE_TEST(fs.fsync(fd) == 0);
+
+        OE_TEST(fs.close(fd2) == 0);
+        OE_TEST(fs.close(fd) == 0);
+
+        /* Shrink the file. */
+        OE_TEST(fs.truncate(path, OE_PAGE_SIZE + 10) == 0);
+    }
+
+    /* Check what reached the host without the cache. */
+    {
+        oe_fd_hostfs_file_system fs;
+
+        OE_TEST(fs.stat(path, &st) == 0);
+        OE_TEST(st.st_size == OE_PAGE_SIZE + 10);
+
+        fd = fs.open(path, OE_O_RDONLY, 0);
+        OE_TEST(fd != -1);
+
+        OE_TEST(fs.pread(fd, buf, 100, 0) == 100);
+        _check(buf, 100, 0);
+
+        OE_TEST(fs.pread(fd, buf, 20, OE_PAGE_SIZE - 10) == 20);
+        for (size_t i = 0; i < 20; i++)
+            OE_TEST(buf[i] == 0xff);
+
+        OE_TEST(fs.close(fd) == 0);
+        OE_TEST(fs.unlink(path) == 0);
+    }
+}
+
+/* Test a cached O_APPEND descriptor next to a regular cached one. */
+static void test_hostfs_cache_append(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    const size_t size = 2 * OE_PAGE_SIZE + 100;
+    const size_t chunk = 1000;
+    uint8_t buf[chunk];
+    uint8_t data[size + chunk];
+    struct oe_stat_t st;
+    int fd;
+    int fd2;
+
+    printf("=== testing hostfs cache with O_APPEND:
+");
+
+    mkpath(path, tmp_dir, "appended");
+
+    {
+        oe_fd_cached_hostfs_file_system fs;
+
+        fd = fs.open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+        OE_TEST(fd != -1);
+
+        for (size_t offset = 0; offset < size; offset += chunk)
+        {
+            size_t n = size - offset < chunk ? size - offset : chunk;
+            _fill(buf, n, offset);
+            OE_TEST(fs.write(fd, buf, n) == (ssize_t)n);
+        }
+
+        /* The append lands after the data not yet written back. */
+        fd2 = fs.open(path, OE_O_WRONLY | OE_O_APPEND, 0);
+        OE_TEST(fd2 != -1);
+        OE_TEST(oe_fcntl(fd2, OE_F_GETFL, 0) & OE_O_APPEND);
+
+        _fill(buf, chunk, size);
+        OE_TEST(fs.write(fd2, buf, chunk) == (ssize_t)chunk);
+        OE_TEST(fs.lseek(fd2, 0, OE_SEEK_CUR) == (off_t)(size + chunk));
+
+        /* The other descriptor sees the appended data. */
+        OE_TEST(fs.fstat(fd, &st) == 0);
+        OE_TEST(st.st_size == (off_t)(size + chunk));
+        OE_TEST(fs.pread(fd, buf, chunk, size) == (ssize_t)chunk);
+        _check(buf, chunk, size);
+
+        /* Dirty the page that holds the start of the appended data. */
+        _fill(buf, 50, size - 50);
+        OE_TEST(fs.pwrite(fd, buf, 50, size - 50) == 50);
+
+        /* Without O_APPEND, writes go to the file position. */
+        OE_TEST(oe_fcntl(fd2, OE_F_SETFL, 0) == 0);
+        OE_TEST(!(oe_fcntl(fd2, OE_F_GETFL, 0) & OE_O_APPEND));
+        OE_TEST(fs.lseek(fd2, 0, OE_SEEK_SET) == 0);
+        memset(buf, 0xff, 10);
+        OE_TEST(fs.write(fd2, buf, 10) == 10);
+
+        OE_TEST(fs.close(fd2) == 0);
+        OE_TEST(fs.close(fd) == 0);
+    }
+
+    /* Check what reached the host without the cache. */
+    {
+        oe_fd_hostfs_file_system fs;
+
+        OE_TEST(fs.stat(path, &st) == 0);
+        OE_TEST(st.st_size == (off_t)(size + chunk));
+
+        fd = fs.open(path, OE_O_RDONLY, 0);
+        OE_TEST(fd != -1);
+        OE_TEST(fs.read(fd, data, sizeof(data)) == (ssize_t)sizeof(data));
+
+        for (size_t i = 0; i < 10; i++)
+            OE_TEST(data[i] == 0xff);
+        _check(data + 10, sizeof(data) - 10, 10);
+
+        OE_TEST(fs.close(fd) == 0);
+        OE_TEST(fs.unlink(path) == 0);
+    }
+}
+
+/* Test reading directories with more entries than one host batch. */
+static void test_readdir_batches(const char* tmp_dir)
+{
+    oe_fd_hostfs_file_system fs;
+    const size_t num_files = 200;
+    char dirname[OE_PATH_MAX];
+    char path[OE_PATH_MAX];
+    char name[32];
+    OE_DIR* dir;
+    struct oe_dirent* ent;
+    set<string> names;
+
+    printf("=== testing readdir batches:\n");
+
+    mkpath(dirname, tmp_dir, "many");
+    OE_TEST(fs.mkdir(dirname, 0777) == 0);
+
+    for (size_t i = 0; i < num_files; i++)
+    {
+        const int flags = OE_O_CREAT | OE_O_WRONLY;
+        int fd;
+
+        snprintf(name, sizeof(name), "file%zu", i);
+        fd = fs.open(mkpath(path, dirname, name), flags, MODE);
+        OE_TEST(fd != -1);
+        OE_TEST(fs.close(fd) == 0);
+    }
+
+    OE_TEST((dir = fs.opendir(dirname)));
+
+    /* Stop in the middle of the second batch, then start over. */
+    for (size_t i = 0; i < 100; i++)
+        OE_TEST(fs.readdir(dir));
+
+    fs.rewinddir(dir);
+
+    while ((ent = fs.readdir(dir)))
+        OE_TEST(names.insert(ent->d_name).second);
+
+    OE_TEST(names.size() == num_files + 2);
+    OE_TEST(names.count(".") && names.count(".."));
+    OE_TEST(names.count("file0") && names.count("file199"));
+
+    /* The end of the directory is sticky. */
+    OE_TEST(fs.readdir(dir) == NULL);
+    OE_TEST(fs.closedir(dir) == 0);
+
+    for (size_t i = 0; i < num_files; i++)
+    {
+        snprintf(name, sizeof(name), "file%zu", i);
+        OE_TEST(fs.unlink(mkpath(path, dirname, name)) == 0);
+    }
+
+    OE_TEST(fs.rmdir(dirname) == 0);
+}
+
 static void test_realpath(const char* tmp_dir)
 {
     oe_syscall_path_t buf;
@@ -595,6 +828,79 @@ static void test_realpath(const char* tmp_dir)
     OE_TEST(umount("/") == 0);
 }
 
+/* Resolutions of paths are cached, so check that mounting, unmounting and
+ * changing the directory are seen by the paths resolved before. */
+static void test_mount_resolution(const char* tmp_dir)
+{
+    char source[OE_PATH_MAX];
+    char target[OE_PATH_MAX];
+    char source_file[OE_PATH_MAX];
+    char source_nested[OE_PATH_MAX];
+    char target_file[OE_PATH_MAX];
+    char target_nested[OE_PATH_MAX];
+    char nested_file[OE_PATH_MAX];
+    struct stat st;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    mkpath(source, tmp_dir, "resolve_source");
+    mkpath(target, tmp_dir, "resolve_target");
+    mkpath(source_file, source, "file");
+    mkpath(source_nested, source, "nested");
+    mkpath(target_file, target, "file");
+    mkpath(target_nested, target, "nested");
+
+    /* Through a mount of "/" at target_nested, this is source_file. */
+    mkpath(nested_file, target_nested, source_file + 1);
+
+    OE_TEST(mount("/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) == 0);
+    unlink(source_file);
+    rmdir(source_nested);
+    rmdir(target_nested);
+    rmdir(source);
+    rmdir(target);
+    OE_TEST(mkdir(source, 0777) == 0);
+    OE_TEST(mkdir(source_nested, 0777) == 0);
+    OE_TEST(mkdir(target, 0777) == 0);
+    OE_TEST(mkdir(target_nested, 0777) == 0);
+    _touch(source_file);
+
+    OE_TEST(stat(target_file, &st) == -1);
+    OE_TEST(stat(target_file, &st) == -1);
+
+    /* The file is visible through the mount point only while mounted. */
+    OE_TEST(
+        mount(source, target, OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) == 0);
+    OE_TEST(stat(target_file, &st) == 0);
+    OE_TEST(stat(target_file, &st) == 0);
+    OE_TEST(stat(nested_file, &st) == -1);
+
+    /* The mount point below the other one is the longest match. */
+    OE_TEST(
+        mount("/", target_nested, OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) ==
+        0);
+    OE_TEST(stat(nested_file, &st) == 0);
+    OE_TEST(umount(target_nested) == 0);
+    OE_TEST(stat(nested_file, &st) == -1);
+
+    OE_TEST(umount(target) == 0);
+    OE_TEST(stat(target_file, &st) == -1);
+
+    /* Relative paths follow the current directory. */
+    OE_TEST(chdir(source) == 0);
+    OE_TEST(stat("file", &st) == 0);
+    OE_TEST(chdir(target) == 0);
+    OE_TEST(stat("file", &st) == -1);
+    OE_TEST(chdir("/") == 0);
+
+    OE_TEST(unlink(source_file) == 0);
+    OE_TEST(rmdir(source_nested) == 0);
+    OE_TEST(rmdir(target_nested) == 0);
+    OE_TEST(rmdir(source) == 0);
+    OE_TEST(rmdir(target) == 0);
+    OE_TEST(umount("/") == 0);
+}
+
 void test_zero_sized_iovs(void)
 {
     struct oe_iovec iov;
@@ -679,6 +985,14 @@ void test_fs(const char* src_dir, const char* tmp_dir)
         test_common(fs, tmp_dir);
     }
 
+    /* Test the HOSTFS oe file descriptor interfaces through the cache. */
+    {
+        printf("=== testing oe-fd-cached-hostfs:\n");
+
+        oe_fd_cached_hostfs_file_system fs;
+        test_common(fs, tmp_dir);
+    }
+
 #if defined(TEST_SGXFS)
     /* Test the SGXFS oe file descriptor interfaces. */
     {
@@ -797,6 +1111,11 @@ void test_fs(const char* src_dir, const char* tmp_dir)
     /* Test mounting. */
     _test_mount(tmp_dir);
 
+    test_hostfs_cache(tmp_dir);
+    test_hostfs_cache_append(tmp_dir);
+
+    test_readdir_batches(tmp_dir);
+
     /* Test fprintf and fscanf. */
     test_fprintf_fscanf(tmp_dir);
 
@@ -809,6 +1128,8 @@ void test_fs(const char* src_dir, const char* tmp_dir)
 
     test_realpath(tmp_dir);
 
+    test_mount_resolution(tmp_dir);
+
     test_zero_sized_iovs();
 
     /* Note: these must come last since they change STDOUT and STDERR. */
@@ -839,6 +1160,14 @@ void test_fs_linux(const char* src_dir, const char* tmp_dir)
         test_pio(fs, tmp_dir);
     }
 
+    /* Test the HOSTFS oe file descriptor interfaces through the cache. */
+    {
+        printf("=== testing oe-fd-cached-hostfs:\n");
+
+        oe_fd_cached_hostfs_file_system fs;
+        test_pio(fs, tmp_dir);
+    }
+
 #if defined(TEST_SGXFS)
     /* Test the SGXFS oe file descriptor interfaces. */
     {
@@ -164,6 +164,29 @@ class oe_fd_hostfs_file_system : public oe_fd_file_system
     }
 };
 
+class oe_fd_cached_hostfs_file_system : public oe_fd_file_system
+{
+  public:
+    oe_fd_cached_hostfs_file_system()
+    {
+        /* Use a small budget so that the tests also exercise eviction. */
+        oe_hostfs_cache_options_t options = {16 * OE_PAGE_SIZE};
+
+        OE_TEST(
+            oe_mount(
+                "/",
+                "/",
+                OE_DEVICE_NAME_HOST_FILE_SYSTEM,
+                OE_MS_HOSTFS_CACHE,
+                &options) == 0);
+    }
+
+    ~oe_fd_cached_hostfs_file_system()
+    {
+        OE_TEST(oe_umount("/") == 0);
+    }
+};
+
 #if defined(TEST_SGXFS)
 class oe_fd_sgxfs_file_system : public oe_fd_file_system
 {
@@ -0,0 +1,247 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/syscall/sys/ioring.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "test_ioring_t.h"
+
+#define NUM_ENTRIES 8
+#define BUFFER_SIZE 4096
+
+static int _setup(void)
+{
+    struct oe_io_ring_params params = {NUM_ENTRIES, BUFFER_SIZE, 2};
+    int ring = oe_io_ring_setup(&params);
+
+    OE_TEST(ring >= 0);
+    return ring;
+}
+
+static void _reap_all(int ring, struct oe_io_ring_cqe* cqes, unsigned int n)
+{
+    unsigned int reaped = 0;
+
+    while (reaped < n)
+    {
+        int r = oe_io_ring_reap(ring, cqes + reaped, n - reaped, 1);
+        OE_TEST(r > 0);
+        reaped += (unsigned int)r;
+    }
+}
+
+static void test_invalid(void)
+{
+    struct oe_io_ring_params params = {OE_IO_RING_MAX_ENTRIES + 1, 0, 0};
+    struct oe_io_ring_sqe sqe = {0};
+    struct oe_io_ring_cqe cqe;
+    int ring;
+
+    OE_TEST(oe_io_ring_setup(&params) == -1);
+    OE_TEST(errno == EINVAL);
+
+    ring = _setup();
+
+    /* Nothing is in flight, so nothing is waited for. */
+    OE_TEST(oe_io_ring_reap(ring, &cqe, 1, 1) == 0);
+
+    sqe.opcode = OE_IO_RING_OP_READ;
+    sqe.fd = 1000;
+    OE_TEST(oe_io_ring_submit(ring, &sqe, 1) == -1);
+    OE_TEST(errno == EBADF);
+
+    sqe.opcode = 1000;
+    sqe.fd = STDOUT_FILENO;
+    OE_TEST(oe_io_ring_submit(ring, &sqe, 1) == -1);
+    OE_TEST(errno == EINVAL);
+
+    /* The ring is not a host descriptor. */
+    sqe.opcode = OE_IO_RING_OP_READ;
+    sqe.fd = ring;
+    OE_TEST(oe_io_ring_submit(ring, &sqe, 1) == -1);
+    OE_TEST(errno == EBADF);
+
+    sqe.opcode = OE_IO_RING_OP_NOP;
+    sqe.user_data = 42;
+    OE_TEST(oe_io_ring_submit(ring, &sqe, 1) == 1);
+    OE_TEST(oe_io_ring_reap(ring, &cqe, 1, 1) == 1);
+    OE_TEST(cqe.user_data == 42);
+    OE_TEST(cqe.res == 0);
+
+    OE_TEST(close(ring) == 0);
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+static void test_file(const char* tmp_dir)
+{
+    static uint8_t bufs[NUM_ENTRIES][2 * BUFFER_SIZE];
+    struct oe_io_ring_sqe sqes[NUM_ENTRIES + 1];
+    struct oe_io_ring_cqe cqes[NUM_ENTRIES];
+    char path[PATH_MAX];
+    int ring = _setup();
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/file", tmp_dir);
+    OE_TEST((fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0666)) >= 0);
+
+    /* Write a page per entry, and one more than fits in the ring. */
+    memset(sqes, 0, sizeof(sqes));
+    for (size_t i = 0; i <= NUM_ENTRIES; i++)
+    {
+        if (i < NUM_ENTRIES)
+            memset(bufs[i], 'a' + (int)i, BUFFER_SIZE);
+
+        sqes[i].opcode = OE_IO_RING_OP_WRITE;
+        sqes[i].fd = fd;
+        sqes[i].addr = bufs[i % NUM_ENTRIES];
+        sqes[i].len = BUFFER_SIZE;
+        sqes[i].off = (oe_off_t)(i * BUFFER_SIZE);
+        sqes[i].user_data = i;
+    }
+
+    OE_TEST(oe_io_ring_submit(ring, sqes, NUM_ENTRIES + 1) == NUM_ENTRIES);
+    OE_TEST(oe_io_ring_submit(ring, &sqes[NUM_ENTRIES], 1) == -1);
+    OE_TEST(errno == EBUSY);
+
+    /* The data has been copied, so the buffers can be reused. */
+    memset(bufs, 0, sizeof(bufs));
+
+    _reap_all(ring, cqes, NUM_ENTRIES);
+    for (size_t i = 0; i < NUM_ENTRIES; i++)
+        OE_TEST(cqes[i].res == BUFFER_SIZE);
+
+    /* Flush the file, then read it back. Reads longer than the host buffer
+     * are shortened to it. */
+    sqes[0].opcode = OE_IO_RING_OP_FSYNC;
+    sqes[0].user_data = 100;
+    OE_TEST(oe_io_ring_submit(ring, sqes, 1) == 1);
+    OE_TEST(oe_io_ring_reap(ring, cqes, 1, 1) == 1);
+    OE_TEST(cqes[0].user_data == 100);
+    OE_TEST(cqes[0].res == 0);
+
+    for (size_t i = 0; i < NUM_ENTRIES; i++)
+    {
+        sqes[i].opcode = OE_IO_RING_OP_READ;
+        sqes[i].addr = bufs[i];
+        sqes[i].len = sizeof(bufs[i]);
+        sqes[i].off = (oe_off_t)(i * BUFFER_SIZE);
+        sqes[i].user_data = i;
+    }
+
+    OE_TEST(oe_io_ring_submit(ring, sqes, NUM_ENTRIES) == NUM_ENTRIES);
+    _reap_all(ring, cqes, NUM_ENTRIES);
+
+    for (size_t i = 0; i < NUM_ENTRIES; i++)
+    {
+        size_t n = cqes[i].user_data;
+
+        OE_TEST(n < NUM_ENTRIES);
+        OE_TEST(cqes[i].res == BUFFER_SIZE);
+
+        for (size_t j = 0; j < BUFFER_SIZE; j++)
+            OE_TEST(bufs[n][j] == 'a' + n);
+    }
+
+    /* Read at the end of the file. */
+    sqes[0].off = NUM_ENTRIES * BUFFER_SIZE;
+    OE_TEST(oe_io_ring_submit(ring, sqes, 1) == 1);
+    OE_TEST(oe_io_ring_reap(ring, cqes, 1, 1) == 1);
+    OE_TEST(cqes[0].res == 0);
+
+    /* The file descriptor is closed once the operation using it completes. */
+    sqes[0].off = 0;
+    OE_TEST(oe_io_ring_submit(ring, sqes, 1) == 1);
+    OE_TEST(close(fd) == 0);
+    OE_TEST(oe_io_ring_reap(ring, cqes, 1, 1) == 1);
+    OE_TEST(cqes[0].res == BUFFER_SIZE);
+
+    OE_TEST(close(ring) == 0);
+    OE_TEST(unlink(path) == 0);
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+static void test_socket(void)
+{
+    const char message[] = "hello ring";
+    char buf[sizeof(message)];
+    struct oe_io_ring_sqe sqes[2];
+    struct oe_io_ring_cqe cqes[2];
+    int ring = _setup();
+    int sv[2];
+
+    OE_TEST(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+
+    /* Queue the receive first, so that it blocks on the host until the send
+     * completes. */
+    memset(sqes, 0, sizeof(sqes));
+    sqes[0].opcode = OE_IO_RING_OP_RECV;
+    sqes[0].fd = sv[1];
+    sqes[0].addr = buf;
+    sqes[0].len = sizeof(buf);
+    sqes[0].flags = MSG_WAITALL;
+    sqes[0].user_data = 0;
+    OE_TEST(oe_io_ring_submit(ring, sqes, 1) == 1);
+
+    sqes[1].opcode = OE_IO_RING_OP_SEND;
+    sqes[1].fd = sv[0];
+    sqes[1].addr = (void*)message;
+    sqes[1].len = sizeof(message);
+    sqes[1].user_data = 1;
+    OE_TEST(oe_io_ring_submit(ring, &sqes[1], 1) == 1);
+
+    _reap_all(ring, cqes, 2);
+    OE_TEST(cqes[0].res == sizeof(message));
+    OE_TEST(cqes[1].res == sizeof(message));
+    OE_TEST(memcmp(buf, message, sizeof(message)) == 0);
+
+    /* Sockets do not support fsync(). */
+    sqes[0].opcode = OE_IO_RING_OP_FSYNC;
+    OE_TEST(oe_io_ring_submit(ring, sqes, 1) == -1);
+    OE_TEST(errno == EINVAL);
+
+    /* Closing the ring abandons a receive that has not completed. */
+    sqes[0].opcode = OE_IO_RING_OP_RECV;
+    OE_TEST(oe_io_ring_submit(ring, sqes, 1) == 1);
+    OE_TEST(close(ring) == 0);
+
+    OE_TEST(shutdown(sv[0], SHUT_RDWR) == 0);
+    OE_TEST(close(sv[0]) == 0);
+    OE_TEST(close(sv[1]) == 0);
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+void test_ioring(const char* tmp_dir)
+{
+    struct stat st;
+
+    OE_TEST(oe_load_module_host_file_system() == OE_OK);
+    OE_TEST(oe_load_module_host_socket_interface() == OE_OK);
+    OE_TEST(oe_load_module_host_io_ring() == OE_OK);
+    OE_TEST(mount("/", "/", OE_HOST_FILE_SYSTEM, 0, NULL) == 0);
+
+    if (stat(tmp_dir, &st) != 0)
+        OE_TEST(mkdir(tmp_dir, 0777) == 0);
+
+    test_invalid();
+    test_file(tmp_dir);
+    test_socket();
+
+    OE_TEST(umount("/") == 0);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    1024, /* NumStackPages */
+    2);   /* NumTCS */
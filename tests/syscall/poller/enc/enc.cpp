@@ -3,8 +3,11 @@
 
 #include <openenclave/corelibc/stdio.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/syscall/netinet/in.h>
+#include <openenclave/internal/syscall/sys/poll.h>
 #include <openenclave/internal/syscall/sys/select.h>
 #include <openenclave/internal/syscall/sys/socket.h>
+#include <openenclave/internal/syscall/unistd.h>
 #include <openenclave/internal/tests.h>
 #include "../client.h"
 #include "../server.h"
@@ -324,6 +327,159 @@ extern "C" void test_fd_set(void)
     oe_printf("==== passed %s\n", __FUNCTION__);
 }
 
+/* Enough pairs for poll() to keep an interest set on the host. */
+#define NUM_PAIRS 16
+
+static void _open_pair(int* sock, int* peer)
+{
+    int sv[2];
+
+    OE_TEST(oe_socketpair(OE_AF_LOCAL, OE_SOCK_STREAM, 0, sv) == 0);
+    *sock = sv[0];
+    *peer = sv[1];
+}
+
+static void _write_byte(int fd)
+{
+    char c = 'x';
+    OE_TEST(oe_write(fd, &c, 1) == 1);
+}
+
+static void _read_byte(int fd)
+{
+    char c = 0;
+    OE_TEST(oe_read(fd, &c, 1) == 1);
+    OE_TEST(c == 'x');
+}
+
+static int _poll(struct oe_pollfd* fds, oe_nfds_t nfds)
+{
+    for (oe_nfds_t i = 0; i < nfds; i++)
+        fds[i].revents = -1;
+
+    return oe_poll(fds, nfds, 0);
+}
+
+extern "C" void test_interest_set(void)
+{
+    int socks[NUM_PAIRS];
+    int peers[NUM_PAIRS];
+    struct oe_pollfd fds[NUM_PAIRS];
+
+    _init();
+
+    for (size_t i = 0; i < NUM_PAIRS; i++)
+    {
+        _open_pair(&socks[i], &peers[i]);
+        fds[i].fd = socks[i];
+        fds[i].events = OE_POLLIN;
+    }
+
+    /* Nothing is readable yet. */
+    OE_TEST(_poll(fds, NUM_PAIRS) == 0);
+
+    for (size_t i = 0; i < NUM_PAIRS; i++)
+        OE_TEST(fds[i].revents == 0);
+
+    /* Repeated calls with a changing set of events. */
+    for (size_t round = 0; round < 4 * NUM_PAIRS; round++)
+    {
+        size_t readable = round % NUM_PAIRS;
+        size_t writable = (round * 7 + 3) % NUM_PAIRS;
+
+        _write_byte(peers[readable]);
+        fds[writable].events = OE_POLLOUT;
+
+        int n = _poll(fds, NUM_PAIRS);
+        OE_TEST(n == (readable == writable ? 1 : 2));
+
+        for (size_t i = 0; i < NUM_PAIRS; i++)
+        {
+            if (i == writable)
+                OE_TEST(fds[i].revents == OE_POLLOUT);
+            else if (i == readable)
+                OE_TEST(fds[i].revents == OE_POLLIN);
+            else
+                OE_TEST(fds[i].revents == 0);
+        }
+
+        _read_byte(socks[readable]);
+        fds[writable].events = OE_POLLIN;
+    }
+
+    /* Replace a pair, which may reuse the same fds on the host. */
+    OE_TEST(oe_close(socks[5]) == 0);
+    OE_TEST(oe_close(peers[5]) == 0);
+    _open_pair(&socks[5], &peers[5]);
+    fds[5].fd = socks[5];
+
+    OE_TEST(_poll(fds, NUM_PAIRS) == 0);
+    _write_byte(peers[5]);
+    OE_TEST(_poll(fds, NUM_PAIRS) == 1);
+    OE_TEST(fds[5].revents == OE_POLLIN);
+    _read_byte(socks[5]);
+
+    /* A hang up is reported without being asked for. */
+    OE_TEST(oe_close(peers[9]) == 0);
+    OE_TEST(_poll(fds, NUM_PAIRS) == 1);
+    OE_TEST(fds[9].revents & OE_POLLHUP);
+    OE_TEST(oe_close(socks[9]) == 0);
+    _open_pair(&socks[9], &peers[9]);
+    fds[9].fd = socks[9];
+
+    /* The same fd listed twice. */
+    fds[1].fd = socks[0];
+    _write_byte(peers[0]);
+    OE_TEST(_poll(fds, NUM_PAIRS) == 2);
+    OE_TEST(fds[0].revents == OE_POLLIN);
+    OE_TEST(fds[1].revents == OE_POLLIN);
+    _read_byte(socks[0]);
+    fds[1].fd = socks[1];
+
+    /* A set too small for the interest set falls back to a plain poll. */
+    _write_byte(peers[2]);
+    OE_TEST(_poll(fds, 4) == 1);
+    OE_TEST(fds[2].revents == OE_POLLIN);
+    OE_TEST(_poll(fds, NUM_PAIRS) == 1);
+    _read_byte(socks[2]);
+
+    /* select() takes the same path. */
+    {
+        oe_fd_set rfds;
+        int max = -1;
+        struct oe_timeval tv = {0, 0};
+
+        OE_FD_ZERO(&rfds);
+
+        for (size_t i = 0; i < NUM_PAIRS; i++)
+        {
+            OE_FD_SET(socks[i], &rfds);
+
+            if (socks[i] > max)
+                max = socks[i];
+        }
+
+        _write_byte(peers[3]);
+        _write_byte(peers[11]);
+
+        OE_TEST(oe_select(max + 1, &rfds, NULL, NULL, &tv) == 2);
+
+        for (size_t i = 0; i < NUM_PAIRS; i++)
+            OE_TEST(!!OE_FD_ISSET(socks[i], &rfds) == (i == 3 || i == 11));
+
+        _read_byte(socks[3]);
+        _read_byte(socks[11]);
+    }
+
+    for (size_t i = 0; i < NUM_PAIRS; i++)
+    {
+        OE_TEST(oe_close(socks[i]) == 0);
+        OE_TEST(oe_close(peers[i]) == 0);
+    }
+
+    oe_printf("==== passed %s\n", __FUNCTION__);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
@@ -156,6 +156,7 @@ int main(int argc, const char* argv[])
     test_enclave_to_enclave(poller_type);
 
     test_fd_set(_enclave);
+    test_interest_set(_enclave);
 
     r = oe_terminate_enclave(_enclave);
     OE_TEST(r == OE_OK);
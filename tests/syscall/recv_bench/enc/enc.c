@@ -0,0 +1,152 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "recv_bench_t.h"
+
+static int _send_all(int fd, const uint8_t* buf, size_t size)
+{
+    while (size)
+    {
+        ssize_t n = send(fd, buf, size, 0);
+        if (n <= 0)
+            return -1;
+
+        buf += n;
+        size -= (size_t)n;
+    }
+
+    return 0;
+}
+
+/* Receive exactly size bytes in calls of up to buffer_size bytes each. */
+static int _recv_all(int fd, uint8_t* buf, size_t buffer_size, size_t size)
+{
+    size_t received = 0;
+
+    while (received < size)
+    {
+        ssize_t n = recv(fd, buf + received, buffer_size - received, 0);
+        if (n <= 0 || (size_t)n > size - received)
+            return -1;
+
+        received += (size_t)n;
+    }
+
+    return 0;
+}
+
+int enc_recv_bench(size_t message_size, size_t buffer_size, size_t num_messages)
+{
+    int ret = -1;
+    int sv[2] = {-1, -1};
+    uint8_t* message = NULL;
+    uint8_t* buf = NULL;
+
+    if (!message_size || message_size > buffer_size)
+        goto done;
+
+    if (oe_load_module_host_socket_interface() != OE_OK)
+        goto done;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+        goto done;
+
+    if (!(message = malloc(message_size)) || !(buf = malloc(buffer_size)))
+        goto done;
+
+    for (size_t i = 0; i < num_messages; i++)
+    {
+        message[0] = (uint8_t)i;
+        message[message_size - 1] = (uint8_t)~i;
+
+        if (_send_all(sv[0], message, message_size) != 0)
+            goto done;
+
+        if (_recv_all(sv[1], buf, buffer_size, message_size) != 0)
+            goto done;
+
+        if (buf[0] != (uint8_t)i || buf[message_size - 1] != (uint8_t)~i)
+            goto done;
+    }
+
+    ret = 0;
+
+done:
+    if (sv[0] != -1)
+        close(sv[0]);
+    if (sv[1] != -1)
+        close(sv[1]);
+    free(message);
+    free(buf);
+
+    return ret;
+}
+
+static int _sv[2] = {-1, -1};
+static uint8_t* _message;
+static uint8_t* _buf;
+static size_t _buffer_size;
+
+int enc_recv_setup(size_t buffer_size)
+{
+    if (!buffer_size)
+        return -1;
+
+    if (oe_load_module_host_socket_interface() != OE_OK)
+        return -1;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, _sv) != 0)
+        return -1;
+
+    if (!(_message = calloc(1, buffer_size)) || !(_buf = malloc(buffer_size)))
+        return -1;
+
+    _buffer_size = buffer_size;
+
+    return 0;
+}
+
+int enc_recv_one(size_t message_size)
+{
+    static uint8_t count;
+
+    if (!message_size || message_size > _buffer_size)
+        return -1;
+
+    _message[0] = ++count;
+
+    if (_send_all(_sv[0], _message, message_size) != 0)
+        return -1;
+
+    if (recv(_sv[1], _buf, _buffer_size, 0) != (ssize_t)message_size)
+        return -1;
+
+    return _buf[0] == count ? 0 : -1;
+}
+
+void enc_recv_teardown()
+{
+    if (_sv[0] != -1)
+        close(_sv[0]);
+    if (_sv[1] != -1)
+        close(_sv[1]);
+    _sv[0] = _sv[1] = -1;
+
+    free(_message);
+    free(_buf);
+    _message = _buf = NULL;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    1024, /* NumStackPages */
+    1);   /* NumTCS */
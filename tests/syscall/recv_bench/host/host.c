@@ -0,0 +1,109 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <time.h>
+#include "recv_bench_u.h"
+
+/* Every message is received into a buffer of this size, as a server reading
+ * requests of unknown length would. */
+#define BUFFER_SIZE (64 * 1024)
+
+/* Bytes and messages sent per message size. */
+#define TOTAL_BYTES (64 * 1024 * 1024)
+#define MAX_MESSAGES 20000
+
+/* Messages received one per ecall, per message size. */
+#define ECALL_MESSAGES 10000
+
+static double _now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void _run_benchmark(oe_enclave_t* enclave, size_t message_size)
+{
+    size_t num_messages = TOTAL_BYTES / message_size;
+    double begin;
+    double seconds;
+    int ret = -1;
+
+    if (num_messages > MAX_MESSAGES)
+        num_messages = MAX_MESSAGES;
+
+    begin = _now();
+    OE_TEST(
+        enc_recv_bench(
+            enclave, &ret, message_size, BUFFER_SIZE, num_messages) == OE_OK);
+    OE_TEST(ret == 0);
+    seconds = _now() - begin;
+
+    printf(
+        "%6zu byte messages: %10.0f messages/s, %8.1f MB/s\n",
+        message_size,
+        (double)num_messages / seconds,
+        (double)(num_messages * message_size) / seconds / (1024 * 1024));
+}
+
+/* Receive each message in an ecall of its own, so that the thread does not
+ * keep host memory for switchless calls between the receives. */
+static void _run_ecall_benchmark(oe_enclave_t* enclave, size_t message_size)
+{
+    double begin;
+    double seconds;
+    int ret = -1;
+
+    OE_TEST(enc_recv_setup(enclave, &ret, BUFFER_SIZE) == OE_OK);
+    OE_TEST(ret == 0);
+
+    begin = _now();
+    for (size_t i = 0; i < ECALL_MESSAGES; i++)
+    {
+        OE_TEST(enc_recv_one(enclave, &ret, message_size) == OE_OK);
+        OE_TEST(ret == 0);
+    }
+    seconds = _now() - begin;
+
+    OE_TEST(enc_recv_teardown(enclave) == OE_OK);
+
+    printf(
+        "%6zu byte messages, one recv per ecall: %10.0f messages/s\n",
+        message_size,
+        (double)ECALL_MESSAGES / seconds);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t r;
+    oe_enclave_t* enclave = NULL;
+    const uint32_t flags = oe_get_create_flags();
+    const size_t message_sizes[] = {64, 1024, 16 * 1024, BUFFER_SIZE};
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    r = oe_create_recv_bench_enclave(
+        argv[1], OE_ENCLAVE_TYPE_AUTO, flags, NULL, 0, &enclave);
+    OE_TEST(r == OE_OK);
+
+    for (size_t i = 0; i < OE_COUNTOF(message_sizes); i++)
+        _run_benchmark(enclave, message_sizes[i]);
+
+    for (size_t i = 0; i < OE_COUNTOF(message_sizes); i++)
+        _run_ecall_benchmark(enclave, message_sizes[i]);
+
+    r = oe_terminate_enclave(enclave);
+    OE_TEST(r == OE_OK);
+
+    printf("=== passed all tests (recv_bench)\n");
+
+    return 0;
+}
@@ -194,10 +194,107 @@ int ecall_getaddrinfo(struct oe_addrinfo** res)
     return 0;
 }
 
+static int _lookup(const char* node, struct oe_addrinfo** res)
+{
+    struct oe_addrinfo hints;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    return oe_getaddrinfo(node, "telnet", &hints, res);
+}
+
+static bool _addrinfo_equal(
+    const struct oe_addrinfo* ai1,
+    const struct oe_addrinfo* ai2)
+{
+    for (; ai1 && ai2; ai1 = ai1->ai_next, ai2 = ai2->ai_next)
+    {
+        if (ai1->ai_family != ai2->ai_family ||
+            ai1->ai_socktype != ai2->ai_socktype ||
+            ai1->ai_protocol != ai2->ai_protocol ||
+            ai1->ai_addrlen != ai2->ai_addrlen ||
+            memcmp(ai1->ai_addr, ai2->ai_addr, ai1->ai_addrlen) != 0)
+        {
+            return false;
+        }
+    }
+
+    return !ai1 && !ai2;
+}
+
+void ecall_test_cache(void)
+{
+    oe_host_resolver_cache_options_t options = {2, 60, 60};
+    struct oe_addrinfo* ai1 = NULL;
+    struct oe_addrinfo* ai2 = NULL;
+    struct oe_addrinfo* ai3 = NULL;
+
+    options.max_entries = OE_HOST_RESOLVER_CACHE_MAX_ENTRIES + 1;
+    OE_TEST(oe_configure_host_resolver_cache(&options) == OE_INVALID_PARAMETER);
+
+    options.max_entries = 2;
+    OE_TEST(oe_configure_host_resolver_cache(&options) == OE_OK);
+
+    /* The first lookup fills the cache, the second is answered from it. Each
+     * caller gets its own list. */
+    OE_TEST(_lookup("localhost", &ai1) == 0);
+    OE_TEST(_lookup("localhost", &ai2) == 0);
+    OE_TEST(ai1 != ai2);
+    OE_TEST(_addrinfo_equal(ai1, ai2));
+    oe_freeaddrinfo(ai1);
+
+    /* A lookup that finds nothing gives the same error again. */
+    {
+        int ret1 = _lookup("oe-resolver-test.invalid", &ai1);
+        int ret2 = _lookup("oe-resolver-test.invalid", &ai1);
+
+        OE_TEST(ret1 != 0);
+        OE_TEST(ret2 != 0);
+        OE_TEST(ai1 == NULL);
+    }
+
+    /* Evicting the entries does not affect the results already returned. */
+    OE_TEST(_lookup("127.0.0.1", &ai3) == 0);
+    oe_freeaddrinfo(ai3);
+    OE_TEST(_lookup("localhost", &ai1) == 0);
+    OE_TEST(_addrinfo_equal(ai1, ai2));
+    oe_freeaddrinfo(ai1);
+    oe_freeaddrinfo(ai2);
+
+    /* With the cache disabled, lookups go to the host again. */
+    OE_TEST(oe_configure_host_resolver_cache(NULL) == OE_OK);
+    OE_TEST(_lookup("localhost", &ai1) == 0);
+    oe_freeaddrinfo(ai1);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+void ecall_enable_cache(size_t max_entries)
+{
+    oe_host_resolver_cache_options_t options = {max_entries, 0, 0};
+
+    /* With a time to live of 0, only concurrent lookups share results. */
+    OE_TEST(oe_configure_host_resolver_cache(&options) == OE_OK);
+}
+
+void ecall_getaddrinfo_cached(size_t iterations)
+{
+    for (size_t i = 0; i < iterations; i++)
+    {
+        struct oe_addrinfo* ai = NULL;
+
+        OE_TEST(_lookup(i % 2 ? "localhost" : "127.0.0.1", &ai) == 0);
+        OE_TEST(ai != NULL);
+        oe_freeaddrinfo(ai);
+    }
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
     true, /* Debug */
     256,  /* NumHeapPages */
     256,  /* NumStackPages */
-    1);   /* NumTCS */
+    4);   /* NumTCS */
@@ -27,6 +27,12 @@ typedef HANDLE pthread_t;
 
 #define SERVER_PORT "12345"
 
+/* Must not exceed the NumTCS of the enclave. */
+#define NUM_THREADS 4
+#define ITERATIONS 200
+
+static oe_enclave_t* _enclave;
+
 static void _free_addrinfo(struct oe_addrinfo* res)
 {
     struct oe_addrinfo* p;
@@ -43,6 +49,50 @@ static void _free_addrinfo(struct oe_addrinfo* res)
     }
 }
 
+static void* _lookup_thread(void* arg)
+{
+    OE_UNUSED(arg);
+
+    OE_TEST(ecall_getaddrinfo_cached(_enclave, ITERATIONS) == OE_OK);
+
+    return NULL;
+}
+
+/* Look up the same names from several threads, so that lookups of the same
+ * name wait for each other and share their results. */
+static void _test_concurrent_lookups(void)
+{
+    pthread_t threads[NUM_THREADS];
+
+    OE_TEST(ecall_enable_cache(_enclave, 1) == OE_OK);
+
+    for (size_t i = 0; i < NUM_THREADS; i++)
+    {
+#if defined(_WIN32)
+        threads[i] = CreateThread(
+            NULL, 0, (LPTHREAD_START_ROUTINE)_lookup_thread, NULL, 0, NULL);
+        OE_TEST(threads[i] != INVALID_HANDLE_VALUE);
+#else
+        if (pthread_create(&threads[i], NULL, _lookup_thread, NULL) != 0)
+        {
+            OE_TEST("pthread_create()" == NULL);
+        }
+#endif
+    }
+
+    for (size_t i = 0; i < NUM_THREADS; i++)
+    {
+#if defined(_WIN32)
+        OE_TEST(WaitForSingleObject(threads[i], INFINITE) == WAIT_OBJECT_0);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -124,6 +174,10 @@ int main(int argc, const char* argv[])
         printf("host received: host = %s\n", host);
     }
 
+    _enclave = client_enclave;
+    OE_TEST(ecall_test_cache(client_enclave) == OE_OK);
+    _test_concurrent_lookups();
+
     OE_TEST(oe_terminate_enclave(client_enclave) == OE_OK);
 
     printf("=== passed all tests (resolver_test)\n");
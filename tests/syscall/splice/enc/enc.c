@@ -0,0 +1,232 @@
+// Copyright (c) Open Enclave SDK contributors.
+// Licensed under the MIT License.
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mount.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "test_splice_t.h"
+
+#define FILE_SIZE (200 * 1024)
+
+static uint8_t _data[FILE_SIZE];
+static uint8_t _buf[FILE_SIZE];
+
+static void _create_file(const char* path)
+{
+    int fd;
+
+    for (size_t i = 0; i < FILE_SIZE; i++)
+        _data[i] = (uint8_t)(i * 7 + i / 256);
+
+    OE_TEST((fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0666)) >= 0);
+    OE_TEST(write(fd, _data, FILE_SIZE) == FILE_SIZE);
+    OE_TEST(close(fd) == 0);
+}
+
+static void _recv_all(int fd, uint8_t* buf, size_t size)
+{
+    size_t received = 0;
+
+    while (received < size)
+    {
+        ssize_t n = recv(fd, buf + received, size - received, 0);
+        OE_TEST(n > 0);
+        received += (size_t)n;
+    }
+}
+
+/* Send size bytes from the file to the socket pair, and check that they
+ * arrive in order, starting at offset start of the file. */
+static void _sendfile_and_check(
+    int sv[2],
+    int fd,
+    off_t* offset,
+    size_t start,
+    size_t size)
+{
+    size_t sent = 0;
+
+    while (sent < size)
+    {
+        ssize_t n = sendfile(sv[0], fd, offset, size - sent);
+        OE_TEST(n > 0);
+
+        _recv_all(sv[1], _buf + sent, (size_t)n);
+        sent += (size_t)n;
+    }
+
+    OE_TEST(memcmp(_buf, _data + start, size) == 0);
+}
+
+static void test_sendfile(const char* path)
+{
+    int sv[2];
+    int fd;
+    off_t offset;
+
+    OE_TEST(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    OE_TEST((fd = open(path, O_RDONLY)) >= 0);
+
+    /* Without an offset, the file position is used and advanced. */
+    OE_TEST(lseek(fd, 1000, SEEK_SET) == 1000);
+    _sendfile_and_check(sv, fd, NULL, 1000, 50000);
+    OE_TEST(lseek(fd, 0, SEEK_CUR) == 51000);
+
+    /* With an offset, the offset is advanced instead. */
+    offset = 100000;
+    _sendfile_and_check(sv, fd, &offset, 100000, 60000);
+    OE_TEST(offset == 160000);
+    OE_TEST(lseek(fd, 0, SEEK_CUR) == 51000);
+
+    /* At the end of the file. */
+    offset = FILE_SIZE;
+    OE_TEST(sendfile(sv[0], fd, &offset, 100) == 0);
+    OE_TEST(offset == FILE_SIZE);
+
+    /* Offsets are only valid for files. */
+    offset = 0;
+    OE_TEST(sendfile(fd, sv[1], &offset, 100) == -1);
+    OE_TEST(errno == ESPIPE);
+
+    offset = -1;
+    OE_TEST(sendfile(sv[0], fd, &offset, 100) == -1);
+    OE_TEST(errno == EINVAL);
+
+    OE_TEST(sendfile(sv[0], 1000, NULL, 100) == -1);
+    OE_TEST(errno == EBADF);
+
+    OE_TEST(close(fd) == 0);
+    OE_TEST(close(sv[0]) == 0);
+    OE_TEST(close(sv[1]) == 0);
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+static void test_forward(const char* path)
+{
+    int in[2];
+    int out[2];
+    int fd;
+    off_t offset = 500;
+    size_t moved = 0;
+
+    OE_TEST(socketpair(AF_UNIX, SOCK_STREAM, 0, in) == 0);
+    OE_TEST(socketpair(AF_UNIX, SOCK_STREAM, 0, out) == 0);
+
+    /* Forward from one socket to another. */
+    OE_TEST(send(in[0], _data, 4096, 0) == 4096);
+    OE_TEST(splice(in[1], NULL, out[0], NULL, 4096, SPLICE_F_MOVE) == 4096);
+    _recv_all(out[1], _buf, 4096);
+    OE_TEST(memcmp(_buf, _data, 4096) == 0);
+
+    /* Forward from a socket into a file, at an offset. */
+    OE_TEST((fd = open(path, O_RDWR)) >= 0);
+    OE_TEST(send(in[0], _data + 4096, 10000, 0) == 10000);
+
+    while (moved < 10000)
+    {
+        ssize_t n = splice(in[1], NULL, fd, &offset, 10000 - moved, 0);
+        OE_TEST(n > 0);
+        moved += (size_t)n;
+    }
+
+    OE_TEST(offset == 10500);
+    OE_TEST(lseek(fd, 0, SEEK_CUR) == 0);
+    OE_TEST(pread(fd, _buf, 10000, 500) == 10000);
+    OE_TEST(memcmp(_buf, _data + 4096, 10000) == 0);
+
+    /* Restore the file. */
+    OE_TEST(pwrite(fd, _data + 500, 10000, 500) == 10000);
+
+    OE_TEST(splice(in[1], NULL, out[0], NULL, 100, 0x100) == -1);
+    OE_TEST(errno == EINVAL);
+
+    OE_TEST(close(fd) == 0);
+    OE_TEST(close(in[0]) == 0);
+    OE_TEST(close(in[1]) == 0);
+    OE_TEST(close(out[0]) == 0);
+    OE_TEST(close(out[1]) == 0);
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+/* Cached files are copied through the enclave, so that the data and the
+ * file position of the cache are used. */
+static void test_cached(const char* path)
+{
+    oe_hostfs_cache_options_t options = {0};
+    struct pollfd pfd = {0};
+    int sv[2];
+    int fd;
+
+    OE_TEST(
+        mount("/", "/", OE_HOST_FILE_SYSTEM, OE_MS_HOSTFS_CACHE, &options) ==
+        0);
+    OE_TEST(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+    OE_TEST((fd = open(path, O_RDWR)) >= 0);
+
+    /* The write is only in the cache until it is flushed. */
+    memset(_data, 0x5a, 8192);
+    OE_TEST(write(fd, _data, 8192) == 8192);
+    OE_TEST(lseek(fd, 0, SEEK_SET) == 0);
+
+    _sendfile_and_check(sv, fd, NULL, 0, 30000);
+    OE_TEST(lseek(fd, 0, SEEK_CUR) == 30000);
+
+    /* poll() still works on the host descriptor of a cached file. */
+    pfd.fd = fd;
+    pfd.events = POLLIN | POLLOUT;
+    OE_TEST(poll(&pfd, 1, 0) == 1);
+    OE_TEST((pfd.revents & (POLLIN | POLLOUT)) == (POLLIN | POLLOUT));
+    OE_TEST(lseek(fd, 0, SEEK_CUR) == 30000);
+
+    OE_TEST(close(fd) == 0);
+    OE_TEST(close(sv[0]) == 0);
+    OE_TEST(close(sv[1]) == 0);
+    OE_TEST(umount("/") == 0);
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+void test_splice(const char* tmp_dir)
+{
+    char path[PATH_MAX];
+    struct stat st;
+
+    OE_TEST(oe_load_module_host_file_system() == OE_OK);
+    OE_TEST(oe_load_module_host_socket_interface() == OE_OK);
+    OE_TEST(mount("/", "/", OE_HOST_FILE_SYSTEM, 0, NULL) == 0);
+
+    if (stat(tmp_dir, &st) != 0)
+        OE_TEST(mkdir(tmp_dir, 0777) == 0);
+
+    snprintf(path, sizeof(path), "%s/file", tmp_dir);
+    _create_file(path);
+
+    test_sendfile(path);
+    test_forward(path);
+    OE_TEST(umount("/") == 0);
+
+    test_cached(path);
+
+    OE_TEST(mount("/", "/", OE_HOST_FILE_SYSTEM, 0, NULL) == 0);
+    OE_TEST(unlink(path) == 0);
+    OE_TEST(umount("/") == 0);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* Debug */
+    1024, /* NumHeapPages */
+    1024, /* NumStackPages */
+    1);   /* NumTCS */
@@ -93,6 +93,9 @@ struct Function
     std::vector<Decl*> params_;
     bool switchless_;
     bool errno_;
+    bool async_;
+    bool zero_copy_;
+    bool batchable_;
 };
 
 struct Edl
@@ -219,6 +219,29 @@ class CEmitter
               << "size_t __oe_ecalls_table_size = "
                  "OE_COUNTOF(__oe_ecalls_table);"
               << "";
+        zero_copy_ecalls_table();
+    }
+
+    void zero_copy_ecalls_table()
+    {
+        bool zero_copy = false;
+        for (Function* f : edl_->trusted_funcs_)
+            zero_copy = zero_copy || f->zero_copy_;
+        if (!zero_copy)
+            return;
+
+        // Tells oe_handle_call_enclave_function to leave the input buffer of
+        // these ecalls in host memory.
+        out() << "static const uint8_t _zero_copy_ecalls[] = {";
+        size_t idx = 0;
+        for (Function* f : edl_->trusted_funcs_)
+            out() << std::string("    ") + (f->zero_copy_ ? "1" : "0") +
+                         (++idx < edl_->trusted_funcs_.size() ? "," : "");
+        out() << "};"
+              << ""
+              << "const uint8_t* __oe_ecalls_zero_copy_table = "
+                 "_zero_copy_ecalls;"
+              << "";
     }
 
     void ocalls_table()
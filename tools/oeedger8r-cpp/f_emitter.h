@@ -51,10 +51,21 @@ class FEmitter
               << "    oe_result_t _result = OE_FAILURE;";
         if (!ecall_)
             out() << "    OE_UNUSED(input_buffer_size);";
+        bool zero_copy = ecall_ && f->zero_copy_;
         out() << ""
-              << "    /* Prepare parameters. */"
-              << "    " + args_t + "* pargs_in = (" + args_t + "*)input_buffer;"
-              << "    " + args_t + "* pargs_out = (" + args_t +
+              << "    /* Prepare parameters. */";
+        if (zero_copy)
+        {
+            out() << "    /* The input buffer of a zero_copy ecall may lie in "
+                     "host memory. */"
+                  << "    " + args_t + " _args_in;"
+                  << "    " + args_t + "* pargs_in = &_args_in;";
+            declare_in_copies(f);
+        }
+        else
+            out() << "    " + args_t + "* pargs_in = (" + args_t +
+                         "*)input_buffer;";
+        out() << "    " + args_t + "* pargs_out = (" + args_t +
                      "*)output_buffer;"
               << ""
               << "    size_t input_buffer_offset = 0;"
@@ -62,12 +73,22 @@ class FEmitter
               << "    OE_ADD_SIZE(input_buffer_offset, sizeof(*pargs_in));"
               << "    OE_ADD_SIZE(output_buffer_offset, sizeof(*pargs_out));"
               << "";
-        if (ecall_)
+        if (zero_copy)
+            zero_copy_buffer_checks();
+        else if (ecall_)
             ecall_buffer_checks();
         else
             ocall_buffer_checks();
-        out() << "    /* Set in and in-out pointers. */";
-        set_in_in_out_pointers(f);
+        if (zero_copy)
+        {
+            out() << "    /* Copy in pointers to their own enclave buffers. */";
+            copy_in_pointers(f);
+        }
+        else
+        {
+            out() << "    /* Set in and in-out pointers. */";
+            set_in_in_out_pointers(f);
+        }
         out() << "    /* Set out and in-out pointers. */"
               << "    /* In-out parameters are copied to output buffer. */";
         set_out_in_out_pointers(f);
@@ -89,6 +110,8 @@ class FEmitter
               << ""
               << "done:";
         write_result();
+        if (zero_copy)
+            free_in_copies(f);
         out() << "}"
               << "";
     }
@@ -109,6 +132,63 @@ class FEmitter
               << "";
     }
 
+    void zero_copy_buffer_checks()
+    {
+        out() << "    /* Make sure the input buffer lies either within or "
+                 "outside the enclave */"
+              << "    /* and the output buffer lies within the enclave. */"
+              << "    if (!oe_is_within_enclave(input_buffer, "
+                 "input_buffer_size) &&"
+              << "        !oe_is_outside_enclave(input_buffer, "
+                 "input_buffer_size))"
+              << "        goto done;"
+              << ""
+              << "    if (!oe_is_within_enclave(output_buffer, "
+                 "output_buffer_size))"
+              << "        goto done;"
+              << ""
+              << "    /* Copy the marshalling struct to avoid TOCTOU issues. */"
+              << "    if (input_buffer_size < input_buffer_offset)"
+              << "    {"
+              << "        _result = OE_BUFFER_TOO_SMALL;"
+              << "        goto done;"
+              << "    }"
+              << "    memcpy(pargs_in, input_buffer, sizeof(*pargs_in));"
+              << "";
+    }
+
+    void declare_in_copies(Function* f)
+    {
+        for (Decl* p : f->params_)
+            if (p->attrs_ && p->attrs_->in_)
+                out() << "    void* _in_" + p->name_ + " = NULL;";
+    }
+
+    void copy_in_pointers(Function* f)
+    {
+        bool empty = true;
+        for (Decl* p : f->params_)
+        {
+            if (!p->attrs_ || !p->attrs_->in_)
+                continue;
+            std::string size = psize(p, "pargs_in->");
+            out() << "    if (pargs_in->" + p->name_ + ")"
+                  << "        OE_COPY_IN_POINTER(" + p->name_ + ", " + size +
+                         ", " + mtype_str(p) + ");";
+            empty = false;
+        }
+        if (empty)
+            out() << "    /* There were no in parameters. */";
+        out() << "";
+    }
+
+    void free_in_copies(Function* f)
+    {
+        for (Decl* p : f->params_)
+            if (p->attrs_ && p->attrs_->in_)
+                out() << "    oe_free(_in_" + p->name_ + ");";
+    }
+
     void ocall_buffer_checks()
     {
         out() << "    /* Make sure input and output buffers are valid. */"
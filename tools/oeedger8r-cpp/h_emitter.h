@@ -66,8 +66,11 @@ class HEmitter
         std::string inc = (gen_t_h_ ? "enclave" : "host");
         header(out(), guard);
         out() << ""
-              << "#include <openenclave/" + inc + ".h>"
-              << ""
+              << "#include <openenclave/" + inc + ".h>";
+        // Asynchronous and batched ocalls use the edger8r enclave API.
+        if (gen_t_h_ && has_async_or_batchable_ocalls())
+            out() << "#include <openenclave/edger8r/enclave.h>";
+        out() << ""
               << "#include \"" + edl_->name_ + "_args.h\""
               << ""
               << "OE_EXTERNC_BEGIN"
@@ -97,11 +100,27 @@ class HEmitter
     void untrusted_prototypes()
     {
         for (Function* f : edl_->untrusted_funcs_)
+        {
             out() << prototype(f, false, gen_t_h_) + ";"
                   << "";
+            if (f->async_ && gen_t_h_)
+                out() << async_prototype(f) + ";"
+                      << "";
+            if (f->batchable_ && gen_t_h_)
+                out() << batch_prototype(f) + ";"
+                      << "";
+        }
         if (edl_->untrusted_funcs_.empty())
             out() << "";
     }
+
+    bool has_async_or_batchable_ocalls()
+    {
+        for (Function* f : edl_->untrusted_funcs_)
+            if (f->async_ || f->batchable_)
+                return true;
+        return false;
+    }
 };
 
 #endif // H_EMITTER_H
@@ -564,7 +564,7 @@ void Parser::parse_allow_list(bool trusted, const std::string& fname)
 Function* Parser::parse_function_decl(bool trusted)
 {
     in_function_ = true;
-    Function* f = new Function{{}, {}, {}, false, false};
+    Function* f = new Function{{}, {}, {}, false, false, false, false, false};
     f->rtype_ = parse_atype();
     Token name = next();
     if (!name.is_name())
@@ -588,7 +588,7 @@ Function* Parser::parse_function_decl(bool trusted)
     expect(")");
     parse_allow_list(trusted, f->name_);
 
-    for (int i = 0; i < 2; ++i)
+    for (int i = 0; i < 5; ++i)
     {
         if (peek() == "transition_using_threads" && !f->switchless_)
         {
@@ -600,9 +600,31 @@ Function* Parser::parse_function_decl(bool trusted)
             next();
             f->errno_ = true;
         }
+        else if (!trusted && peek() == "async" && !f->async_)
+        {
+            next();
+            f->async_ = true;
+        }
+        else if (!trusted && peek() == "batchable" && !f->batchable_)
+        {
+            next();
+            f->batchable_ = true;
+        }
+        else if (trusted && peek() == "zero_copy" && !f->zero_copy_)
+        {
+            next();
+            f->zero_copy_ = true;
+        }
     }
     expect(";");
 
+    if (f->async_)
+        check_async(f);
+    if (f->zero_copy_)
+        check_zero_copy(f);
+    if (f->batchable_)
+        check_batchable(f);
+
     warn_non_portable(f);
     error_size_count(f);
     check_size_count_decls(f->name_, f->params_);
@@ -909,6 +931,69 @@ void Parser::warn_non_portable(Function* f)
     }
 }
 
+void Parser::check_async(Function* f)
+{
+    // The caller does not wait for an async ocall to complete, so there is
+    // nothing to return results through.
+    if (!f->switchless_)
+        ERROR(
+            "Function '%s': async functions must also be declared "
+            "transition_using_threads",
+            f->name_.c_str());
+    if (f->errno_)
+        ERROR(
+            "Function '%s': async functions cannot propagate errno",
+            f->name_.c_str());
+    if (f->rtype_->tag_ != Void)
+        ERROR(
+            "Function '%s': async functions must return void",
+            f->name_.c_str());
+    for (Decl* p : f->params_)
+        if (p->attrs_ && (p->attrs_->out_ || p->attrs_->inout_))
+            ERROR(
+                "Function '%s': async functions cannot have out or in-out "
+                "parameters",
+                f->name_.c_str());
+}
+
+void Parser::check_batchable(Function* f)
+{
+    // The calls of a batch complete when the batch is submitted, after the
+    // caller's out buffers may have gone away. Only the return value and
+    // errno are delivered.
+    if (f->async_)
+        ERROR(
+            "Function '%s': batchable functions cannot be async",
+            f->name_.c_str());
+    for (Decl* p : f->params_)
+        if (p->attrs_ && (p->attrs_->out_ || p->attrs_->inout_))
+            ERROR(
+                "Function '%s': batchable functions cannot have out or in-out "
+                "parameters",
+                f->name_.c_str());
+}
+
+void Parser::check_zero_copy(Function* f)
+{
+    // The in parameters of a zero_copy ecall are copied straight from host
+    // memory into their own enclave buffers, one level deep.
+    for (Decl* p : f->params_)
+    {
+        if (!p->attrs_)
+            continue;
+        if (p->attrs_->inout_)
+            ERROR(
+                "Function '%s': zero_copy functions cannot have in-out "
+                "parameters",
+                f->name_.c_str());
+        if (p->attrs_->in_ && get_user_type_for_deep_copy(types_, p))
+            ERROR(
+                "Function '%s': zero_copy functions cannot have deep-copied "
+                "in parameters",
+                f->name_.c_str());
+    }
+}
+
 void Parser::error_size_count(Function* f)
 {
     for (Decl* p : f->params_)
@@ -89,6 +89,9 @@ class Parser
     void append_function(std::vector<Function*>& funcs, Function* f);
     void warn_allow_list(const std::string& fname);
     void warn_non_portable(Function* f);
+    void check_async(Function* f);
+    void check_batchable(Function* f);
+    void check_zero_copy(Function* f);
     void error_size_count(Function* f);
     void check_size_count_decls(
         const std::string& parent_name,
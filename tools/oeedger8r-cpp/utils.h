@@ -185,6 +185,29 @@ inline std::string prototype(
     return retstr + " " + prefix + f->name_ + argsstr;
 }
 
+// Enclave-side wrapper of an async ocall that returns a completion handle.
+inline std::string async_prototype(const Function* f)
+{
+    std::string argsstr = "(\n    oe_async_ocall_t** _call";
+    for (Decl* p : f->params_)
+        argsstr += ",\n    " + decl_str(p->name_, p->type_, p->dims_);
+    argsstr += ")";
+    return "oe_result_t " + f->name_ + "_async" + argsstr;
+}
+
+// Enclave-side wrapper that adds an ocall to a batch.
+inline std::string batch_prototype(const Function* f)
+{
+    std::string argsstr =
+        "(\n    oe_ocall_batch_t* _batch,\n    oe_result_t* _call_result";
+    if (f->rtype_->tag_ != Void)
+        argsstr += ",\n    " + atype_str(f->rtype_) + "* _retval";
+    for (Decl* p : f->params_)
+        argsstr += ",\n    " + decl_str(p->name_, p->type_, p->dims_);
+    argsstr += ")";
+    return "oe_result_t " + f->name_ + "_batch" + argsstr;
+}
+
 inline std::string create_prototype(const std::string& ename)
 {
     return "oe_result_t oe_create_" + ename + "_enclave(\n" +
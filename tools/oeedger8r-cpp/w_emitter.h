@@ -75,7 +75,17 @@ class WEmitter
 
     void emit(Function* f, bool ecall, const std::string& prefix = "")
     {
+        if (!ecall && f->async_)
+        {
+            ecall_ = ecall;
+            emit_async(f);
+            return;
+        }
+
         ecall_ = ecall;
+        if (!ecall && f->batchable_)
+            emit_batch(f);
+
         std::string alloc_fcn;
         std::string free_fcn;
         std::string call;
@@ -207,6 +217,212 @@ class WEmitter
                   << "";
     }
 
+    /*
+     * An async ocall is marshalled into a buffer owned by an oe_async_ocall_t
+     * and posted to the host switchless workers. The wrapper returns as soon
+     * as the call is posted. Async ocalls have no outputs (see
+     * Parser::check_async), so nothing is unmarshalled.
+     *
+     * Two wrappers are generated: [fun_name]_async returns the completion
+     * handle, and [fun_name] releases it immediately (fire-and-forget).
+     */
+    void emit_async(Function* f)
+    {
+        std::string fcn_id = edl_->name_ + "_fcn_id_" + f->name_;
+        std::string args_t = f->name_ + "_args_t";
+
+        out() << async_prototype(f) << "{"
+              << "    oe_result_t _result = OE_FAILURE;"
+              << "";
+        enclave_status_check();
+        out() << "    /* Marshalling struct. */"
+              << "    " + args_t + " _args, *_pargs_in = NULL;"
+              << ""
+              << "    /* Marshalling buffer and sizes. */"
+              << "    size_t _input_buffer_size = 0;"
+              << "    size_t _output_buffer_size = 0;"
+              << "    size_t _total_buffer_size = 0;"
+              << "    oe_async_ocall_t* _async_call = NULL;"
+              << "    uint8_t* _buffer = NULL;"
+              << "    uint8_t* _input_buffer = NULL;"
+              << "    uint8_t* _output_buffer = NULL;"
+              << "    size_t _input_buffer_offset = 0;"
+              << ""
+              << "    /* Fill marshalling struct. */"
+              << "    memset(&_args, 0, sizeof(_args));";
+        fill_marshalling_struct(f);
+        out() << ""
+              << "    /* Compute input buffer size. Include in and in-out "
+                 "parameters. */";
+        compute_input_buffer_size(f);
+        out() << "    "
+              << "    /* Compute output buffer size. Include out and in-out "
+                 "parameters. */";
+        compute_output_buffer_size(f);
+        out() << "    "
+              << "    /* Allocate the call and its marshalling buffer. */"
+              << "    _total_buffer_size = _input_buffer_size;"
+              << "    OE_ADD_SIZE(_total_buffer_size, _output_buffer_size);"
+              << "    _async_call = oe_allocate_async_ocall(_total_buffer_size);"
+              << "    if (_async_call == NULL)"
+              << "    {"
+              << "        _result = OE_OUT_OF_MEMORY;"
+              << "        goto done;"
+              << "    }"
+              << "    _buffer = (uint8_t*)oe_get_async_ocall_buffer(_async_call);"
+              << "    _input_buffer = _buffer;"
+              << "    _output_buffer = _buffer + _input_buffer_size;"
+              << "    "
+              << "    /* Serialize buffer inputs (in and in-out parameters). */";
+        serialize_buffer_inputs(f);
+        out() << "    "
+              << "    /* Copy args structure (now filled) to input buffer. */"
+              << "    memcpy(_pargs_in, &_args, sizeof(*_pargs_in));"
+              << ""
+              << "    /* Post the call to the host without waiting for it. */"
+              << "    if ((_result = oe_post_async_ocall("
+              << "             _async_call,"
+              << "             " + fcn_id + ","
+              << "             _input_buffer,"
+              << "             _input_buffer_size,"
+              << "             _output_buffer,"
+              << "             _output_buffer_size)) != OE_OK)"
+              << "        goto done;"
+              << ""
+              << "    /* The call now owns the marshalling buffer. */"
+              << "    if (_call)"
+              << "        *_call = _async_call;"
+              << "    else"
+              << "        oe_release_async_ocall(_async_call);"
+              << "    _async_call = NULL;"
+              << ""
+              << "    _result = OE_OK;"
+              << ""
+              << "done:"
+              << "    if (_async_call)"
+              << "        oe_release_async_ocall(_async_call);"
+              << ""
+              << "    return _result;"
+              << "}"
+              << "";
+
+        std::string args = "NULL";
+        for (Decl* p : f->params_)
+            args += ", " + p->name_;
+        out() << prototype(f, false, true) << "{"
+              << "    return " + f->name_ + "_async(" + args + ");"
+              << "}"
+              << "";
+    }
+
+    /*
+     * A batchable ocall gets an additional [fun_name]_batch wrapper that
+     * marshals the call into the buffer of an oe_ocall_batch_t and adds it to
+     * the batch. The call is performed when the batch is submitted; the
+     * return value and errno are then unmarshalled by a completion function.
+     * Batchable ocalls have no out or in-out parameters (see
+     * Parser::check_batchable).
+     */
+    void emit_batch(Function* f)
+    {
+        std::string fcn_id = edl_->name_ + "_fcn_id_" + f->name_;
+        std::string args_t = f->name_ + "_args_t";
+        std::string completion = "NULL";
+        std::string completion_arg = "NULL";
+
+        if (f->rtype_->tag_ != Void || f->errno_)
+        {
+            completion = "_" + f->name_ + "_batch_completion";
+            out() << "static void " + completion + "("
+                  << "    const void* _output_buffer,"
+                  << "    void* _arg)"
+                  << "{"
+                  << "    const " + args_t + "* _pargs_out ="
+                  << "        (const " + args_t + "*)_output_buffer;"
+                  << "";
+            if (f->rtype_->tag_ != Void)
+            {
+                completion_arg = "_retval";
+                out() << "    /* Unmarshal return value. */"
+                      << "    if (_arg)"
+                      << "        *(" + atype_str(f->rtype_) +
+                             "*)_arg = _pargs_out->_retval;";
+            }
+            else
+                out() << "    OE_UNUSED(_arg);";
+            if (f->errno_)
+                out() << ""
+                      << "    /* Retrieve propagated errno from OCALL. */"
+                      << "    oe_errno = _pargs_out->_ocall_errno;";
+            out() << "}"
+                  << "";
+        }
+
+        out() << batch_prototype(f) << "{"
+              << "    oe_result_t _result = OE_FAILURE;"
+              << "";
+        enclave_status_check();
+        out() << "    /* Marshalling struct. */"
+              << "    " + args_t + " _args, *_pargs_in = NULL;"
+              << ""
+              << "    /* Marshalling buffer and sizes. */"
+              << "    size_t _input_buffer_size = 0;"
+              << "    size_t _output_buffer_size = 0;"
+              << "    size_t _total_buffer_size = 0;"
+              << "    uint8_t* _buffer = NULL;"
+              << "    uint8_t* _input_buffer = NULL;"
+              << "    uint8_t* _output_buffer = NULL;"
+              << "    size_t _input_buffer_offset = 0;"
+              << ""
+              << "    /* Fill marshalling struct. */"
+              << "    memset(&_args, 0, sizeof(_args));";
+        fill_marshalling_struct(f);
+        out() << ""
+              << "    /* Compute input buffer size. Include in and in-out "
+                 "parameters. */";
+        compute_input_buffer_size(f);
+        out() << "    "
+              << "    /* Compute output buffer size. Include out and in-out "
+                 "parameters. */";
+        compute_output_buffer_size(f);
+        out() << "    "
+              << "    /* Allocate marshalling buffer in the batch. */"
+              << "    _total_buffer_size = _input_buffer_size;"
+              << "    OE_ADD_SIZE(_total_buffer_size, _output_buffer_size);"
+              << "    _buffer = (uint8_t*)oe_ocall_batch_allocate_buffer("
+              << "        _batch, _total_buffer_size);"
+              << "    if (_buffer == NULL)"
+              << "    {"
+              << "        _result = OE_OUT_OF_MEMORY;"
+              << "        goto done;"
+              << "    }"
+              << "    _input_buffer = _buffer;"
+              << "    _output_buffer = _buffer + _input_buffer_size;"
+              << "    "
+              << "    /* Serialize buffer inputs (in and in-out parameters). */";
+        serialize_buffer_inputs(f);
+        out() << "    "
+              << "    /* Copy args structure (now filled) to input buffer. */"
+              << "    memcpy(_pargs_in, &_args, sizeof(*_pargs_in));"
+              << ""
+              << "    /* Add the call to the batch. */"
+              << "    _result = oe_ocall_batch_add("
+              << "        _batch,"
+              << "        " + fcn_id + ","
+              << "        _input_buffer,"
+              << "        _input_buffer_size,"
+              << "        _output_buffer,"
+              << "        _output_buffer_size,"
+              << "        " + completion + ","
+              << "        " + completion_arg + ","
+              << "        _call_result);"
+              << ""
+              << "done:"
+              << "    return _result;"
+              << "}"
+              << "";
+    }
+
     bool gen_t() const
     {
         return !ecall_;